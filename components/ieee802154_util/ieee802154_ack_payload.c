@@ -0,0 +1,142 @@
+#include <string.h>
+#include <stdbool.h>
+#include <freertos/FreeRTOS.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_ack_payload.h"
+
+typedef struct {
+    uint8_t addr_mode;  // ADDR_MODE_NONE if the entry is free
+    uint8_t addr[8];    // On air byte order
+    uint8_t length;
+    uint8_t payload[IEEE802154_ACK_PAYLOAD_MAX];
+} ack_payload_entry_t;
+
+static ack_payload_entry_t entries[IEEE802154_ACK_PAYLOAD_ENTRIES];
+static volatile uint8_t entries_used = 0; // Lets the ACK generator skip the lookup if nothing is pending
+static portMUX_TYPE entries_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint8_t address_to_air(const ieee802154_address_t *addr, uint8_t *air)
+{
+    if (addr->mode == ADDR_MODE_SHORT)
+    {
+        air[0] = addr->short_address & 0xFF;
+        air[1] = addr->short_address >> 8;
+        return 2;
+    }
+    esp_ieee802154_ext_address_write(addr->long_address, air);
+    return 8;
+}
+
+static IEEE802154_ISR_ATTR ack_payload_entry_t *find_entry(uint8_t addr_mode, const uint8_t *addr)
+{
+    uint8_t addr_length = (addr_mode == ADDR_MODE_SHORT) ? 2 : 8;
+    for (uint8_t idx = 0; idx < IEEE802154_ACK_PAYLOAD_ENTRIES; idx++)
+    {
+        if (entries[idx].addr_mode == addr_mode && memcmp(entries[idx].addr, addr, addr_length) == 0)
+        {
+            return &entries[idx];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_ieee802154_ack_payload_set(const ieee802154_address_t *addr, const uint8_t *data, uint8_t length)
+{
+    if (length == 0 || length > IEEE802154_ACK_PAYLOAD_MAX || (addr->mode != ADDR_MODE_SHORT && addr->mode != ADDR_MODE_LONG))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t air[8] = {0};
+    address_to_air(addr, air);
+
+    esp_err_t err = ESP_OK;
+    portENTER_CRITICAL(&entries_lock);
+    ack_payload_entry_t *entry = find_entry(addr->mode, air);
+    if (entry == NULL)
+    {
+        for (uint8_t idx = 0; idx < IEEE802154_ACK_PAYLOAD_ENTRIES && entry == NULL; idx++)
+        {
+            if (entries[idx].addr_mode == ADDR_MODE_NONE)
+            {
+                entry = &entries[idx];
+            }
+        }
+    }
+    if (entry == NULL)
+    {
+        err = ESP_ERR_NO_MEM;
+    }
+    else
+    {
+        if (entry->addr_mode == ADDR_MODE_NONE)
+        {
+            entries_used += 1;
+        }
+        entry->addr_mode = addr->mode;
+        memcpy(entry->addr, air, sizeof(air));
+        memcpy(entry->payload, data, length);
+        entry->length = length;
+    }
+    portEXIT_CRITICAL(&entries_lock);
+    return err;
+}
+
+void esp_ieee802154_ack_payload_clear(const ieee802154_address_t *addr)
+{
+    uint8_t air[8] = {0};
+    address_to_air(addr, air);
+
+    portENTER_CRITICAL(&entries_lock);
+    ack_payload_entry_t *entry = find_entry(addr->mode, air);
+    if (entry != NULL)
+    {
+        entry->addr_mode = ADDR_MODE_NONE;
+        entries_used -= 1;
+    }
+    portEXIT_CRITICAL(&entries_lock);
+}
+
+bool esp_ieee802154_ack_payload_pending(const ieee802154_address_t *addr)
+{
+    uint8_t air[8] = {0};
+    address_to_air(addr, air);
+
+    portENTER_CRITICAL(&entries_lock);
+    bool pending = (find_entry(addr->mode, air) != NULL);
+    portEXIT_CRITICAL(&entries_lock);
+    return pending;
+}
+
+IEEE802154_ISR_ATTR uint8_t esp_ieee802154_ack_payload_take(uint8_t addr_mode, const uint8_t *addr, uint8_t *payload)
+{
+    if (entries_used == 0 || (addr_mode != ADDR_MODE_SHORT && addr_mode != ADDR_MODE_LONG))
+    {
+        return 0;
+    }
+
+    uint8_t length = 0;
+    portENTER_CRITICAL_ISR(&entries_lock);
+    ack_payload_entry_t *entry = find_entry(addr_mode, addr);
+    if (entry != NULL)
+    {
+        length = entry->length;
+        memcpy(payload, entry->payload, length);
+        entry->addr_mode = ADDR_MODE_NONE;
+        entries_used -= 1;
+    }
+    portEXIT_CRITICAL_ISR(&entries_lock);
+    return length;
+}
+
+uint8_t esp_ieee802154_ack_payload_get(const uint8_t *ack, const uint8_t **payload)
+{
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&ack[1], ack[0], &parsed) || parsed.frame_type != FRAME_TYPE_ACK || parsed.payload_length == 0)
+    {
+        return 0;
+    }
+    *payload = &ack[1 + parsed.header_length];
+    return parsed.payload_length;
+}
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_ack_policy.h"
+
+#define TAG "ieee802154_ack_policy"
+
+#define FCF_ACK_REQUEST_BIT 0x20
+#define ACK_POLICY_US_PER_BYTE     32
+#define ACK_POLICY_PHY_OVERHEAD    6    // Preamble, SFD and PHR
+#define ACK_POLICY_TURNAROUND_US   192  // aTurnaroundTime, 12 symbols
+#define ACK_POLICY_IMM_ACK_LENGTH  5    // Imm-ACK including the FCS, until the first ACK was seen
+#define ACK_POLICY_LOSS_SCALE      16   // The loss rate is kept in 1/16 per mille, so the average does not stall
+#define ACK_POLICY_LOSS_WEIGHT     8    // Weight 1/8 of a new sample
+
+typedef struct {
+    ieee802154_addr_id_t id;
+    uint16_t loss_q;             // Loss rate in 1/16 per mille
+    uint8_t probe_countdown;     // Frames without ACK request until the next probe
+    ieee802154_ack_policy_state_t state;
+} ack_policy_destination_t;
+
+static ack_policy_destination_t destinations[IEEE802154_ACK_POLICY_MAX_DESTINATIONS];
+static uint8_t destination_count = 0;
+static uint8_t destination_index[IEEE802154_ADDR_BOOK_MAX]; // Index + 1 in destinations by address book id, 0 if none
+static portMUX_TYPE policy_lock = portMUX_INITIALIZER_UNLOCKED; // Protects the destinations
+
+/* --- Policy --- */
+
+static uint16_t ack_policy_limit_permille(ieee802154_reliability_t reliability)
+{
+    return (reliability == IEEE802154_RELIABILITY_BEST_EFFORT) ? 100 : 10;
+}
+
+static ack_policy_destination_t *ack_policy_find(ieee802154_addr_id_t id)
+{
+    if (destination_index[id] > 0)
+    {
+        return &destinations[destination_index[id] - 1];
+    }
+    if (destination_count >= IEEE802154_ACK_POLICY_MAX_DESTINATIONS)
+    {
+        return NULL;
+    }
+
+    ack_policy_destination_t *destination = &destinations[destination_count];
+    memset(destination, 0, sizeof(ack_policy_destination_t));
+    destination->id = id;
+    destination->state.ack_length = ACK_POLICY_IMM_ACK_LENGTH;
+    destination_count += 1;
+    destination_index[id] = destination_count;
+    return destination;
+}
+
+bool esp_ieee802154_ack_policy_decide(ieee802154_addr_id_t dst, ieee802154_reliability_t reliability)
+{
+    if (reliability == IEEE802154_RELIABILITY_NONE || dst == IEEE802154_ADDR_ID_NONE)
+    {
+        return false; // Broadcasts are never acknowledged
+    }
+
+    portENTER_CRITICAL(&policy_lock);
+    ack_policy_destination_t *destination = ack_policy_find(dst);
+    if (destination == NULL)
+    {
+        portEXIT_CRITICAL(&policy_lock);
+        return true;
+    }
+
+    ieee802154_ack_policy_state_t *state = &destination->state;
+    uint16_t limit_q = ack_policy_limit_permille(reliability) * ACK_POLICY_LOSS_SCALE;
+    bool ack = true;
+    state->frames += 1;
+
+    if (reliability == IEEE802154_RELIABILITY_CRITICAL || state->samples < IEEE802154_ACK_POLICY_MIN_SAMPLES ||
+        destination->loss_q > limit_q)
+    {
+        if (state->unacked)
+        {
+            state->unacked = false;
+            state->fallbacks += 1;
+        }
+    }
+    else if (!state->unacked && destination->loss_q <= limit_q / 2)
+    {
+        state->unacked = true;
+        destination->probe_countdown = IEEE802154_ACK_POLICY_PROBE_INTERVAL - 1;
+    }
+
+    if (state->unacked)
+    {
+        if (destination->probe_countdown > 0)
+        {
+            destination->probe_countdown -= 1;
+            ack = false;
+            state->without_ack += 1;
+            state->saved_us += ACK_POLICY_TURNAROUND_US + (ACK_POLICY_PHY_OVERHEAD + state->ack_length) * ACK_POLICY_US_PER_BYTE;
+            state->delivered_milli += 1000 - state->loss_permille;
+        }
+        else
+        {
+            destination->probe_countdown = IEEE802154_ACK_POLICY_PROBE_INTERVAL - 1;
+        }
+    }
+    portEXIT_CRITICAL(&policy_lock);
+    return ack;
+}
+
+void esp_ieee802154_ack_policy_update(ieee802154_addr_id_t dst, const uint8_t *frame, const ieee802154_tx_result_t *result)
+{
+    if (dst == IEEE802154_ADDR_ID_NONE || (frame[1] & FCF_ACK_REQUEST_BIT) == 0)
+    {
+        return;
+    }
+    if (result->error != ESP_IEEE802154_TX_ERR_NONE && result->error != ESP_IEEE802154_TX_ERR_NO_ACK)
+    {
+        return; // The frame did not reach the air or the outcome is unknown
+    }
+
+    portENTER_CRITICAL(&policy_lock);
+    ack_policy_destination_t *destination = ack_policy_find(dst);
+    if (destination != NULL)
+    {
+        ieee802154_ack_policy_state_t *state = &destination->state;
+        int32_t sample_q = result->acked ? 0 : 1000 * ACK_POLICY_LOSS_SCALE;
+        destination->loss_q += (sample_q - (int32_t)destination->loss_q) / ACK_POLICY_LOSS_WEIGHT;
+        state->loss_permille = destination->loss_q / ACK_POLICY_LOSS_SCALE;
+        state->samples += 1;
+        if (result->acked)
+        {
+            state->ack_length = result->ack[0];
+        }
+        else
+        {
+            state->lost += 1;
+        }
+    }
+    portEXIT_CRITICAL(&policy_lock);
+}
+
+bool esp_ieee802154_ack_policy_get(ieee802154_addr_id_t id, ieee802154_ack_policy_state_t *state)
+{
+    if (id >= IEEE802154_ADDR_BOOK_MAX)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&policy_lock);
+    bool found = (destination_index[id] > 0);
+    if (found)
+    {
+        *state = destinations[destination_index[id] - 1].state;
+    }
+    portEXIT_CRITICAL(&policy_lock);
+    return found;
+}
+
+uint16_t esp_ieee802154_ack_policy_delivery(const ieee802154_ack_policy_state_t *state)
+{
+    uint64_t frames = (uint64_t)state->samples + state->without_ack;
+    if (frames == 0)
+    {
+        return 1000;
+    }
+    return (uint16_t)((((uint64_t)state->samples - state->lost) * 1000 + state->delivered_milli) / frames);
+}
+
+bool esp_ieee802154_ack_policy_parse_reliability(const char *name, ieee802154_reliability_t *reliability)
+{
+    static const char *names[] = { "none", "best", "normal", "critical" };
+    for (uint8_t idx = 0; idx < sizeof(names) / sizeof(names[0]); idx++)
+    {
+        if (strcmp(name, names[idx]) == 0)
+        {
+            *reliability = (ieee802154_reliability_t)idx;
+            return true;
+        }
+    }
+    return false;
+}
+
+void esp_ieee802154_ack_policy_reset(void)
+{
+    portENTER_CRITICAL(&policy_lock);
+    memset(destination_index, 0, sizeof(destination_index));
+    destination_count = 0;
+    portEXIT_CRITICAL(&policy_lock);
+}
+
+/* --- Console --- */
+
+static void ack_policy_print(void)
+{
+    char addr[IEEE802154_ADDRESS_TEXT_LENGTH];
+    ieee802154_ack_policy_state_t state;
+
+    portENTER_CRITICAL(&policy_lock);
+    uint8_t count = destination_count;
+    portEXIT_CRITICAL(&policy_lock);
+
+    if (count == 0)
+    {
+        printf("No frames recorded\n");
+        return;
+    }
+
+    printf("%-24s %-7s %6s %8s %8s %8s %8s %5s %10s %9s\n",
+           "Destination", "Mode", "Loss", "Samples", "Lost", "Frames", "No ACK", "Back", "Saved ms", "Delivery");
+    for (uint8_t idx = 0; idx < count; idx++)
+    {
+        portENTER_CRITICAL(&policy_lock);
+        ieee802154_addr_id_t id = destinations[idx].id;
+        state = destinations[idx].state;
+        portEXIT_CRITICAL(&policy_lock);
+
+        uint16_t delivery = esp_ieee802154_ack_policy_delivery(&state);
+        esp_ieee802154_addr_book_format(id, addr, sizeof(addr));
+        printf("%-24s %-7s %3u.%u%% %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %5" PRIu32 " %10" PRIu64 " %6u.%u%%\n",
+               addr, state.unacked ? "no ACK" : "ACKed", state.loss_permille / 10, state.loss_permille % 10,
+               state.samples, state.lost, state.frames, state.without_ack, state.fallbacks, state.saved_us / 1000,
+               delivery / 10, delivery % 10);
+    }
+}
+
+static int ack_policy_command(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        ack_policy_print();
+    }
+    else if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        esp_ieee802154_ack_policy_reset();
+    }
+    else
+    {
+        printf("Usage: ackpolicy [reset]\n");
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_ack_policy_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "ackpolicy",
+        .help = "ACK request policy per destination: loss rate, frames sent without ACK, saved air time and delivery ratio",
+        .hint = "[reset]",
+        .func = &ack_policy_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,235 @@
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_addr_book.h"
+
+#define TAG "ieee802154_addr_book"
+
+#define NO_SHORT_ADDRESS 0xFFFF
+#define NO_EXT_ADDRESS   0
+#define MAX_SLOTS_USED   (IEEE802154_ADDR_BOOK_SLOTS - IEEE802154_ADDR_BOOK_SLOTS / 4) // Keeps probe sequences short
+
+static ieee802154_addr_book_entry_t entries[IEEE802154_ADDR_BOOK_MAX];
+static ieee802154_addr_id_t slots[IEEE802154_ADDR_BOOK_SLOTS]; // Ids, IEEE802154_ADDR_ID_NONE if empty
+static uint16_t entry_count = 0;
+static uint16_t slot_count = 0; // Used slots, an entry with both addresses has two
+static bool initialized = false;
+static portMUX_TYPE book_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* --- Hash table --- */
+
+static IEEE802154_ISR_ATTR uint32_t addr_book_hash(uint16_t pan_id, uint8_t mode, uint64_t value)
+{
+    uint64_t key = value ^ ((uint64_t)pan_id << 48) ^ mode;
+    uint32_t folded = (uint32_t)(key >> 32) ^ (uint32_t)key;
+    return (folded * 0x9E3779B1) >> (32 - IEEE802154_ADDR_BOOK_BITS); // Fibonacci hashing
+}
+
+static IEEE802154_ISR_ATTR bool addr_book_matches(const ieee802154_addr_book_entry_t *entry, uint16_t pan_id, uint8_t mode, uint64_t value)
+{
+    if (entry->pan_id != pan_id)
+    {
+        return false;
+    }
+    return (mode == ADDR_MODE_SHORT) ? (entry->short_address == value) : (entry->ext_address == value);
+}
+
+/* Index of the slot holding the address, or of the empty slot that ends its probe sequence */
+static IEEE802154_ISR_ATTR uint32_t addr_book_probe(uint16_t pan_id, uint8_t mode, uint64_t value)
+{
+    uint32_t index = addr_book_hash(pan_id, mode, value);
+    while (slots[index] != IEEE802154_ADDR_ID_NONE && !addr_book_matches(&entries[slots[index]], pan_id, mode, value))
+    {
+        index = (index + 1) & (IEEE802154_ADDR_BOOK_SLOTS - 1); // Ends at an empty slot, at most MAX_SLOTS_USED are used
+    }
+    return index;
+}
+
+static void addr_book_init(void)
+{
+    if (!initialized)
+    {
+        memset(slots, 0xFF, sizeof(slots)); // All slots IEEE802154_ADDR_ID_NONE
+        initialized = true;
+    }
+}
+
+static IEEE802154_ISR_ATTR uint64_t addr_book_key(const ieee802154_address_t *addr)
+{
+    return (addr->mode == ADDR_MODE_SHORT) ? addr->short_address : addr->long_address;
+}
+
+/* The values that mark an unknown address (and broadcasts) are never stored */
+static IEEE802154_ISR_ATTR bool addr_book_valid(const ieee802154_address_t *addr)
+{
+    return (addr->mode == ADDR_MODE_SHORT && addr->short_address != NO_SHORT_ADDRESS) ||
+           (addr->mode == ADDR_MODE_LONG && addr->long_address != NO_EXT_ADDRESS);
+}
+
+static ieee802154_addr_id_t addr_book_add(uint16_t pan_id, uint16_t short_address, uint64_t ext_address)
+{
+    uint16_t needed = (short_address != NO_SHORT_ADDRESS) + (ext_address != NO_EXT_ADDRESS);
+    if (entry_count >= IEEE802154_ADDR_BOOK_MAX || slot_count + needed > MAX_SLOTS_USED)
+    {
+        return IEEE802154_ADDR_ID_NONE;
+    }
+
+    ieee802154_addr_id_t id = entry_count;
+    entries[id].pan_id = pan_id;
+    entries[id].short_address = short_address;
+    entries[id].ext_address = ext_address;
+    entry_count += 1;
+    slot_count += needed;
+
+    if (short_address != NO_SHORT_ADDRESS)
+    {
+        slots[addr_book_probe(pan_id, ADDR_MODE_SHORT, short_address)] = id;
+    }
+    if (ext_address != NO_EXT_ADDRESS)
+    {
+        slots[addr_book_probe(pan_id, ADDR_MODE_LONG, ext_address)] = id;
+    }
+    return id;
+}
+
+/* --- Address book --- */
+
+ieee802154_addr_id_t esp_ieee802154_addr_book_intern(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    if (!addr_book_valid(addr))
+    {
+        return IEEE802154_ADDR_ID_NONE;
+    }
+
+    portENTER_CRITICAL(&book_lock);
+    addr_book_init();
+    ieee802154_addr_id_t id = slots[addr_book_probe(pan_id, addr->mode, addr_book_key(addr))];
+    if (id == IEEE802154_ADDR_ID_NONE)
+    {
+        bool is_short = (addr->mode == ADDR_MODE_SHORT);
+        id = addr_book_add(pan_id, is_short ? addr->short_address : NO_SHORT_ADDRESS, is_short ? NO_EXT_ADDRESS : addr->long_address);
+    }
+    portEXIT_CRITICAL(&book_lock);
+    return id;
+}
+
+ieee802154_addr_id_t esp_ieee802154_addr_book_destination(const uint8_t *frame)
+{
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed))
+    {
+        return IEEE802154_ADDR_ID_NONE;
+    }
+    return esp_ieee802154_addr_book_find(parsed.dst_pan_id, &parsed.dst_addr);
+}
+
+IEEE802154_ISR_ATTR ieee802154_addr_id_t esp_ieee802154_addr_book_find(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    if (!initialized || !addr_book_valid(addr))
+    {
+        return IEEE802154_ADDR_ID_NONE;
+    }
+
+    portENTER_CRITICAL_SAFE(&book_lock);
+    ieee802154_addr_id_t id = slots[addr_book_probe(pan_id, addr->mode, addr_book_key(addr))];
+    portEXIT_CRITICAL_SAFE(&book_lock);
+    return id;
+}
+
+ieee802154_addr_id_t esp_ieee802154_addr_book_bind(uint16_t pan_id, uint16_t short_address, uint64_t ext_address)
+{
+    if (short_address == NO_SHORT_ADDRESS || ext_address == NO_EXT_ADDRESS)
+    {
+        return IEEE802154_ADDR_ID_NONE;
+    }
+
+    portENTER_CRITICAL(&book_lock);
+    addr_book_init();
+    uint32_t short_slot = addr_book_probe(pan_id, ADDR_MODE_SHORT, short_address);
+    uint32_t ext_slot = addr_book_probe(pan_id, ADDR_MODE_LONG, ext_address);
+    ieee802154_addr_id_t short_id = slots[short_slot];
+    ieee802154_addr_id_t ext_id = slots[ext_slot];
+    ieee802154_addr_id_t id = IEEE802154_ADDR_ID_NONE;
+    bool slot_free = (slot_count < MAX_SLOTS_USED); // The second address of a known entry takes a slot of its own
+
+    if (short_id == IEEE802154_ADDR_ID_NONE && ext_id == IEEE802154_ADDR_ID_NONE)
+    {
+        id = addr_book_add(pan_id, short_address, ext_address);
+    }
+    else if (short_id == ext_id)
+    {
+        id = short_id;
+    }
+    else if (slot_free && ext_id == IEEE802154_ADDR_ID_NONE && short_id < IEEE802154_ADDR_BOOK_MAX && entries[short_id].ext_address == NO_EXT_ADDRESS)
+    {
+        id = short_id;
+        entries[id].ext_address = ext_address;
+        slots[ext_slot] = id;
+        slot_count += 1;
+    }
+    else if (slot_free && short_id == IEEE802154_ADDR_ID_NONE && ext_id < IEEE802154_ADDR_BOOK_MAX && entries[ext_id].short_address == NO_SHORT_ADDRESS)
+    {
+        id = ext_id;
+        entries[id].short_address = short_address;
+        slots[short_slot] = id;
+        slot_count += 1;
+    }
+    portEXIT_CRITICAL(&book_lock);
+
+    if (id == IEEE802154_ADDR_ID_NONE)
+    {
+        ESP_LOGW(TAG, "Can not bind 0x%04x to %016llx", short_address, (unsigned long long)ext_address);
+    }
+    return id;
+}
+
+bool esp_ieee802154_addr_book_get(ieee802154_addr_id_t id, ieee802154_addr_book_entry_t *entry)
+{
+    portENTER_CRITICAL(&book_lock);
+    bool valid = (id < entry_count);
+    if (valid)
+    {
+        *entry = entries[id];
+    }
+    portEXIT_CRITICAL(&book_lock);
+    return valid;
+}
+
+bool esp_ieee802154_addr_book_address(ieee802154_addr_id_t id, uint16_t *pan_id, ieee802154_address_t *addr)
+{
+    ieee802154_addr_book_entry_t entry;
+    if (!esp_ieee802154_addr_book_get(id, &entry))
+    {
+        return false;
+    }
+
+    if (pan_id != NULL)
+    {
+        *pan_id = entry.pan_id;
+    }
+    if (entry.short_address != NO_SHORT_ADDRESS)
+    {
+        addr->mode = ADDR_MODE_SHORT;
+        addr->short_address = entry.short_address;
+    }
+    else
+    {
+        addr->mode = ADDR_MODE_LONG;
+        addr->long_address = entry.ext_address;
+    }
+    return true;
+}
+
+int esp_ieee802154_addr_book_format(ieee802154_addr_id_t id, char *buffer, size_t size)
+{
+    ieee802154_address_t addr = { .mode = ADDR_MODE_NONE };
+    esp_ieee802154_addr_book_address(id, NULL, &addr);
+    return esp_ieee802154_format_address(buffer, size, &addr);
+}
+
+uint16_t esp_ieee802154_addr_book_count(void)
+{
+    return entry_count;
+}
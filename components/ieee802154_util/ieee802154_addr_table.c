@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_ieee802154.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_addr_table.h"
+#include "ieee802154_tx.h"
+
+#define TAG "ieee802154_addr_table"
+
+#define SLOT_EMPTY   0
+#define SLOT_USED    1
+#define SLOT_DELETED 2 // Keeps the probe sequences of other entries intact
+
+#define FCF_ACK_REQUEST_BIT 0x20
+#define IMM_ACK_LENGTH      5 // FCF, sequence number, FCS
+
+typedef struct {
+    uint8_t state;
+    uint16_t pan_id;
+    ieee802154_address_t addr;
+} addr_table_slot_t;
+
+static addr_table_slot_t slots[IEEE802154_ADDR_TABLE_SLOTS];
+static uint16_t slot_count = 0;  // Used slots
+static uint16_t own_pan_id = 0xFFFF;
+static portMUX_TYPE slots_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t ack_frame[128];   // Must stay valid until the software ACK has been transmitted
+static volatile bool ack_enabled = true;
+
+/* --- Hash table --- */
+
+static IEEE802154_ISR_ATTR uint32_t addr_table_hash(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    uint32_t key = pan_id;
+    if (addr->mode == ADDR_MODE_SHORT)
+    {
+        key = (key << 16) | addr->short_address;
+    }
+    else
+    {
+        key ^= (uint32_t)(addr->long_address >> 32) ^ (uint32_t)addr->long_address;
+    }
+    return (key * 0x9E3779B1) >> (32 - IEEE802154_ADDR_TABLE_BITS); // Fibonacci hashing
+}
+
+static IEEE802154_ISR_ATTR bool addr_table_equal(const addr_table_slot_t *slot, uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    if (slot->pan_id != pan_id || slot->addr.mode != addr->mode)
+    {
+        return false;
+    }
+    if (addr->mode == ADDR_MODE_SHORT)
+    {
+        return slot->addr.short_address == addr->short_address;
+    }
+    return slot->addr.long_address == addr->long_address;
+}
+
+/* Index of the slot holding the address, or of the first free slot of its probe sequence (-1 if none) */
+static IEEE802154_ISR_ATTR int32_t addr_table_probe(uint16_t pan_id, const ieee802154_address_t *addr, bool *found)
+{
+    int32_t free_slot = -1;
+    uint32_t index = addr_table_hash(pan_id, addr);
+
+    for (uint32_t probe = 0; probe < IEEE802154_ADDR_TABLE_SLOTS; probe++)
+    {
+        addr_table_slot_t *slot = &slots[index];
+        if (slot->state == SLOT_EMPTY)
+        {
+            *found = false;
+            return (free_slot >= 0) ? free_slot : (int32_t)index;
+        }
+        if (slot->state == SLOT_DELETED)
+        {
+            free_slot = (free_slot >= 0) ? free_slot : (int32_t)index;
+        }
+        else if (addr_table_equal(slot, pan_id, addr))
+        {
+            *found = true;
+            return index;
+        }
+        index = (index + 1) & (IEEE802154_ADDR_TABLE_SLOTS - 1);
+    }
+    *found = false;
+    return free_slot;
+}
+
+static esp_err_t addr_table_insert(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    bool found;
+    int32_t index = addr_table_probe(pan_id, addr, &found);
+    if (found)
+    {
+        return ESP_OK;
+    }
+    if (index < 0 || slot_count >= IEEE802154_ADDR_TABLE_MAX)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    slots[index].pan_id = pan_id;
+    slots[index].addr = *addr;
+    slots[index].state = SLOT_USED;
+    slot_count += 1;
+    return ESP_OK;
+}
+
+/* The hardware does not filter in promiscuous mode, so the own addresses are accepted by the table */
+static void addr_table_activate(uint16_t pan_id, uint16_t short_address, uint64_t ext_address)
+{
+    own_pan_id = pan_id;
+    ieee802154_address_t own = {
+        .mode = ADDR_MODE_SHORT,
+        .short_address = short_address,
+    };
+    if (own.short_address != 0xFFFF)
+    {
+        addr_table_insert(pan_id, &own);
+    }
+
+    own.mode = ADDR_MODE_LONG;
+    own.long_address = ext_address;
+    addr_table_insert(pan_id, &own);
+}
+
+esp_err_t esp_ieee802154_addr_table_add(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    if (addr->mode != ADDR_MODE_SHORT && addr->mode != ADDR_MODE_LONG)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // The driver is not called with interrupts disabled, the own addresses are read before
+    uint8_t ext_addr[8];
+    uint16_t own_pan = esp_ieee802154_get_panid();
+    uint16_t own_short = esp_ieee802154_get_short_address();
+    esp_ieee802154_get_extended_address(ext_addr);
+
+    portENTER_CRITICAL(&slots_lock);
+    bool activate = (slot_count == 0);
+    if (activate)
+    {
+        addr_table_activate(own_pan, own_short, esp_ieee802154_ext_address_read(ext_addr));
+    }
+    esp_err_t err = addr_table_insert(pan_id, addr);
+    portEXIT_CRITICAL(&slots_lock);
+
+    if (activate)
+    {
+        esp_ieee802154_set_promiscuous(true);
+    }
+    return err;
+}
+
+esp_err_t esp_ieee802154_addr_table_add_range(uint16_t pan_id, const ieee802154_address_t *base, uint16_t count)
+{
+    for (uint16_t offset = 0; offset < count; offset++)
+    {
+        ieee802154_address_t addr;
+        esp_ieee802154_address_offset(base, offset, &addr);
+        esp_err_t err = esp_ieee802154_addr_table_add(pan_id, &addr);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_addr_table_remove(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    bool found;
+    portENTER_CRITICAL(&slots_lock);
+    int32_t index = addr_table_probe(pan_id, addr, &found);
+    if (found)
+    {
+        slots[index].state = SLOT_DELETED;
+        slot_count -= 1;
+    }
+    portEXIT_CRITICAL(&slots_lock);
+    return found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void esp_ieee802154_addr_table_clear(void)
+{
+    portENTER_CRITICAL(&slots_lock);
+    memset(slots, 0, sizeof(slots));
+    slot_count = 0;
+    portEXIT_CRITICAL(&slots_lock);
+
+    esp_ieee802154_set_promiscuous(false);
+}
+
+uint16_t esp_ieee802154_addr_table_count(void)
+{
+    return slot_count;
+}
+
+IEEE802154_ISR_ATTR bool esp_ieee802154_addr_table_contains(uint16_t pan_id, const ieee802154_address_t *addr)
+{
+    bool found;
+    portENTER_CRITICAL_SAFE(&slots_lock);
+    addr_table_probe(pan_id, addr, &found);
+    portEXIT_CRITICAL_SAFE(&slots_lock);
+    return found;
+}
+
+/* --- Receive path --- */
+
+IEEE802154_ISR_ATTR bool esp_ieee802154_addr_table_receive(const uint8_t *frame)
+{
+    if (slot_count == 0)
+    {
+        return true;
+    }
+    if (frame[0] < IMM_ACK_LENGTH)
+    {
+        return false;
+    }
+
+    // Only the destination is needed: FCF, sequence number (unless suppressed in 2015 frames), pan id, address
+    uint16_t fcf = frame[1] | (frame[2] << 8);
+    uint8_t version = (fcf >> 12) & 0x3;
+    uint8_t dst_mode = (fcf >> 10) & 0x3;
+    bool sns = (version == FRAME_VERSION_STD_2015) && (fcf & (1 << 8));
+    uint8_t position = sns ? 3 : 4;
+
+    if ((dst_mode != ADDR_MODE_SHORT && dst_mode != ADDR_MODE_LONG) ||
+        position + 2 + (dst_mode == ADDR_MODE_LONG ? 8 : 2) > frame[0] + 1)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_RX_FILTERED);
+        return false;
+    }
+
+    ieee802154_address_t dst_addr = { .mode = dst_mode };
+    uint16_t dst_pan_id = frame[position] | (frame[position + 1] << 8);
+    position += 2;
+    if (dst_mode == ADDR_MODE_SHORT)
+    {
+        dst_addr.short_address = frame[position] | (frame[position + 1] << 8);
+        if (dst_addr.short_address == 0xFFFF)
+        {
+            return true; // Broadcasts are never acknowledged
+        }
+    }
+    else
+    {
+        dst_addr.long_address = esp_ieee802154_ext_address_read(&frame[position]);
+    }
+
+    if (!esp_ieee802154_addr_table_contains(dst_pan_id, &dst_addr) &&
+        (dst_pan_id != 0xFFFF || !esp_ieee802154_addr_table_contains(own_pan_id, &dst_addr)))
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_RX_FILTERED);
+        return false;
+    }
+
+    if (!ack_enabled)
+    {
+        // e.g. replayed frames, nobody waits for their ACK
+    }
+    else if ((fcf & FCF_ACK_REQUEST_BIT) && esp_ieee802154_tx_engine_busy())
+    {
+        // The ACK would abort the frame on air, the sender retransmits instead
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_ACK_SKIPPED);
+    }
+    else if (fcf & FCF_ACK_REQUEST_BIT)
+    {
+        if (version == FRAME_VERSION_STD_2015)
+        {
+            esp_ieee802154_create_2015_ack_frame((uint8_t *)frame, ack_frame);
+        }
+        else
+        {
+            ack_frame[0] = IMM_ACK_LENGTH;
+            ack_frame[1] = FRAME_TYPE_ACK;
+            ack_frame[2] = 0x00;
+            ack_frame[3] = frame[3];
+            esp_ieee802154_metrics_inc(IEEE802154_METRIC_ACK_SENT);
+        }
+        esp_ieee802154_transmit(ack_frame, false); // The ACK is sent without CCA
+    }
+    return true;
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_addr_table_set_ack(bool enable)
+{
+    ack_enabled = enable;
+}
+
+/* --- Console --- */
+
+static int addr_table_command(int argc, char **argv)
+{
+    ieee802154_address_t addr;
+    esp_err_t err = ESP_OK;
+
+    if (argc == 2 && strcmp(argv[1], "clear") == 0)
+    {
+        esp_ieee802154_addr_table_clear();
+    }
+    else if (argc == 2 && strcmp(argv[1], "count") == 0)
+    {
+        printf("%u addresses\n", esp_ieee802154_addr_table_count());
+    }
+    else if (argc == 4 && esp_ieee802154_parse_address(argv[3], &addr) && strcmp(argv[1], "add") == 0)
+    {
+        err = esp_ieee802154_addr_table_add(strtoul(argv[2], NULL, 0), &addr);
+    }
+    else if (argc == 4 && esp_ieee802154_parse_address(argv[3], &addr) && strcmp(argv[1], "del") == 0)
+    {
+        err = esp_ieee802154_addr_table_remove(strtoul(argv[2], NULL, 0), &addr);
+    }
+    else if (argc == 5 && esp_ieee802154_parse_address(argv[3], &addr) && strcmp(argv[1], "range") == 0)
+    {
+        err = esp_ieee802154_addr_table_add_range(strtoul(argv[2], NULL, 0), &addr, strtoul(argv[4], NULL, 0));
+    }
+    else
+    {
+        printf("Usage: addrs add <pan> <addr> | range <pan> <addr> <count> | del <pan> <addr> | clear | count\n");
+        return 1;
+    }
+
+    if (err != ESP_OK)
+    {
+        printf("Failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_addr_table_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "addrs",
+        .help = "Software address table, the node accepts and acknowledges frames to these addresses",
+        .hint = "add <pan> <addr> | range <pan> <addr> <count> | del <pan> <addr> | clear | count",
+        .func = &addr_table_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,443 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_X86 1
+#else
+#define BATCH_X86 0
+#endif
+
+#define BATCH_MIN_LENGTH 4                          // FCF and FCS
+#define BATCH_MAX_HEADER (2 + 1 + 2 + 8 + 2 + 8)    // FCF, sequence number, two pan ids and two long addresses
+
+/* --- Batch --- */
+
+bool esp_ieee802154_batch_alloc(ieee802154_batch_t *batch, size_t capacity)
+{
+    memset(batch, 0, sizeof(ieee802154_batch_t));
+    batch->capacity = capacity;
+    batch->fcf = malloc(capacity * sizeof(uint16_t));
+    batch->frame_type = malloc(capacity);
+    batch->frame_version = malloc(capacity);
+    batch->flags = malloc(capacity);
+    batch->sequence_number = malloc(capacity);
+    batch->dst_mode = malloc(capacity);
+    batch->src_mode = malloc(capacity);
+    batch->header_length = malloc(capacity);
+    batch->payload_length = malloc(capacity);
+    batch->dst_pan_id = malloc(capacity * sizeof(uint16_t));
+    batch->src_pan_id = malloc(capacity * sizeof(uint16_t));
+    batch->dst_addr = malloc(capacity * sizeof(uint64_t));
+    batch->src_addr = malloc(capacity * sizeof(uint64_t));
+
+    if (batch->fcf == NULL || batch->frame_type == NULL || batch->frame_version == NULL || batch->flags == NULL ||
+        batch->sequence_number == NULL || batch->dst_mode == NULL || batch->src_mode == NULL ||
+        batch->header_length == NULL || batch->payload_length == NULL || batch->dst_pan_id == NULL ||
+        batch->src_pan_id == NULL || batch->dst_addr == NULL || batch->src_addr == NULL)
+    {
+        esp_ieee802154_batch_free(batch);
+        return false;
+    }
+    return true;
+}
+
+void esp_ieee802154_batch_free(ieee802154_batch_t *batch)
+{
+    free(batch->fcf);
+    free(batch->frame_type);
+    free(batch->frame_version);
+    free(batch->flags);
+    free(batch->sequence_number);
+    free(batch->dst_mode);
+    free(batch->src_mode);
+    free(batch->header_length);
+    free(batch->payload_length);
+    free(batch->dst_pan_id);
+    free(batch->src_pan_id);
+    free(batch->dst_addr);
+    free(batch->src_addr);
+    memset(batch, 0, sizeof(ieee802154_batch_t));
+}
+
+ieee802154_batch_kernel_t esp_ieee802154_batch_kernel(ieee802154_batch_kernel_t kernel)
+{
+#if BATCH_X86
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool sse2 = __builtin_cpu_supports("sse2");
+#else
+    bool avx2 = false;
+    bool sse2 = false;
+#endif
+
+    if ((kernel == IEEE802154_BATCH_AVX2 || kernel == IEEE802154_BATCH_AUTO) && avx2)
+    {
+        return IEEE802154_BATCH_AVX2;
+    }
+    if ((kernel == IEEE802154_BATCH_SSE2 || kernel == IEEE802154_BATCH_AVX2 || kernel == IEEE802154_BATCH_AUTO) && sse2)
+    {
+        return IEEE802154_BATCH_SSE2;
+    }
+    return IEEE802154_BATCH_SCALAR;
+}
+
+const char *esp_ieee802154_batch_kernel_name(ieee802154_batch_kernel_t kernel)
+{
+    switch (kernel)
+    {
+    case IEEE802154_BATCH_AUTO:
+        return "auto";
+    case IEEE802154_BATCH_SCALAR:
+        return "scalar";
+    case IEEE802154_BATCH_SSE2:
+        return "sse2";
+    case IEEE802154_BATCH_AVX2:
+        return "avx2";
+    }
+    return "?";
+}
+
+/* --- Addressing fields --- */
+
+static inline uint64_t batch_read_address(const uint8_t *header, uint8_t position, uint8_t mode)
+{
+    if (mode == ADDR_MODE_SHORT)
+    {
+        return header[position] | (header[position + 1] << 8);
+    }
+    if (mode == ADDR_MODE_LONG)
+    {
+        return esp_ieee802154_ext_address_read(&header[position]);
+    }
+    return 0;
+}
+
+/**
+ * Read the sequence number, the pan ids and the addresses of a decoded frame at the offsets given by its FCF. As
+ * in the parser, bytes beyond the frame (without FCS) read as 0.
+ *
+ * A frame which holds its header and at least BATCH_MAX_HEADER bytes is read without branches on the addressing
+ * modes: every field is loaded at its offset with full width and masked, absent fields read as 0. Shorter frames
+ * are read field by field, through a zero padded copy if the header does not fit.
+ */
+static inline __attribute__((always_inline)) void batch_decode_addressing(const uint8_t *psdu, uint8_t length, size_t idx, uint8_t flags,
+                                                                         uint8_t dst_mode, uint8_t src_mode, uint8_t header_length,
+                                                                         ieee802154_batch_t *batch)
+{
+    static const uint64_t address_mask[4] = { 0, 0, 0xFFFF, UINT64_MAX };
+    static const uint8_t address_length[4] = { 0, 0, 2, 8 };
+
+    uint8_t sequence_number = 0;
+    uint16_t dst_pan_id = 0;
+    uint16_t src_pan_id = 0;
+    uint64_t dst_addr = 0;
+    uint64_t src_addr = 0;
+
+    if (length >= BATCH_MAX_HEADER && header_length <= length - 2)
+    {
+        // The last field ends at BATCH_MAX_HEADER at the latest, so the full width loads stay within the frame
+        uint32_t seq_present = (flags & IEEE802154_BATCH_SEQ_PRESENT) != 0;
+        uint32_t dst_present = dst_mode >> 1;
+        uint32_t src_present = src_mode >> 1;
+        uint32_t pan_id_compressed = dst_present & ((flags & IEEE802154_BATCH_PAN_ID_COMPRESSION) != 0);
+        uint32_t src_pan_present = src_present & !pan_id_compressed;
+
+        sequence_number = psdu[2] & -seq_present;
+        uint32_t position = 2 + seq_present;
+        dst_pan_id = (psdu[position] | (psdu[position + 1] << 8)) & -dst_present;
+        dst_addr = esp_ieee802154_ext_address_read(&psdu[position + 2]) & address_mask[dst_mode];
+        position += dst_present * 2 + address_length[dst_mode];
+
+        src_pan_id = ((psdu[position] | (psdu[position + 1] << 8)) & -src_pan_present) |
+                     (dst_pan_id & -(src_present & pan_id_compressed));
+        position += src_pan_present * 2;
+        src_addr = esp_ieee802154_ext_address_read(&psdu[position]) & address_mask[src_mode];
+    }
+    else if (length >= BATCH_MIN_LENGTH)
+    {
+        // Only a header which does not fit into the frame is read beyond it
+        uint8_t padded[BATCH_MAX_HEADER];
+        const uint8_t *header = psdu;
+        if (header_length > length - 2)
+        {
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, psdu, length - 2);
+            header = padded;
+        }
+
+        uint8_t position = 2;
+        if (flags & IEEE802154_BATCH_SEQ_PRESENT)
+        {
+            sequence_number = header[position];
+            position += 1;
+        }
+        if (address_length[dst_mode] > 0)
+        {
+            dst_pan_id = header[position] | (header[position + 1] << 8);
+            dst_addr = batch_read_address(header, position + 2, dst_mode);
+            position += 2 + address_length[dst_mode];
+        }
+        if (address_length[src_mode] > 0)
+        {
+            if (address_length[dst_mode] > 0 && (flags & IEEE802154_BATCH_PAN_ID_COMPRESSION))
+            {
+                src_pan_id = dst_pan_id;
+            }
+            else
+            {
+                src_pan_id = header[position] | (header[position + 1] << 8);
+                position += 2;
+            }
+            src_addr = batch_read_address(header, position, src_mode);
+        }
+    }
+
+    batch->sequence_number[idx] = sequence_number;
+    batch->dst_pan_id[idx] = dst_pan_id;
+    batch->src_pan_id[idx] = src_pan_id;
+    batch->dst_addr[idx] = dst_addr;
+    batch->src_addr[idx] = src_addr;
+}
+
+/* --- FCF and header length --- */
+
+static inline uint16_t batch_read_fcf(const uint8_t *psdu, uint8_t length)
+{
+    return (length >= BATCH_MIN_LENGTH) ? (uint16_t)(psdu[0] | (psdu[1] << 8)) : 0;
+}
+
+/**
+ * Scalar kernel, also used for the frames after the last full vector. Decodes every frame completely in one pass,
+ * so the fields stay in registers instead of being read back from the arrays. The vector kernels compute the same
+ * expressions, lane by lane.
+ *
+ * @return Number of valid frames.
+ */
+static size_t batch_decode_scalar(const uint8_t *const *psdus, const uint8_t *lengths, size_t first, size_t count,
+                                  ieee802154_batch_t *out)
+{
+    // Local copy of the array pointers: the byte stores could alias the batch, which forces a reload after each
+    ieee802154_batch_t arrays = *out;
+    ieee802154_batch_t *batch = &arrays;
+    size_t valid_frames = 0;
+    for (size_t idx = first; idx < count; idx++)
+    {
+        uint32_t length = lengths[idx];
+        uint32_t fcf = batch_read_fcf(psdus[idx], length);
+        uint32_t version = (fcf >> 12) & 0x3;
+        uint32_t dst_mode = (fcf >> 10) & 0x3;
+        uint32_t src_mode = (fcf >> 14) & 0x3;
+        uint32_t flags = ((fcf >> 3) & 0x0F) | ((fcf >> 4) & 0x30);
+
+        // Conditions as 0 or 1 and masks, so the random fields of a trace do not cost branch mispredictions
+        uint32_t seq_present = 1 ^ ((version == FRAME_VERSION_STD_2015) & ((fcf >> 8) & 0x1));
+        uint32_t dst_present = dst_mode >> 1;
+        uint32_t src_present = src_mode >> 1;
+        uint32_t src_pan_present = src_present & !(dst_present & ((flags & IEEE802154_BATCH_PAN_ID_COMPRESSION) != 0));
+        uint32_t header_length = 2 + seq_present + dst_present * 4 + (dst_present & dst_mode) * 6 +
+                                 src_pan_present * 2 + src_present * 2 + (src_present & src_mode) * 6;
+
+        uint32_t decoded = length >= BATCH_MIN_LENGTH;
+        uint32_t fits = header_length + 2 <= length;
+        uint32_t valid = fits & ((flags & (IEEE802154_BATCH_SECURE | IEEE802154_BATCH_IE_PRESENT)) == 0);
+        flags |= seq_present * IEEE802154_BATCH_SEQ_PRESENT;
+        flags |= valid * IEEE802154_BATCH_VALID;
+
+        batch->fcf[idx] = fcf;
+        batch->frame_type[idx] = fcf & 0x7;
+        batch->frame_version[idx] = version;
+        batch->dst_mode[idx] = dst_mode;
+        batch->src_mode[idx] = src_mode;
+        batch->flags[idx] = flags & -decoded;
+        batch->header_length[idx] = header_length & -decoded;
+        batch->payload_length[idx] = (length - 2 - header_length) & -fits;
+        batch_decode_addressing(psdus[idx], length, idx, flags, dst_mode, src_mode, header_length, batch);
+        valid_frames += valid;
+    }
+    return valid_frames;
+}
+
+#if BATCH_X86
+/**
+ * The kernels work on 16-bit lanes: the FCF of every frame and its length. The FCFs are gathered with scalar
+ * loads, everything else (field extraction, header length, fit check, flags) is vector arithmetic.
+ */
+#define BATCH_VECTOR_KERNEL(NAME, TARGET, LANES, VEC, SET1, ZERO, LOAD_LENGTHS, AND, OR, ANDNOT, ADD, SUB, SRLI, SLLI, CMPEQ, CMPGT, STORE_U16, STORE_U8) \
+static __attribute__((target(TARGET))) size_t NAME(const uint8_t *const *psdus, const uint8_t *lengths, size_t count, ieee802154_batch_t *batch) \
+{ \
+    const VEC one = SET1(1); \
+    const VEC three = SET1(3); \
+    const VEC version_2015 = SET1(FRAME_VERSION_STD_2015); \
+    const VEC min_length = SET1(BATCH_MIN_LENGTH - 1); \
+    const VEC flag_low = SET1(0x0F); \
+    const VEC flag_high = SET1(0x30); \
+    const VEC mask_invalid = SET1(IEEE802154_BATCH_SECURE | IEEE802154_BATCH_IE_PRESENT); \
+    uint16_t fcfs[LANES] __attribute__((aligned(32))); \
+    size_t idx = 0; \
+    for (; idx + LANES <= count; idx += LANES) \
+    { \
+        for (uint8_t lane = 0; lane < LANES; lane++) \
+        { \
+            fcfs[lane] = batch_read_fcf(psdus[idx + lane], lengths[idx + lane]); \
+        } \
+        VEC length = LOAD_LENGTHS(&lengths[idx]); \
+        VEC decoded = CMPGT(length, min_length); \
+        VEC fcf = AND(*(const VEC *)fcfs, decoded); \
+        VEC version = AND(SRLI(fcf, 12), three); \
+        VEC dst_mode = AND(SRLI(fcf, 10), three); \
+        VEC src_mode = SRLI(fcf, 14); \
+        VEC flags = OR(AND(SRLI(fcf, 3), flag_low), AND(SRLI(fcf, 4), flag_high)); \
+        VEC seq_suppressed = AND(CMPEQ(version, version_2015), CMPEQ(AND(SRLI(fcf, 8), one), one)); \
+        VEC seq_present = ANDNOT(seq_suppressed, one); \
+        VEC dst_present = SRLI(dst_mode, 1); \
+        VEC src_present = SRLI(src_mode, 1); \
+        VEC compressed = AND(SRLI(fcf, 6), one); \
+        VEC src_pan_present = ANDNOT(AND(dst_present, compressed), src_present); \
+        VEC header_length = ADD(ADD(SET1(2), seq_present), SLLI(dst_present, 2)); \
+        header_length = ADD(header_length, SUB(SLLI(AND(dst_present, dst_mode), 3), SLLI(AND(dst_present, dst_mode), 1))); \
+        header_length = ADD(header_length, SLLI(ADD(src_pan_present, src_present), 1)); \
+        header_length = ADD(header_length, SUB(SLLI(AND(src_present, src_mode), 3), SLLI(AND(src_present, src_mode), 1))); \
+        VEC available = SUB(length, SET1(2)); \
+        VEC fits = ANDNOT(CMPGT(header_length, available), decoded); \
+        VEC supported = CMPEQ(AND(flags, mask_invalid), ZERO); \
+        flags = OR(flags, SLLI(seq_present, 6)); \
+        flags = OR(flags, AND(AND(fits, supported), SET1(IEEE802154_BATCH_VALID))); \
+        STORE_U16(&batch->fcf[idx], fcf); \
+        STORE_U8(&batch->frame_type[idx], AND(fcf, SET1(0x7))); \
+        STORE_U8(&batch->frame_version[idx], version); \
+        STORE_U8(&batch->dst_mode[idx], dst_mode); \
+        STORE_U8(&batch->src_mode[idx], src_mode); \
+        STORE_U8(&batch->flags[idx], AND(flags, decoded)); \
+        STORE_U8(&batch->header_length[idx], AND(header_length, decoded)); \
+        STORE_U8(&batch->payload_length[idx], AND(SUB(available, header_length), fits)); \
+    } \
+    return idx; \
+}
+
+/* SSE2: 8 frames per vector */
+
+static inline __attribute__((target("sse2"), always_inline)) __m128i batch_sse2_load_lengths(const uint8_t *lengths)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)lengths), _mm_setzero_si128());
+}
+
+static inline __attribute__((target("sse2"), always_inline)) void batch_sse2_store_u16(uint16_t *out, __m128i value)
+{
+    _mm_storeu_si128((__m128i *)out, value);
+}
+
+static inline __attribute__((target("sse2"), always_inline)) void batch_sse2_store_u8(uint8_t *out, __m128i value)
+{
+    _mm_storel_epi64((__m128i *)out, _mm_packus_epi16(value, value));
+}
+
+BATCH_VECTOR_KERNEL(batch_decode_fcf_sse2, "sse2", 8, __m128i, _mm_set1_epi16, _mm_setzero_si128(), batch_sse2_load_lengths,
+                    _mm_and_si128, _mm_or_si128, _mm_andnot_si128, _mm_add_epi16, _mm_sub_epi16, _mm_srli_epi16,
+                    _mm_slli_epi16, _mm_cmpeq_epi16, _mm_cmpgt_epi16, batch_sse2_store_u16, batch_sse2_store_u8)
+
+/* AVX2: 16 frames per vector */
+
+static inline __attribute__((target("avx2"), always_inline)) __m256i batch_avx2_load_lengths(const uint8_t *lengths)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)lengths));
+}
+
+static inline __attribute__((target("avx2"), always_inline)) void batch_avx2_store_u16(uint16_t *out, __m256i value)
+{
+    _mm256_storeu_si256((__m256i *)out, value);
+}
+
+static inline __attribute__((target("avx2"), always_inline)) void batch_avx2_store_u8(uint8_t *out, __m256i value)
+{
+    _mm_storeu_si128((__m128i *)out, _mm_packus_epi16(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1)));
+}
+
+BATCH_VECTOR_KERNEL(batch_decode_fcf_avx2, "avx2", 16, __m256i, _mm256_set1_epi16, _mm256_setzero_si256(), batch_avx2_load_lengths,
+                    _mm256_and_si256, _mm256_or_si256, _mm256_andnot_si256, _mm256_add_epi16, _mm256_sub_epi16, _mm256_srli_epi16,
+                    _mm256_slli_epi16, _mm256_cmpeq_epi16, _mm256_cmpgt_epi16, batch_avx2_store_u16, batch_avx2_store_u8)
+#endif
+
+/* --- Decoder --- */
+
+size_t esp_ieee802154_batch_decode(const uint8_t *const *psdus, const uint8_t *lengths, size_t count,
+                                   ieee802154_batch_t *batch, ieee802154_batch_kernel_t kernel)
+{
+    if (count > batch->capacity)
+    {
+        count = batch->capacity;
+    }
+
+    size_t done = 0;
+#if BATCH_X86
+    if (kernel == IEEE802154_BATCH_AUTO)
+    {
+        kernel = esp_ieee802154_batch_kernel(kernel);
+    }
+    if (kernel == IEEE802154_BATCH_AVX2)
+    {
+        done = batch_decode_fcf_avx2(psdus, lengths, count, batch);
+    }
+    else if (kernel == IEEE802154_BATCH_SSE2)
+    {
+        done = batch_decode_fcf_sse2(psdus, lengths, count, batch);
+    }
+#else
+    (void)kernel;
+#endif
+
+    // The vector kernels leave the addressing fields, the scalar kernel decodes the rest of the frames completely
+    ieee802154_batch_t arrays = *batch;
+    size_t valid = 0;
+    for (size_t idx = 0; idx < done; idx++)
+    {
+        uint8_t flags = arrays.flags[idx];
+        batch_decode_addressing(psdus[idx], lengths[idx], idx, flags, arrays.dst_mode[idx], arrays.src_mode[idx],
+                                arrays.header_length[idx], &arrays);
+        valid += (flags & IEEE802154_BATCH_VALID) != 0;
+    }
+    return valid + batch_decode_scalar(psdus, lengths, done, count, batch);
+}
+
+bool esp_ieee802154_batch_get(const ieee802154_batch_t *batch, size_t idx, ieee802154_frame_t *frame)
+{
+    uint8_t flags = batch->flags[idx];
+    memset(frame, 0, sizeof(ieee802154_frame_t));
+    frame->frame_type = batch->frame_type[idx];
+    frame->frame_version = batch->frame_version[idx];
+    frame->secure = (flags & IEEE802154_BATCH_SECURE) != 0;
+    frame->frame_pending = (flags & IEEE802154_BATCH_FRAME_PENDING) != 0;
+    frame->ack_request = (flags & IEEE802154_BATCH_ACK_REQUEST) != 0;
+    frame->pan_id_compression = (flags & IEEE802154_BATCH_PAN_ID_COMPRESSION) != 0;
+    frame->sequence_number_suppression = (flags & IEEE802154_BATCH_SEQ_SUPPRESSION) != 0;
+    frame->information_elements_present = (flags & IEEE802154_BATCH_IE_PRESENT) != 0;
+    frame->sequence_number_present = (flags & IEEE802154_BATCH_SEQ_PRESENT) != 0;
+    frame->sequence_number = batch->sequence_number[idx];
+    frame->dst_pan_id = batch->dst_pan_id[idx];
+    frame->src_pan_id = batch->src_pan_id[idx];
+    frame->dst_addr.mode = batch->dst_mode[idx];
+    frame->src_addr.mode = batch->src_mode[idx];
+    if (frame->dst_addr.mode == ADDR_MODE_SHORT)
+    {
+        frame->dst_addr.short_address = batch->dst_addr[idx];
+    }
+    else if (frame->dst_addr.mode == ADDR_MODE_LONG)
+    {
+        frame->dst_addr.long_address = batch->dst_addr[idx];
+    }
+    if (frame->src_addr.mode == ADDR_MODE_SHORT)
+    {
+        frame->src_addr.short_address = batch->src_addr[idx];
+    }
+    else if (frame->src_addr.mode == ADDR_MODE_LONG)
+    {
+        frame->src_addr.long_address = batch->src_addr[idx];
+    }
+    frame->header_length = batch->header_length[idx];
+    frame->payload_length = batch->payload_length[idx];
+    return (flags & IEEE802154_BATCH_VALID) != 0;
+}
@@ -0,0 +1,629 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <esp_console.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_survey.h"
+#include "ieee802154_channel.h"
+
+#define TAG "ieee802154_channel"
+
+#define FCF_ACK_REQUEST_BIT   0x20
+#define CHANNEL_QUEUE_LENGTH  4
+#define CHANNEL_WINDOW        CONFIG_IEEE802154_UTIL_CHANNEL_WINDOW
+#define CHANNEL_WINDOW_MASK   ((CHANNEL_WINDOW == 64) ? UINT64_MAX : ((1ULL << CHANNEL_WINDOW) - 1))
+#define CHANNEL_MIN_ACKED     (CHANNEL_WINDOW / 4) // Frames with ACK request before the no-ACK rate counts
+#define CHANNEL_HOLDOFF_US    ((int64_t)CONFIG_IEEE802154_UTIL_CHANNEL_HOLDOFF_S * 1000000)
+
+#define ANNOUNCE_COMMAND_SWITCH 1
+#define ANNOUNCE_LENGTH         5 // Dispatch, command, channel, time left in ms (little endian)
+
+typedef enum {
+    CHANNEL_EVENT_TRIGGER,    // Threshold crossed, survey and switch
+    CHANNEL_EVENT_SWITCH,     // Announce and switch to the given channel
+    CHANNEL_EVENT_PEER,       // Switch announced by a peer
+    CHANNEL_EVENT_SURVEY,     // Periodic survey, switch if the best channel is noticeably quieter
+} channel_event_type_t;
+
+typedef struct {
+    channel_event_type_t type;
+    ieee802154_channel_reason_t reason;
+    uint8_t channel;
+    int64_t due_us;           // Switch time of a peer announcement
+} channel_event_t;
+
+typedef enum {
+    TRACK_IDLE,
+    TRACK_PENDING,            // Triggered, not switched yet
+    TRACK_SWITCHED,           // Switched, waiting for the first frame on the new channel
+} channel_track_t;
+
+static QueueHandle_t channel_queue = NULL;
+static portMUX_TYPE channel_lock = portMUX_INITIALIZER_UNLOCKED; // Protects the window, the tracking and the stats
+
+static uint64_t cca_bits = 0;          // CCA failures, bit 0 is the latest frame
+static uint64_t ack_bits = 0;          // Frames with ACK request
+static uint64_t no_ack_bits = 0;       // Frames with ACK request and without ACK
+static uint8_t window_fill = 0;
+static bool trigger_queued = false;
+static int64_t holdoff_until_us = 0;
+
+static channel_track_t track = TRACK_IDLE;
+static ieee802154_channel_switch_t current;    // Switch in progress
+static volatile bool announcing = false;       // The channel task announces a switch of its own
+static volatile bool abort_announcement = false;
+static volatile bool held = false;             // Another task sets the channel, results and peers are ignored
+static uint8_t peer_channel = 0;               // Channel of a queued peer announcement, 0 if none
+static ieee802154_channel_stats_t stats;
+
+/* --- Window --- */
+
+static void channel_window_clear(void)
+{
+    cca_bits = 0;
+    ack_bits = 0;
+    no_ack_bits = 0;
+    window_fill = 0;
+}
+
+static bool channel_track_begin(ieee802154_channel_reason_t reason, int64_t now)
+{
+    if (track != TRACK_IDLE && track != TRACK_SWITCHED)
+    {
+        return false;
+    }
+    memset(&current, 0, sizeof(current));
+    current.reason = reason;
+    current.trigger_us = now;
+    track = TRACK_PENDING;
+    return true;
+}
+
+static void channel_track_failure(void)
+{
+    if (track == TRACK_PENDING)
+    {
+        current.lost += 1;
+    }
+    else if (track == TRACK_SWITCHED)
+    {
+        stats.history[0].lost += 1;
+    }
+}
+
+static void channel_track_recovered(int64_t now)
+{
+    if (track == TRACK_SWITCHED)
+    {
+        stats.history[0].recovered_us = now;
+        track = TRACK_IDLE;
+    }
+}
+
+void esp_ieee802154_channel_update(const uint8_t *frame, const ieee802154_tx_result_t *result)
+{
+    if (channel_queue == NULL || held)
+    {
+        return;
+    }
+
+    bool cca_failed = (result->error == ESP_IEEE802154_TX_ERR_CCA_BUSY);
+    bool ack_requested = (frame[1] & FCF_ACK_REQUEST_BIT) != 0 && !cca_failed;
+    bool no_ack = ack_requested && !result->acked;
+    int64_t now = esp_timer_get_time();
+    channel_event_t event = { .type = CHANNEL_EVENT_TRIGGER };
+    bool trigger = false;
+
+    portENTER_CRITICAL(&channel_lock);
+    cca_bits = ((cca_bits << 1) | cca_failed) & CHANNEL_WINDOW_MASK;
+    ack_bits = ((ack_bits << 1) | ack_requested) & CHANNEL_WINDOW_MASK;
+    no_ack_bits = ((no_ack_bits << 1) | no_ack) & CHANNEL_WINDOW_MASK;
+    if (window_fill < CHANNEL_WINDOW)
+    {
+        window_fill += 1;
+    }
+
+    if (result->error != ESP_IEEE802154_TX_ERR_NONE)
+    {
+        channel_track_failure();
+    }
+    else if (result->acked)
+    {
+        channel_track_recovered(now);
+    }
+
+    uint8_t cca_failures = __builtin_popcountll(cca_bits);
+    uint8_t acked = __builtin_popcountll(ack_bits);
+    uint8_t no_acks = __builtin_popcountll(no_ack_bits);
+    if (window_fill == CHANNEL_WINDOW && !trigger_queued && now >= holdoff_until_us)
+    {
+        if (cca_failures * 100 >= CONFIG_IEEE802154_UTIL_CHANNEL_CCA_PERCENT * CHANNEL_WINDOW)
+        {
+            event.reason = IEEE802154_CHANNEL_REASON_CCA;
+            trigger = true;
+        }
+        else if (acked >= CHANNEL_MIN_ACKED && no_acks * 100 >= CONFIG_IEEE802154_UTIL_CHANNEL_NO_ACK_PERCENT * acked)
+        {
+            event.reason = IEEE802154_CHANNEL_REASON_NO_ACK;
+            trigger = true;
+        }
+        trigger = trigger && channel_track_begin(event.reason, now);
+        trigger_queued = trigger;
+    }
+    portEXIT_CRITICAL(&channel_lock);
+
+    if (trigger)
+    {
+        ESP_LOGW(TAG, "Channel %d: %d of %d CCA failures, %d of %d ACKs missing", esp_ieee802154_get_channel(),
+                 cca_failures, CHANNEL_WINDOW, no_acks, acked);
+        xQueueSend(channel_queue, &event, 0);
+    }
+}
+
+/* --- Announcements --- */
+
+bool esp_ieee802154_channel_input(const uint8_t *frame)
+{
+    if (channel_queue == NULL)
+    {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) || parsed.frame_type != FRAME_TYPE_DATA ||
+        parsed.payload_length < ANNOUNCE_LENGTH || frame[1 + parsed.header_length] != IEEE802154_CHANNEL_DISPATCH)
+    {
+        portENTER_CRITICAL(&channel_lock);
+        channel_track_recovered(now);
+        portEXIT_CRITICAL(&channel_lock);
+        return false;
+    }
+    const uint8_t *payload = &frame[1 + parsed.header_length];
+    if (payload[1] != ANNOUNCE_COMMAND_SWITCH || payload[2] < IEEE802154_CHANNEL_MIN || payload[2] > IEEE802154_CHANNEL_MAX)
+    {
+        return true;
+    }
+
+    uint8_t channel = payload[2];
+    uint16_t left_ms = payload[3] | (payload[4] << 8);
+    if (held)
+    {
+        return true;
+    }
+
+    // Both peers announced at once, the lower short address wins
+    if (announcing && parsed.src_addr.mode == ADDR_MODE_SHORT &&
+        parsed.src_addr.short_address > esp_ieee802154_get_short_address())
+    {
+        return true;
+    }
+
+    channel_event_t event = {
+        .type = CHANNEL_EVENT_PEER,
+        .reason = IEEE802154_CHANNEL_REASON_PEER,
+        .channel = channel,
+        .due_us = now + (int64_t)left_ms * 1000,
+    };
+    bool follow = false;
+    uint8_t current_channel = esp_ieee802154_get_channel();
+    portENTER_CRITICAL(&channel_lock);
+    stats.announcements_received += 1;
+    if (peer_channel == 0 && channel != current_channel)
+    {
+        peer_channel = channel;
+        abort_announcement = announcing;
+        if (track == TRACK_PENDING)
+        {
+            current.reason = IEEE802154_CHANNEL_REASON_PEER; // Own trigger, the peer was faster
+        }
+        else
+        {
+            channel_track_begin(IEEE802154_CHANNEL_REASON_PEER, now);
+        }
+        follow = true;
+    }
+    portEXIT_CRITICAL(&channel_lock);
+
+    if (follow && xQueueSend(channel_queue, &event, 0) != pdTRUE)
+    {
+        portENTER_CRITICAL(&channel_lock);
+        peer_channel = 0;
+        portEXIT_CRITICAL(&channel_lock);
+    }
+    return true;
+}
+
+static void channel_send_announcement(uint8_t channel, uint16_t left_ms)
+{
+    uint8_t frame[128];
+    uint8_t payload[ANNOUNCE_LENGTH] = {
+        IEEE802154_CHANNEL_DISPATCH, ANNOUNCE_COMMAND_SWITCH, channel, (uint8_t)left_ms, (uint8_t)(left_ms >> 8),
+    };
+    ieee802154_address_t broadcast = {
+        .mode = ADDR_MODE_SHORT,
+        .short_address = 0xFFFF,
+    };
+    static uint8_t seq_nr = 0;
+
+    seq_nr += 1;
+    if (esp_ieee802154_create_2015_l2_data_frame(frame, esp_ieee802154_get_panid(), &broadcast, payload, sizeof(payload), &seq_nr, false) == 0)
+    {
+        return;
+    }
+    // Without CCA, a jammed channel would hold the announcement back
+    if (esp_ieee802154_tx_engine_submit(frame, false, NULL, NULL, 0) == ESP_OK)
+    {
+        portENTER_CRITICAL(&channel_lock);
+        stats.announcements_sent += 1;
+        portEXIT_CRITICAL(&channel_lock);
+    }
+}
+
+/* --- Channel task --- */
+
+static void channel_move(uint8_t channel)
+{
+    int64_t now = esp_timer_get_time();
+    uint8_t from = esp_ieee802154_get_channel();
+    // Retuning aborts a frame on air, the engine waits for its outcome first
+    esp_ieee802154_tx_engine_pause();
+    esp_ieee802154_set_channel(channel);
+    esp_ieee802154_receive();
+    esp_ieee802154_tx_engine_resume();
+
+    portENTER_CRITICAL(&channel_lock);
+    if (track != TRACK_PENDING)
+    {
+        channel_track_begin(IEEE802154_CHANNEL_REASON_SURVEY, now);
+    }
+    current.from = from;
+    current.to = channel;
+    current.switch_us = now;
+    memmove(&stats.history[1], &stats.history[0], (IEEE802154_CHANNEL_HISTORY - 1) * sizeof(ieee802154_channel_switch_t));
+    stats.history[0] = current;
+    if (stats.history_count < IEEE802154_CHANNEL_HISTORY)
+    {
+        stats.history_count += 1;
+    }
+    stats.switches += 1;
+    track = TRACK_SWITCHED;
+    channel_window_clear();
+    holdoff_until_us = now + CHANNEL_HOLDOFF_US;
+    peer_channel = 0;
+    portEXIT_CRITICAL(&channel_lock);
+
+    ESP_LOGI(TAG, "Switched from channel %d to channel %d", from, channel);
+}
+
+static void channel_announce_and_move(uint8_t channel)
+{
+    announcing = true;
+    abort_announcement = false;
+    int64_t due_us = esp_timer_get_time() + IEEE802154_CHANNEL_DELAY_MS * 1000;
+
+    for (uint8_t idx = 0; idx < IEEE802154_CHANNEL_ANNOUNCEMENTS && !abort_announcement; idx++)
+    {
+        int64_t left_us = due_us - esp_timer_get_time();
+        channel_send_announcement(channel, (left_us > 0) ? left_us / 1000 : 0);
+        vTaskDelay(IEEE802154_CHANNEL_SPACING_MS / portTICK_PERIOD_MS);
+    }
+
+    int64_t left_us = due_us - esp_timer_get_time();
+    if (!abort_announcement && left_us > 0)
+    {
+        vTaskDelay(left_us / 1000 / portTICK_PERIOD_MS + 1);
+    }
+    if (!abort_announcement)
+    {
+        channel_move(channel);
+    }
+    announcing = false;
+}
+
+static uint8_t channel_pick(void)
+{
+    ieee802154_survey_t survey;
+    uint8_t ranking[IEEE802154_NUM_CHANNELS];
+    uint8_t current_channel = esp_ieee802154_get_channel();
+
+    // The survey puts the radio back on the current channel, the announcement goes out there
+    esp_err_t err = esp_ieee802154_survey_run(CONFIG_IEEE802154_UTIL_SURVEY_SAMPLES, CONFIG_IEEE802154_UTIL_SURVEY_ED_DURATION,
+                                              CONFIG_IEEE802154_UTIL_SURVEY_BUSY_DBM, &survey);
+    esp_ieee802154_receive();
+    if (err != ESP_OK)
+    {
+        return 0;
+    }
+
+    esp_ieee802154_survey_rank(&survey, ranking);
+    return (ranking[0] != current_channel) ? ranking[0] : ranking[1];
+}
+
+/* Moves only if the current channel is noticeably busier than the best one, see esp_ieee802154_survey_should_switch() */
+static void channel_survey(void)
+{
+    ieee802154_survey_t survey;
+    uint8_t current_channel = esp_ieee802154_get_channel();
+
+    esp_err_t err = esp_ieee802154_survey_run(CONFIG_IEEE802154_UTIL_SURVEY_SAMPLES, CONFIG_IEEE802154_UTIL_SURVEY_ED_DURATION,
+                                              CONFIG_IEEE802154_UTIL_SURVEY_BUSY_DBM, &survey);
+    esp_ieee802154_receive();
+    if (err != ESP_OK)
+    {
+        return;
+    }
+
+    esp_ieee802154_survey_print(&survey);
+    if (!esp_ieee802154_survey_should_switch(&survey, current_channel))
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&channel_lock);
+    bool begin = channel_track_begin(IEEE802154_CHANNEL_REASON_SURVEY, esp_timer_get_time());
+    portEXIT_CRITICAL(&channel_lock);
+    if (begin)
+    {
+        channel_announce_and_move(survey.best_channel);
+    }
+}
+
+/* Events queued before the hold are dropped, the tracked switch ends */
+static void channel_drop_event(const channel_event_t *event)
+{
+    portENTER_CRITICAL(&channel_lock);
+    track = (track == TRACK_PENDING) ? TRACK_IDLE : track;
+    trigger_queued = (event->type == CHANNEL_EVENT_TRIGGER) ? false : trigger_queued;
+    peer_channel = (event->type == CHANNEL_EVENT_PEER) ? 0 : peer_channel;
+    portEXIT_CRITICAL(&channel_lock);
+}
+
+static void channel_task(void *pvParameters)
+{
+    channel_event_t event;
+
+    while (1)
+    {
+        if (xQueueReceive(channel_queue, &event, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        if (held && event.type != CHANNEL_EVENT_SWITCH)
+        {
+            channel_drop_event(&event);
+            continue;
+        }
+
+        switch (event.type)
+        {
+        case CHANNEL_EVENT_SURVEY:
+            channel_survey();
+            break;
+        case CHANNEL_EVENT_TRIGGER:
+        {
+            uint8_t channel = channel_pick();
+            if (channel != 0)
+            {
+                channel_announce_and_move(channel);
+            }
+            portENTER_CRITICAL(&channel_lock);
+            if (track == TRACK_PENDING && channel == 0)
+            {
+                track = TRACK_IDLE;
+                holdoff_until_us = esp_timer_get_time() + CHANNEL_HOLDOFF_US;
+            }
+            trigger_queued = false;
+            portEXIT_CRITICAL(&channel_lock);
+            break;
+        }
+        case CHANNEL_EVENT_SWITCH:
+            if (event.channel != esp_ieee802154_get_channel())
+            {
+                channel_announce_and_move(event.channel);
+            }
+            else
+            {
+                portENTER_CRITICAL(&channel_lock);
+                track = (track == TRACK_PENDING) ? TRACK_IDLE : track;
+                portEXIT_CRITICAL(&channel_lock);
+            }
+            break;
+        case CHANNEL_EVENT_PEER:
+        {
+            int64_t left_us = event.due_us - esp_timer_get_time();
+            if (left_us > 0)
+            {
+                vTaskDelay(left_us / 1000 / portTICK_PERIOD_MS + 1);
+            }
+            if (held)
+            {
+                channel_drop_event(&event);
+                break;
+            }
+            channel_move(event.channel);
+            break;
+        }
+        }
+    }
+}
+
+esp_err_t esp_ieee802154_channel_start(UBaseType_t priority)
+{
+    if (channel_queue != NULL)
+    {
+        return ESP_OK;
+    }
+
+    channel_queue = xQueueCreate(CHANNEL_QUEUE_LENGTH, sizeof(channel_event_t));
+    if (channel_queue == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(channel_task, "channel_task", 4096, NULL, priority, NULL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_channel_switch(uint8_t channel)
+{
+    if (channel < IEEE802154_CHANNEL_MIN || channel > IEEE802154_CHANNEL_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    channel_event_t event = {
+        .type = CHANNEL_EVENT_SWITCH,
+        .reason = IEEE802154_CHANNEL_REASON_SURVEY,
+        .channel = channel,
+    };
+    portENTER_CRITICAL(&channel_lock);
+    channel_track_begin(IEEE802154_CHANNEL_REASON_SURVEY, esp_timer_get_time());
+    portEXIT_CRITICAL(&channel_lock);
+    return (xQueueSend(channel_queue, &event, 0) == pdTRUE) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_ieee802154_channel_survey(void)
+{
+    if (channel_queue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    channel_event_t event = {
+        .type = CHANNEL_EVENT_SURVEY,
+        .reason = IEEE802154_CHANNEL_REASON_SURVEY,
+    };
+    return (xQueueSend(channel_queue, &event, 0) == pdTRUE) ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+void esp_ieee802154_channel_hold(bool hold)
+{
+    portENTER_CRITICAL(&channel_lock);
+    held = hold;
+    abort_announcement = hold && announcing;
+    if (!hold)
+    {
+        channel_window_clear(); // The results while held are not of the current channel
+    }
+    portEXIT_CRITICAL(&channel_lock);
+}
+
+void esp_ieee802154_channel_get_stats(ieee802154_channel_stats_t *out)
+{
+    portENTER_CRITICAL(&channel_lock);
+    *out = stats;
+    out->window = window_fill;
+    out->cca_failures = __builtin_popcountll(cca_bits);
+    out->acked_window = __builtin_popcountll(ack_bits);
+    out->no_acks = __builtin_popcountll(no_ack_bits);
+    portEXIT_CRITICAL(&channel_lock);
+    out->channel = esp_ieee802154_get_channel();
+}
+
+/* --- Console --- */
+
+static const char *channel_reason_name(ieee802154_channel_reason_t reason)
+{
+    switch (reason)
+    {
+    case IEEE802154_CHANNEL_REASON_CCA:
+        return "CCA";
+    case IEEE802154_CHANNEL_REASON_NO_ACK:
+        return "no ACK";
+    case IEEE802154_CHANNEL_REASON_SURVEY:
+        return "survey";
+    case IEEE802154_CHANNEL_REASON_PEER:
+        return "peer";
+    }
+    return "?";
+}
+
+static void channel_print(void)
+{
+    static ieee802154_channel_stats_t channel_stats; // Too large for the console task stack
+    esp_ieee802154_channel_get_stats(&channel_stats);
+
+    printf("Channel %d, window %d frames: %d CCA failures (limit %d %%), %d of %d ACKs missing (limit %d %%)\n",
+           channel_stats.channel, channel_stats.window, channel_stats.cca_failures, CONFIG_IEEE802154_UTIL_CHANNEL_CCA_PERCENT,
+           channel_stats.no_acks, channel_stats.acked_window, CONFIG_IEEE802154_UTIL_CHANNEL_NO_ACK_PERCENT);
+    printf("%" PRIu32 " switches, %" PRIu32 " announcements sent, %" PRIu32 " received\n",
+           channel_stats.switches, channel_stats.announcements_sent, channel_stats.announcements_received);
+    if (channel_stats.history_count == 0)
+    {
+        return;
+    }
+
+    printf("%-8s %4s %4s %12s %12s %8s\n", "Reason", "From", "To", "Switch ms", "Recover ms", "Lost");
+    for (uint8_t idx = 0; idx < channel_stats.history_count; idx++)
+    {
+        const ieee802154_channel_switch_t *entry = &channel_stats.history[idx];
+        printf("%-8s %4d %4d %12" PRId64, channel_reason_name(entry->reason), entry->from, entry->to,
+               (entry->switch_us - entry->trigger_us) / 1000);
+        if (entry->recovered_us != 0)
+        {
+            printf(" %12" PRId64, (entry->recovered_us - entry->trigger_us) / 1000);
+        }
+        else
+        {
+            printf(" %12s", "-");
+        }
+        printf(" %8" PRIu32 "\n", entry->lost);
+    }
+}
+
+static int channel_command(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        channel_print();
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "survey") == 0)
+    {
+        esp_err_t err = esp_ieee802154_channel_survey();
+        if (err != ESP_OK)
+        {
+            printf("Survey failed: %s\n", esp_err_to_name(err));
+            return 1;
+        }
+        return 0;
+    }
+    if (argc == 3 && strcmp(argv[1], "switch") == 0)
+    {
+        esp_err_t err = esp_ieee802154_channel_switch(strtoul(argv[2], NULL, 0));
+        if (err != ESP_OK)
+        {
+            printf("Switch failed: %s\n", esp_err_to_name(err));
+            return 1;
+        }
+        return 0;
+    }
+    printf("Usage: channel [survey | switch <%d-%d>]\n", IEEE802154_CHANNEL_MIN, IEEE802154_CHANNEL_MAX);
+    return 1;
+}
+
+esp_err_t esp_ieee802154_channel_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "channel",
+        .help = "Channel agility: CCA and ACK window, recorded switches with switch time and lost frames",
+        .hint = "[survey | switch <channel>]",
+        .func = &channel_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,33 @@
+#include <esp_console.h>
+
+#include "sdkconfig.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_console.h"
+
+esp_err_t esp_ieee802154_console_start(const char *prompt)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = prompt;
+    repl_config.max_cmdline_length = IEEE802154_CONSOLE_MAX_LINE;
+
+#if defined(CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG)
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#else
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t err = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#endif
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    esp_console_register_help_command();
+    err = esp_ieee802154_metrics_register_console();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    return esp_console_start_repl(repl);
+}
@@ -0,0 +1,144 @@
+#include <string.h>
+#include <stdbool.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_fanout.h"
+
+#define TAG "ieee802154_fanout"
+
+typedef struct {
+    SemaphoreHandle_t done;    // Given once per outcome
+    ieee802154_fanout_dst_t *dsts;
+    size_t reported;           // Outcomes stored, the TX engine reports the frames in the order they were queued
+} fanout_call_t;
+
+/* --- Template --- */
+
+/* The header of b has the layout of the header of a: same addressing mode and pan id compression */
+static bool fanout_same_layout(const ieee802154_fanout_dst_t *a, const ieee802154_fanout_dst_t *b, uint16_t src_pan_id)
+{
+    return a->dst_addr.mode == b->dst_addr.mode && (a->dst_pan_id == src_pan_id) == (b->dst_pan_id == src_pan_id);
+}
+
+/* Write the sequence number and the destination into the template, at the positions of the header builders */
+static void fanout_patch(uint8_t *frame, const ieee802154_fanout_dst_t *dst, const uint8_t *seq_nr)
+{
+    uint8_t *header = &frame[1];
+    uint8_t dst_pan_pos = 2;
+    if (seq_nr != NULL)
+    {
+        header[dst_pan_pos] = *seq_nr;
+        dst_pan_pos += 1;
+    }
+
+    header[dst_pan_pos] = dst->dst_pan_id & 0xff;
+    header[dst_pan_pos + 1] = dst->dst_pan_id >> 8;
+    if (dst->dst_addr.mode == ADDR_MODE_SHORT)
+    {
+        header[dst_pan_pos + 2] = dst->dst_addr.short_address & 0xff;
+        header[dst_pan_pos + 3] = dst->dst_addr.short_address >> 8;
+    }
+    else if (dst->dst_addr.mode == ADDR_MODE_LONG)
+    {
+        esp_ieee802154_ext_address_write(dst->dst_addr.long_address, &header[dst_pan_pos + 2]);
+    }
+}
+
+/* --- Fan-out --- */
+
+/* Called in the TX engine task */
+static void fanout_tx_done(const uint8_t *frame, const ieee802154_tx_result_t *result, void *arg)
+{
+    fanout_call_t *call = arg;
+    ieee802154_fanout_dst_t *dst = &call->dsts[call->reported];
+    dst->error = result->error;
+    dst->acked = result->acked;
+    dst->ack_rssi = result->ack_rssi;
+    call->reported += 1;
+    // The caller returns (and its stack frame with it) once the last outcome is given, nothing touches it after
+    xSemaphoreGive(call->done);
+}
+
+esp_err_t esp_ieee802154_fanout_send(ieee802154_fanout_dst_t *dsts, size_t count, uint8_t *data, uint8_t data_length,
+                                     uint8_t *seq_nr, bool ack, TickType_t timeout)
+{
+    uint8_t frame[128];
+    uint16_t src_pan_id;
+    ieee802154_address_t src_addr;
+    esp_ieee802154_get_source_address(&src_pan_id, &src_addr);
+
+    // Counts the outcomes, so none is lost if the engine reports several before the caller takes them
+    StaticSemaphore_t done_buffer;
+    fanout_call_t call = {
+        .done = xSemaphoreCreateCountingStatic(count > 0 ? count : 1, 0, &done_buffer),
+        .dsts = dsts,
+        .reported = 0,
+    };
+    const ieee802154_fanout_dst_t *layout = NULL; // Destination the template header was built for
+    uint8_t seq = (seq_nr != NULL) ? *seq_nr : 0;
+    size_t queued = 0;
+    esp_err_t err = ESP_OK;
+
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        ieee802154_fanout_dst_t *dst = &dsts[idx];
+        dst->seq_nr = seq;
+        dst->error = ESP_IEEE802154_TX_ERR_ABORT;
+        dst->acked = false;
+        if (err != ESP_OK)
+        {
+            continue;
+        }
+
+        uint8_t *dst_seq_nr = (seq_nr != NULL) ? &dst->seq_nr : NULL;
+        if (layout == NULL || !fanout_same_layout(layout, dst, src_pan_id))
+        {
+            if (esp_ieee802154_create_2015_l2_data_frame_from(frame, src_pan_id, &src_addr, dst->dst_pan_id, &dst->dst_addr,
+                                                              data, data_length, dst_seq_nr, ack) == 0)
+            {
+                err = ESP_ERR_INVALID_SIZE;
+                continue;
+            }
+            layout = dst;
+        }
+        else
+        {
+            fanout_patch(frame, dst, dst_seq_nr);
+        }
+
+        if (esp_ieee802154_tx_engine_submit(frame, true, fanout_tx_done, &call, timeout) != ESP_OK)
+        {
+            err = ESP_ERR_TIMEOUT;
+            continue;
+        }
+        queued += 1;
+        seq += (seq_nr != NULL);
+    }
+
+    // The engine reports every queued frame, either from the radio or after its own timeout
+    for (size_t idx = 0; idx < queued; idx++)
+    {
+        xSemaphoreTake(call.done, portMAX_DELAY);
+    }
+    vSemaphoreDelete(call.done);
+
+    if (seq_nr != NULL && queued > 0)
+    {
+        *seq_nr = seq - 1;
+    }
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        if (dsts[idx].error != ESP_IEEE802154_TX_ERR_NONE)
+        {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,174 @@
+#include <stdbool.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#endif
+#include "ieee802154_util.h"
+
+#define TAG "ieee802154"
+
+/* --- IEEE802154 header builders --- */
+
+/**
+ * Explicit encoding of the frame control field. The bit positions are taken from the IEEE802.15.4 standard,
+ * so the serialized FCF does not depend on how the compiler lays out the ieee802154_fcf_t bitfield.
+ */
+#define FCF_FRAME_TYPE_SHIFT        0
+#define FCF_SECURE_SHIFT            3
+#define FCF_FRAME_PENDING_SHIFT     4
+#define FCF_ACK_REQUEST_SHIFT       5
+#define FCF_PAN_ID_COMPRESSION_SHIFT 6
+#define FCF_SEQ_NR_SUPPRESSION_SHIFT 8
+#define FCF_IE_PRESENT_SHIFT        9
+#define FCF_DST_ADDR_MODE_SHIFT     10
+#define FCF_FRAME_VERSION_SHIFT     12
+#define FCF_SRC_ADDR_MODE_SHIFT     14
+
+#define FCF_ENCODE(type, ver, sns, pic, dst_mode, src_mode)                  \
+    ((uint16_t)(((type) & 0x7) << FCF_FRAME_TYPE_SHIFT) |                    \
+     (uint16_t)(((pic) & 0x1) << FCF_PAN_ID_COMPRESSION_SHIFT) |             \
+     (uint16_t)(((sns) & 0x1) << FCF_SEQ_NR_SUPPRESSION_SHIFT) |             \
+     (uint16_t)(((dst_mode) & 0x3) << FCF_DST_ADDR_MODE_SHIFT) |             \
+     (uint16_t)(((ver) & 0x3) << FCF_FRAME_VERSION_SHIFT) |                  \
+     (uint16_t)(((src_mode) & 0x3) << FCF_SRC_ADDR_MODE_SHIFT))
+
+#define ADDR_MODE_LENGTH(mode) ((mode) == ADDR_MODE_LONG ? 8 : ((mode) == ADDR_MODE_SHORT ? 2 : 0))
+
+typedef uint8_t (*data_header_builder_t)(uint16_t dst_pan_id, const ieee802154_address_t *dst_addr, uint16_t src_pan_id,
+                                         const ieee802154_address_t *src_addr, const uint8_t *seq_nr, bool ack, uint8_t *header);
+
+/**
+ * Template for all data header builders.
+ *
+ * Every builder below calls this function with constant arguments for the frame version, the sequence number
+ * suppression, the pan id compression and both addressing modes. Since the function is always inlined, the
+ * compiler folds all offsets and removes every branch on these parameters.
+ *
+ * Note: The destination pan id is always written, even if no destination address is present. This matches the
+ * behaviour of the previous implementation.
+ */
+static inline __attribute__((always_inline)) uint8_t data_header_template(const uint8_t ver, const bool sns, const bool pic,
+                                                                          const uint8_t dst_mode, const uint8_t src_mode,
+                                                                          uint16_t dst_pan_id, const ieee802154_address_t *dst_addr,
+                                                                          uint16_t src_pan_id, const ieee802154_address_t *src_addr,
+                                                                          const uint8_t *seq_nr, bool ack, uint8_t *header)
+{
+    const uint8_t seq_nr_pos = 2;
+    const uint8_t dst_pan_pos = seq_nr_pos + (sns ? 0 : 1);
+    const uint8_t dst_addr_pos = dst_pan_pos + 2;
+    const uint8_t src_pan_pos = dst_addr_pos + ADDR_MODE_LENGTH(dst_mode);
+    const uint8_t src_addr_pos = src_pan_pos + (pic ? 0 : 2);
+    const uint8_t header_length = src_addr_pos + ADDR_MODE_LENGTH(src_mode);
+
+    const uint16_t fcf = FCF_ENCODE(FRAME_TYPE_DATA, ver, sns, pic, dst_mode, src_mode) | ((uint16_t)ack << FCF_ACK_REQUEST_SHIFT);
+    header[0] = fcf & 0xff;
+    header[1] = fcf >> 8;
+
+    if (!sns)
+    {
+        header[seq_nr_pos] = *seq_nr;
+    }
+
+    header[dst_pan_pos] = dst_pan_id & 0xff;
+    header[dst_pan_pos + 1] = dst_pan_id >> 8;
+
+    if (dst_mode == ADDR_MODE_SHORT)
+    {
+        header[dst_addr_pos] = dst_addr->short_address & 0xff;
+        header[dst_addr_pos + 1] = dst_addr->short_address >> 8;
+    }
+    else if (dst_mode == ADDR_MODE_LONG)
+    {
+        esp_ieee802154_ext_address_write(dst_addr->long_address, &header[dst_addr_pos]);
+    }
+
+    if (!pic)
+    {
+        // Add the SRC PAN to perform an inter PAN communication
+        header[src_pan_pos] = src_pan_id & 0xff;
+        header[src_pan_pos + 1] = src_pan_id >> 8;
+    }
+
+    if (src_mode == ADDR_MODE_SHORT)
+    {
+        header[src_addr_pos] = src_addr->short_address & 0xff;
+        header[src_addr_pos + 1] = src_addr->short_address >> 8;
+    }
+    else if (src_mode == ADDR_MODE_LONG)
+    {
+        esp_ieee802154_ext_address_write(src_addr->long_address, &header[src_addr_pos]);
+    }
+
+    return header_length;
+}
+
+/* Instantiate one builder per (version, sequence number suppression, pan id compression, dst mode, src mode) */
+#define DATA_HEADER_BUILDER_NAME(ver, sns, pic, dst, src) data_header_##ver##_##sns##_##pic##_##dst##_##src
+
+#define DEFINE_DATA_HEADER_BUILDER(ver, sns, pic, dst, src)                                                                   \
+    static uint8_t DATA_HEADER_BUILDER_NAME(ver, sns, pic, dst, src)(uint16_t dst_pan_id, const ieee802154_address_t *dst_addr, \
+                                                                    uint16_t src_pan_id, const ieee802154_address_t *src_addr, \
+                                                                    const uint8_t *seq_nr, bool ack, uint8_t *header)           \
+    {                                                                                                                         \
+        return data_header_template(ver, sns, pic, dst, src, dst_pan_id, dst_addr, src_pan_id, src_addr, seq_nr, ack, header); \
+    }
+
+#define DATA_HEADER_BUILDER_ENTRY(ver, sns, pic, dst, src) DATA_HEADER_BUILDER_NAME(ver, sns, pic, dst, src),
+
+#define FOR_EACH_SRC_MODE(X, ver, sns, pic, dst) X(ver, sns, pic, dst, 0) X(ver, sns, pic, dst, 1) X(ver, sns, pic, dst, 2) X(ver, sns, pic, dst, 3)
+#define FOR_EACH_DST_MODE(X, ver, sns, pic)                                                                  \
+    FOR_EACH_SRC_MODE(X, ver, sns, pic, 0) FOR_EACH_SRC_MODE(X, ver, sns, pic, 1) FOR_EACH_SRC_MODE(X, ver, sns, pic, 2) \
+    FOR_EACH_SRC_MODE(X, ver, sns, pic, 3)
+#define FOR_EACH_PIC(X, ver, sns) FOR_EACH_DST_MODE(X, ver, sns, 0) FOR_EACH_DST_MODE(X, ver, sns, 1)
+#define FOR_EACH_2003_BUILDER(X) FOR_EACH_PIC(X, 0, 0)
+#define FOR_EACH_2015_BUILDER(X) FOR_EACH_PIC(X, 2, 0) FOR_EACH_PIC(X, 2, 1)
+
+FOR_EACH_2003_BUILDER(DEFINE_DATA_HEADER_BUILDER)
+FOR_EACH_2015_BUILDER(DEFINE_DATA_HEADER_BUILDER)
+
+// Indexed by (sns << 5) | (pic << 4) | (dst_mode << 2) | src_mode, 2003 headers never suppress the sequence number
+static const data_header_builder_t data_header_2003_builders[32] = { FOR_EACH_2003_BUILDER(DATA_HEADER_BUILDER_ENTRY) };
+static const data_header_builder_t data_header_2015_builders[64] = { FOR_EACH_2015_BUILDER(DATA_HEADER_BUILDER_ENTRY) };
+
+#define DATA_HEADER_BUILDER_INDEX(sns, pic, dst_mode, src_mode) \
+    (((sns) << 5) | ((pic) << 4) | (((dst_mode) & 0x3) << 2) | ((src_mode) & 0x3))
+
+uint8_t esp_ieee802154_create_2003_data_header(uint16_t *dst_pan_id, ieee802154_address_t *dst_addr, uint16_t *src_pan_id, ieee802154_address_t *src_addr, uint8_t *seq_nr, bool ack, uint8_t *header)
+{
+    if (seq_nr == NULL)
+    {
+#ifdef ESP_PLATFORM
+        ESP_LOGE(TAG, "Sequence number cant be NULL.");
+#endif
+    }
+
+    /**
+     * According to the IEEE802.15.4 standard 2003, the pan id can be compressed if the source and destination
+     * pan id is the same.
+     * In other words, if the pan id matches, only the destination pan id has to be present in the header and the
+     * pan_id_compression bit in the frame control field should be set to 1.
+     */
+    bool pic = (*dst_pan_id == *src_pan_id);
+
+    data_header_builder_t builder = data_header_2003_builders[DATA_HEADER_BUILDER_INDEX(0, pic, dst_addr->mode, src_addr->mode)];
+    return builder(*dst_pan_id, dst_addr, *src_pan_id, src_addr, seq_nr, ack, header);
+}
+
+uint8_t esp_ieee802154_create_2015_data_header(uint16_t *dst_pan_id, ieee802154_address_t *dst_addr, uint16_t *src_pan_id, ieee802154_address_t *src_addr, uint8_t *seq_nr, bool ack, uint8_t *header)
+{
+    /**
+     * According to the IEEE802.15.4 standard 2015, the sequence number can be suppressed.
+     */
+    bool sns = (seq_nr == NULL);
+
+    /**
+     * According to the IEEE802.15.4 standard 2015, the pan id can be compressed if the source and destination
+     * pan id is the same.
+     * In other words, if the pan id matches, only the destination pan id has to be present in the header and the
+     * pan_id_compression bit in the frame control field should be set to 1.
+     */
+    bool pic = (*dst_pan_id == *src_pan_id);
+
+    data_header_builder_t builder = data_header_2015_builders[DATA_HEADER_BUILDER_INDEX(sns, pic, dst_addr->mode, src_addr->mode)];
+    return builder(*dst_pan_id, dst_addr, *src_pan_id, src_addr, seq_nr, ack, header);
+}
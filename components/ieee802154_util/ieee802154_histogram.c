@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "ieee802154_histogram.h"
+
+#define HISTOGRAM_BAR_WIDTH 32
+
+static uint32_t histogram_upper_bound(uint8_t bucket)
+{
+    return (bucket == 0) ? 0 : (uint32_t)((1ULL << bucket) - 1);
+}
+
+uint32_t esp_ieee802154_histogram_percentile(const ieee802154_histogram_t *histogram, uint8_t percent)
+{
+    if (histogram->count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = ((uint64_t)histogram->count * percent + 99) / 100; // The rank-th smallest value, at least 1
+    uint64_t seen = 0;
+    for (uint8_t bucket = 0; bucket < IEEE802154_HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank && seen > 0)
+        {
+            uint32_t bound = histogram_upper_bound(bucket);
+            return (bound < histogram->max && bucket < IEEE802154_HISTOGRAM_BUCKETS - 1) ? bound : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void esp_ieee802154_histogram_print(const ieee802154_histogram_t *histogram, const char *indent, const char *unit)
+{
+    if (histogram->count == 0)
+    {
+        printf("%sno samples\n", indent);
+        return;
+    }
+
+    printf("%s%" PRIu32 " samples, min %" PRIu32 ", avg %" PRIu32 ", p50 %" PRIu32 ", p99 %" PRIu32 ", max %" PRIu32 " %s\n",
+           indent, histogram->count, histogram->min, (uint32_t)(histogram->sum / histogram->count),
+           esp_ieee802154_histogram_percentile(histogram, 50), esp_ieee802154_histogram_percentile(histogram, 99),
+           histogram->max, unit);
+
+    uint32_t largest = 0;
+    for (uint8_t bucket = 0; bucket < IEEE802154_HISTOGRAM_BUCKETS; bucket++)
+    {
+        largest = (histogram->buckets[bucket] > largest) ? histogram->buckets[bucket] : largest;
+    }
+
+    for (uint8_t bucket = 0; bucket < IEEE802154_HISTOGRAM_BUCKETS; bucket++)
+    {
+        uint32_t count = histogram->buckets[bucket];
+        if (count == 0)
+        {
+            continue;
+        }
+
+        char bar[HISTOGRAM_BAR_WIDTH + 1];
+        uint32_t width = (uint32_t)(((uint64_t)count * HISTOGRAM_BAR_WIDTH + largest - 1) / largest);
+        for (uint32_t idx = 0; idx < width; idx++)
+        {
+            bar[idx] = '#';
+        }
+        bar[width] = '\0';
+
+        uint32_t low = (bucket == 0) ? 0 : (1UL << (bucket - 1));
+        if (bucket == IEEE802154_HISTOGRAM_BUCKETS - 1)
+        {
+            printf("%s  >= %-12" PRIu32 " %s %8" PRIu32 " %s\n", indent, low, unit, count, bar);
+        }
+        else
+        {
+            printf("%s  %7" PRIu32 "-%-7" PRIu32 " %s %8" PRIu32 " %s\n", indent, low, histogram_upper_bound(bucket), unit, count, bar);
+        }
+    }
+}
@@ -0,0 +1,725 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_mesh.h"
+#include "ieee802154_addr_book.h"
+
+#define TAG "ieee802154_mesh"
+
+#define SLOT_EMPTY   0
+#define SLOT_USED    1
+#define SLOT_DELETED 2 // Keeps the probe sequences of other entries intact
+
+#define MESH_HOPS_OFFSET        1
+#define MESH_DST_OFFSET         2
+#define MESH_ORIGINATOR_OFFSET  4
+#define MESH_MAX_MAC_HEADER     21  // FCF, sequence number, pan id, two long addresses
+#define MESH_NO_NEIGHBOR        0xFF
+#define MESH_LQI_HYSTERESIS     32  // A learned route only moves to a neighbor with a clearly better link
+
+typedef struct {
+    ieee802154_addr_id_t id; // Address book id of the neighbor
+    uint8_t lqi;             // Average LQI of the frames and ACKs of the neighbor
+    uint32_t last_heard_ms;
+} mesh_neighbor_t;
+
+typedef struct {
+    uint8_t state;
+    bool fixed;              // Added with esp_ieee802154_mesh_route_add(), never aged
+    uint8_t neighbor;        // Index of the next hop in the neighbor table
+    uint16_t dst;
+} mesh_route_t;
+
+typedef struct {
+    ieee802154_rx_entry_t *entry;   // Spare RX entry while free, the entry of the frame on air while forwarding
+    ieee802154_addr_id_t next_hop;  // Address book id of the neighbor the frame is sent to
+    uint32_t start_us;              // Reception of the forwarded frame
+    bool busy;
+} mesh_forward_t;
+
+static mesh_route_t routes[IEEE802154_MESH_ROUTE_SLOTS];
+static uint16_t route_count = 0;
+static mesh_neighbor_t neighbors[IEEE802154_MESH_MAX_NEIGHBORS];
+static uint8_t neighbor_count = 0;
+static uint8_t neighbor_index[IEEE802154_ADDR_BOOK_MAX]; // Index + 1 in neighbors by address book id, 0 if none
+static portMUX_TYPE mesh_lock = portMUX_INITIALIZER_UNLOCKED; // Protects the tables and the statistics
+
+static ieee802154_mesh_deliver_cb_t deliver_cb = NULL;
+static void *deliver_arg = NULL;
+static uint8_t mesh_seq = 0;
+static ieee802154_rx_entry_t forward_entries[IEEE802154_MESH_FORWARD_BUFFERS];
+static mesh_forward_t forwards[IEEE802154_MESH_FORWARD_BUFFERS];
+
+static ieee802154_mesh_stats_t stats;
+static int64_t rate_window_start = 0;
+static uint32_t rate_window_count = 0;
+
+/* --- Neighbors --- */
+
+static uint32_t mesh_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/* Link quality, halved for every aging interval without a frame of the neighbor */
+static uint8_t mesh_link_quality(const mesh_neighbor_t *neighbor, uint32_t now_ms)
+{
+    int32_t silent_ms = (int32_t)(now_ms - neighbor->last_heard_ms); // Negative if heard after now_ms was taken
+    uint32_t intervals = (silent_ms > 0) ? silent_ms / (IEEE802154_MESH_AGE_INTERVAL_S * 1000) : 0;
+    return (intervals >= 8) ? 0 : (neighbor->lqi >> intervals);
+}
+
+
+/* A neighbor can be replaced if no fixed route uses it and its link is too weak for learned routes */
+static bool mesh_neighbor_unused(uint8_t index, uint32_t now_ms)
+{
+    if (mesh_link_quality(&neighbors[index], now_ms) >= CONFIG_IEEE802154_UTIL_MESH_MIN_LQI)
+    {
+        return false;
+    }
+    for (uint32_t idx = 0; idx < IEEE802154_MESH_ROUTE_SLOTS; idx++)
+    {
+        if (routes[idx].state == SLOT_USED && routes[idx].neighbor == index && routes[idx].fixed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void mesh_remove_routes(uint8_t index)
+{
+    for (uint32_t idx = 0; idx < IEEE802154_MESH_ROUTE_SLOTS; idx++)
+    {
+        if (routes[idx].state == SLOT_USED && routes[idx].neighbor == index)
+        {
+            routes[idx].state = SLOT_DELETED;
+            route_count -= 1;
+        }
+    }
+}
+
+/* Index of the neighbor, a new neighbor replaces an unused one if the table is full (MESH_NO_NEIGHBOR if none) */
+static uint8_t mesh_add_neighbor(ieee802154_addr_id_t id, uint8_t lqi, uint32_t now_ms)
+{
+    if (neighbor_index[id] > 0)
+    {
+        return neighbor_index[id] - 1;
+    }
+
+    uint8_t index = MESH_NO_NEIGHBOR;
+    if (neighbor_count < IEEE802154_MESH_MAX_NEIGHBORS)
+    {
+        index = neighbor_count;
+        neighbor_count += 1;
+    }
+    else
+    {
+        for (uint8_t idx = 0; idx < neighbor_count && index == MESH_NO_NEIGHBOR; idx++)
+        {
+            if (mesh_neighbor_unused(idx, now_ms))
+            {
+                index = idx;
+            }
+        }
+        if (index == MESH_NO_NEIGHBOR)
+        {
+            return MESH_NO_NEIGHBOR;
+        }
+        mesh_remove_routes(index); // Learned routes over the old neighbor, they must not move to the new one
+        neighbor_index[neighbors[index].id] = 0;
+    }
+
+    neighbor_index[id] = index + 1;
+    neighbors[index].id = id;
+    neighbors[index].lqi = lqi;
+    neighbors[index].last_heard_ms = now_ms;
+    return index;
+}
+
+/* The neighbor with the address book id, NULL if its slot went to another neighbor */
+static mesh_neighbor_t *mesh_find_neighbor(ieee802154_addr_id_t id)
+{
+    return (neighbor_index[id] > 0) ? &neighbors[neighbor_index[id] - 1] : NULL;
+}
+
+static void mesh_update_neighbor(mesh_neighbor_t *neighbor, uint8_t lqi, uint32_t now_ms)
+{
+    neighbor->lqi = (3 * neighbor->lqi + lqi) / 4;
+    neighbor->last_heard_ms = now_ms;
+}
+
+/* --- Routing table --- */
+
+static uint32_t mesh_hash(uint16_t dst)
+{
+    return ((uint32_t)dst * 0x9E3779B1) >> (32 - IEEE802154_MESH_ROUTE_BITS); // Fibonacci hashing
+}
+
+/* Index of the slot holding the route, or of the first free slot of its probe sequence (-1 if none) */
+static int32_t mesh_probe(uint16_t dst, bool *found)
+{
+    int32_t free_slot = -1;
+    uint32_t index = mesh_hash(dst);
+
+    for (uint32_t probe = 0; probe < IEEE802154_MESH_ROUTE_SLOTS; probe++)
+    {
+        mesh_route_t *route = &routes[index];
+        if (route->state == SLOT_EMPTY)
+        {
+            *found = false;
+            return (free_slot >= 0) ? free_slot : (int32_t)index;
+        }
+        if (route->state == SLOT_DELETED)
+        {
+            free_slot = (free_slot >= 0) ? free_slot : (int32_t)index;
+        }
+        else if (route->dst == dst)
+        {
+            *found = true;
+            return index;
+        }
+        index = (index + 1) & (IEEE802154_MESH_ROUTE_SLOTS - 1);
+    }
+    *found = false;
+    return free_slot;
+}
+
+static esp_err_t mesh_set_route(uint16_t dst, uint8_t neighbor, bool fixed)
+{
+    bool found;
+    int32_t index = mesh_probe(dst, &found);
+    if (!found)
+    {
+        if (index < 0 || route_count >= IEEE802154_MESH_MAX_ROUTES)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        route_count += 1;
+    }
+
+    routes[index].state = SLOT_USED;
+    routes[index].dst = dst;
+    routes[index].neighbor = neighbor;
+    routes[index].fixed = fixed;
+    return ESP_OK;
+}
+
+/* The route to dst, learned routes over a neighbor below the minimum link quality are removed */
+static mesh_route_t *mesh_get_route(uint16_t dst, uint32_t now_ms)
+{
+    bool found;
+    int32_t index = mesh_probe(dst, &found);
+    if (!found)
+    {
+        return NULL;
+    }
+
+    mesh_route_t *route = &routes[index];
+    if (!route->fixed && mesh_link_quality(&neighbors[route->neighbor], now_ms) < CONFIG_IEEE802154_UTIL_MESH_MIN_LQI)
+    {
+        route->state = SLOT_DELETED;
+        route_count -= 1;
+        return NULL;
+    }
+    return route;
+}
+
+/* The originator of a received frame is reachable over the neighbor that sent it */
+static void mesh_learn_route(uint16_t originator, uint8_t neighbor, uint32_t now_ms)
+{
+    mesh_route_t *route = mesh_get_route(originator, now_ms);
+    if (route != NULL && (route->fixed || route->neighbor == neighbor ||
+                          mesh_link_quality(&neighbors[neighbor], now_ms) <
+                          mesh_link_quality(&neighbors[route->neighbor], now_ms) + MESH_LQI_HYSTERESIS))
+    {
+        return;
+    }
+    mesh_set_route(originator, neighbor, false);
+}
+
+esp_err_t esp_ieee802154_mesh_route_add(uint16_t dst, const ieee802154_address_t *next_hop)
+{
+    if (next_hop->mode != ADDR_MODE_SHORT && next_hop->mode != ADDR_MODE_LONG)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ieee802154_addr_id_t id = esp_ieee802154_addr_book_intern(esp_ieee802154_get_panid(), next_hop);
+    if (id == IEEE802154_ADDR_ID_NONE)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t now_ms = mesh_now_ms();
+    esp_err_t err = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&mesh_lock);
+    uint8_t neighbor = mesh_add_neighbor(id, 0, now_ms);
+    if (neighbor != MESH_NO_NEIGHBOR)
+    {
+        err = mesh_set_route(dst, neighbor, true);
+    }
+    portEXIT_CRITICAL(&mesh_lock);
+    return err;
+}
+
+esp_err_t esp_ieee802154_mesh_route_remove(uint16_t dst)
+{
+    bool found;
+    portENTER_CRITICAL(&mesh_lock);
+    int32_t index = mesh_probe(dst, &found);
+    if (found)
+    {
+        routes[index].state = SLOT_DELETED;
+        route_count -= 1;
+    }
+    portEXIT_CRITICAL(&mesh_lock);
+    return found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/* Address book id and address of the next hop to dst, IEEE802154_ADDR_ID_NONE without route */
+static ieee802154_addr_id_t mesh_next_hop(uint16_t dst, uint32_t now_ms, ieee802154_address_t *next_hop)
+{
+    portENTER_CRITICAL(&mesh_lock);
+    mesh_route_t *route = mesh_get_route(dst, now_ms);
+    ieee802154_addr_id_t id = (route != NULL) ? neighbors[route->neighbor].id : IEEE802154_ADDR_ID_NONE;
+    portEXIT_CRITICAL(&mesh_lock);
+
+    return esp_ieee802154_addr_book_address(id, NULL, next_hop) ? id : IEEE802154_ADDR_ID_NONE;
+}
+
+bool esp_ieee802154_mesh_route_lookup(uint16_t dst, ieee802154_address_t *next_hop)
+{
+    return mesh_next_hop(dst, mesh_now_ms(), next_hop) != IEEE802154_ADDR_ID_NONE;
+}
+
+/* --- Forwarding --- */
+
+/* The neighbor is looked up again, its slot may hold another neighbor since the frame was queued */
+static void mesh_transmit_done(const uint8_t *frame, const ieee802154_tx_result_t *result, void *arg)
+{
+    mesh_forward_t *forward = arg;
+    uint32_t now_ms = mesh_now_ms();
+    uint32_t latency = (uint32_t)esp_timer_get_time() - forward->start_us;
+
+    portENTER_CRITICAL(&mesh_lock);
+    mesh_neighbor_t *neighbor = mesh_find_neighbor(forward->next_hop);
+    if (result->error == ESP_IEEE802154_TX_ERR_NONE)
+    {
+        if (result->acked && neighbor != NULL)
+        {
+            mesh_update_neighbor(neighbor, result->ack_lqi, now_ms);
+        }
+        if (stats.forward_sent == 0 || latency < stats.latency_min_us)
+        {
+            stats.latency_min_us = latency;
+        }
+        if (latency > stats.latency_max_us)
+        {
+            stats.latency_max_us = latency;
+        }
+        stats.latency_sum_us += latency;
+        stats.forward_sent += 1;
+    }
+    else
+    {
+        if (result->error == ESP_IEEE802154_TX_ERR_NO_ACK && neighbor != NULL)
+        {
+            neighbor->lqi /= 2;
+        }
+        stats.forward_failed += 1;
+    }
+    forward->busy = false; // The engine is done with the receive buffer, it is the spare entry of the slot now
+    portEXIT_CRITICAL(&mesh_lock);
+}
+
+static void mesh_originate_done(const uint8_t *frame, const ieee802154_tx_result_t *result, void *arg)
+{
+    ieee802154_addr_id_t next_hop = (ieee802154_addr_id_t)(uintptr_t)arg;
+    uint32_t now_ms = mesh_now_ms();
+
+    portENTER_CRITICAL(&mesh_lock);
+    mesh_neighbor_t *neighbor = mesh_find_neighbor(next_hop);
+    if (neighbor != NULL && result->acked)
+    {
+        mesh_update_neighbor(neighbor, result->ack_lqi, now_ms);
+    }
+    else if (neighbor != NULL && result->error == ESP_IEEE802154_TX_ERR_NO_ACK)
+    {
+        neighbor->lqi /= 2;
+    }
+    portEXIT_CRITICAL(&mesh_lock);
+}
+
+/* MAC header to the next hop, with the own source address and the next sequence number */
+static uint8_t mesh_create_header(uint8_t version, const ieee802154_address_t *next_hop, uint8_t *seq_nr, uint8_t *header)
+{
+    uint16_t pan_id;
+    ieee802154_address_t src_addr;
+    ieee802154_address_t dst_addr = *next_hop;
+    esp_ieee802154_get_source_address(&pan_id, &src_addr);
+
+    portENTER_CRITICAL(&mesh_lock);
+    *seq_nr = mesh_seq++;
+    portEXIT_CRITICAL(&mesh_lock);
+    bool ack = !(dst_addr.mode == ADDR_MODE_SHORT && dst_addr.short_address == 0xFFFF);
+    if (version == FRAME_VERSION_STD_2015)
+    {
+        return esp_ieee802154_create_2015_data_header(&pan_id, &dst_addr, &pan_id, &src_addr, seq_nr, ack, header);
+    }
+    return esp_ieee802154_create_2003_data_header(&pan_id, &dst_addr, &pan_id, &src_addr, seq_nr, ack, header);
+}
+
+/**
+ * Replace the MAC header of a received frame in place. The new header ends where the old one ended, so the
+ * payload is not touched. Only a longer header (e.g. a long next hop address after a short one) moves the
+ * payload back. Returns the start of the rewritten frame (its length byte) within the buffer, NULL if the frame
+ * would be longer than the maximum PSDU (the frame is not touched then).
+ */
+static uint8_t *mesh_rewrite(uint8_t *frame, const ieee802154_frame_t *parsed, const ieee802154_address_t *next_hop, uint8_t *seq_nr, bool *moved)
+{
+    uint8_t header[MESH_MAX_MAC_HEADER];
+    uint8_t header_length = mesh_create_header(parsed->frame_version, next_hop, seq_nr, header);
+    uint8_t *payload = &frame[1 + parsed->header_length];
+    if (header_length + parsed->payload_length + 2 > IEEE802154_MAX_PSDU_LENGTH)
+    {
+        return NULL;
+    }
+
+    *moved = (header_length > parsed->header_length);
+    if (*moved)
+    {
+        uint8_t shift = header_length - parsed->header_length;
+        memmove(payload + shift, payload, parsed->payload_length); // Fits, the buffer holds the longest frame
+        payload += shift;
+    }
+
+    uint8_t *start = payload - header_length - 1;
+    memcpy(&start[1], header, header_length);
+    start[0] = header_length + parsed->payload_length + 2; // FCS included
+    return start;
+}
+
+static void mesh_count_forward(int64_t now)
+{
+    if (now - rate_window_start >= 1000000)
+    {
+        rate_window_start = now;
+        rate_window_count = 0;
+    }
+    rate_window_count += 1;
+    if (rate_window_count > stats.peak_rate)
+    {
+        stats.peak_rate = rate_window_count;
+    }
+    stats.forwarded += 1;
+}
+
+/* A free forward slot, NULL if every slot has a frame on air */
+static mesh_forward_t *mesh_take_forward(void)
+{
+    mesh_forward_t *forward = NULL;
+    portENTER_CRITICAL(&mesh_lock);
+    for (uint32_t idx = 0; idx < IEEE802154_MESH_FORWARD_BUFFERS && forward == NULL; idx++)
+    {
+        if (!forwards[idx].busy && forwards[idx].entry != NULL)
+        {
+            forward = &forwards[idx];
+            forward->busy = true;
+        }
+    }
+    portEXIT_CRITICAL(&mesh_lock);
+    return forward;
+}
+
+static void mesh_forward(ieee802154_rx_entry_t **entry, const ieee802154_frame_t *parsed, uint8_t *mesh_header)
+{
+    ieee802154_rx_entry_t *received = *entry;
+    uint16_t dst = mesh_header[MESH_DST_OFFSET] | (mesh_header[MESH_DST_OFFSET + 1] << 8);
+    if (mesh_header[MESH_HOPS_OFFSET] <= 1)
+    {
+        portENTER_CRITICAL(&mesh_lock);
+        stats.hop_limit += 1;
+        portEXIT_CRITICAL(&mesh_lock);
+        return;
+    }
+
+    ieee802154_address_t next_hop;
+    ieee802154_addr_id_t next_hop_id = mesh_next_hop(dst, (uint32_t)(received->timestamp_us / 1000), &next_hop);
+    if (next_hop_id == IEEE802154_ADDR_ID_NONE)
+    {
+        portENTER_CRITICAL(&mesh_lock);
+        stats.no_route += 1;
+        portEXIT_CRITICAL(&mesh_lock);
+        return;
+    }
+
+    mesh_forward_t *forward = mesh_take_forward();
+    if (forward == NULL)
+    {
+        portENTER_CRITICAL(&mesh_lock);
+        stats.queue_full += 1;
+        portEXIT_CRITICAL(&mesh_lock);
+        return;
+    }
+
+    mesh_header[MESH_HOPS_OFFSET] -= 1;
+    uint8_t seq_nr;
+    bool moved;
+    uint8_t *frame = mesh_rewrite(received->frame, parsed, &next_hop, &seq_nr, &moved);
+    if (frame == NULL)
+    {
+        portENTER_CRITICAL(&mesh_lock);
+        forward->busy = false;
+        stats.too_long += 1;
+        portEXIT_CRITICAL(&mesh_lock);
+        return;
+    }
+
+    // The frame is sent from the receive buffer, the receiver continues with the spare entry of the slot
+    forward->next_hop = next_hop_id;
+    forward->start_us = (uint32_t)received->timestamp_us;
+    *entry = forward->entry;
+    forward->entry = received;
+    esp_err_t err = esp_ieee802154_tx_engine_submit_ref(frame, true, mesh_transmit_done, forward, 0);
+
+    portENTER_CRITICAL(&mesh_lock);
+    stats.moved += moved ? 1 : 0;
+    if (err == ESP_OK)
+    {
+        mesh_count_forward(received->timestamp_us);
+    }
+    else
+    {
+        forward->entry = *entry;
+        *entry = received;
+        forward->busy = false;
+        stats.queue_full += 1;
+    }
+    portEXIT_CRITICAL(&mesh_lock);
+}
+
+bool esp_ieee802154_mesh_input(ieee802154_rx_entry_t **entry)
+{
+    uint8_t *frame = (*entry)->frame;
+    int64_t timestamp = (*entry)->timestamp_us;
+    ieee802154_frame_t parsed;
+    if (frame[0] < 3 || frame[0] > IEEE802154_MAX_PSDU_LENGTH || !esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) ||
+        parsed.frame_type != FRAME_TYPE_DATA || parsed.secure || parsed.information_elements_present)
+    {
+        return false;
+    }
+
+    uint8_t *mesh_header = &frame[1 + parsed.header_length];
+    if (parsed.payload_length < IEEE802154_MESH_HEADER_LENGTH || mesh_header[0] != IEEE802154_MESH_DISPATCH)
+    {
+        return false;
+    }
+
+    // Every mesh frame refreshes the link to its sender and the route back to its originator
+    uint16_t originator = mesh_header[MESH_ORIGINATOR_OFFSET] | (mesh_header[MESH_ORIGINATOR_OFFSET + 1] << 8);
+    uint8_t lqi = frame[frame[0]]; // The radio stores rssi/lqi in place of the FCS
+    uint32_t now_ms = (uint32_t)(timestamp / 1000);
+    uint16_t own_address = esp_ieee802154_get_short_address();
+    ieee802154_addr_id_t src_id = esp_ieee802154_addr_book_intern(parsed.src_pan_id, &parsed.src_addr);
+
+    portENTER_CRITICAL(&mesh_lock);
+    uint8_t neighbor = (src_id != IEEE802154_ADDR_ID_NONE) ? mesh_add_neighbor(src_id, lqi, now_ms) : MESH_NO_NEIGHBOR;
+    if (neighbor != MESH_NO_NEIGHBOR)
+    {
+        mesh_update_neighbor(&neighbors[neighbor], lqi, now_ms);
+        if (originator != own_address)
+        {
+            mesh_learn_route(originator, neighbor, now_ms);
+        }
+    }
+    portEXIT_CRITICAL(&mesh_lock);
+
+    uint16_t dst = mesh_header[MESH_DST_OFFSET] | (mesh_header[MESH_DST_OFFSET + 1] << 8);
+    if (dst != own_address)
+    {
+        mesh_forward(entry, &parsed, mesh_header);
+        return true;
+    }
+
+    portENTER_CRITICAL(&mesh_lock);
+    stats.delivered += 1;
+    portEXIT_CRITICAL(&mesh_lock);
+    if (deliver_cb != NULL)
+    {
+        deliver_cb(originator, &mesh_header[IEEE802154_MESH_HEADER_LENGTH], parsed.payload_length - IEEE802154_MESH_HEADER_LENGTH,
+                   CONFIG_IEEE802154_UTIL_MESH_MAX_HOPS - mesh_header[MESH_HOPS_OFFSET] + 1, deliver_arg);
+    }
+    return true;
+}
+
+esp_err_t esp_ieee802154_mesh_send(uint16_t dst, const uint8_t *data, uint8_t length)
+{
+    if (length > IEEE802154_MESH_MAX_PAYLOAD)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint16_t own_address = esp_ieee802154_get_short_address();
+    if (own_address >= 0xFFFE)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ieee802154_address_t next_hop;
+    ieee802154_addr_id_t next_hop_id = mesh_next_hop(dst, mesh_now_ms(), &next_hop);
+    if (next_hop_id == IEEE802154_ADDR_ID_NONE)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t frame[128];
+    uint8_t seq_nr;
+    uint8_t header_length = mesh_create_header(FRAME_VERSION_STD_2015, &next_hop, &seq_nr, &frame[1]);
+    uint8_t *mesh_header = &frame[1 + header_length];
+    mesh_header[0] = IEEE802154_MESH_DISPATCH;
+    mesh_header[MESH_HOPS_OFFSET] = CONFIG_IEEE802154_UTIL_MESH_MAX_HOPS;
+    mesh_header[MESH_DST_OFFSET] = dst & 0xFF;
+    mesh_header[MESH_DST_OFFSET + 1] = dst >> 8;
+    mesh_header[MESH_ORIGINATOR_OFFSET] = own_address & 0xFF;
+    mesh_header[MESH_ORIGINATOR_OFFSET + 1] = own_address >> 8;
+    memcpy(&mesh_header[IEEE802154_MESH_HEADER_LENGTH], data, length);
+    frame[0] = header_length + IEEE802154_MESH_HEADER_LENGTH + length + 2; // FCS included
+
+    esp_err_t err = esp_ieee802154_tx_engine_submit(frame, true, mesh_originate_done, (void *)(uintptr_t)next_hop_id, 0);
+    if (err == ESP_OK)
+    {
+        portENTER_CRITICAL(&mesh_lock);
+        stats.originated += 1;
+        portEXIT_CRITICAL(&mesh_lock);
+    }
+    return err;
+}
+
+void esp_ieee802154_mesh_start(ieee802154_mesh_deliver_cb_t cb, void *arg)
+{
+    deliver_cb = cb;
+    deliver_arg = arg;
+    for (uint32_t idx = 0; idx < IEEE802154_MESH_FORWARD_BUFFERS; idx++)
+    {
+        if (forwards[idx].entry == NULL) // A second start keeps the entries swapped with the receiver
+        {
+            forwards[idx].entry = &forward_entries[idx];
+        }
+    }
+}
+
+void esp_ieee802154_mesh_get_stats(ieee802154_mesh_stats_t *out)
+{
+    portENTER_CRITICAL(&mesh_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&mesh_lock);
+}
+
+/* --- Console --- */
+
+static void mesh_print_routes(void)
+{
+    static mesh_route_t route_copy[IEEE802154_MESH_ROUTE_SLOTS];
+    static mesh_neighbor_t neighbor_copy[IEEE802154_MESH_MAX_NEIGHBORS];
+    uint32_t now_ms = mesh_now_ms();
+    char addr[IEEE802154_ADDRESS_TEXT_LENGTH];
+
+    portENTER_CRITICAL(&mesh_lock);
+    memcpy(route_copy, routes, sizeof(routes));
+    memcpy(neighbor_copy, neighbors, sizeof(neighbors));
+    uint8_t count = neighbor_count;
+    portEXIT_CRITICAL(&mesh_lock);
+
+    printf("Neighbors: address, link quality, last heard\n");
+    for (uint8_t idx = 0; idx < count; idx++)
+    {
+        esp_ieee802154_addr_book_format(neighbor_copy[idx].id, addr, sizeof(addr));
+        printf("  %-16s %3u  %" PRIu32 " ms ago\n", addr, mesh_link_quality(&neighbor_copy[idx], now_ms),
+               now_ms - neighbor_copy[idx].last_heard_ms);
+    }
+
+    printf("Routes: destination, next hop\n");
+    for (uint32_t idx = 0; idx < IEEE802154_MESH_ROUTE_SLOTS; idx++)
+    {
+        if (route_copy[idx].state == SLOT_USED)
+        {
+            esp_ieee802154_addr_book_format(neighbor_copy[route_copy[idx].neighbor].id, addr, sizeof(addr));
+            printf("  0x%04x -> %s%s\n", route_copy[idx].dst, addr, route_copy[idx].fixed ? " (fixed)" : "");
+        }
+    }
+}
+
+static void mesh_print_stats(void)
+{
+    ieee802154_mesh_stats_t copy;
+    esp_ieee802154_mesh_get_stats(&copy);
+
+    printf("Originated %" PRIu32 ", delivered %" PRIu32 ", forwarded %" PRIu32 " (%" PRIu32 " sent, %" PRIu32 " failed, %" PRIu32 " moved)\n",
+           copy.originated, copy.delivered, copy.forwarded, copy.forward_sent, copy.forward_failed, copy.moved);
+    printf("Dropped: %" PRIu32 " without route, %" PRIu32 " hop limit, %" PRIu32 " TX queue full, %" PRIu32 " too long\n",
+           copy.no_route, copy.hop_limit, copy.queue_full, copy.too_long);
+    if (copy.forward_sent > 0)
+    {
+        printf("Per-hop latency: min %" PRIu32 " us, avg %" PRIu32 " us, max %" PRIu32 " us\n", copy.latency_min_us,
+               (uint32_t)(copy.latency_sum_us / copy.forward_sent), copy.latency_max_us);
+    }
+    printf("Peak forwarding rate: %" PRIu32 " frames/s\n", copy.peak_rate);
+}
+
+static int mesh_command(int argc, char **argv)
+{
+    ieee802154_address_t next_hop;
+    esp_err_t err = ESP_OK;
+
+    if (argc == 2 && strcmp(argv[1], "routes") == 0)
+    {
+        mesh_print_routes();
+    }
+    else if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        mesh_print_stats();
+    }
+    else if (argc == 3 && strcmp(argv[1], "del") == 0)
+    {
+        err = esp_ieee802154_mesh_route_remove(strtoul(argv[2], NULL, 0));
+    }
+    else if (argc == 4 && strcmp(argv[1], "route") == 0 && esp_ieee802154_parse_address(argv[3], &next_hop))
+    {
+        err = esp_ieee802154_mesh_route_add(strtoul(argv[2], NULL, 0), &next_hop);
+    }
+    else if (argc == 4 && strcmp(argv[1], "send") == 0)
+    {
+        err = esp_ieee802154_mesh_send(strtoul(argv[2], NULL, 0), (const uint8_t *)argv[3], strnlen(argv[3], IEEE802154_MESH_MAX_PAYLOAD + 1));
+    }
+    else
+    {
+        printf("Usage: mesh route <dst> <next hop> | del <dst> | routes | send <dst> <text> | stats\n");
+        return 1;
+    }
+
+    if (err != ESP_OK)
+    {
+        printf("Failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_mesh_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "mesh",
+        .help = "Multi-hop forwarding: routing table, sending and statistics",
+        .hint = "route <dst> <next hop> | del <dst> | routes | send <dst> <text> | stats",
+        .func = &mesh_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "esp_log.h"
+#include "ieee802154_metrics.h"
+
+#define TAG "ieee802154_metrics"
+
+#define METRICS_LINE_LENGTH 384
+
+#define IEEE802154_METRIC_NAME(id, name, description) name,
+#define IEEE802154_METRIC_DESCRIPTION(id, name, description) description,
+
+uint32_t ieee802154_metrics[IEEE802154_METRIC_COUNT];
+
+static const char *metric_names[IEEE802154_METRIC_COUNT] = {
+    IEEE802154_METRICS_COUNTERS(IEEE802154_METRIC_NAME)
+    IEEE802154_METRICS_GAUGES(IEEE802154_METRIC_NAME)
+};
+
+static const char *metric_descriptions[IEEE802154_METRIC_COUNT] = {
+    IEEE802154_METRICS_COUNTERS(IEEE802154_METRIC_DESCRIPTION)
+    IEEE802154_METRICS_GAUGES(IEEE802154_METRIC_DESCRIPTION)
+};
+
+uint32_t esp_ieee802154_metrics_get(ieee802154_metric_t id)
+{
+    return __atomic_load_n(&ieee802154_metrics[id], __ATOMIC_RELAXED);
+}
+
+const char *esp_ieee802154_metrics_name(ieee802154_metric_t id)
+{
+    return metric_names[id];
+}
+
+void esp_ieee802154_metrics_reset(void)
+{
+    for (uint8_t id = 0; id < IEEE802154_METRIC_COUNT; id++)
+    {
+        if (id != IEEE802154_METRIC_TX_QUEUE)
+        {
+            __atomic_store_n(&ieee802154_metrics[id], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+void esp_ieee802154_metrics_dump(void)
+{
+    char line[METRICS_LINE_LENGTH];
+    int length = 0;
+
+    for (uint8_t id = 0; id < IEEE802154_METRIC_COUNT && length < sizeof(line); id++)
+    {
+        length += snprintf(&line[length], sizeof(line) - length, "%s%s=%" PRIu32, (id > 0) ? " " : "", metric_names[id],
+                           esp_ieee802154_metrics_get(id));
+    }
+    ESP_LOGI(TAG, "%s", line);
+}
+
+/* --- Console --- */
+
+static int metrics_command(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0)
+    {
+        esp_ieee802154_metrics_reset();
+        printf("Metrics reset\n");
+        return 0;
+    }
+    if (argc > 1)
+    {
+        printf("Usage: metrics [reset]\n");
+        return 1;
+    }
+
+    for (uint8_t id = 0; id < IEEE802154_METRIC_COUNT; id++)
+    {
+        printf("%-10s %10" PRIu32 "  %s\n", metric_names[id], esp_ieee802154_metrics_get(id), metric_descriptions[id]);
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_metrics_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "metrics",
+        .help = "Print the radio metrics, 'metrics reset' resets them",
+        .hint = "[reset]",
+        .func = &metrics_command,
+    };
+    return esp_console_cmd_register(&command);
+}
+
+/* --- Periodic dump --- */
+
+static void metrics_dump_task(void *pvParameters)
+{
+    uint32_t interval_s = (uint32_t)(uintptr_t)pvParameters;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, interval_s * 1000 / portTICK_PERIOD_MS);
+        esp_ieee802154_metrics_dump();
+    }
+}
+
+esp_err_t esp_ieee802154_metrics_start_dump(uint32_t interval_s)
+{
+    if (xTaskCreate(metrics_dump_task, "metrics_dump_task", 3072, (void *)(uintptr_t)interval_s, 3, NULL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdbool.h>
+
+#include "ieee802154_util.h"
+
+/* --- Frame parser (no driver dependencies) --- */
+
+static uint8_t parse_address(const uint8_t *psdu, uint8_t position, uint8_t mode, ieee802154_address_t *addr)
+{
+    addr->mode = mode;
+
+    if (mode == ADDR_MODE_SHORT)
+    {
+        addr->short_address = psdu[position] | (psdu[position + 1] << 8);
+        return 2;
+    }
+    else if (mode == ADDR_MODE_LONG)
+    {
+        addr->long_address = esp_ieee802154_ext_address_read(&psdu[position]);
+        return 8;
+    }
+    return 0;
+}
+
+bool esp_ieee802154_parse_frame(const uint8_t *psdu, uint8_t psdu_length, ieee802154_frame_t *frame)
+{
+    memset(frame, 0, sizeof(ieee802154_frame_t));
+
+    // Smallest valid frame is an Imm-ACK: FCF, sequence number and FCS
+    if (psdu_length < 2 + 2)
+    {
+        return false;
+    }
+
+    uint16_t fcf = psdu[0] | (psdu[1] << 8);
+    frame->frame_type = fcf & 0x7;
+    frame->secure = (fcf >> 3) & 0x1;
+    frame->frame_pending = (fcf >> 4) & 0x1;
+    frame->ack_request = (fcf >> 5) & 0x1;
+    frame->pan_id_compression = (fcf >> 6) & 0x1;
+    frame->sequence_number_suppression = (fcf >> 8) & 0x1;
+    frame->information_elements_present = (fcf >> 9) & 0x1;
+    frame->dst_addr.mode = (fcf >> 10) & 0x3;
+    frame->frame_version = (fcf >> 12) & 0x3;
+    frame->src_addr.mode = (fcf >> 14) & 0x3;
+
+    // The sequence number can only be suppressed in 2015 frames
+    if (frame->frame_version == FRAME_VERSION_STD_2015 && frame->sequence_number_suppression)
+    {
+        frame->sequence_number_present = false;
+    }
+    else
+    {
+        frame->sequence_number_present = true;
+    }
+
+    /**
+     * Upper bound of the header: FCF, sequence number, two pan ids and two long addresses.
+     * The header is parsed into a local buffer, so short (malformed) frames can not be read out of bounds.
+     */
+    uint8_t header[2 + 1 + 2 + 8 + 2 + 8] = {0};
+    uint8_t available = psdu_length - 2 < (int)sizeof(header) ? psdu_length - 2 : (int)sizeof(header);
+    memcpy(header, psdu, available);
+
+    uint8_t position = 2;
+    if (frame->sequence_number_present)
+    {
+        frame->sequence_number = header[position];
+        position += 1;
+    }
+
+    bool dst_present = frame->dst_addr.mode == ADDR_MODE_SHORT || frame->dst_addr.mode == ADDR_MODE_LONG;
+    bool src_present = frame->src_addr.mode == ADDR_MODE_SHORT || frame->src_addr.mode == ADDR_MODE_LONG;
+
+    if (dst_present)
+    {
+        frame->dst_pan_id = header[position] | (header[position + 1] << 8);
+        position += 2;
+        position += parse_address(header, position, frame->dst_addr.mode, &frame->dst_addr);
+    }
+
+    if (src_present)
+    {
+        if (dst_present && frame->pan_id_compression)
+        {
+            frame->src_pan_id = frame->dst_pan_id; // intra PAN
+        }
+        else
+        {
+            frame->src_pan_id = header[position] | (header[position + 1] << 8);
+            position += 2;
+        }
+        position += parse_address(header, position, frame->src_addr.mode, &frame->src_addr);
+    }
+
+    frame->header_length = position;
+    if (position > psdu_length - 2)
+    {
+        return false; // The header does not fit into the frame
+    }
+    frame->payload_length = psdu_length - 2 - position;
+
+    return !frame->secure && !frame->information_elements_present;
+}
+
+bool esp_ieee802154_address_equal(const ieee802154_address_t *a, const ieee802154_address_t *b)
+{
+    if (a->mode != b->mode)
+    {
+        return false;
+    }
+    if (a->mode == ADDR_MODE_SHORT)
+    {
+        return a->short_address == b->short_address;
+    }
+    if (a->mode == ADDR_MODE_LONG)
+    {
+        return a->long_address == b->long_address;
+    }
+    return true;
+}
+
+bool esp_ieee802154_parse_address(const char *str, ieee802154_address_t *addr)
+{
+    char *end;
+    if (strlen(str) == 16)
+    {
+        addr->mode = ADDR_MODE_LONG;
+        addr->long_address = strtoull(str, &end, 16);
+        return isxdigit((unsigned char)*str) && *end == '\0';
+    }
+
+    unsigned long value = strtoul(str, &end, 0);
+    addr->mode = ADDR_MODE_SHORT;
+    addr->short_address = value;
+    return *str != '\0' && *end == '\0' && value < 0xFFFF;
+}
+
+int esp_ieee802154_format_address(char *buffer, size_t size, const ieee802154_address_t *addr)
+{
+    switch (addr->mode)
+    {
+    case ADDR_MODE_SHORT:
+        return snprintf(buffer, size, "0x%04x", addr->short_address);
+    case ADDR_MODE_LONG:
+        return snprintf(buffer, size, "%016" PRIx64, addr->long_address);
+    default:
+        return snprintf(buffer, size, "none");
+    }
+}
+
+void esp_ieee802154_address_offset(const ieee802154_address_t *base, uint16_t offset, ieee802154_address_t *addr)
+{
+    *addr = *base;
+    if (base->mode == ADDR_MODE_SHORT)
+    {
+        addr->short_address = base->short_address + offset;
+    }
+    else if (base->mode == ADDR_MODE_LONG)
+    {
+        uint16_t low = (base->long_address & 0xFFFF) + offset;
+        addr->long_address = (base->long_address & ~0xFFFFULL) | low;
+    }
+}
@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_power.h"
+
+#define TAG "ieee802154_power"
+
+typedef struct {
+    ieee802154_addr_id_t id;
+    ieee802154_power_state_t state;
+} power_destination_t;
+
+static power_destination_t destinations[IEEE802154_POWER_MAX_DESTINATIONS];
+static uint8_t destination_count = 0;
+static uint8_t destination_index[IEEE802154_ADDR_BOOK_MAX]; // Index + 1 in destinations by address book id, 0 if none
+static portMUX_TYPE power_lock = portMUX_INITIALIZER_UNLOCKED; // Protects the destinations
+
+/* --- Power control --- */
+
+static int8_t power_clamp(int power)
+{
+    if (power < IEEE802154_POWER_MIN_DBM)
+    {
+        return IEEE802154_POWER_MIN_DBM;
+    }
+    if (power > IEEE802154_POWER_MAX_DBM)
+    {
+        return IEEE802154_POWER_MAX_DBM;
+    }
+    return (int8_t)power;
+}
+
+static ieee802154_power_state_t *power_find(ieee802154_addr_id_t id)
+{
+    if (destination_index[id] > 0)
+    {
+        return &destinations[destination_index[id] - 1].state;
+    }
+    if (destination_count >= IEEE802154_POWER_MAX_DESTINATIONS)
+    {
+        return NULL;
+    }
+
+    power_destination_t *destination = &destinations[destination_count];
+    memset(destination, 0, sizeof(power_destination_t));
+    destination->id = id;
+    destination->state.power_dbm = power_clamp(IEEE802154_POWER_NOMINAL_DBM);
+    destination_count += 1;
+    destination_index[id] = destination_count;
+    return &destination->state;
+}
+
+int8_t esp_ieee802154_power_select(ieee802154_addr_id_t dst)
+{
+    if (!IEEE802154_POWER_CONTROL_ENABLED || dst == IEEE802154_ADDR_ID_NONE)
+    {
+        return IEEE802154_POWER_NOMINAL_DBM;
+    }
+
+    int8_t power = IEEE802154_POWER_NOMINAL_DBM;
+    portENTER_CRITICAL(&power_lock);
+    if (destination_index[dst] > 0)
+    {
+        power = destinations[destination_index[dst] - 1].state.power_dbm;
+    }
+    portEXIT_CRITICAL(&power_lock);
+    return power;
+}
+
+void esp_ieee802154_power_update(ieee802154_addr_id_t dst, const ieee802154_tx_result_t *result)
+{
+    if (!IEEE802154_POWER_CONTROL_ENABLED || dst == IEEE802154_ADDR_ID_NONE)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&power_lock);
+    ieee802154_power_state_t *state = power_find(dst);
+    if (state == NULL)
+    {
+        portEXIT_CRITICAL(&power_lock);
+        return;
+    }
+
+    state->frames += 1;
+    int power = state->power_dbm;
+    if (result->acked)
+    {
+        state->acks += 1;
+        state->no_ack_streak = 0;
+        state->last_rssi = result->ack_rssi;
+        state->last_lqi = result->ack_lqi;
+
+        // Moving average with weight 1/4 in quarter dB, the first ACK sets the estimate
+        int16_t sample_q = (int16_t)((IEEE802154_POWER_NOMINAL_DBM - result->ack_rssi) * 4);
+        if (state->acks == 1)
+        {
+            state->path_loss_q = sample_q;
+        }
+        else
+        {
+            state->path_loss_q += (sample_q - state->path_loss_q) / 4;
+        }
+
+        int path_loss = (state->path_loss_q + 2) / 4;
+        int desired = IEEE802154_POWER_SENSITIVITY_DBM + IEEE802154_POWER_TARGET_MARGIN_DB + path_loss;
+        if (result->ack_lqi < IEEE802154_POWER_LOW_LQI)
+        {
+            desired += IEEE802154_POWER_STEP_DB;
+        }
+
+        if (desired > power)
+        {
+            power = desired;
+        }
+        else if (desired <= power - IEEE802154_POWER_HYSTERESIS_DB)
+        {
+            power = (power - IEEE802154_POWER_STEP_DB > desired) ? power - IEEE802154_POWER_STEP_DB : desired;
+        }
+    }
+    else if (result->error == ESP_IEEE802154_TX_ERR_NO_ACK)
+    {
+        state->no_acks += 1;
+        if (state->no_ack_streak < UINT8_MAX)
+        {
+            state->no_ack_streak += 1;
+        }
+        power += IEEE802154_POWER_STEP_DB * state->no_ack_streak;
+    }
+
+    int8_t next = power_clamp(power);
+    if (next > state->power_dbm)
+    {
+        state->raised += 1;
+    }
+    else if (next < state->power_dbm)
+    {
+        state->lowered += 1;
+    }
+    state->power_dbm = next;
+    if (state->acks > 0)
+    {
+        state->margin_db = (int8_t)(next - (state->path_loss_q + 2) / 4 - IEEE802154_POWER_SENSITIVITY_DBM);
+    }
+    portEXIT_CRITICAL(&power_lock);
+}
+
+bool esp_ieee802154_power_get(ieee802154_addr_id_t id, ieee802154_power_state_t *state)
+{
+    if (id >= IEEE802154_ADDR_BOOK_MAX)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&power_lock);
+    bool found = (destination_index[id] > 0);
+    if (found)
+    {
+        *state = destinations[destination_index[id] - 1].state;
+    }
+    portEXIT_CRITICAL(&power_lock);
+    return found;
+}
+
+void esp_ieee802154_power_reset(void)
+{
+    portENTER_CRITICAL(&power_lock);
+    memset(destination_index, 0, sizeof(destination_index));
+    destination_count = 0;
+    portEXIT_CRITICAL(&power_lock);
+}
+
+/* --- Console --- */
+
+static void power_print(void)
+{
+    char addr[IEEE802154_ADDRESS_TEXT_LENGTH];
+    ieee802154_power_state_t state;
+
+    if (!IEEE802154_POWER_CONTROL_ENABLED)
+    {
+        printf("Power control disabled, all frames are sent with %d dBm\n", IEEE802154_POWER_NOMINAL_DBM);
+        return;
+    }
+
+    portENTER_CRITICAL(&power_lock);
+    uint8_t count = destination_count;
+    portEXIT_CRITICAL(&power_lock);
+
+    if (count == 0)
+    {
+        printf("No frames sent, all destinations use %d dBm\n", IEEE802154_POWER_NOMINAL_DBM);
+        return;
+    }
+
+    printf("%-24s %6s %6s %5s %5s %4s %8s %8s %8s %6s %6s\n",
+           "Destination", "Power", "Margin", "RSSI", "LQI", "Miss", "Frames", "ACKs", "No ACK", "Up", "Down");
+    for (uint8_t idx = 0; idx < count; idx++)
+    {
+        portENTER_CRITICAL(&power_lock);
+        ieee802154_addr_id_t id = destinations[idx].id;
+        state = destinations[idx].state;
+        portEXIT_CRITICAL(&power_lock);
+
+        esp_ieee802154_addr_book_format(id, addr, sizeof(addr));
+        printf("%-24s %6d %6d %5d %5u %4u %8" PRIu32 " %8" PRIu32 " %8" PRIu32 " %6" PRIu32 " %6" PRIu32 "\n",
+               addr, state.power_dbm, state.margin_db, state.last_rssi, state.last_lqi, state.no_ack_streak,
+               state.frames, state.acks, state.no_acks, state.raised, state.lowered);
+    }
+}
+
+static int power_command(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        power_print();
+    }
+    else if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        esp_ieee802154_power_reset();
+    }
+    else
+    {
+        printf("Usage: power [reset]\n");
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_power_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "power",
+        .help = "TX power per destination, adapted to the RSSI and LQI of the ACKs",
+        .hint = "[reset]",
+        .func = &power_command,
+    };
+    return esp_console_cmd_register(&command);
+}
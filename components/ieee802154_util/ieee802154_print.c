@@ -0,0 +1,526 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#endif
+#include "ieee802154_util.h"
+
+#if IEEE802154_PRINT_ENABLED
+
+#define TAG "ieee802154_util" // The printer output keeps the tag it had in ieee802154_util.c
+
+#ifndef LOG_COLOR_I
+#define LOG_COLOR_E ""
+#define LOG_COLOR_W ""
+#define LOG_COLOR_I ""
+#define LOG_RESET_COLOR ""
+#endif
+
+/**
+ * The frame is rendered into one text buffer in the ESP_LOGx line format, and written with a single log
+ * call. Numbers are converted by hand (hex with a lookup table), so no printf runs per field or per byte.
+ */
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t length;
+    uint32_t timestamp;
+} render_t;
+
+static const char hex_digits[] = "0123456789abcdef";
+
+/* --- Render helpers --- */
+
+static inline void put_char(render_t *r, char c)
+{
+    if (r->length + 1 < r->size)
+    {
+        r->buffer[r->length++] = c;
+    }
+}
+
+static void put_str(render_t *r, const char *str)
+{
+    size_t length = strlen(str);
+    if (r->length + length >= r->size)
+    {
+        length = r->size - r->length - 1;
+    }
+    memcpy(&r->buffer[r->length], str, length);
+    r->length += length;
+}
+
+static inline void put_hex8(render_t *r, uint8_t value)
+{
+    put_char(r, hex_digits[value >> 4]);
+    put_char(r, hex_digits[value & 0x0F]);
+}
+
+static void put_uint(render_t *r, uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0)
+    {
+        put_char(r, digits[--count]);
+    }
+}
+
+static void put_int(render_t *r, int32_t value)
+{
+    if (value < 0)
+    {
+        put_char(r, '-');
+        put_uint(r, -(uint32_t)value);
+        return;
+    }
+    put_uint(r, value);
+}
+
+/* Start a line like ESP_LOGx: "<color>L (<timestamp>) <tag>: " */
+static void line_begin(render_t *r, const char *color, char level)
+{
+    put_str(r, color);
+    put_char(r, level);
+    put_str(r, " (");
+    put_uint(r, r->timestamp);
+    put_str(r, ") " TAG ": ");
+}
+
+static void line_end(render_t *r)
+{
+    put_str(r, LOG_RESET_COLOR "\n");
+}
+
+static void line_info(render_t *r, const char *text)
+{
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, text);
+    line_end(r);
+}
+
+static void line_bool(render_t *r, const char *label, bool value)
+{
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, label);
+    put_str(r, value ? "True" : "False");
+    line_end(r);
+}
+
+/* "xx:yy", most significant byte first */
+static void put_hex16(render_t *r, uint16_t value)
+{
+    put_hex8(r, value >> 8);
+    put_char(r, ':');
+    put_hex8(r, value & 0x00FF);
+}
+
+static void put_long_address(render_t *r, uint64_t addr)
+{
+    for (int8_t shift = 56; shift >= 0; shift -= 8)
+    {
+        put_hex8(r, (addr >> shift) & 0xFF);
+        if (shift > 0)
+        {
+            put_char(r, ':');
+        }
+    }
+}
+
+/* --- Printer --- */
+
+static char *frame_version_to_string(uint8_t frame_version)
+{
+    switch (frame_version)
+    {
+    case FRAME_VERSION_STD_2003:
+        return "2003";
+    case FRAME_VERSION_STD_2006:
+        return "2006";
+    case FRAME_VERSION_STD_2015:
+        return "2015";
+    default:
+        return "Invalid";
+    }
+}
+
+static char *addr_mode_to_string(uint8_t addr_mode)
+{
+    switch (addr_mode)
+    {
+    case ADDR_MODE_NONE:
+        return "None";
+    case ADDR_MODE_RESERVED:
+        return "Reserved";
+    case ADDR_MODE_SHORT:
+        return "Short";
+    case ADDR_MODE_LONG:
+        return "Long";
+    default:
+        return "Invalid"; // Should never happen
+    }
+}
+
+static char *frame_type_to_string(ieee802154_fcf_t *fcf)
+{
+    switch (fcf->frame_type)
+    {
+    case FRAME_TYPE_BEACON:
+        return "Beacon";
+    case FRAME_TYPE_DATA:
+        return "Data";
+    case FRAME_TYPE_ACK:
+        if (fcf->frame_ver == FRAME_VERSION_STD_2015)
+        {
+            return "Enh-ACK";
+        }
+        return "Imm-ACK";
+    case FRAME_TYPE_MAC_COMMAND:
+        return "MAC CMD";
+    case FRAME_TYPE_RESERVED:
+        return "Reserved";
+    case FRAME_TYPE_MULTIPURPOSE:
+        return "Multipurpose (2015)";
+    case FRAME_TYPE_FRAGMENT:
+        return "Fragment (2015)";
+    case FRAME_TYPE_EXTENDED:
+        return "Extended (2015)";
+    default:
+        return "Invalid"; // Should never happen
+    }
+}
+
+#define BYTES_PER_LINE 12
+
+static void render_data_hexdump(render_t *r, const uint8_t *buffer, uint8_t buff_len)
+{
+    uint8_t offset = 0;
+
+    while (offset < buff_len)
+    {
+        uint8_t bytes_read = buff_len - offset < BYTES_PER_LINE ? buff_len - offset : BYTES_PER_LINE;
+
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, (offset == 0) ? "Data dump: " : "           ");
+        for (uint8_t i = 0; i < BYTES_PER_LINE; i++)
+        {
+            if (i < bytes_read)
+            {
+                put_hex8(r, buffer[offset + i]);
+                put_char(r, ' ');
+            }
+            else
+            {
+                put_str(r, "   ");
+            }
+        }
+        put_char(r, '|');
+        for (uint8_t i = 0; i < bytes_read; i++)
+        {
+            uint8_t c = buffer[offset + i];
+            put_char(r, (c >= 32 && c <= 126) ? c : '.');
+        }
+        put_char(r, '|');
+        line_end(r);
+
+        offset += bytes_read;
+    }
+}
+
+static void render_address_information(render_t *r, const uint8_t *packet, uint8_t *position)
+{
+    ieee802154_fcf_t *fcf = (ieee802154_fcf_t *)&packet[1];
+    uint16_t dst_pan_id = 0;
+
+    if (fcf->dst_addr_mode == ADDR_MODE_SHORT || fcf->dst_addr_mode == ADDR_MODE_LONG)
+    {
+        dst_pan_id = packet[*position] | (packet[*position + 1] << 8);
+        *position += 2;
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, "DST PAN: ");
+        put_hex16(r, dst_pan_id);
+        line_end(r);
+    }
+
+    switch (fcf->dst_addr_mode)
+    {
+    case ADDR_MODE_SHORT:
+    {
+        uint16_t short_dst_addr = packet[*position] | (packet[*position + 1] << 8);
+        *position += 2;
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, "DST ADDR: ");
+        put_hex16(r, short_dst_addr);
+        put_char(r, ' ');
+        if (short_dst_addr == 0xFFFF)
+        {
+            put_str(r, (dst_pan_id == 0xFFFF) ? "(global Broadcast)" : "(local Broadcast)");
+        }
+        line_end(r);
+        break;
+    }
+    case ADDR_MODE_LONG:
+    {
+        uint64_t addr = esp_ieee802154_ext_address_read(&packet[*position]);
+        *position += 8;
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, "DST ADDR: ");
+        put_long_address(r, addr);
+        line_end(r);
+        break;
+    }
+    default:
+    {
+        // Typically not possible, because of hardware filtering
+        line_begin(r, LOG_COLOR_W, 'W');
+        put_str(r, "No DST address information present");
+        line_end(r);
+        return;
+    }
+    }
+
+    if (fcf->dst_addr_mode == ADDR_MODE_SHORT || fcf->dst_addr_mode == ADDR_MODE_LONG)
+    {
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, "SRC PAN: ");
+        if (fcf->pan_id_compression)
+        {
+            // SRC PAN is the same as DST PAN -> intra PAN (same network)
+            put_hex16(r, dst_pan_id);
+            put_str(r, " (intra PAN)");
+        }
+        else
+        {
+            // SRC PAN is different from DST PAN -> inter PAN (across network)
+            put_hex16(r, packet[*position] | (packet[*position + 1] << 8));
+            *position += 2;
+            put_str(r, " (inter PAN)");
+        }
+        line_end(r);
+    }
+
+    switch (fcf->src_addr_mode)
+    {
+    case ADDR_MODE_SHORT:
+    {
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, "SRC ADDR: ");
+        put_hex16(r, packet[*position] | (packet[*position + 1] << 8));
+        line_end(r);
+        *position += 2;
+        break;
+    }
+    case ADDR_MODE_LONG:
+    {
+        uint64_t addr = esp_ieee802154_ext_address_read(&packet[*position]);
+        *position += 8;
+        line_begin(r, LOG_COLOR_I, 'I');
+        put_str(r, "SRC ADDR: ");
+        put_long_address(r, addr);
+        line_end(r);
+        break;
+    }
+    default:
+    {
+        line_begin(r, LOG_COLOR_W, 'W');
+        put_str(r, "No SRC address information present.");
+        line_end(r);
+        return;
+    }
+    }
+}
+
+static void render_sequence_number(render_t *r, const uint8_t *packet, uint8_t *position)
+{
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "Sequence number: ");
+    put_uint(r, packet[*position]);
+    line_end(r);
+    *position += 1;
+}
+
+static void render_data_length(render_t *r, uint8_t data_length)
+{
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "Data length: ");
+    put_uint(r, data_length);
+    line_end(r);
+}
+
+size_t esp_ieee802154_render_packet(const uint8_t *packet, uint32_t timestamp, char *buffer, size_t size)
+{
+    render_t render = {
+        .buffer = buffer,
+        .size = size,
+        .length = 0,
+        .timestamp = timestamp,
+    };
+    render_t *r = &render;
+
+    uint8_t packet_length = packet[0];
+    uint8_t position = 1; // Exclude the length
+
+    ieee802154_fcf_t *fcf = (ieee802154_fcf_t *)&packet[position];
+    position += 2;
+
+    line_info(r, "---------------------------------------------------------------------");
+
+    line_info(r, "------ Frame Control Field ------");
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "Frame type:                   ");
+    put_str(r, frame_type_to_string(fcf));
+    line_end(r);
+    line_bool(r, "Security Enabled:             ", fcf->secure);
+    line_bool(r, "Frame pending:                ", fcf->frame_pending);
+    line_bool(r, "Acknowledge request:          ", fcf->ack_request);
+    line_bool(r, "PAN ID Compression:           ", fcf->pan_id_compression);
+    line_bool(r, "Reserved:                     ", fcf->reserved);
+    if (fcf->frame_ver == FRAME_VERSION_STD_2015)
+    {
+        line_bool(r, "Sequence Number Suppression:  ", fcf->sequence_number_suppression);
+        line_bool(r, "Information Elements Present: ", fcf->information_elements_present);
+    }
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "Destination addressing mode:  ");
+    put_str(r, addr_mode_to_string(fcf->dst_addr_mode));
+    line_end(r);
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "Frame version:                ");
+    put_str(r, frame_version_to_string(fcf->frame_ver));
+    line_end(r);
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "Source addressing mode:       ");
+    put_str(r, addr_mode_to_string(fcf->src_addr_mode));
+    line_end(r);
+
+    if (fcf->secure || fcf->information_elements_present)
+    {
+        line_begin(r, LOG_COLOR_E, 'E');
+        put_str(r, "Security and Information Elements are currently not supported.");
+        line_end(r);
+        line_info(r, "---------------------------------------------------------------------");
+        r->buffer[r->length] = '\0';
+        return r->length;
+    }
+
+    if (fcf->reserved)
+    {
+        line_begin(r, LOG_COLOR_W, 'W');
+        put_str(r, "Reserved bit is set...");
+        line_end(r);
+    }
+
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "------ ");
+    put_str(r, frame_type_to_string(fcf));
+    put_str(r, " Packet ------");
+    line_end(r);
+
+    switch (fcf->frame_type)
+    {
+    case FRAME_TYPE_DATA:
+    {
+        if (fcf->sequence_number_suppression && fcf->frame_ver == FRAME_VERSION_STD_2015)
+        {
+            line_info(r, "Sequence number suppressed.");
+        }
+        else // FRAME_VERSION_STD_2003/2006 or sequence_number_suppression == false
+        {
+            render_sequence_number(r, packet, &position);
+        }
+
+        render_address_information(r, packet, &position);
+
+        // The FCS is not stored in the receive buffer, the radio puts rssi/lqi in its place
+        const uint8_t *data = &packet[position];
+        uint8_t data_length = packet_length - (position - 1) - sizeof(uint16_t);
+        position += data_length;
+
+        render_data_length(r, data_length);
+        render_data_hexdump(r, data, data_length);
+        break;
+    }
+    case FRAME_TYPE_ACK:
+        if (fcf->frame_ver == FRAME_VERSION_STD_2015)
+        {
+            if (fcf->sequence_number_suppression)
+            {
+                line_info(r, "Sequence number suppressed.");
+            }
+            else
+            {
+                render_sequence_number(r, packet, &position);
+            }
+
+            render_address_information(r, packet, &position);
+
+            const uint8_t *data = &packet[position];
+            uint8_t data_length = packet_length - (position - 1) - sizeof(uint16_t);
+            position += data_length;
+
+            if (data_length > 0)
+            {
+                line_info(r, "ACK contains data.");
+                render_data_length(r, data_length);
+                render_data_hexdump(r, data, data_length);
+            }
+            else
+            {
+                line_info(r, "ACK contains no data.");
+            }
+        }
+        else
+        {
+            render_sequence_number(r, packet, &position);
+        }
+        break;
+    default:
+        line_begin(r, LOG_COLOR_W, 'W');
+        put_str(r, "Printing this packets is currently not supported.");
+        line_end(r);
+        break;
+    }
+
+    // Doesnt work if the type is not supported
+    line_info(r, "----- Transmission Info -----");
+
+    // The radio stores rssi/lqi in place of the FCS
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "RSSI: ");
+    put_int(r, (int8_t)packet[position]);
+    line_end(r);
+    line_begin(r, LOG_COLOR_I, 'I');
+    put_str(r, "LQI: ");
+    put_uint(r, packet[position + 1]);
+    line_end(r);
+
+    line_info(r, "---------------------------------------------------------------------");
+
+    r->buffer[r->length] = '\0';
+    return r->length;
+}
+
+void esp_ieee802154_print_packet(uint8_t *packet)
+{
+    static char buffer[IEEE802154_PRINT_BUFFER_SIZE];
+
+#ifdef ESP_PLATFORM
+    // One log write per frame, the log lock is taken once and the lines of a frame are not interleaved
+    esp_ieee802154_render_packet(packet, esp_log_timestamp(), buffer, sizeof(buffer));
+    esp_log_write(ESP_LOG_INFO, TAG, "%s", buffer);
+#else
+    esp_ieee802154_render_packet(packet, 0, buffer, sizeof(buffer));
+    fputs(buffer, stdout);
+#endif
+}
+
+#endif // IEEE802154_PRINT_ENABLED
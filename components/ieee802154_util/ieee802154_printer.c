@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/message_buffer.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_printer.h"
+#include "ieee802154_addr_book.h"
+
+#if IEEE802154_PRINT_ENABLED
+
+#define TAG "ieee802154_printer"
+
+#define PRINTER_BUFFER_SIZE  (8 * (128 + sizeof(size_t))) // Frames waiting to be printed
+#define PRINTER_FRAME_TYPES  8
+
+typedef struct {
+    ieee802154_addr_id_t id;    // IEEE802154_ADDR_ID_NONE for frames without (known) source
+    uint32_t frames;
+    uint32_t types[PRINTER_FRAME_TYPES];
+    int8_t rssi_min;
+    int8_t rssi_max;
+    int32_t rssi_sum;
+} printer_source_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t printed;
+    uint32_t dropped;           // Frames that should have been printed, but the print buffer was full
+    uint8_t source_count;
+    printer_source_t sources[IEEE802154_PRINTER_MAX_SOURCES + 1]; // The last one collects all further sources
+} printer_period_t;
+
+static const char *frame_type_names[PRINTER_FRAME_TYPES] = {
+    "beacon", "data", "ack", "cmd", "reserved", "multi", "frag", "ext"
+};
+
+static MessageBufferHandle_t printer_buffer = NULL;
+static portMUX_TYPE printer_lock = portMUX_INITIALIZER_UNLOCKED;
+static printer_period_t period;     // Protected by printer_lock
+static bool summarizing = false;    // Protected by printer_lock
+static uint32_t sample_counter = 0; // Protected by printer_lock
+static uint32_t printer_rate_limit;
+static uint32_t printer_sample_every;
+
+/* --- Accounting --- */
+
+static printer_source_t *printer_find_source(ieee802154_addr_id_t id)
+{
+    for (uint8_t idx = 0; idx < period.source_count; idx++)
+    {
+        if (period.sources[idx].id == id)
+        {
+            return &period.sources[idx];
+        }
+    }
+
+    printer_source_t *source = &period.sources[IEEE802154_PRINTER_MAX_SOURCES];
+    if (period.source_count < IEEE802154_PRINTER_MAX_SOURCES)
+    {
+        source = &period.sources[period.source_count];
+        period.source_count += 1;
+        source->id = id;
+    }
+    return source;
+}
+
+static void printer_account(printer_source_t *source, uint8_t frame_type, int8_t rssi)
+{
+    if (source->frames == 0 || rssi < source->rssi_min)
+    {
+        source->rssi_min = rssi;
+    }
+    if (source->frames == 0 || rssi > source->rssi_max)
+    {
+        source->rssi_max = rssi;
+    }
+    source->rssi_sum += rssi;
+    source->types[frame_type] += 1;
+    source->frames += 1;
+}
+
+void esp_ieee802154_printer_submit(const uint8_t *frame)
+{
+    if (printer_buffer == NULL || frame[0] < 3)
+    {
+        return;
+    }
+
+    /**
+     * Frames the parser rejects are counted without source. Only sources in the address book are listed, the
+     * RX path does not add entries (they are never removed), other sources are summarized as "other".
+     */
+    ieee802154_frame_t parsed;
+    ieee802154_addr_id_t src_id = IEEE802154_ADDR_ID_NONE;
+    bool unknown = false;
+    if (esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed))
+    {
+        src_id = esp_ieee802154_addr_book_find(parsed.src_pan_id, &parsed.src_addr);
+        unknown = (src_id == IEEE802154_ADDR_ID_NONE && parsed.src_addr.mode != ADDR_MODE_NONE);
+    }
+    uint8_t frame_type = frame[1] & 0x07;
+    int8_t rssi = (int8_t)frame[frame[0] - 1]; // The radio stores rssi/lqi in place of the FCS
+
+    portENTER_CRITICAL(&printer_lock);
+    printer_account(unknown ? &period.sources[IEEE802154_PRINTER_MAX_SOURCES] : printer_find_source(src_id), frame_type, rssi);
+    period.frames += 1;
+    if (period.frames > printer_rate_limit)
+    {
+        summarizing = true;
+    }
+
+    bool print = !summarizing;
+    if (summarizing && printer_sample_every > 0)
+    {
+        sample_counter += 1;
+        if (sample_counter >= printer_sample_every)
+        {
+            sample_counter = 0;
+            print = true;
+        }
+    }
+    portEXIT_CRITICAL(&printer_lock);
+
+    if (!print)
+    {
+        return;
+    }
+
+    bool queued = (xMessageBufferSend(printer_buffer, frame, frame[0] + 1, 0) > 0);
+    portENTER_CRITICAL(&printer_lock);
+    if (queued)
+    {
+        period.printed += 1;
+    }
+    else
+    {
+        period.dropped += 1;
+    }
+    portEXIT_CRITICAL(&printer_lock);
+}
+
+/* --- Print task --- */
+
+static void printer_print_source(const printer_source_t *source, bool other)
+{
+    char line[160];
+    int length = other ? snprintf(line, sizeof(line), "other") : esp_ieee802154_addr_book_format(source->id, line, sizeof(line));
+
+    length += snprintf(&line[length], sizeof(line) - length, ": %" PRIu32 " (", source->frames);
+    bool first = true;
+    for (uint8_t type = 0; type < PRINTER_FRAME_TYPES && length < sizeof(line); type++)
+    {
+        if (source->types[type] > 0)
+        {
+            length += snprintf(&line[length], sizeof(line) - length, "%s%s %" PRIu32, first ? "" : ", ",
+                               frame_type_names[type], source->types[type]);
+            first = false;
+        }
+    }
+    if (length < sizeof(line))
+    {
+        snprintf(&line[length], sizeof(line) - length, "), RSSI %d/%d/%d", source->rssi_min,
+                 (int)(source->rssi_sum / (int32_t)source->frames), source->rssi_max);
+    }
+    ESP_LOGI(TAG, "  %s", line);
+}
+
+static void printer_print_summary(const printer_period_t *summary)
+{
+    ESP_LOGI(TAG, "%" PRIu32 " frames/s, %" PRIu32 " printed, %" PRIu32 " not printed (buffer full); per source: frames (types), RSSI min/avg/max",
+             summary->frames, summary->printed, summary->dropped);
+    for (uint8_t idx = 0; idx < summary->source_count; idx++)
+    {
+        printer_print_source(&summary->sources[idx], false);
+    }
+    if (summary->sources[IEEE802154_PRINTER_MAX_SOURCES].frames > 0)
+    {
+        printer_print_source(&summary->sources[IEEE802154_PRINTER_MAX_SOURCES], true);
+    }
+}
+
+static void printer_task(void *pvParameters)
+{
+    static printer_period_t summary;
+    uint8_t frame[128];
+    TickType_t period_start = xTaskGetTickCount();
+
+    while (1)
+    {
+        TickType_t elapsed = xTaskGetTickCount() - period_start;
+        if (elapsed >= pdMS_TO_TICKS(1000))
+        {
+            // A summary covers every second in which the limit was reached
+            portENTER_CRITICAL(&printer_lock);
+            bool summarized = summarizing;
+            summary = period;
+            memset(&period, 0, sizeof(period));
+            summarizing = (summary.frames > printer_rate_limit);
+            portEXIT_CRITICAL(&printer_lock);
+
+            if (summarized)
+            {
+                printer_print_summary(&summary);
+            }
+
+            period_start += pdMS_TO_TICKS(1000);
+            if (elapsed >= pdMS_TO_TICKS(2000))
+            {
+                period_start = xTaskGetTickCount(); // Printing fell behind, start a new period now
+            }
+            continue;
+        }
+
+        if (xMessageBufferReceive(printer_buffer, frame, sizeof(frame), pdMS_TO_TICKS(1000) - elapsed) > 0)
+        {
+            esp_ieee802154_print_packet(frame);
+        }
+    }
+}
+
+esp_err_t esp_ieee802154_printer_start(uint32_t rate_limit, uint32_t sample_every, UBaseType_t priority)
+{
+    printer_rate_limit = rate_limit;
+    printer_sample_every = sample_every;
+
+    printer_buffer = xMessageBufferCreate(PRINTER_BUFFER_SIZE);
+    if (printer_buffer == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(printer_task, "printer_task", 4096, NULL, priority, NULL) != pdPASS)
+    {
+        vMessageBufferDelete(printer_buffer);
+        printer_buffer = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+#endif // IEEE802154_PRINT_ENABLED
@@ -0,0 +1,356 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_addr_table.h"
+#include "ieee802154_replay.h"
+
+#define TAG "ieee802154_replay"
+
+#define REPLAY_RECORD_HEADER    8   // Delta (4), length (1), rssi (1), lqi (1), flags (1)
+#define REPLAY_FLAG_ENH_ACK     0x01
+#define REPLAY_US_PER_BYTE      32
+#define REPLAY_PHY_OVERHEAD     6   // Preamble, SFD and PHR
+
+static uint8_t buffer[IEEE802154_REPLAY_BUFFER_SIZE];
+static uint32_t buffer_used = 0;
+static esp_timer_handle_t replay_timer = NULL;
+
+// Written by the timer callback only, read under the lock
+static ieee802154_replay_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// State of the running replay, only used by the timer callback after the start
+static uint32_t cursor = 0;
+static uint16_t replay_speed = 1;
+static uint16_t passes_left = 0;
+static int64_t due_us = 0;
+static int64_t first_us = 0;
+
+// Drops the receive path reports while a record is handed to the callbacks
+static volatile bool injecting = false;
+static volatile uint32_t inject_drops = 0;
+
+/* --- Injection --- */
+
+static uint32_t replay_airtime_us(uint8_t length)
+{
+    return (REPLAY_PHY_OVERHEAD + length + 2) * REPLAY_US_PER_BYTE; // Add the FCS
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_replay_count_drop(void)
+{
+    if (injecting)
+    {
+        inject_drops += 1;
+    }
+}
+
+/**
+ * Hands a record to the radio callbacks, as the driver does for a received frame. The software ACKs of the
+ * address table are off meanwhile, the sender of a replayed frame is not on the air.
+ */
+static bool replay_inject(const uint8_t *record, uint32_t *dropped)
+{
+    uint8_t length = record[4];
+    uint8_t frame[IEEE802154_MAX_PSDU_LENGTH + 1];
+    frame[0] = length + 2;
+    memcpy(&frame[1], &record[REPLAY_RECORD_HEADER], length);
+    frame[length + 1] = record[5]; // rssi/lqi in place of the FCS
+    frame[length + 2] = record[6];
+
+    esp_ieee802154_frame_info_t frame_info = {
+        .process = true,
+        .channel = esp_ieee802154_get_channel(),
+        .rssi = (int8_t)record[5],
+        .lqi = record[6],
+        .timestamp = esp_timer_get_time(),
+    };
+
+    bool enh_ack = (record[7] & REPLAY_FLAG_ENH_ACK) != 0;
+    inject_drops = 0;
+    injecting = true;
+    esp_ieee802154_addr_table_set_ack(false);
+    if (enh_ack)
+    {
+        uint8_t ack[IEEE802154_MAX_PSDU_LENGTH + 1];
+        esp_ieee802154_enh_ack_generator(frame, &frame_info, ack);
+    }
+    esp_ieee802154_receive_done(frame, &frame_info);
+    esp_ieee802154_addr_table_set_ack(true);
+    injecting = false;
+    *dropped = inject_drops;
+    return enh_ack;
+}
+
+static void replay_timer_cb(void *arg)
+{
+    if (!stats.running)
+    {
+        return; // Stopped while the timer was about to fire
+    }
+
+    int64_t now = esp_timer_get_time();
+    const uint8_t *record = &buffer[cursor];
+
+    uint32_t dropped;
+    bool enh_ack = replay_inject(record, &dropped);
+
+    portENTER_CRITICAL(&stats_lock);
+    if (dropped > 0 && stats.first_drop == IEEE802154_REPLAY_NO_DROP)
+    {
+        stats.first_drop = stats.injected;
+    }
+    stats.injected += 1;
+    stats.enh_acks += enh_ack;
+    stats.dropped += dropped;
+    uint32_t late = (now > due_us) ? (uint32_t)(now - due_us) : 0;
+    stats.max_late_us = (late > stats.max_late_us) ? late : stats.max_late_us;
+    stats.duration_us = now - first_us;
+    portEXIT_CRITICAL(&stats_lock);
+
+    // The next frame starts after the captured gap (scaled) but never before this frame is off the air
+    uint32_t airtime = replay_airtime_us(record[4]);
+    cursor += REPLAY_RECORD_HEADER + record[4];
+    if (cursor >= buffer_used)
+    {
+        cursor = 0;
+        passes_left -= 1;
+        if (passes_left == 0)
+        {
+            portENTER_CRITICAL(&stats_lock);
+            stats.running = false;
+            portEXIT_CRITICAL(&stats_lock);
+            return;
+        }
+    }
+
+    uint32_t delta;
+    memcpy(&delta, &buffer[cursor], sizeof(delta));
+    uint32_t gap = (replay_speed == IEEE802154_REPLAY_FAST) ? 0 : delta / replay_speed;
+    due_us += (gap > airtime) ? gap : airtime;
+
+    int64_t wait = due_us - esp_timer_get_time();
+    esp_timer_start_once(replay_timer, (wait > 0) ? wait : 0);
+}
+
+/* --- Buffer --- */
+
+esp_err_t esp_ieee802154_replay_clear(void)
+{
+    if (stats.running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    buffer_used = 0;
+    stats.frames = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_replay_add(uint32_t delta_us, const uint8_t *psdu, uint8_t length, int8_t rssi, uint8_t lqi)
+{
+    if (stats.running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (length < 3 || length > IEEE802154_MAX_PSDU_LENGTH - 2)
+    {
+        return ESP_ERR_INVALID_SIZE; // FCF and sequence number, room for the FCS
+    }
+    if (buffer_used + REPLAY_RECORD_HEADER + length > sizeof(buffer))
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // The driver calls the Enh-ACK generator for 2015 frames with ACK request
+    ieee802154_frame_t parsed;
+    bool enh_ack = esp_ieee802154_parse_frame(psdu, length + 2, &parsed) && parsed.ack_request &&
+                   parsed.frame_version == FRAME_VERSION_STD_2015;
+
+    uint8_t *record = &buffer[buffer_used];
+    memcpy(record, &delta_us, sizeof(delta_us));
+    record[4] = length;
+    record[5] = (uint8_t)rssi;
+    record[6] = lqi;
+    record[7] = enh_ack ? REPLAY_FLAG_ENH_ACK : 0;
+    memcpy(&record[REPLAY_RECORD_HEADER], psdu, length);
+    buffer_used += REPLAY_RECORD_HEADER + length;
+    stats.frames += 1;
+    return ESP_OK;
+}
+
+/* --- Replay --- */
+
+esp_err_t esp_ieee802154_replay_start(uint16_t speed, uint16_t passes)
+{
+    if (stats.running || buffer_used == 0 || passes == 0)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (replay_timer == NULL)
+    {
+        const esp_timer_create_args_t args = {
+            .callback = replay_timer_cb,
+            .name = "replay",
+        };
+        if (esp_timer_create(&args, &replay_timer) != ESP_OK)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    cursor = 0;
+    replay_speed = speed;
+    passes_left = passes;
+    first_us = esp_timer_get_time();
+    due_us = first_us;
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.running = true;
+    stats.injected = 0;
+    stats.enh_acks = 0;
+    stats.dropped = 0;
+    stats.first_drop = IEEE802154_REPLAY_NO_DROP;
+    stats.max_late_us = 0;
+    stats.duration_us = 0;
+    portEXIT_CRITICAL(&stats_lock);
+
+    ESP_LOGI(TAG, "Replaying %" PRIu32 " frames, %u passes", stats.frames, passes);
+    return esp_timer_start_once(replay_timer, 0);
+}
+
+void esp_ieee802154_replay_stop(void)
+{
+    if (replay_timer != NULL)
+    {
+        esp_timer_stop(replay_timer);
+    }
+    portENTER_CRITICAL(&stats_lock);
+    stats.running = false;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void esp_ieee802154_replay_get_stats(ieee802154_replay_stats_t *out)
+{
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+/* --- Console --- */
+
+static int replay_hex_value(char c)
+{
+    return isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10;
+}
+
+static esp_err_t replay_add_hex(const char *delta, const char *hex, const char *rssi, const char *lqi)
+{
+    uint8_t psdu[IEEE802154_MAX_PSDU_LENGTH];
+    size_t digits = strlen(hex);
+    if (digits % 2 != 0 || digits / 2 > sizeof(psdu))
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    for (size_t idx = 0; idx < digits; idx++)
+    {
+        if (!isxdigit((unsigned char)hex[idx]))
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    for (size_t idx = 0; idx < digits / 2; idx++)
+    {
+        psdu[idx] = (uint8_t)((replay_hex_value(hex[2 * idx]) << 4) | replay_hex_value(hex[2 * idx + 1]));
+    }
+
+    return esp_ieee802154_replay_add(strtoul(delta, NULL, 0), psdu, (uint8_t)(digits / 2),
+                                     (rssi != NULL) ? (int8_t)atoi(rssi) : -50, (lqi != NULL) ? (uint8_t)atoi(lqi) : 255);
+}
+
+static void replay_print_stats(void)
+{
+    ieee802154_replay_stats_t copy;
+    esp_ieee802154_replay_get_stats(&copy);
+
+    printf("%" PRIu32 " frames (%" PRIu32 " of %d bytes)%s\n", copy.frames, buffer_used, IEEE802154_REPLAY_BUFFER_SIZE,
+           copy.running ? ", replay running" : "");
+    if (copy.injected == 0)
+    {
+        return;
+    }
+
+    uint32_t rate = (copy.duration_us > 0) ? (uint32_t)((uint64_t)(copy.injected - 1) * 1000000 / copy.duration_us) : 0;
+    printf("Injected %" PRIu32 " frames in %" PRId64 " ms (%" PRIu32 " frames/s), %" PRIu32 " Enh-ACKs generated, max %" PRIu32 " us late\n",
+           copy.injected, copy.duration_us / 1000, rate, copy.enh_acks, copy.max_late_us);
+    if (copy.first_drop == IEEE802154_REPLAY_NO_DROP)
+    {
+        printf("No drops\n");
+    }
+    else
+    {
+        printf("%" PRIu32 " dropped, the RX path sustained %" PRIu32 " frames before the first drop\n", copy.dropped, copy.first_drop);
+    }
+}
+
+static int replay_command(int argc, char **argv)
+{
+    esp_err_t err = ESP_OK;
+
+    if (argc == 2 && strcmp(argv[1], "clear") == 0)
+    {
+        err = esp_ieee802154_replay_clear();
+    }
+    else if (argc >= 4 && argc <= 6 && strcmp(argv[1], "add") == 0)
+    {
+        err = replay_add_hex(argv[2], argv[3], (argc > 4) ? argv[4] : NULL, (argc > 5) ? argv[5] : NULL);
+    }
+    else if (argc >= 2 && argc <= 4 && strcmp(argv[1], "run") == 0)
+    {
+        uint16_t speed = 1;
+        if (argc > 2)
+        {
+            speed = (strcmp(argv[2], "fast") == 0) ? IEEE802154_REPLAY_FAST : (uint16_t)atoi(argv[2][0] == 'x' ? &argv[2][1] : argv[2]);
+        }
+        err = esp_ieee802154_replay_start(speed, (argc > 3) ? (uint16_t)atoi(argv[3]) : 1);
+    }
+    else if (argc == 2 && strcmp(argv[1], "stop") == 0)
+    {
+        esp_ieee802154_replay_stop();
+    }
+    else if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        replay_print_stats();
+    }
+    else
+    {
+        printf("Usage: replay clear | add <delta us> <hex> [rssi] [lqi] | run [x<speed>|fast] [passes] | stop | stats\n");
+        return 1;
+    }
+
+    if (err != ESP_OK)
+    {
+        printf("Failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_replay_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "replay",
+        .help = "Replay captured frames into the receive path and report the drops",
+        .hint = "clear | add <delta us> <hex> [rssi] [lqi] | run [x<speed>|fast] [passes] | stop | stats",
+        .func = &replay_command,
+    };
+    return esp_console_cmd_register(&command);
+}
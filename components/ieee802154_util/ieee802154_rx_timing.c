@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_timer.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_rx_timing.h"
+
+#define TAG "ieee802154_rx_timing"
+
+typedef struct {
+    ieee802154_addr_id_t id;
+    int64_t last_timestamp_us;
+    ieee802154_histogram_t inter_arrival;
+} rx_timing_source_t;
+
+static rx_timing_source_t sources[IEEE802154_RX_TIMING_MAX_SOURCES];
+static uint8_t source_count = 0;
+static uint8_t source_index[IEEE802154_ADDR_BOOK_MAX]; // Index + 1 in sources by address book id, 0 if none
+static ieee802154_histogram_t delay;
+static portMUX_TYPE timing_lock = portMUX_INITIALIZER_UNLOCKED; // Protects the histograms
+
+/* --- RX entries --- */
+
+IEEE802154_ISR_ATTR size_t esp_ieee802154_rx_entry_fill(ieee802154_rx_entry_t *entry, const uint8_t *frame, const esp_ieee802154_frame_info_t *frame_info)
+{
+    entry->timestamp_us = (frame_info != NULL && frame_info->timestamp != 0) ? (int64_t)frame_info->timestamp : esp_timer_get_time();
+    memcpy(entry->frame, frame, frame[0] + 1);
+    return IEEE802154_RX_ENTRY_LENGTH(entry);
+}
+
+/* --- Histograms --- */
+
+static uint32_t rx_timing_clamp(int64_t value_us)
+{
+    if (value_us < 0)
+    {
+        return 0; // A stamp taken after now_us, e.g. the entry was stamped while the task was preempted
+    }
+    return (value_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)value_us;
+}
+
+static rx_timing_source_t *rx_timing_find_source(ieee802154_addr_id_t id)
+{
+    if (source_index[id] > 0)
+    {
+        return &sources[source_index[id] - 1];
+    }
+    if (source_count >= IEEE802154_RX_TIMING_MAX_SOURCES)
+    {
+        return NULL;
+    }
+
+    rx_timing_source_t *source = &sources[source_count];
+    memset(source, 0, sizeof(rx_timing_source_t));
+    source->id = id;
+    source->last_timestamp_us = -1;
+    source_count += 1;
+    source_index[id] = source_count;
+    return source;
+}
+
+void esp_ieee802154_rx_timing_record(const ieee802154_rx_entry_t *entry, int64_t now_us)
+{
+    ieee802154_frame_t parsed;
+    ieee802154_addr_id_t id = IEEE802154_ADDR_ID_NONE;
+    if (esp_ieee802154_parse_frame(&entry->frame[1], entry->frame[0], &parsed))
+    {
+        // Entries are never removed from the address book, new sources are only added while a slot is free
+        id = esp_ieee802154_addr_book_find(parsed.src_pan_id, &parsed.src_addr);
+        if (id == IEEE802154_ADDR_ID_NONE && source_count < IEEE802154_RX_TIMING_MAX_SOURCES)
+        {
+            id = esp_ieee802154_addr_book_intern(parsed.src_pan_id, &parsed.src_addr); // NONE without source address
+        }
+    }
+
+    portENTER_CRITICAL(&timing_lock);
+    esp_ieee802154_histogram_add(&delay, rx_timing_clamp(now_us - entry->timestamp_us));
+
+    rx_timing_source_t *source = (id != IEEE802154_ADDR_ID_NONE) ? rx_timing_find_source(id) : NULL;
+    if (source != NULL)
+    {
+        if (source->last_timestamp_us >= 0)
+        {
+            esp_ieee802154_histogram_add(&source->inter_arrival, rx_timing_clamp(entry->timestamp_us - source->last_timestamp_us));
+        }
+        source->last_timestamp_us = entry->timestamp_us;
+    }
+    portEXIT_CRITICAL(&timing_lock);
+}
+
+bool esp_ieee802154_rx_timing_get_source(ieee802154_addr_id_t id, ieee802154_histogram_t *histogram)
+{
+    if (id >= IEEE802154_ADDR_BOOK_MAX)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&timing_lock);
+    bool found = (source_index[id] > 0);
+    if (found)
+    {
+        *histogram = sources[source_index[id] - 1].inter_arrival;
+    }
+    portEXIT_CRITICAL(&timing_lock);
+    return found;
+}
+
+void esp_ieee802154_rx_timing_get_delay(ieee802154_histogram_t *histogram)
+{
+    portENTER_CRITICAL(&timing_lock);
+    *histogram = delay;
+    portEXIT_CRITICAL(&timing_lock);
+}
+
+void esp_ieee802154_rx_timing_reset(void)
+{
+    portENTER_CRITICAL(&timing_lock);
+    memset(&delay, 0, sizeof(delay));
+    memset(source_index, 0, sizeof(source_index));
+    source_count = 0;
+    portEXIT_CRITICAL(&timing_lock);
+}
+
+/* --- Console --- */
+
+static void rx_timing_print(void)
+{
+    ieee802154_histogram_t histogram;
+    char addr[IEEE802154_ADDRESS_TEXT_LENGTH];
+
+    esp_ieee802154_rx_timing_get_delay(&histogram);
+    printf("SFD to receiver task:\n");
+    esp_ieee802154_histogram_print(&histogram, "  ", "us");
+
+    portENTER_CRITICAL(&timing_lock);
+    uint8_t count = source_count;
+    portEXIT_CRITICAL(&timing_lock);
+
+    for (uint8_t idx = 0; idx < count; idx++)
+    {
+        portENTER_CRITICAL(&timing_lock);
+        ieee802154_addr_id_t id = sources[idx].id;
+        histogram = sources[idx].inter_arrival;
+        portEXIT_CRITICAL(&timing_lock);
+
+        esp_ieee802154_addr_book_format(id, addr, sizeof(addr));
+        printf("Inter-arrival from %s:\n", addr);
+        esp_ieee802154_histogram_print(&histogram, "  ", "us");
+    }
+}
+
+static int rx_timing_command(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        rx_timing_print();
+    }
+    else if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        esp_ieee802154_rx_timing_reset();
+    }
+    else
+    {
+        printf("Usage: rxtime [reset]\n");
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_rx_timing_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "rxtime",
+        .help = "RX timing: delay from the SFD to the receiver task and inter-arrival times per source",
+        .hint = "[reset]",
+        .func = &rx_timing_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,226 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <esp_ieee802154.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/stream_buffer.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_stream.h"
+
+#define TAG "ieee802154_stream"
+
+#define STREAM_MAX_LISTENERS 4
+#define STREAM_TASK_PRIORITY 10
+
+struct ieee802154_stream {
+    StreamBufferHandle_t buffer;
+    ieee802154_frame_t peer;    // Destination (sending) or source (receiving) of the stream
+    uint8_t frame[128];         // Frame with the prebuilt header (sending)
+    uint8_t payload_offset;     // Offset of the first stream byte in frame (sending)
+    uint8_t max_payload;        // Stream bytes per frame (sending)
+    uint8_t seq_nr;             // Last sequence number
+    bool seq_valid;             // A frame has been received (receiving)
+    TickType_t flush_timeout;
+    uint32_t bytes;
+    uint32_t frames;
+    uint32_t dropped;
+};
+
+static struct ieee802154_stream *listeners[STREAM_MAX_LISTENERS];
+
+/* --- Sending --- */
+
+static void stream_task(void *pvParameters)
+{
+    struct ieee802154_stream *stream = pvParameters;
+
+    while (1)
+    {
+        // The first bytes of a frame start its flush deadline
+        uint8_t *payload = &stream->frame[stream->payload_offset];
+        xStreamBufferSetTriggerLevel(stream->buffer, 1);
+        size_t length = xStreamBufferReceive(stream->buffer, payload, stream->max_payload, portMAX_DELAY);
+        if (length == 0)
+        {
+            continue;
+        }
+
+        /**
+         * A receive returns as soon as any bytes are available, so it is repeated until the frame is full or the
+         * deadline expires. The trigger level wakes the task only once the rest of the frame is available.
+         */
+        TimeOut_t deadline;
+        TickType_t remaining = stream->flush_timeout;
+        vTaskSetTimeOutState(&deadline);
+        while (length < stream->max_payload && xTaskCheckForTimeOut(&deadline, &remaining) == pdFALSE)
+        {
+            xStreamBufferSetTriggerLevel(stream->buffer, stream->max_payload - length);
+            length += xStreamBufferReceive(stream->buffer, &payload[length], stream->max_payload - length, remaining);
+        }
+
+        stream->seq_nr += 1;
+        stream->frame[3] = stream->seq_nr; // The sequence number directly follows the FCF
+        stream->frame[0] = (stream->payload_offset - 1) + length + 2; // FCS included
+
+        esp_err_t err = ESP_FAIL;
+        for (uint8_t attempt = 0; attempt <= IEEE802154_STREAM_RETRIES && err != ESP_OK; attempt++)
+        {
+            err = esp_ieee802154_tx_engine_transmit(stream->frame, true, NULL, portMAX_DELAY);
+        }
+
+        if (err == ESP_OK)
+        {
+            stream->bytes += length;
+            stream->frames += 1;
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Dropped %d stream bytes", (int)length);
+            stream->dropped += length;
+        }
+    }
+}
+
+esp_err_t esp_ieee802154_stream_open(uint16_t dst_pan_id, const ieee802154_address_t *dst_addr, size_t buffer_size,
+                                     uint32_t flush_timeout_ms, ieee802154_stream_handle_t *handle)
+{
+    struct ieee802154_stream *stream = calloc(1, sizeof(struct ieee802154_stream));
+    if (stream == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* The header only depends on the destination and the radio configuration, so it is created once */
+    uint8_t dispatch = IEEE802154_STREAM_DISPATCH;
+    ieee802154_address_t dst = *dst_addr;
+    if (esp_ieee802154_create_2015_l2_data_frame(stream->frame, dst_pan_id, &dst, &dispatch, sizeof(dispatch), &stream->seq_nr, true) == 0)
+    {
+        free(stream);
+        return ESP_ERR_INVALID_ARG;
+    }
+    stream->payload_offset = 1 + (stream->frame[0] - 2); // Length byte, header and dispatch byte
+    stream->max_payload = IEEE802154_MAX_PSDU_LENGTH - 2 - (stream->payload_offset - 1);
+    stream->flush_timeout = flush_timeout_ms / portTICK_PERIOD_MS;
+    stream->peer.dst_pan_id = dst_pan_id;
+    stream->peer.dst_addr = *dst_addr;
+
+    stream->buffer = xStreamBufferCreate(buffer_size, stream->max_payload);
+    if (stream->buffer == NULL)
+    {
+        free(stream);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreate(stream_task, "stream_task", 4096, stream, STREAM_TASK_PRIORITY, NULL) != pdPASS)
+    {
+        vStreamBufferDelete(stream->buffer);
+        free(stream);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Stream opened, %d bytes per frame", stream->max_payload);
+    *handle = stream;
+    return ESP_OK;
+}
+
+size_t esp_ieee802154_stream_write(ieee802154_stream_handle_t handle, const void *data, size_t length, TickType_t timeout)
+{
+    return xStreamBufferSend(handle->buffer, data, length, timeout);
+}
+
+/* --- Receiving --- */
+
+esp_err_t esp_ieee802154_stream_listen(uint16_t src_pan_id, const ieee802154_address_t *src_addr, size_t buffer_size,
+                                       ieee802154_stream_handle_t *handle)
+{
+    for (uint8_t idx = 0; idx < STREAM_MAX_LISTENERS; idx++)
+    {
+        if (listeners[idx] != NULL)
+        {
+            continue;
+        }
+
+        struct ieee802154_stream *stream = calloc(1, sizeof(struct ieee802154_stream));
+        if (stream == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        stream->buffer = xStreamBufferCreate(buffer_size, 1);
+        if (stream->buffer == NULL)
+        {
+            free(stream);
+            return ESP_ERR_NO_MEM;
+        }
+        stream->peer.src_pan_id = src_pan_id;
+        stream->peer.src_addr = *src_addr;
+
+        listeners[idx] = stream;
+        *handle = stream;
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+size_t esp_ieee802154_stream_read(ieee802154_stream_handle_t handle, void *data, size_t length, TickType_t timeout)
+{
+    return xStreamBufferReceive(handle->buffer, data, length, timeout);
+}
+
+bool esp_ieee802154_stream_input(const uint8_t *frame)
+{
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) || parsed.frame_type != FRAME_TYPE_DATA ||
+        parsed.payload_length < 1 || frame[1 + parsed.header_length] != IEEE802154_STREAM_DISPATCH)
+    {
+        return false;
+    }
+
+    for (uint8_t idx = 0; idx < STREAM_MAX_LISTENERS; idx++)
+    {
+        struct ieee802154_stream *stream = listeners[idx];
+        if (stream == NULL || stream->peer.src_pan_id != parsed.src_pan_id || !esp_ieee802154_address_equal(&stream->peer.src_addr, &parsed.src_addr))
+        {
+            continue;
+        }
+
+        // A retransmission after a lost ACK carries the same sequence number
+        if (stream->seq_valid && parsed.sequence_number_present && parsed.sequence_number == stream->seq_nr)
+        {
+            stream->dropped += 1;
+            return true;
+        }
+        stream->seq_valid = parsed.sequence_number_present;
+        stream->seq_nr = parsed.sequence_number;
+
+        uint8_t length = parsed.payload_length - 1;
+        size_t written = xStreamBufferSend(stream->buffer, &frame[1 + parsed.header_length + 1], length, 0);
+        if (written < length)
+        {
+            ESP_LOGW(TAG, "RX stream buffer full, %d bytes lost", (int)(length - written));
+        }
+        stream->bytes += written;
+        stream->frames += 1;
+        return true;
+    }
+    return false;
+}
+
+void esp_ieee802154_stream_get_stats(ieee802154_stream_handle_t handle, uint32_t *bytes, uint32_t *frames, uint32_t *dropped)
+{
+    if (bytes != NULL)
+    {
+        *bytes = handle->bytes;
+    }
+    if (frames != NULL)
+    {
+        *frames = handle->frames;
+    }
+    if (dropped != NULL)
+    {
+        *dropped = handle->dropped;
+    }
+}
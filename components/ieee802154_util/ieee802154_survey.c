@@ -0,0 +1,214 @@
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_survey.h"
+#include "ieee802154_tx.h"
+
+#define TAG "ieee802154_survey"
+
+#define SURVEY_ED_TIMEOUT_MS 100
+
+static QueueHandle_t ed_queue = NULL;
+static SemaphoreHandle_t survey_lock = NULL; // One survey at a time, it owns the radio and ed_queue
+
+/* --- Energy detection --- */
+
+// ISR Context (Radio callback)
+IEEE802154_ISR_ATTR void esp_ieee802154_energy_detect_done(int8_t power)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (ed_queue != NULL)
+    {
+        xQueueOverwriteFromISR(ed_queue, &power, &higher_priority_task_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+static uint8_t energy_to_bucket(int8_t power)
+{
+    if (power < IEEE802154_SURVEY_BUCKET_BASE)
+    {
+        return 0;
+    }
+    uint8_t bucket = 1 + (power - IEEE802154_SURVEY_BUCKET_BASE) / 10;
+    return bucket < IEEE802154_SURVEY_BUCKETS ? bucket : IEEE802154_SURVEY_BUCKETS - 1;
+}
+
+/* --- Survey --- */
+
+static esp_err_t survey_lock_take(void)
+{
+    if (__atomic_load_n(&survey_lock, __ATOMIC_ACQUIRE) == NULL)
+    {
+        // Surveys may be started by several tasks at once, the first created mutex wins
+        SemaphoreHandle_t lock = xSemaphoreCreateMutex();
+        SemaphoreHandle_t expected = NULL;
+        if (lock == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        if (!__atomic_compare_exchange_n(&survey_lock, &expected, lock, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            vSemaphoreDelete(lock);
+        }
+    }
+    xSemaphoreTake(survey_lock, portMAX_DELAY);
+
+    if (ed_queue == NULL)
+    {
+        ed_queue = xQueueCreate(1, sizeof(int8_t));
+        if (ed_queue == NULL)
+        {
+            xSemaphoreGive(survey_lock);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t survey_sample(uint16_t samples_per_channel, uint32_t ed_duration, int8_t busy_threshold_dbm, ieee802154_survey_t *survey)
+{
+    for (uint8_t idx = 0; idx < IEEE802154_NUM_CHANNELS; idx++)
+    {
+        ieee802154_channel_survey_t *channel = &survey->channels[idx];
+        channel->min_dbm = INT8_MAX;
+        channel->max_dbm = INT8_MIN;
+
+        esp_ieee802154_set_channel(IEEE802154_CHANNEL_MIN + idx);
+
+        for (uint16_t sample = 0; sample < samples_per_channel; sample++)
+        {
+            int8_t power;
+            xQueueReset(ed_queue);
+            esp_ieee802154_energy_detect(ed_duration);
+            if (xQueueReceive(ed_queue, &power, SURVEY_ED_TIMEOUT_MS / portTICK_PERIOD_MS) != pdTRUE)
+            {
+                ESP_LOGE(TAG, "Energy detection on channel %d timed out", IEEE802154_CHANNEL_MIN + idx);
+                return ESP_ERR_TIMEOUT;
+            }
+
+            channel->samples += 1;
+            channel->sum_dbm += power;
+            channel->min_dbm = power < channel->min_dbm ? power : channel->min_dbm;
+            channel->max_dbm = power > channel->max_dbm ? power : channel->max_dbm;
+            channel->busy += (power >= busy_threshold_dbm);
+            channel->histogram[energy_to_bucket(power)] += 1;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_survey_run(uint16_t samples_per_channel, uint32_t ed_duration, int8_t busy_threshold_dbm, ieee802154_survey_t *survey)
+{
+    esp_err_t err = survey_lock_take();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    memset(survey, 0, sizeof(ieee802154_survey_t));
+    survey->busy_threshold_dbm = busy_threshold_dbm;
+
+    // No frames (and no CCA or ACK results of frames) while the radio is on the other channels
+    esp_ieee802154_tx_engine_pause();
+    uint8_t channel = esp_ieee802154_get_channel();
+    int64_t start = esp_timer_get_time();
+
+    err = survey_sample(samples_per_channel, ed_duration, busy_threshold_dbm, survey);
+
+    survey->duration_us = esp_timer_get_time() - start;
+    esp_ieee802154_set_channel(channel);
+    esp_ieee802154_tx_engine_resume();
+    xSemaphoreGive(survey_lock);
+
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    uint8_t ranking[IEEE802154_NUM_CHANNELS];
+    esp_ieee802154_survey_rank(survey, ranking);
+    survey->best_channel = ranking[0];
+
+    return ESP_OK;
+}
+
+/**
+ * Returns true if channel a is quieter than channel b.
+ */
+static bool channel_is_quieter(const ieee802154_survey_t *survey, uint8_t a, uint8_t b)
+{
+    const ieee802154_channel_survey_t *ca = &survey->channels[a - IEEE802154_CHANNEL_MIN];
+    const ieee802154_channel_survey_t *cb = &survey->channels[b - IEEE802154_CHANNEL_MIN];
+
+    if (ca->busy != cb->busy)
+    {
+        return ca->busy < cb->busy;
+    }
+    // Compare the mean energy without dividing (both channels have the same number of samples)
+    if (ca->sum_dbm != cb->sum_dbm)
+    {
+        return ca->sum_dbm < cb->sum_dbm;
+    }
+    return a > b;
+}
+
+void esp_ieee802154_survey_rank(const ieee802154_survey_t *survey, uint8_t *channels)
+{
+    // Insertion sort, there are only 16 channels
+    for (uint8_t idx = 0; idx < IEEE802154_NUM_CHANNELS; idx++)
+    {
+        uint8_t channel = IEEE802154_CHANNEL_MIN + idx;
+        uint8_t pos = idx;
+        while (pos > 0 && channel_is_quieter(survey, channel, channels[pos - 1]))
+        {
+            channels[pos] = channels[pos - 1];
+            pos -= 1;
+        }
+        channels[pos] = channel;
+    }
+}
+
+bool esp_ieee802154_survey_should_switch(const ieee802154_survey_t *survey, uint8_t channel)
+{
+    if (channel < IEEE802154_CHANNEL_MIN || channel > IEEE802154_CHANNEL_MAX)
+    {
+        return true;
+    }
+
+    const ieee802154_channel_survey_t *current = &survey->channels[channel - IEEE802154_CHANNEL_MIN];
+    const ieee802154_channel_survey_t *best = &survey->channels[survey->best_channel - IEEE802154_CHANNEL_MIN];
+
+    // Hysteresis, so the nodes do not hop between channels with similar occupancy
+    return current->busy > best->busy + current->samples / 8;
+}
+
+void esp_ieee802154_survey_print(const ieee802154_survey_t *survey)
+{
+    ESP_LOGI(TAG, "------ Channel Survey ------");
+    ESP_LOGI(TAG, "Duration: %" PRId64 " ms, busy threshold: %d dBm", survey->duration_us / 1000, survey->busy_threshold_dbm);
+    ESP_LOGI(TAG, "CH  busy   min  mean   max | <-100 -100  -90  -80  -70  -60  -50  -40");
+
+    for (uint8_t idx = 0; idx < IEEE802154_NUM_CHANNELS; idx++)
+    {
+        const ieee802154_channel_survey_t *channel = &survey->channels[idx];
+        if (channel->samples == 0)
+        {
+            continue;
+        }
+        const uint16_t *h = channel->histogram;
+        ESP_LOGI(TAG, "%2d %4d%% %5d %5d %5d | %5d %4d %4d %4d %4d %4d %4d %4d%s", IEEE802154_CHANNEL_MIN + idx,
+                 channel->busy * 100 / channel->samples, channel->min_dbm, (int)(channel->sum_dbm / channel->samples),
+                 channel->max_dbm, h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+                 IEEE802154_CHANNEL_MIN + idx == survey->best_channel ? " <- best" : "");
+    }
+}
@@ -0,0 +1,754 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <esp_random.h>
+#include <esp_console.h>
+#include <nvs.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_traffic.h"
+
+#define TAG "ieee802154_traffic"
+
+#define TRAFFIC_NVS_NAMESPACE   "ieee802154"
+#define TRAFFIC_NVS_KEY         "traffic"
+#define TRAFFIC_TASK_PRIORITY   8
+#define TRAFFIC_MAX_BACKLOG_US  1000000 // A generator that falls behind further skips the missed frames
+
+#define TRAFFIC_SEQ_OFFSET       1
+#define TRAFFIC_TIMESTAMP_OFFSET 5
+#define TRAFFIC_CHECKSUM_OFFSET  9
+
+#define TRAFFIC_HISTORY_LENGTH   32  // Frames covered by the duplicate detection
+#define TRAFFIC_RESTART_GAP      256 // Sequence numbers further behind are a restart of the sender
+
+static ieee802154_traffic_profile_t traffic_profile;
+static char traffic_spec[IEEE802154_TRAFFIC_SPEC_LENGTH];
+static TaskHandle_t traffic_task_handle = NULL;
+static volatile bool traffic_running = false;
+static uint32_t traffic_seq = 0;
+static uint32_t node_seq[IEEE802154_TRAFFIC_MAX_NODES]; // Sequence numbers of the virtual nodes
+
+static ieee802154_traffic_tx_stats_t tx_stats;
+static ieee802154_traffic_rx_stats_t rx_stats[IEEE802154_TRAFFIC_MAX_SOURCES];
+static uint8_t rx_sources = 0;
+static uint8_t rx_source_index[IEEE802154_ADDR_BOOK_MAX]; // Index + 1 in rx_stats by address book id, 0 if none
+
+/* --- Payload --- */
+
+static uint16_t traffic_checksum(const uint8_t *payload, uint8_t length)
+{
+    // Fletcher-16 over the payload without the checksum field
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (uint8_t idx = 0; idx < length; idx++)
+    {
+        if (idx == TRAFFIC_CHECKSUM_OFFSET || idx == TRAFFIC_CHECKSUM_OFFSET + 1)
+        {
+            continue;
+        }
+        sum1 = (sum1 + payload[idx]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+}
+
+static void put_u32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+    buffer[2] = (value >> 16) & 0xFF;
+    buffer[3] = (value >> 24) & 0xFF;
+}
+
+static uint32_t get_u32(const uint8_t *buffer)
+{
+    return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+static void traffic_fill_payload(uint8_t *payload, uint8_t length, uint32_t seq, uint32_t timestamp)
+{
+    payload[0] = IEEE802154_TRAFFIC_DISPATCH;
+    put_u32(&payload[TRAFFIC_SEQ_OFFSET], seq);
+    put_u32(&payload[TRAFFIC_TIMESTAMP_OFFSET], timestamp);
+    for (uint8_t idx = IEEE802154_TRAFFIC_HEADER_LENGTH; idx < length; idx++)
+    {
+        payload[idx] = (uint8_t)(seq + idx);
+    }
+
+    uint16_t checksum = traffic_checksum(payload, length);
+    payload[TRAFFIC_CHECKSUM_OFFSET] = checksum & 0xFF;
+    payload[TRAFFIC_CHECKSUM_OFFSET + 1] = checksum >> 8;
+}
+
+/* --- Profile --- */
+
+/* Parse a whole value as a number, signs and trailing characters are rejected */
+static bool parse_number(const char *value, unsigned long max, uint32_t *number)
+{
+    char *end;
+    unsigned long parsed = strtoul(value, &end, 0);
+    if (end == value || *end != '\0' || value[0] == '-' || parsed > max)
+    {
+        return false;
+    }
+    *number = parsed;
+    return true;
+}
+
+static esp_err_t parse_sizes(char *value, ieee802154_traffic_profile_t *profile)
+{
+    profile->size_count = 0;
+    for (char *item = strtok(value, ","); item != NULL; item = strtok(NULL, ","))
+    {
+        if (profile->size_count >= IEEE802154_TRAFFIC_MAX_SIZES)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        ieee802154_traffic_size_t *size = &profile->sizes[profile->size_count];
+        char *end;
+        unsigned long min = strtoul(item, &end, 0);
+        unsigned long max = min;
+        unsigned long weight = 1;
+        if (*end == '-')
+        {
+            max = strtoul(end + 1, &end, 0);
+        }
+        if (*end == ':')
+        {
+            weight = strtoul(end + 1, &end, 0);
+        }
+        if (*end != '\0' || min < IEEE802154_TRAFFIC_HEADER_LENGTH || max < min || max > IEEE802154_TRAFFIC_MAX_PAYLOAD ||
+            weight == 0 || weight > UINT8_MAX)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        size->min = min;
+        size->max = max;
+        size->weight = weight;
+        profile->size_count += 1;
+    }
+    return (profile->size_count > 0) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+static esp_err_t parse_dsts(char *value, ieee802154_traffic_profile_t *profile)
+{
+    profile->dst_count = 0;
+    for (char *item = strtok(value, ","); item != NULL; item = strtok(NULL, ","))
+    {
+        char *end;
+        unsigned long first = strtoul(item, &end, 0);
+        unsigned long last = first;
+        if (*end == '-')
+        {
+            last = strtoul(end + 1, &end, 0);
+        }
+        if (profile->dst_count >= IEEE802154_TRAFFIC_MAX_DSTS || *end != '\0' || last < first || last >= UINT16_MAX)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        profile->dsts[profile->dst_count].first = first;
+        profile->dsts[profile->dst_count].count = last - first + 1;
+        profile->dst_count += 1;
+    }
+    return (profile->dst_count > 0) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_ieee802154_traffic_parse(const char *spec, ieee802154_traffic_profile_t *profile)
+{
+    char buffer[IEEE802154_TRAFFIC_SPEC_LENGTH];
+    if (strlen(spec) >= sizeof(buffer))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    strcpy(buffer, spec);
+
+    *profile = (ieee802154_traffic_profile_t) {
+        .mode = IEEE802154_TRAFFIC_CONSTANT,
+        .rate = 10,
+        .on_ms = 1000,
+        .off_ms = 1000,
+        .size_count = 1,
+        .sizes = { { .min = 20, .max = 20, .weight = 1 } },
+        .dst_count = 0,
+        .ack = IEEE802154_RELIABILITY_CRITICAL,
+        .duration_s = 0,
+        .nodes = 0,
+        .src = { .mode = ADDR_MODE_SHORT, .short_address = 0x1000 },
+    };
+
+    // strtok is used for the sizes and destinations, so the pairs are split with strtok_r
+    char *save;
+    for (char *pair = strtok_r(buffer, " ", &save); pair != NULL; pair = strtok_r(NULL, " ", &save))
+    {
+        char *value = strchr(pair, '=');
+        if (value == NULL)
+        {
+            return ESP_ERR_INVALID_ARG;
+        }
+        *value = '\0';
+        value += 1;
+
+        esp_err_t err = ESP_OK;
+        if (strcmp(pair, "mode") == 0)
+        {
+            if (strcmp(value, "const") == 0)
+            {
+                profile->mode = IEEE802154_TRAFFIC_CONSTANT;
+            }
+            else if (strcmp(value, "poisson") == 0)
+            {
+                profile->mode = IEEE802154_TRAFFIC_POISSON;
+            }
+            else if (strcmp(value, "onoff") == 0)
+            {
+                profile->mode = IEEE802154_TRAFFIC_ON_OFF;
+            }
+            else if (strcmp(value, "saturate") == 0)
+            {
+                profile->mode = IEEE802154_TRAFFIC_SATURATE;
+            }
+            else
+            {
+                err = ESP_ERR_INVALID_ARG;
+            }
+        }
+        else if (strcmp(pair, "rate") == 0)
+        {
+            // A rate above 1000000 would make the interval 0 and the generator spin
+            err = parse_number(value, IEEE802154_TRAFFIC_MAX_RATE, &profile->rate) ? ESP_OK : ESP_ERR_INVALID_ARG;
+        }
+        else if (strcmp(pair, "on") == 0)
+        {
+            err = parse_number(value, UINT32_MAX, &profile->on_ms) ? ESP_OK : ESP_ERR_INVALID_ARG;
+        }
+        else if (strcmp(pair, "off") == 0)
+        {
+            err = parse_number(value, UINT32_MAX, &profile->off_ms) ? ESP_OK : ESP_ERR_INVALID_ARG;
+        }
+        else if (strcmp(pair, "size") == 0)
+        {
+            err = parse_sizes(value, profile);
+        }
+        else if (strcmp(pair, "dst") == 0)
+        {
+            err = parse_dsts(value, profile);
+        }
+        else if (strcmp(pair, "ack") == 0)
+        {
+            if (strcmp(value, "0") == 0 || strcmp(value, "1") == 0)
+            {
+                profile->ack = (value[0] == '1') ? IEEE802154_RELIABILITY_CRITICAL : IEEE802154_RELIABILITY_NONE;
+            }
+            else if (!esp_ieee802154_ack_policy_parse_reliability(value, &profile->ack))
+            {
+                err = ESP_ERR_INVALID_ARG;
+            }
+        }
+        else if (strcmp(pair, "duration") == 0)
+        {
+            err = parse_number(value, UINT32_MAX, &profile->duration_s) ? ESP_OK : ESP_ERR_INVALID_ARG;
+        }
+        else if (strcmp(pair, "nodes") == 0)
+        {
+            uint32_t nodes = 0;
+            err = parse_number(value, IEEE802154_TRAFFIC_MAX_NODES, &nodes) ? ESP_OK : ESP_ERR_INVALID_ARG;
+            profile->nodes = nodes;
+        }
+        else if (strcmp(pair, "src") == 0)
+        {
+            err = esp_ieee802154_parse_address(value, &profile->src) ? ESP_OK : ESP_ERR_INVALID_ARG;
+        }
+        else
+        {
+            err = ESP_ERR_INVALID_ARG;
+        }
+
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+
+    if (profile->dst_count == 0 || (profile->mode != IEEE802154_TRAFFIC_SATURATE && profile->rate == 0) ||
+        (profile->mode == IEEE802154_TRAFFIC_ON_OFF && profile->on_ms == 0))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+/* --- Generator --- */
+
+static uint8_t traffic_pick_size(const ieee802154_traffic_profile_t *profile)
+{
+    uint32_t total = 0;
+    for (uint8_t idx = 0; idx < profile->size_count; idx++)
+    {
+        total += profile->sizes[idx].weight;
+    }
+
+    uint32_t pick = esp_random() % total;
+    const ieee802154_traffic_size_t *size = &profile->sizes[0];
+    for (uint8_t idx = 0; idx < profile->size_count; idx++)
+    {
+        size = &profile->sizes[idx];
+        if (pick < size->weight)
+        {
+            break;
+        }
+        pick -= size->weight;
+    }
+    return size->min + esp_random() % (size->max - size->min + 1);
+}
+
+static uint16_t traffic_pick_dst(const ieee802154_traffic_profile_t *profile)
+{
+    uint32_t total = 0;
+    for (uint8_t idx = 0; idx < profile->dst_count; idx++)
+    {
+        total += profile->dsts[idx].count;
+    }
+
+    uint32_t pick = esp_random() % total;
+    for (uint8_t idx = 0; idx < profile->dst_count; idx++)
+    {
+        if (pick < profile->dsts[idx].count)
+        {
+            return profile->dsts[idx].first + pick;
+        }
+        pick -= profile->dsts[idx].count;
+    }
+    return profile->dsts[0].first;
+}
+
+static uint32_t traffic_interval_us(const ieee802154_traffic_profile_t *profile)
+{
+    if (profile->mode == IEEE802154_TRAFFIC_POISSON)
+    {
+        // Exponential inter-arrival time, the uniform sample is in (0, 1] so the logarithm is finite
+        float uniform = ((float)esp_random() + 1.0f) / 4294967296.0f;
+        return (uint32_t)(-logf(uniform) * 1000000.0f / profile->rate);
+    }
+    return 1000000 / profile->rate;
+}
+
+static void traffic_tx_done(const uint8_t *frame, const ieee802154_tx_result_t *result, void *arg)
+{
+    if (result->error == ESP_IEEE802154_TX_ERR_NONE)
+    {
+        tx_stats.sent += 1;
+        tx_stats.bytes += (uint8_t)(uintptr_t)arg;
+    }
+    else
+    {
+        tx_stats.failed += 1;
+    }
+}
+
+static void traffic_send(const ieee802154_traffic_profile_t *profile, TickType_t timeout)
+{
+    uint8_t payload[IEEE802154_TRAFFIC_MAX_PAYLOAD];
+    uint8_t frame[128];
+
+    uint8_t length = traffic_pick_size(profile);
+    uint16_t pan_id = esp_ieee802154_get_panid();
+    ieee802154_address_t dst_addr = {
+        .mode = ADDR_MODE_SHORT,
+        .short_address = traffic_pick_dst(profile),
+    };
+
+    // Only looked up, a destination range can be larger than the address book. Destinations that are not in the
+    // book (the TX engine adds the first ones it sends to) start in ACKed mode, as new destinations of the policy.
+    ieee802154_addr_id_t dst = esp_ieee802154_addr_book_find(pan_id, &dst_addr);
+    bool ack = (dst != IEEE802154_ADDR_ID_NONE) ? esp_ieee802154_ack_policy_decide(dst, profile->ack)
+                                                : (profile->ack != IEEE802154_RELIABILITY_NONE && dst_addr.short_address != 0xFFFF);
+
+    uint8_t frame_length;
+    if (profile->nodes == 0)
+    {
+        uint32_t seq = traffic_seq++;
+        uint8_t mac_seq = (uint8_t)seq;
+        traffic_fill_payload(payload, length, seq, (uint32_t)esp_timer_get_time());
+        frame_length = esp_ieee802154_create_2015_l2_data_frame(frame, pan_id, &dst_addr, payload, length, &mac_seq, ack);
+    }
+    else
+    {
+        // A random virtual node sends the frame, with its own address and sequence numbers
+        uint16_t node = esp_random() % profile->nodes;
+        ieee802154_address_t src_addr;
+        esp_ieee802154_address_offset(&profile->src, node, &src_addr);
+
+        uint32_t seq = node_seq[node]++;
+        uint8_t mac_seq = (uint8_t)seq;
+        traffic_fill_payload(payload, length, seq, (uint32_t)esp_timer_get_time());
+        frame_length = esp_ieee802154_create_2015_l2_data_frame_from(frame, pan_id, &src_addr, pan_id, &dst_addr, payload, length, &mac_seq, ack);
+    }
+
+    if (frame_length == 0)
+    {
+        tx_stats.failed += 1;
+        return;
+    }
+
+    tx_stats.generated += 1;
+    if (esp_ieee802154_tx_engine_submit(frame, true, traffic_tx_done, (void *)(uintptr_t)length, timeout) != ESP_OK)
+    {
+        tx_stats.queue_full += 1;
+    }
+}
+
+static void traffic_task(void *pvParameters)
+{
+    const ieee802154_traffic_profile_t *profile = &traffic_profile;
+    int64_t start = esp_timer_get_time();
+    int64_t next = start;
+
+    while (traffic_running)
+    {
+        int64_t now = esp_timer_get_time();
+        if (profile->duration_s > 0 && now - start >= (int64_t)profile->duration_s * 1000000)
+        {
+            break;
+        }
+
+        if (profile->mode == IEEE802154_TRAFFIC_SATURATE)
+        {
+            // Blocks while the TX queue is full, so the radio is always busy
+            traffic_send(profile, portMAX_DELAY);
+            continue;
+        }
+
+        if (profile->mode == IEEE802154_TRAFFIC_ON_OFF)
+        {
+            uint32_t phase_ms = ((now - start) / 1000) % (profile->on_ms + profile->off_ms);
+            if (phase_ms >= profile->on_ms)
+            {
+                vTaskDelay((profile->on_ms + profile->off_ms - phase_ms) / portTICK_PERIOD_MS + 1);
+                next = esp_timer_get_time();
+                continue;
+            }
+        }
+
+        /**
+         * The tick is coarse (10 ms by default), so all frames that are due are sent at once. The average rate
+         * is kept, the arrivals within a tick are bunched.
+         */
+        if (now - next > TRAFFIC_MAX_BACKLOG_US)
+        {
+            next = now;
+        }
+        while (next <= now && traffic_running)
+        {
+            traffic_send(profile, 0);
+            next += traffic_interval_us(profile);
+        }
+
+        TickType_t ticks = (next - now) / 1000 / portTICK_PERIOD_MS;
+        vTaskDelay((ticks > 0) ? ticks : 1);
+    }
+
+    ESP_LOGI(TAG, "Profile finished, %" PRIu32 " frames generated", tx_stats.generated);
+    traffic_running = false;
+    traffic_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t esp_ieee802154_traffic_start(const char *spec)
+{
+    ieee802154_traffic_profile_t profile;
+    esp_err_t err = esp_ieee802154_traffic_parse(spec, &profile);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Invalid profile: %s", spec);
+        return err;
+    }
+
+    esp_ieee802154_traffic_stop();
+
+    traffic_profile = profile;
+    strlcpy(traffic_spec, spec, sizeof(traffic_spec));
+    traffic_running = true;
+    if (xTaskCreate(traffic_task, "traffic_task", 4096, NULL, TRAFFIC_TASK_PRIORITY, &traffic_task_handle) != pdPASS)
+    {
+        traffic_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Profile started: %s", spec);
+    return ESP_OK;
+}
+
+void esp_ieee802154_traffic_stop(void)
+{
+    traffic_running = false;
+    while (traffic_task_handle != NULL)
+    {
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+}
+
+/* --- NVS --- */
+
+esp_err_t esp_ieee802154_traffic_save(const char *spec)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(TRAFFIC_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    if (spec != NULL)
+    {
+        err = nvs_set_str(handle, TRAFFIC_NVS_KEY, spec);
+    }
+    else
+    {
+        err = nvs_erase_key(handle, TRAFFIC_NVS_KEY);
+        err = (err == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : err;
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return err;
+}
+
+esp_err_t esp_ieee802154_traffic_start_saved(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(TRAFFIC_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK)
+    {
+        return ESP_ERR_NVS_NOT_FOUND; // The namespace does not exist before the first save
+    }
+
+    char spec[IEEE802154_TRAFFIC_SPEC_LENGTH];
+    size_t length = sizeof(spec);
+    err = nvs_get_str(handle, TRAFFIC_NVS_KEY, spec, &length);
+    nvs_close(handle);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    return esp_ieee802154_traffic_start(spec);
+}
+
+/* --- Verifier --- */
+
+static ieee802154_traffic_rx_stats_t *traffic_find_source(uint16_t pan_id, const ieee802154_address_t *src)
+{
+    ieee802154_addr_id_t id = esp_ieee802154_addr_book_find(pan_id, src);
+    if (id != IEEE802154_ADDR_ID_NONE && rx_source_index[id] > 0)
+    {
+        return &rx_stats[rx_source_index[id] - 1];
+    }
+    if (rx_sources >= IEEE802154_TRAFFIC_MAX_SOURCES)
+    {
+        return NULL;
+    }
+
+    // Entries are never removed from the address book, only sources that get a slot here are added
+    id = (id != IEEE802154_ADDR_ID_NONE) ? id : esp_ieee802154_addr_book_intern(pan_id, src);
+    if (id == IEEE802154_ADDR_ID_NONE)
+    {
+        return NULL;
+    }
+
+    ieee802154_traffic_rx_stats_t *stats = &rx_stats[rx_sources];
+    memset(stats, 0, sizeof(ieee802154_traffic_rx_stats_t));
+    stats->src_id = id;
+    rx_sources += 1;
+    rx_source_index[id] = rx_sources;
+    return stats;
+}
+
+bool esp_ieee802154_traffic_verify(const uint8_t *frame, int64_t rx_time_us)
+{
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) || parsed.frame_type != FRAME_TYPE_DATA ||
+        parsed.payload_length < 1 || frame[1 + parsed.header_length] != IEEE802154_TRAFFIC_DISPATCH)
+    {
+        return false;
+    }
+
+    const uint8_t *payload = &frame[1 + parsed.header_length];
+    ieee802154_traffic_rx_stats_t *stats = traffic_find_source(parsed.src_pan_id, &parsed.src_addr);
+    if (stats == NULL)
+    {
+        return true;
+    }
+
+    uint16_t checksum = payload[TRAFFIC_CHECKSUM_OFFSET] | (payload[TRAFFIC_CHECKSUM_OFFSET + 1] << 8);
+    if (parsed.payload_length < IEEE802154_TRAFFIC_HEADER_LENGTH || traffic_checksum(payload, parsed.payload_length) != checksum)
+    {
+        stats->corrupted += 1;
+        return true;
+    }
+
+    uint32_t seq = get_u32(&payload[TRAFFIC_SEQ_OFFSET]);
+    uint32_t timestamp = get_u32(&payload[TRAFFIC_TIMESTAMP_OFFSET]);
+
+    // A sender that restarts begins at 0 again, every later frame would count as reordered
+    uint32_t back = stats->next_seq - 1 - seq;
+    bool restart = stats->received > 0 && (int32_t)(seq - stats->next_seq) < 0 && back >= TRAFFIC_HISTORY_LENGTH &&
+                   (seq < TRAFFIC_HISTORY_LENGTH || back >= TRAFFIC_RESTART_GAP);
+    if (restart)
+    {
+        stats->restarts += 1;
+    }
+
+    if (stats->received == 0 || restart || (int32_t)(seq - stats->next_seq) >= 0)
+    {
+        // In order, a gap is counted as lost until the frames arrive late
+        uint32_t gap = (stats->received == 0 || restart) ? 0 : seq - stats->next_seq;
+        stats->lost += gap;
+        stats->history = (gap + 1 >= TRAFFIC_HISTORY_LENGTH) ? 1 : (stats->history << (gap + 1)) | 1;
+        stats->next_seq = seq + 1;
+    }
+    else
+    {
+        if (back < TRAFFIC_HISTORY_LENGTH && (stats->history & (1UL << back)))
+        {
+            stats->duplicates += 1;
+            return true;
+        }
+        if (back < TRAFFIC_HISTORY_LENGTH)
+        {
+            stats->history |= (1UL << back);
+        }
+        stats->reordered += 1;
+        stats->lost -= (stats->lost > 0) ? 1 : 0;
+    }
+
+    // The clocks of sender and receiver are not synchronized, delays are relative to the fastest frame
+    int32_t offset = (int32_t)((uint32_t)rx_time_us - timestamp);
+    if (stats->received == 0 || restart || offset < stats->min_offset_us)
+    {
+        stats->min_offset_us = offset;
+    }
+    uint32_t delay = offset - stats->min_offset_us;
+    stats->max_delay_us = (delay > stats->max_delay_us) ? delay : stats->max_delay_us;
+    stats->sum_delay_us += delay;
+    stats->received += 1;
+    return true;
+}
+
+void esp_ieee802154_traffic_get_tx_stats(ieee802154_traffic_tx_stats_t *stats)
+{
+    *stats = tx_stats;
+}
+
+bool esp_ieee802154_traffic_get_rx_stats(uint8_t index, ieee802154_traffic_rx_stats_t *stats)
+{
+    if (index >= rx_sources)
+    {
+        return false;
+    }
+    *stats = rx_stats[index];
+    return true;
+}
+
+/* --- Console --- */
+
+static void traffic_print_stats(void)
+{
+    printf("Generator: %s\n", traffic_running ? traffic_spec : "stopped");
+    printf("  generated %" PRIu32 ", queue full %" PRIu32 ", sent %" PRIu32 ", failed %" PRIu32 ", %" PRIu64 " bytes\n",
+           tx_stats.generated, tx_stats.queue_full, tx_stats.sent, tx_stats.failed, tx_stats.bytes);
+
+    for (uint8_t idx = 0; idx < rx_sources; idx++)
+    {
+        const ieee802154_traffic_rx_stats_t *stats = &rx_stats[idx];
+        char addr[IEEE802154_ADDRESS_TEXT_LENGTH];
+        esp_ieee802154_addr_book_format(stats->src_id, addr, sizeof(addr));
+        printf("Source %s:\n", addr);
+        printf("  received %" PRIu32 ", lost %" PRIu32 ", duplicates %" PRIu32 ", reordered %" PRIu32 ", corrupted %" PRIu32 ", restarts %" PRIu32 "\n",
+               stats->received, stats->lost, stats->duplicates, stats->reordered, stats->corrupted, stats->restarts);
+        printf("  relative delay avg %" PRIu64 " us, max %" PRIu32 " us\n",
+               (stats->received > 0) ? stats->sum_delay_us / stats->received : 0, stats->max_delay_us);
+    }
+}
+
+static int traffic_command(int argc, char **argv)
+{
+    // The profile is passed as separate arguments by the console, join them again
+    char spec[IEEE802154_TRAFFIC_SPEC_LENGTH] = "";
+    for (int idx = 2; idx < argc; idx++)
+    {
+        if (idx > 2)
+        {
+            strlcat(spec, " ", sizeof(spec));
+        }
+        strlcat(spec, argv[idx], sizeof(spec));
+    }
+
+    esp_err_t err = ESP_OK;
+    if (argc >= 3 && strcmp(argv[1], "start") == 0)
+    {
+        err = esp_ieee802154_traffic_start(spec);
+    }
+    else if (argc == 2 && strcmp(argv[1], "stop") == 0)
+    {
+        esp_ieee802154_traffic_stop();
+    }
+    else if (argc >= 2 && strcmp(argv[1], "save") == 0)
+    {
+        ieee802154_traffic_profile_t profile;
+        const char *saved = (argc >= 3) ? spec : traffic_spec;
+        err = esp_ieee802154_traffic_parse(saved, &profile);
+        if (err == ESP_OK)
+        {
+            err = esp_ieee802154_traffic_save(saved);
+        }
+    }
+    else if (argc == 2 && strcmp(argv[1], "clear") == 0)
+    {
+        err = esp_ieee802154_traffic_save(NULL);
+    }
+    else if (argc == 2 && strcmp(argv[1], "stats") == 0)
+    {
+        traffic_print_stats();
+    }
+    else if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        memset(&tx_stats, 0, sizeof(tx_stats));
+        memset(rx_source_index, 0, sizeof(rx_source_index));
+        rx_sources = 0;
+    }
+    else
+    {
+        printf("Usage: traffic start <profile> | stop | save [profile] | clear | stats | reset\n");
+        return 1;
+    }
+
+    if (err != ESP_OK)
+    {
+        printf("Failed: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_traffic_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "traffic",
+        .help = "Traffic generator, e.g. 'traffic start mode=poisson rate=50 size=20:3,64-110:1 dst=0x0002 ack=normal duration=60'",
+        .hint = "start <profile> | stop | save [profile] | clear | stats | reset",
+        .func = &traffic_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,333 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_window.h"
+#include "ieee802154_transport.h"
+
+#define TAG "ieee802154_transport"
+
+#define TRANSPORT_MAX_HANDLES    4
+#define TRANSPORT_TASK_PRIORITY  10
+#define TRANSPORT_ACK_DELAY_MS   5  // Delay of an ACK if neither a gap nor window / 2 segments have been received
+
+struct ieee802154_transport {
+    bool sender;
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t space;        // Given when an ACK frees window slots (sender)
+    TaskHandle_t task;
+    uint16_t peer_pan_id;
+    ieee802154_address_t peer_addr; // Destination (sender) or source (receiver)
+    uint8_t max_segment;
+    uint8_t seq_nr;                 // MAC sequence number
+    uint32_t acks;                  // ACKs sent (receiver)
+    ieee802154_window_deliver_cb_t deliver;
+    void *arg;
+    union {
+        ieee802154_window_tx_t tx;
+        ieee802154_window_rx_t rx;
+    };
+};
+
+static struct ieee802154_transport *transports[TRANSPORT_MAX_HANDLES];
+
+/* --- Common --- */
+
+static void transport_transmit(struct ieee802154_transport *transport, uint8_t *payload, uint8_t length)
+{
+    uint8_t frame[128];
+
+    /**
+     * The transport acknowledges the segments itself, a MAC ACK request would bring back stop-and-wait.
+     * esp_ieee802154_tx_engine_transmit() waits on a semaphore of its own, so the wake-ups of the transport
+     * tasks (task notifications) can not end the wait early.
+     */
+    transport->seq_nr += 1;
+    if (esp_ieee802154_create_2015_l2_data_frame(frame, transport->peer_pan_id, &transport->peer_addr, payload, length, &transport->seq_nr, false) > 0)
+    {
+        esp_ieee802154_tx_engine_transmit(frame, true, NULL, portMAX_DELAY);
+    }
+}
+
+static void transport_destroy(struct ieee802154_transport *transport)
+{
+    for (uint8_t idx = 0; idx < TRANSPORT_MAX_HANDLES; idx++)
+    {
+        if (transports[idx] == transport)
+        {
+            transports[idx] = NULL;
+        }
+    }
+    if (transport->lock != NULL)
+    {
+        vSemaphoreDelete(transport->lock);
+    }
+    if (transport->space != NULL)
+    {
+        vSemaphoreDelete(transport->space);
+    }
+    free(transport);
+}
+
+static esp_err_t transport_create(bool sender, uint16_t pan_id, const ieee802154_address_t *addr, struct ieee802154_transport **handle)
+{
+    for (uint8_t idx = 0; idx < TRANSPORT_MAX_HANDLES; idx++)
+    {
+        if (transports[idx] != NULL)
+        {
+            continue;
+        }
+
+        struct ieee802154_transport *transport = calloc(1, sizeof(struct ieee802154_transport));
+        if (transport == NULL)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        transport->lock = xSemaphoreCreateMutex();
+        transport->space = xSemaphoreCreateBinary();
+        if (transport->lock == NULL || transport->space == NULL)
+        {
+            transport_destroy(transport);
+            return ESP_ERR_NO_MEM;
+        }
+        transport->sender = sender;
+        transport->peer_pan_id = pan_id;
+        transport->peer_addr = *addr;
+
+        transports[idx] = transport;
+        *handle = transport;
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+/* --- Sender --- */
+
+static void transport_tx_task(void *pvParameters)
+{
+    struct ieee802154_transport *transport = pvParameters;
+    uint8_t payload[IEEE802154_MAX_PSDU_LENGTH];
+
+    while (1)
+    {
+        xSemaphoreTake(transport->lock, portMAX_DELAY);
+        uint32_t now = (uint32_t)esp_timer_get_time();
+        uint8_t length = esp_ieee802154_window_tx_poll(&transport->tx, now, payload);
+        uint32_t timeout = esp_ieee802154_window_tx_next_timeout(&transport->tx, now);
+        xSemaphoreGive(transport->lock);
+
+        if (length > 0)
+        {
+            transport_transmit(transport, payload, length);
+            continue;
+        }
+
+        // Sleep until new segments are enqueued, an ACK arrives or the next retransmission timeout expires
+        ulTaskNotifyTake(pdTRUE, (timeout == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout / 1000) + 1);
+    }
+}
+
+esp_err_t esp_ieee802154_transport_open(uint16_t dst_pan_id, const ieee802154_address_t *dst_addr, uint8_t window,
+                                        uint32_t rto_ms, ieee802154_transport_handle_t *handle)
+{
+    struct ieee802154_transport *transport;
+    esp_err_t err = transport_create(true, dst_pan_id, dst_addr, &transport);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    esp_ieee802154_window_tx_init(&transport->tx, window, rto_ms * 1000);
+
+    // The header length depends on the addressing, create an empty frame to get it
+    uint8_t frame[128];
+    uint8_t header_length = esp_ieee802154_create_2015_l2_data_frame(frame, dst_pan_id, &transport->peer_addr, frame, 0, &transport->seq_nr, false) - 2;
+    transport->max_segment = IEEE802154_MAX_PSDU_LENGTH - 2 - header_length - IEEE802154_WINDOW_HEADER_LENGTH;
+
+    if (xTaskCreate(transport_tx_task, "transport_tx_task", 4096, transport, TRANSPORT_TASK_PRIORITY, &transport->task) != pdPASS)
+    {
+        transport_destroy(transport);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Transport opened, window %d, %d bytes per segment", transport->tx.window, transport->max_segment);
+    *handle = transport;
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_transport_send(ieee802154_transport_handle_t handle, const void *data, uint8_t length, TickType_t timeout)
+{
+    if (length > handle->max_segment)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    TimeOut_t start;
+    vTaskSetTimeOutState(&start);
+
+    while (1)
+    {
+        xSemaphoreTake(handle->lock, portMAX_DELAY);
+        bool enqueued = esp_ieee802154_window_tx_enqueue(&handle->tx, data, length);
+        xSemaphoreGive(handle->lock);
+
+        if (enqueued)
+        {
+            xTaskNotifyGive(handle->task);
+            return ESP_OK;
+        }
+        if (xTaskCheckForTimeOut(&start, &timeout) == pdTRUE || xSemaphoreTake(handle->space, timeout) != pdTRUE)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+esp_err_t esp_ieee802154_transport_flush(ieee802154_transport_handle_t handle, TickType_t timeout)
+{
+    TimeOut_t start;
+    vTaskSetTimeOutState(&start);
+
+    while (1)
+    {
+        xSemaphoreTake(handle->lock, portMAX_DELAY);
+        uint8_t in_flight = esp_ieee802154_window_tx_in_flight(&handle->tx);
+        xSemaphoreGive(handle->lock);
+
+        if (in_flight == 0)
+        {
+            return ESP_OK;
+        }
+        if (xTaskCheckForTimeOut(&start, &timeout) == pdTRUE || xSemaphoreTake(handle->space, timeout) != pdTRUE)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
+
+uint8_t esp_ieee802154_transport_max_segment(ieee802154_transport_handle_t handle)
+{
+    return handle->max_segment;
+}
+
+/* --- Receiver --- */
+
+static void transport_rx_task(void *pvParameters)
+{
+    struct ieee802154_transport *transport = pvParameters;
+    uint8_t payload[IEEE802154_WINDOW_ACK_LENGTH];
+    bool pending = false;
+
+    while (1)
+    {
+        // Every received segment notifies the task, the ACK delay starts at the last segment
+        bool notified = ulTaskNotifyTake(pdTRUE, pending ? pdMS_TO_TICKS(TRANSPORT_ACK_DELAY_MS) : portMAX_DELAY) > 0;
+
+        xSemaphoreTake(transport->lock, portMAX_DELAY);
+        uint8_t length = 0;
+        if (transport->rx.ack_now || (!notified && transport->rx.unacked > 0))
+        {
+            length = esp_ieee802154_window_rx_build_ack(&transport->rx, payload);
+        }
+        pending = (transport->rx.unacked > 0);
+        xSemaphoreGive(transport->lock);
+
+        if (length > 0)
+        {
+            transport_transmit(transport, payload, length);
+            transport->acks += 1;
+        }
+    }
+}
+
+esp_err_t esp_ieee802154_transport_listen(uint16_t src_pan_id, const ieee802154_address_t *src_addr, uint8_t window,
+                                          ieee802154_window_deliver_cb_t deliver, void *arg, ieee802154_transport_handle_t *handle)
+{
+    struct ieee802154_transport *transport;
+    esp_err_t err = transport_create(false, src_pan_id, src_addr, &transport);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    esp_ieee802154_window_rx_init(&transport->rx, window);
+    transport->deliver = deliver;
+    transport->arg = arg;
+
+    if (xTaskCreate(transport_rx_task, "transport_rx_task", 4096, transport, TRANSPORT_TASK_PRIORITY, &transport->task) != pdPASS)
+    {
+        transport_destroy(transport);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *handle = transport;
+    return ESP_OK;
+}
+
+/* --- Input --- */
+
+bool esp_ieee802154_transport_input(const uint8_t *frame)
+{
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) || parsed.frame_type != FRAME_TYPE_DATA ||
+        parsed.payload_length < 2 || frame[1 + parsed.header_length] != IEEE802154_WINDOW_DISPATCH)
+    {
+        return false;
+    }
+
+    const uint8_t *payload = &frame[1 + parsed.header_length];
+    bool data = (payload[1] == IEEE802154_WINDOW_TYPE_DATA);
+
+    for (uint8_t idx = 0; idx < TRANSPORT_MAX_HANDLES; idx++)
+    {
+        struct ieee802154_transport *transport = transports[idx];
+        // Without a task, the transport is still being opened
+        if (transport == NULL || transport->task == NULL || transport->sender == data || transport->peer_pan_id != parsed.src_pan_id ||
+            !esp_ieee802154_address_equal(&transport->peer_addr, &parsed.src_addr))
+        {
+            continue;
+        }
+
+        xSemaphoreTake(transport->lock, portMAX_DELAY);
+        if (data)
+        {
+            esp_ieee802154_window_rx_input(&transport->rx, payload, parsed.payload_length, transport->deliver, transport->arg);
+        }
+        else if (esp_ieee802154_window_tx_ack(&transport->tx, payload, parsed.payload_length) > 0)
+        {
+            xSemaphoreGive(transport->space);
+        }
+        xSemaphoreGive(transport->lock);
+
+        // The sender may retransmit missing segments, the receiver restarts the ACK delay
+        xTaskNotifyGive(transport->task);
+        return true;
+    }
+    return false;
+}
+
+void esp_ieee802154_transport_get_stats(ieee802154_transport_handle_t handle, ieee802154_transport_stats_t *stats)
+{
+    xSemaphoreTake(handle->lock, portMAX_DELAY);
+    if (handle->sender)
+    {
+        stats->transmissions = handle->tx.transmissions;
+        stats->retransmissions = handle->tx.retransmissions;
+        stats->delivered = 0;
+        stats->duplicates = 0;
+    }
+    else
+    {
+        stats->transmissions = handle->acks;
+        stats->retransmissions = 0;
+        stats->delivered = handle->rx.delivered;
+        stats->duplicates = handle->rx.duplicates;
+    }
+    xSemaphoreGive(handle->lock);
+}
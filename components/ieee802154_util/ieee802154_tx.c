@@ -0,0 +1,399 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <esp_ieee802154.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_tx_latency.h"
+#include "ieee802154_power.h"
+#include "ieee802154_ack_policy.h"
+#include "ieee802154_channel.h"
+
+#define TAG "ieee802154_tx"
+
+#define TX_ENGINE_TIMEOUT_MS 100 // Upper bound for CCA, transmission and ACK wait
+#define TX_ENGINE_MAX_NEW_DESTINATIONS IEEE802154_POWER_MAX_DESTINATIONS // As many as the power table holds
+
+typedef struct {
+    const uint8_t *frame;     // A buffer of the pool, or the buffer of the submitter if queued by reference
+    uint8_t *pooled;          // The pool buffer to give back once the frame is done, NULL if queued by reference
+    bool cca;
+    int64_t submit_us;
+    ieee802154_tx_done_cb_t cb;
+    void *arg;
+} tx_job_t;
+
+typedef struct {
+    SemaphoreHandle_t done;
+    ieee802154_tx_result_t *result;
+} tx_waiter_t;
+
+static QueueHandle_t tx_queue = NULL;
+static QueueHandle_t tx_pool = NULL; // Free frame buffers for esp_ieee802154_tx_engine_submit()
+static TaskHandle_t tx_task = NULL;
+static SemaphoreHandle_t tx_radio_lock = NULL; // Held by the engine while a frame is on air, and while paused
+static ieee802154_tx_result_t tx_result; // Written in ISR context while a frame is in flight
+static const uint8_t *volatile tx_frame = NULL; // Frame in flight, callbacks of other frames are ignored
+static portMUX_TYPE tx_lock = portMUX_INITIALIZER_UNLOCKED; // Protects tx_frame
+static int8_t tx_power = IEEE802154_POWER_NOMINAL_DBM; // Power the radio is set to
+static uint16_t tx_new_destinations = 0; // Destinations the engine added to the address book
+
+/* --- ISR Context (Radio callbacks) --- */
+
+/**
+ * Frame buffers are reused (pool buffers by the next jobs, buffers queued by reference by their owners), so the
+ * frame pointer alone does not tell a late callback of a timed out frame from the callback of the current one.
+ * The outcome is taken once: the first callback of the frame in flight disarms tx_frame, and the engine disarms
+ * it on a timeout before the buffer is reused.
+ */
+static IEEE802154_ISR_ATTR bool tx_engine_take_outcome(const uint8_t *frame)
+{
+    portENTER_CRITICAL_ISR(&tx_lock);
+    bool in_flight = (frame == tx_frame);
+    if (in_flight)
+    {
+        tx_frame = NULL;
+    }
+    portEXIT_CRITICAL_ISR(&tx_lock);
+    return in_flight;
+}
+
+IEEE802154_ISR_ATTR bool esp_ieee802154_tx_engine_busy(void)
+{
+    return tx_frame != NULL;
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_tx_engine_transmit_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info)
+{
+    // Frames sent outside the engine (e.g. the software ACKs of the address table) and late callbacks
+    if (!tx_engine_take_outcome(frame))
+    {
+        return;
+    }
+
+    tx_result.timing.done_us = esp_timer_get_time();
+    tx_result.error = ESP_IEEE802154_TX_ERR_NONE;
+    tx_result.acked = (ack != NULL);
+    esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_DONE);
+    if (ack != NULL)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_ACKED);
+        memcpy(tx_result.ack, ack, ack[0] + 1);
+        tx_result.ack_rssi = ack_frame_info->rssi;
+        tx_result.ack_lqi = ack_frame_info->lqi;
+        tx_result.timing.ack_us = (ack_frame_info->timestamp != 0) ? (int64_t)ack_frame_info->timestamp : tx_result.timing.done_us;
+    }
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (tx_task != NULL)
+    {
+        vTaskNotifyGiveFromISR(tx_task, &higher_priority_task_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_tx_engine_transmit_failed(const uint8_t *frame, esp_ieee802154_tx_error_t error)
+{
+    if (!tx_engine_take_outcome(frame))
+    {
+        return;
+    }
+
+    tx_result.timing.done_us = esp_timer_get_time();
+    tx_result.error = error;
+    tx_result.acked = false;
+
+    switch (error)
+    {
+    case ESP_IEEE802154_TX_ERR_NO_ACK:
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_NO_ACK);
+        break;
+    case ESP_IEEE802154_TX_ERR_CCA_BUSY:
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_CCA_BUSY);
+        break;
+    case ESP_IEEE802154_TX_ERR_ABORT:
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_ABORTED);
+        break;
+    default:
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_FAILED);
+        break;
+    }
+
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    if (tx_task != NULL)
+    {
+        vTaskNotifyGiveFromISR(tx_task, &higher_priority_task_woken);
+    }
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+/* --- TX engine --- */
+
+static void tx_engine_set_power(int8_t power)
+{
+    if (power != tx_power)
+    {
+        esp_ieee802154_set_txpower(power);
+        tx_power = power;
+    }
+}
+
+/**
+ * Address book id of the destination of a frame. The power, latency and ACK policy state is kept per id, but a
+ * destination that is not in the book yet is only added while the tables can still take it. Otherwise frames
+ * to many destinations (e.g. the traffic generator) would fill the book that the mesh and the RX statistics use.
+ */
+static ieee802154_addr_id_t tx_engine_destination(const uint8_t *frame)
+{
+    ieee802154_frame_t parsed;
+    if (!esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed))
+    {
+        return IEEE802154_ADDR_ID_NONE;
+    }
+
+    ieee802154_addr_id_t id = esp_ieee802154_addr_book_find(parsed.dst_pan_id, &parsed.dst_addr);
+    if (id == IEEE802154_ADDR_ID_NONE && tx_new_destinations < TX_ENGINE_MAX_NEW_DESTINATIONS)
+    {
+        id = esp_ieee802154_addr_book_intern(parsed.dst_pan_id, &parsed.dst_addr); // NONE for broadcasts
+        tx_new_destinations += (id != IEEE802154_ADDR_ID_NONE);
+    }
+    return id;
+}
+
+static void tx_engine_task(void *pvParameters)
+{
+    static tx_job_t job;
+
+    while (1)
+    {
+        if (xQueueReceive(tx_queue, &job, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        esp_ieee802154_metrics_set(IEEE802154_METRIC_TX_QUEUE, uxQueueMessagesWaiting(tx_queue));
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_FRAMES);
+        esp_ieee802154_metrics_add(IEEE802154_METRIC_TX_BYTES, job.frame[0]);
+
+        tx_result.error = ESP_IEEE802154_TX_ERR_NONE;
+        tx_result.acked = false;
+        tx_result.timing.submit_us = job.submit_us;
+        tx_result.timing.ack_us = 0;
+        ulTaskNotifyTake(pdTRUE, 0); // Drop a stale notification
+
+        ieee802154_addr_id_t dst = tx_engine_destination(job.frame);
+        xSemaphoreTake(tx_radio_lock, portMAX_DELAY);
+        tx_result.power_dbm = esp_ieee802154_power_select(dst);
+        tx_engine_set_power(tx_result.power_dbm);
+
+        portENTER_CRITICAL(&tx_lock);
+        tx_frame = job.frame;
+        portEXIT_CRITICAL(&tx_lock);
+        tx_result.timing.start_us = esp_timer_get_time();
+        if (esp_ieee802154_transmit(job.frame, job.cca) != ESP_OK)
+        {
+            tx_engine_take_outcome(job.frame);
+            tx_result.error = ESP_IEEE802154_TX_ERR_ABORT;
+            tx_result.timing.done_us = esp_timer_get_time();
+        }
+        else if (ulTaskNotifyTake(pdTRUE, TX_ENGINE_TIMEOUT_MS / portTICK_PERIOD_MS) == 0)
+        {
+            if (tx_engine_take_outcome(job.frame))
+            {
+                // A frame that another radio operation (transmit, receive, channel) has aborted is not always
+                // reported by the driver, the radio is no longer transmitting then
+                bool aborted = (esp_ieee802154_get_state() != ESP_IEEE802154_RADIO_TRANSMIT);
+                if (aborted)
+                {
+                    ESP_LOGW(TAG, "Frame aborted by another radio operation");
+                }
+                else
+                {
+                    ESP_LOGW(TAG, "No transmit event within %d ms", TX_ENGINE_TIMEOUT_MS);
+                }
+                // Stop the radio, so it does not report (or send) the frame once its buffer is reused
+                esp_ieee802154_receive();
+                esp_ieee802154_metrics_inc(aborted ? IEEE802154_METRIC_TX_ABORTED : IEEE802154_METRIC_TX_TIMEOUT);
+                tx_result.error = ESP_IEEE802154_TX_ERR_ABORT;
+                tx_result.acked = false;
+                tx_result.timing.done_us = esp_timer_get_time();
+            }
+            else
+            {
+                // The outcome arrived right after the timeout
+                ulTaskNotifyTake(pdTRUE, 0);
+            }
+        }
+
+        // The hardware ACKs of received frames are sent with the nominal power, the peers estimate their
+        // path loss to this node from it
+        tx_engine_set_power(IEEE802154_POWER_NOMINAL_DBM);
+        xSemaphoreGive(tx_radio_lock);
+        esp_ieee802154_power_update(dst, &tx_result);
+        esp_ieee802154_ack_policy_update(dst, job.frame, &tx_result);
+        esp_ieee802154_channel_update(job.frame, &tx_result);
+        esp_ieee802154_tx_latency_record(dst, &tx_result);
+        if (job.cb != NULL)
+        {
+            job.cb(job.frame, &tx_result, job.arg);
+        }
+        if (job.pooled != NULL)
+        {
+            xQueueSend(tx_pool, &job.pooled, 0);
+        }
+    }
+}
+
+esp_err_t esp_ieee802154_tx_engine_start(uint8_t queue_length, UBaseType_t priority)
+{
+    if (tx_queue != NULL)
+    {
+        return ESP_OK;
+    }
+
+    tx_radio_lock = xSemaphoreCreateMutex();
+    if (tx_radio_lock == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    // One buffer more than queued jobs, the frame in flight keeps its buffer until its callback returns
+    uint8_t (*buffers)[128] = malloc((queue_length + 1) * sizeof(*buffers));
+    tx_pool = xQueueCreate(queue_length + 1, sizeof(uint8_t *));
+    tx_queue = xQueueCreate(queue_length, sizeof(tx_job_t));
+    if (buffers == NULL || tx_pool == NULL || tx_queue == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t idx = 0; idx <= queue_length; idx++)
+    {
+        uint8_t *buffer = buffers[idx];
+        xQueueSend(tx_pool, &buffer, 0);
+    }
+    if (xTaskCreate(tx_engine_task, "tx_engine_task", 4096, NULL, priority, &tx_task) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t tx_engine_queue(const tx_job_t *job, TickType_t timeout)
+{
+    if (xQueueSend(tx_queue, job, timeout) != pdTRUE)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_QUEUE_FULL);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    UBaseType_t queued = uxQueueMessagesWaiting(tx_queue);
+    esp_ieee802154_metrics_set(IEEE802154_METRIC_TX_QUEUE, queued);
+    esp_ieee802154_metrics_max(IEEE802154_METRIC_TX_QUEUE_MAX, queued);
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_tx_engine_submit(const uint8_t *frame, bool cca, ieee802154_tx_done_cb_t cb, void *arg, TickType_t timeout)
+{
+    if (frame[0] > IEEE802154_MAX_PSDU_LENGTH)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    TimeOut_t deadline;
+    vTaskSetTimeOutState(&deadline);
+    uint8_t *buffer;
+    if (xQueueReceive(tx_pool, &buffer, timeout) != pdTRUE)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_QUEUE_FULL);
+        return ESP_ERR_TIMEOUT;
+    }
+    memcpy(buffer, frame, frame[0] + 1);
+
+    tx_job_t job = {
+        .frame = buffer,
+        .pooled = buffer,
+        .cca = cca,
+        .submit_us = esp_timer_get_time(),
+        .cb = cb,
+        .arg = arg,
+    };
+    // Jobs queued by reference hold no pool buffer, so the queue can be full while a buffer is free
+    xTaskCheckForTimeOut(&deadline, &timeout); // Sets the remaining time, 0 once it expired
+    esp_err_t err = tx_engine_queue(&job, timeout);
+    if (err != ESP_OK)
+    {
+        xQueueSend(tx_pool, &buffer, 0);
+    }
+    return err;
+}
+
+esp_err_t esp_ieee802154_tx_engine_submit_ref(const uint8_t *frame, bool cca, ieee802154_tx_done_cb_t cb, void *arg, TickType_t timeout)
+{
+    if (frame[0] > IEEE802154_MAX_PSDU_LENGTH)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    tx_job_t job = {
+        .frame = frame,
+        .pooled = NULL,
+        .cca = cca,
+        .submit_us = esp_timer_get_time(),
+        .cb = cb,
+        .arg = arg,
+    };
+    return tx_engine_queue(&job, timeout);
+}
+
+void esp_ieee802154_tx_engine_pause(void)
+{
+    if (tx_radio_lock != NULL)
+    {
+        xSemaphoreTake(tx_radio_lock, portMAX_DELAY);
+    }
+}
+
+void esp_ieee802154_tx_engine_resume(void)
+{
+    if (tx_radio_lock != NULL)
+    {
+        xSemaphoreGive(tx_radio_lock);
+    }
+}
+
+static void tx_engine_wake_waiter(const uint8_t *frame, const ieee802154_tx_result_t *result, void *arg)
+{
+    tx_waiter_t *waiter = arg;
+    if (waiter->result != NULL)
+    {
+        memcpy(waiter->result, result, sizeof(ieee802154_tx_result_t));
+    }
+    // The waiter returns (and its stack frame with it) once the semaphore is given, nothing touches it after
+    xSemaphoreGive(waiter->done);
+}
+
+esp_err_t esp_ieee802154_tx_engine_transmit(const uint8_t *frame, bool cca, ieee802154_tx_result_t *result, TickType_t timeout)
+{
+    ieee802154_tx_result_t local_result;
+    StaticSemaphore_t done_buffer;
+    tx_waiter_t waiter = {
+        .done = xSemaphoreCreateBinaryStatic(&done_buffer),
+        .result = result != NULL ? result : &local_result,
+    };
+
+    // The frame stays valid until the engine is done with it, no copy needed
+    esp_err_t err = esp_ieee802154_tx_engine_submit_ref(frame, cca, tx_engine_wake_waiter, &waiter, timeout);
+    if (err == ESP_OK)
+    {
+        // The engine always reports the outcome, either from the radio or after its own timeout
+        xSemaphoreTake(waiter.done, portMAX_DELAY);
+        err = waiter.result->error == ESP_IEEE802154_TX_ERR_NONE ? ESP_OK : ESP_FAIL;
+    }
+    vSemaphoreDelete(waiter.done);
+    return err;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_console.h>
+#include <freertos/FreeRTOS.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_tx_latency.h"
+
+#define TAG "ieee802154_tx_latency"
+
+typedef struct {
+    ieee802154_addr_id_t id;
+    ieee802154_tx_latency_t latency;
+} tx_latency_destination_t;
+
+static tx_latency_destination_t destinations[IEEE802154_TX_LATENCY_MAX_DESTINATIONS];
+static uint8_t destination_count = 0;
+static uint8_t destination_index[IEEE802154_ADDR_BOOK_MAX]; // Index + 1 in destinations by address book id, 0 if none
+static portMUX_TYPE latency_lock = portMUX_INITIALIZER_UNLOCKED; // Protects the histograms
+
+/* --- Histograms --- */
+
+static uint32_t tx_latency_span(int64_t from_us, int64_t to_us)
+{
+    int64_t span = to_us - from_us;
+    if (span < 0)
+    {
+        return 0;
+    }
+    return (span > UINT32_MAX) ? UINT32_MAX : (uint32_t)span;
+}
+
+static ieee802154_tx_latency_t *tx_latency_find(ieee802154_addr_id_t id)
+{
+    if (destination_index[id] > 0)
+    {
+        return &destinations[destination_index[id] - 1].latency;
+    }
+    if (destination_count >= IEEE802154_TX_LATENCY_MAX_DESTINATIONS)
+    {
+        return NULL;
+    }
+
+    tx_latency_destination_t *destination = &destinations[destination_count];
+    memset(destination, 0, sizeof(tx_latency_destination_t));
+    destination->id = id;
+    destination_count += 1;
+    destination_index[id] = destination_count;
+    return &destination->latency;
+}
+
+void esp_ieee802154_tx_latency_record(ieee802154_addr_id_t dst, const ieee802154_tx_result_t *result)
+{
+    if (dst == IEEE802154_ADDR_ID_NONE)
+    {
+        return; // Broadcast, no destination address or the address book is full
+    }
+
+    const ieee802154_tx_timing_t *timing = &result->timing;
+    portENTER_CRITICAL(&latency_lock);
+    ieee802154_tx_latency_t *latency = tx_latency_find(dst);
+    if (latency != NULL)
+    {
+        esp_ieee802154_histogram_add(&latency->queue, tx_latency_span(timing->submit_us, timing->start_us));
+        if (result->error == ESP_IEEE802154_TX_ERR_NONE)
+        {
+            esp_ieee802154_histogram_add(&latency->round_trip, tx_latency_span(timing->start_us, timing->done_us));
+        }
+        else
+        {
+            esp_ieee802154_histogram_add(&latency->failed, tx_latency_span(timing->start_us, timing->done_us));
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+bool esp_ieee802154_tx_latency_get(ieee802154_addr_id_t id, ieee802154_tx_latency_t *latency)
+{
+    if (id >= IEEE802154_ADDR_BOOK_MAX)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&latency_lock);
+    bool found = (destination_index[id] > 0);
+    if (found)
+    {
+        *latency = destinations[destination_index[id] - 1].latency;
+    }
+    portEXIT_CRITICAL(&latency_lock);
+    return found;
+}
+
+void esp_ieee802154_tx_latency_reset(void)
+{
+    portENTER_CRITICAL(&latency_lock);
+    memset(destination_index, 0, sizeof(destination_index));
+    destination_count = 0;
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+/* --- Console --- */
+
+static void tx_latency_print(void)
+{
+    static ieee802154_tx_latency_t latency; // Too large for the console task stack
+    char addr[IEEE802154_ADDRESS_TEXT_LENGTH];
+
+    portENTER_CRITICAL(&latency_lock);
+    uint8_t count = destination_count;
+    portEXIT_CRITICAL(&latency_lock);
+
+    if (count == 0)
+    {
+        printf("No frames recorded\n");
+        return;
+    }
+
+    for (uint8_t idx = 0; idx < count; idx++)
+    {
+        portENTER_CRITICAL(&latency_lock);
+        ieee802154_addr_id_t id = destinations[idx].id;
+        latency = destinations[idx].latency;
+        portEXIT_CRITICAL(&latency_lock);
+
+        esp_ieee802154_addr_book_format(id, addr, sizeof(addr));
+        printf("To %s, queue:\n", addr);
+        esp_ieee802154_histogram_print(&latency.queue, "  ", "us");
+        printf("To %s, round trip:\n", addr);
+        esp_ieee802154_histogram_print(&latency.round_trip, "  ", "us");
+        printf("To %s, failed:\n", addr);
+        esp_ieee802154_histogram_print(&latency.failed, "  ", "us");
+    }
+}
+
+static int tx_latency_command(int argc, char **argv)
+{
+    if (argc == 1)
+    {
+        tx_latency_print();
+    }
+    else if (argc == 2 && strcmp(argv[1], "reset") == 0)
+    {
+        esp_ieee802154_tx_latency_reset();
+    }
+    else
+    {
+        printf("Usage: txtime [reset]\n");
+        return 1;
+    }
+    return 0;
+}
+
+esp_err_t esp_ieee802154_tx_latency_register_console(void)
+{
+    const esp_console_cmd_t command = {
+        .command = "txtime",
+        .help = "TX latency per destination: queue, round trip (with ACK) and failed transmissions",
+        .hint = "[reset]",
+        .func = &tx_latency_command,
+    };
+    return esp_console_cmd_register(&command);
+}
@@ -0,0 +1,321 @@
+#include <string.h>
+#include <stdbool.h>
+#include <esp_ieee802154.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_ack_payload.h"
+#include "ieee802154_metrics.h"
+
+#define TAG "ieee802154"
+
+/* --- IEEE802154 utility functions --- */
+
+uint8_t frame[128];
+
+void esp_ieee802154_get_source_address(uint16_t *src_pan_id, ieee802154_address_t *src_addr)
+{
+    *src_pan_id = esp_ieee802154_get_panid();
+    uint16_t src_addr_short = esp_ieee802154_get_short_address();
+
+    // Check if the short source address is available (0xffff is the value if the short adrress is not set)
+    if (src_addr_short == 0xffff)
+    {
+        uint8_t ext_addr[8];
+        esp_ieee802154_get_extended_address(ext_addr);
+        src_addr->mode = ADDR_MODE_LONG;
+        src_addr->long_address = esp_ieee802154_ext_address_read(ext_addr);
+    }
+    else
+    {
+        src_addr->mode = ADDR_MODE_SHORT;
+        src_addr->short_address = src_addr_short;
+    }
+}
+
+static uint8_t create_l2_data_frame(uint8_t version, uint8_t *frame, uint16_t src_pan_id, ieee802154_address_t *src_addr, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack)
+{
+    memset(frame, 0, 127);
+    /* Create the header of the frame*/
+    uint8_t hdr_len;
+    if (version == FRAME_VERSION_STD_2003)
+    {
+        hdr_len = esp_ieee802154_create_2003_data_header(&dst_pan_id, dst_addr, &src_pan_id, src_addr, seq_nr, ack, &frame[1]);
+    }
+    else
+    {
+        hdr_len = esp_ieee802154_create_2015_data_header(&dst_pan_id, dst_addr, &src_pan_id, src_addr, seq_nr, ack, &frame[1]);
+    }
+
+    if (hdr_len + data_length + 2 > IEEE802154_MAX_PSDU_LENGTH)
+    {
+        ESP_LOGE(TAG, "Payload of %d bytes does not fit into the frame.", data_length);
+        return 0;
+    }
+
+    /* Copy the payload to the frame */
+    memcpy(&frame[hdr_len + 1], data, data_length);
+
+    /* Set the length of the frame */
+    frame[0] = hdr_len + data_length + 2; // FCS included
+
+    return frame[0];
+}
+
+uint8_t esp_ieee802154_create_2003_l2_data_frame(uint8_t *frame, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack)
+{
+    ieee802154_address_t src_addr;
+    uint16_t src_pan_id;
+    esp_ieee802154_get_source_address(&src_pan_id, &src_addr);
+
+    return create_l2_data_frame(FRAME_VERSION_STD_2003, frame, src_pan_id, &src_addr, dst_pan_id, dst_addr, data, data_length, seq_nr, ack);
+}
+
+uint8_t esp_ieee802154_create_2015_l2_data_frame(uint8_t *frame, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack)
+{
+    ieee802154_address_t src_addr;
+    uint16_t src_pan_id;
+    esp_ieee802154_get_source_address(&src_pan_id, &src_addr);
+
+    return create_l2_data_frame(FRAME_VERSION_STD_2015, frame, src_pan_id, &src_addr, dst_pan_id, dst_addr, data, data_length, seq_nr, ack);
+}
+
+uint8_t esp_ieee802154_create_2015_l2_data_frame_from(uint8_t *frame, uint16_t src_pan_id, ieee802154_address_t *src_addr, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack)
+{
+    return create_l2_data_frame(FRAME_VERSION_STD_2015, frame, src_pan_id, src_addr, dst_pan_id, dst_addr, data, data_length, seq_nr, ack);
+}
+
+void esp_ieee802154_send_2003_l2_data_frame(uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack)
+{
+    if (esp_ieee802154_create_2003_l2_data_frame(frame, dst_pan_id, dst_addr, data, data_length, seq_nr, ack) > 0)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_FRAMES);
+        esp_ieee802154_metrics_add(IEEE802154_METRIC_TX_BYTES, frame[0]);
+        esp_ieee802154_transmit(frame, true); // Always do CCA!
+    }
+}
+
+void esp_ieee802154_send_2015_l2_data_frame(uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack)
+{
+    if (esp_ieee802154_create_2015_l2_data_frame(frame, dst_pan_id, dst_addr, data, data_length, seq_nr, ack) > 0)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_TX_FRAMES);
+        esp_ieee802154_metrics_add(IEEE802154_METRIC_TX_BYTES, frame[0]);
+        esp_ieee802154_transmit(frame, true); // Always do CCA!
+    }
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_create_2015_ack_frame(uint8_t *frame, uint8_t *enhack_frame)
+{
+    uint8_t position = 1; // Exclude the frame length
+    uint8_t ack_dst_addr_position = 0;
+
+    /* Modify the frame control field for the ACK and copy it in the ACK frame */
+    ieee802154_fcf_t *fcf = (ieee802154_fcf_t *)&frame[position];
+    ieee802154_fcf_t ack_fcf = {
+        .frame_type = FRAME_TYPE_ACK,
+        .secure = false,
+        .frame_pending = false,
+        .ack_request = false,
+        .pan_id_compression = fcf->pan_id_compression,
+        .reserved = false,
+        .sequence_number_suppression = fcf->sequence_number_suppression,
+        .information_elements_present = false,
+        .dst_addr_mode = fcf->src_addr_mode,
+        .frame_ver = FRAME_VERSION_STD_2015,
+        .src_addr_mode = fcf->dst_addr_mode
+    };
+    uint8_t *ack_byte_fcf = (uint8_t *)&ack_fcf;
+    enhack_frame[position] = ack_byte_fcf[0];
+    position += 1;
+    enhack_frame[position] = ack_byte_fcf[1];
+    position += 1;
+
+    /* Copy the sequence number in the ACK frame if its set */
+    if (!fcf->sequence_number_suppression)
+    {
+        enhack_frame[position] = frame[position];
+        position += 1;
+    }
+
+    /* Copy the src pan id (if set) and adress to the destination fields of the ACK frame */
+    if (fcf->pan_id_compression)
+    {
+        /* If pan id compression is set, the destination pan id is kept */
+        enhack_frame[position] = frame[position];
+        position += 1;
+        enhack_frame[position] = frame[position];
+        position += 1;
+
+        /* Safe start positions */
+        uint8_t frame_src_addr_position = position;
+        uint8_t frame_dst_addr_position = position;
+        ack_dst_addr_position = position;
+
+        /* Calculate start position of the source address */
+        frame_src_addr_position += 2;
+        if (fcf->dst_addr_mode == ADDR_MODE_LONG)
+        {
+            frame_src_addr_position += 6;
+        }
+
+        /* Copy the source address as the destination address in the ACK frame */
+        enhack_frame[position] = frame[frame_src_addr_position]; // Copy short address
+        position += 1;
+        frame_src_addr_position += 1;
+        enhack_frame[position] = frame[frame_src_addr_position];
+        position += 1;
+        frame_src_addr_position += 1;
+
+        if (fcf->src_addr_mode == ADDR_MODE_LONG)
+        {
+            enhack_frame[position] = frame[frame_src_addr_position]; // Copy remaining long address
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+        }
+
+        /* Copy the destination address as the source address in the ACK frame */
+        enhack_frame[position] = frame[frame_dst_addr_position]; // Copy short address
+        position += 1;
+        frame_dst_addr_position += 1;
+        enhack_frame[position] = frame[frame_dst_addr_position];
+        position += 1;
+        frame_dst_addr_position += 1;
+
+        if (fcf->dst_addr_mode == ADDR_MODE_LONG)
+        {
+            enhack_frame[position] = frame[frame_dst_addr_position]; // Copy remaining long address
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+        }
+    }
+    else
+    {
+        /* Safe start positions */
+        uint8_t frame_src_addr_position = position;
+        uint8_t frame_dst_addr_position = position;
+        ack_dst_addr_position = position + 2; // After the pan id
+
+        /* Calculate start position of the source address */
+        frame_src_addr_position += 4;
+        if (fcf->dst_addr_mode == ADDR_MODE_LONG)
+        {
+            frame_src_addr_position += 6;
+        }
+
+        /* Copy the source pan id and address as the destination in the ACK frame */
+        enhack_frame[position] = frame[frame_src_addr_position]; // Copy pan id
+        position += 1;
+        frame_src_addr_position += 1;
+        enhack_frame[position] = frame[frame_src_addr_position];
+        position += 1;
+        frame_src_addr_position += 1;
+        enhack_frame[position] = frame[frame_src_addr_position]; // Copy short address
+        position += 1;
+        frame_src_addr_position += 1;
+        enhack_frame[position] = frame[frame_src_addr_position];
+        position += 1;
+        frame_src_addr_position += 1;
+
+        if (fcf->src_addr_mode == ADDR_MODE_LONG)
+        {
+            enhack_frame[position] = frame[frame_src_addr_position]; // Copy remaining long address
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+            enhack_frame[position] = frame[frame_src_addr_position];
+            position += 1;
+            frame_src_addr_position += 1;
+        }
+
+        /* Copy the destination pan id and address as the source in the ACK frame */
+        enhack_frame[position] = frame[frame_dst_addr_position]; // Copy pan id
+        position += 1;
+        frame_dst_addr_position += 1;
+        enhack_frame[position] = frame[frame_dst_addr_position];
+        position += 1;
+        frame_dst_addr_position += 1;
+        enhack_frame[position] = frame[frame_dst_addr_position]; // Copy short address
+        position += 1;
+        frame_dst_addr_position += 1;
+        enhack_frame[position] = frame[frame_dst_addr_position];
+        position += 1;
+        frame_dst_addr_position += 1;
+
+        if (fcf->dst_addr_mode == ADDR_MODE_LONG)
+        {
+            enhack_frame[position] = frame[frame_dst_addr_position]; // Copy remaining long address
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+            enhack_frame[position] = frame[frame_dst_addr_position];
+            position += 1;
+            frame_dst_addr_position += 1;
+        }
+    }
+    
+    /* Append the return payload registered for the source of the frame, see esp_ieee802154_ack_payload_set() */
+    uint8_t payload_length = esp_ieee802154_ack_payload_take(fcf->src_addr_mode, &enhack_frame[ack_dst_addr_position], &enhack_frame[position]);
+    position += payload_length;
+
+    esp_ieee802154_metrics_inc(IEEE802154_METRIC_ACK_SENT);
+    if (payload_length > 0)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_ACK_PAYLOADS);
+    }
+
+    /* Set the correct length of the ACK frame */
+    enhack_frame[0] = (position - 1) + 2; // Exclude the length byte, include the FCS
+}
@@ -0,0 +1,187 @@
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <esp_cpu.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "esp_log.h"
+#include "ieee802154_util.h"
+#include "ieee802154_wcet.h"
+
+#define TAG "ieee802154_wcet"
+
+#define WCET_RANDOM_SEED 0x802154
+
+/* --- WCET measurement --- */
+
+void esp_ieee802154_wcet_init(ieee802154_wcet_t *wcet, const char *name)
+{
+    memset(wcet, 0, sizeof(ieee802154_wcet_t));
+    wcet->name = name;
+    wcet->unit = "cycles";
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_wcet_record(ieee802154_wcet_t *wcet, uint32_t cycles, const uint8_t *frame)
+{
+    uint32_t bucket = cycles / IEEE802154_WCET_BUCKET_CYCLES;
+    if (bucket >= IEEE802154_WCET_BUCKETS)
+    {
+        bucket = IEEE802154_WCET_BUCKETS - 1;
+    }
+    wcet->histogram[bucket] += 1;
+    wcet->samples += 1;
+
+    if (cycles > wcet->max_cycles)
+    {
+        wcet->max_cycles = cycles;
+        if (frame != NULL)
+        {
+            // Only copy the valid part of the frame, the length byte can be malformed
+            uint8_t length = frame[0] < sizeof(wcet->worst_input) ? frame[0] : sizeof(wcet->worst_input) - 1;
+            memcpy(wcet->worst_input, frame, length + 1);
+        }
+    }
+}
+
+uint32_t esp_ieee802154_wcet_percentile(const ieee802154_wcet_t *wcet, uint8_t percentile)
+{
+    if (wcet->samples == 0)
+    {
+        return 0;
+    }
+
+    // Number of samples which need to be below the returned value (rounded up)
+    uint64_t threshold = ((uint64_t)wcet->samples * percentile + 99) / 100;
+    uint64_t count = 0;
+
+    for (uint32_t bucket = 0; bucket < IEEE802154_WCET_BUCKETS - 1; bucket++)
+    {
+        count += wcet->histogram[bucket];
+        if (count >= threshold)
+        {
+            uint32_t bound = (bucket + 1) * IEEE802154_WCET_BUCKET_CYCLES;
+            return bound < wcet->max_cycles ? bound : wcet->max_cycles;
+        }
+    }
+    return wcet->max_cycles; // The percentile lies in the overflow bucket
+}
+
+esp_err_t esp_ieee802154_wcet_report(const ieee802154_wcet_t *wcet, uint32_t budget_cycles)
+{
+    ESP_LOGI(TAG, "------ WCET: %s ------", wcet->name);
+    ESP_LOGI(TAG, "Samples: %" PRIu32, wcet->samples);
+    ESP_LOGI(TAG, "p50:     %" PRIu32 " %s", esp_ieee802154_wcet_percentile(wcet, 50), wcet->unit);
+    ESP_LOGI(TAG, "p99:     %" PRIu32 " %s", esp_ieee802154_wcet_percentile(wcet, 99), wcet->unit);
+    ESP_LOGI(TAG, "Max:     %" PRIu32 " %s (budget: %" PRIu32 " %s)", wcet->max_cycles, wcet->unit, budget_cycles, wcet->unit);
+
+    if (wcet->samples > 0)
+    {
+        uint8_t length = wcet->worst_input[0] < sizeof(wcet->worst_input) ? wcet->worst_input[0] : sizeof(wcet->worst_input) - 1;
+        ESP_LOGI(TAG, "Worst input:");
+        ESP_LOG_BUFFER_HEXDUMP(TAG, wcet->worst_input, length + 1, ESP_LOG_INFO);
+    }
+
+    if (wcet->max_cycles > budget_cycles)
+    {
+        ESP_LOGE(TAG, "%s exceeds the budget by %" PRIu32 " %s", wcet->name, wcet->max_cycles - budget_cycles, wcet->unit);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* --- Corpus harness --- */
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void random_fill(uint32_t *state, uint8_t *buffer, uint8_t length)
+{
+    for (uint8_t i = 0; i < length; i++)
+    {
+        buffer[i] = xorshift32(state) & 0xff;
+    }
+}
+
+/**
+ * Length of the MAC header for a given frame control field, as it is assumed by the ACK generator.
+ * Used to give the exhaustive corpus a valid frame length.
+ */
+static uint8_t header_length(uint16_t fcf)
+{
+    static const uint8_t addr_length[4] = {0, 0, 2, 8};
+    bool pic = (fcf >> 6) & 0x1;
+    bool sns = (fcf >> 8) & 0x1;
+    uint8_t dst_mode = (fcf >> 10) & 0x3;
+    uint8_t src_mode = (fcf >> 14) & 0x3;
+
+    return 2 + (sns ? 0 : 1) + 2 + addr_length[dst_mode] + (pic ? 0 : 2) + addr_length[src_mode];
+}
+
+static void measure(ieee802154_wcet_t *wcet, ieee802154_wcet_handler_t handler, uint8_t *frame)
+{
+    uint32_t start = esp_cpu_get_cycle_count();
+    handler(frame);
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    esp_ieee802154_wcet_record(wcet, cycles, frame);
+}
+
+void esp_ieee802154_wcet_run_corpus(ieee802154_wcet_t *wcet, ieee802154_wcet_handler_t handler, uint32_t random_frames)
+{
+    uint8_t frame[128];
+    uint32_t seed = WCET_RANDOM_SEED;
+
+    // Warm up the cache, so the first sample does not dominate the maximum
+    memset(frame, 0, sizeof(frame));
+    handler(frame);
+
+    /* Exhaustive corpus: every frame control field with a valid length and random addresses */
+    for (uint32_t fcf = 0; fcf <= UINT16_MAX; fcf++)
+    {
+        random_fill(&seed, &frame[3], sizeof(frame) - 3);
+        frame[1] = fcf & 0xff;
+        frame[2] = fcf >> 8;
+        frame[0] = header_length(fcf) + 2; // Includes FCS
+        measure(wcet, handler, frame);
+
+        if ((fcf % 10000) == 0)
+        {
+            vTaskDelay(1); // Keep the task watchdog happy
+        }
+    }
+
+    /* Random corpus: random content and random (possibly malformed) length */
+    for (uint32_t i = 0; i < random_frames; i++)
+    {
+        random_fill(&seed, frame, sizeof(frame));
+        frame[0] &= 0x7f; // Only the length is bounded by the PHY
+        measure(wcet, handler, frame);
+
+        if ((i % 10000) == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+}
+
+static void ack_generator(uint8_t *frame)
+{
+    static uint8_t enhack_frame[128];
+    esp_ieee802154_create_2015_ack_frame(frame, enhack_frame);
+}
+
+esp_err_t esp_ieee802154_wcet_run_ack_generator(uint32_t random_frames, uint32_t budget_cycles)
+{
+    static ieee802154_wcet_t wcet;
+
+    esp_ieee802154_wcet_init(&wcet, "esp_ieee802154_create_2015_ack_frame");
+    esp_ieee802154_wcet_run_corpus(&wcet, ack_generator, random_frames);
+    return esp_ieee802154_wcet_report(&wcet, budget_cycles);
+}
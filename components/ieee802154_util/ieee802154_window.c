@@ -0,0 +1,219 @@
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ieee802154_window.h"
+
+/**
+ * This file does not depend on the radio driver or FreeRTOS, so that the host tools can use it.
+ */
+
+#define SLOT(seq) ((seq) & (IEEE802154_WINDOW_MAX - 1))
+
+/* --- Sender --- */
+
+void esp_ieee802154_window_tx_init(ieee802154_window_tx_t *tx, uint8_t window, uint32_t rto_us)
+{
+    memset(tx, 0, sizeof(ieee802154_window_tx_t));
+    tx->window = (window < 1) ? 1 : (window > IEEE802154_WINDOW_MAX) ? IEEE802154_WINDOW_MAX : window;
+    tx->rto_us = rto_us;
+}
+
+uint8_t esp_ieee802154_window_tx_in_flight(const ieee802154_window_tx_t *tx)
+{
+    return (uint8_t)(tx->next - tx->base);
+}
+
+bool esp_ieee802154_window_tx_enqueue(ieee802154_window_tx_t *tx, const uint8_t *data, uint8_t length)
+{
+    if (esp_ieee802154_window_tx_in_flight(tx) >= tx->window || length > IEEE802154_WINDOW_MAX_SEGMENT)
+    {
+        return false;
+    }
+
+    ieee802154_window_slot_t *slot = &tx->slots[SLOT(tx->next)];
+    slot->length = length;
+    slot->sent = false;
+    slot->lost = false;
+    slot->acked = false;
+    memcpy(slot->data, data, length);
+    tx->next += 1;
+    return true;
+}
+
+uint8_t esp_ieee802154_window_tx_poll(ieee802154_window_tx_t *tx, uint32_t now_us, uint8_t *payload)
+{
+    for (uint8_t seq = tx->base; seq != tx->next; seq++)
+    {
+        ieee802154_window_slot_t *slot = &tx->slots[SLOT(seq)];
+        if (slot->acked || (slot->sent && !slot->lost && (uint32_t)(now_us - slot->sent_at) < tx->rto_us))
+        {
+            continue;
+        }
+
+        if (slot->sent)
+        {
+            tx->retransmissions += 1;
+        }
+        tx->transmissions += 1;
+        slot->order = tx->transmissions;
+        slot->sent = true;
+        slot->lost = false;
+        slot->sent_at = now_us;
+
+        payload[0] = IEEE802154_WINDOW_DISPATCH;
+        payload[1] = IEEE802154_WINDOW_TYPE_DATA;
+        payload[2] = seq;
+        memcpy(&payload[IEEE802154_WINDOW_HEADER_LENGTH], slot->data, slot->length);
+        return IEEE802154_WINDOW_HEADER_LENGTH + slot->length;
+    }
+    return 0;
+}
+
+uint8_t esp_ieee802154_window_tx_ack(ieee802154_window_tx_t *tx, const uint8_t *payload, uint8_t length)
+{
+    if (length < IEEE802154_WINDOW_ACK_LENGTH || payload[0] != IEEE802154_WINDOW_DISPATCH || payload[1] != IEEE802154_WINDOW_TYPE_ACK)
+    {
+        return 0;
+    }
+
+    uint8_t cumulative = payload[2];
+    uint32_t selective = payload[3] | (payload[4] << 8) | (payload[5] << 16) | ((uint32_t)payload[6] << 24);
+    uint8_t in_flight = esp_ieee802154_window_tx_in_flight(tx);
+
+    // An old ACK that arrives after a newer one would move the window backwards
+    uint8_t freed = (uint8_t)(cumulative - tx->base);
+    if (freed > in_flight)
+    {
+        return 0;
+    }
+    tx->base = cumulative;
+
+    uint8_t highest = 0; // Offset + 1 of the highest selectively acknowledged segment
+    for (uint8_t idx = 0; idx < 32 && (uint8_t)(idx + 1) < (uint8_t)(tx->next - tx->base); idx++)
+    {
+        if (selective & (1UL << idx))
+        {
+            tx->slots[SLOT(cumulative + 1 + idx)].acked = true;
+            highest = idx + 1;
+        }
+    }
+
+    /**
+     * The radio keeps the order of the frames, so a missing segment that was transmitted before the highest
+     * selectively acknowledged one has been lost. It is retransmitted by the next poll without waiting for the
+     * timeout. A segment that has been retransmitted after that is still on its way.
+     */
+    if (highest > 0)
+    {
+        uint32_t order = tx->slots[SLOT(cumulative + highest)].order;
+        for (uint8_t offset = 0; offset < highest; offset++)
+        {
+            ieee802154_window_slot_t *slot = &tx->slots[SLOT(cumulative + offset)];
+            if (!slot->acked && slot->sent && (int32_t)(order - slot->order) > 0)
+            {
+                slot->lost = true;
+            }
+        }
+    }
+    return freed;
+}
+
+uint32_t esp_ieee802154_window_tx_next_timeout(const ieee802154_window_tx_t *tx, uint32_t now_us)
+{
+    uint32_t timeout = UINT32_MAX;
+    for (uint8_t seq = tx->base; seq != tx->next; seq++)
+    {
+        const ieee802154_window_slot_t *slot = &tx->slots[SLOT(seq)];
+        if (slot->acked)
+        {
+            continue;
+        }
+        if (!slot->sent || slot->lost)
+        {
+            return 0;
+        }
+
+        uint32_t elapsed = now_us - slot->sent_at;
+        uint32_t remaining = (elapsed >= tx->rto_us) ? 0 : tx->rto_us - elapsed;
+        if (remaining < timeout)
+        {
+            timeout = remaining;
+        }
+    }
+    return timeout;
+}
+
+/* --- Receiver --- */
+
+void esp_ieee802154_window_rx_init(ieee802154_window_rx_t *rx, uint8_t window)
+{
+    memset(rx, 0, sizeof(ieee802154_window_rx_t));
+    rx->window = (window < 1) ? 1 : (window > IEEE802154_WINDOW_MAX) ? IEEE802154_WINDOW_MAX : window;
+}
+
+bool esp_ieee802154_window_rx_input(ieee802154_window_rx_t *rx, const uint8_t *payload, uint8_t length,
+                                    ieee802154_window_deliver_cb_t deliver, void *arg)
+{
+    if (length < IEEE802154_WINDOW_HEADER_LENGTH || payload[0] != IEEE802154_WINDOW_DISPATCH || payload[1] != IEEE802154_WINDOW_TYPE_DATA)
+    {
+        return false;
+    }
+
+    uint8_t offset = (uint8_t)(payload[2] - rx->expected);
+    rx->unacked += 1;
+
+    if (offset >= IEEE802154_WINDOW_MAX || (rx->received & (1UL << offset)))
+    {
+        // Already delivered or buffered, the sender has probably missed an ACK
+        rx->duplicates += 1;
+        rx->ack_now = true;
+        return true;
+    }
+
+    ieee802154_window_slot_t *slot = &rx->slots[SLOT(payload[2])];
+    slot->length = length - IEEE802154_WINDOW_HEADER_LENGTH;
+    memcpy(slot->data, &payload[IEEE802154_WINDOW_HEADER_LENGTH], slot->length);
+    rx->received |= (1UL << offset);
+
+    if (offset > 0)
+    {
+        // Gap, tell the sender which segments are missing
+        rx->ack_now = true;
+    }
+
+    while (rx->received & 1)
+    {
+        slot = &rx->slots[SLOT(rx->expected)];
+        if (deliver != NULL)
+        {
+            deliver(slot->data, slot->length, arg);
+        }
+        rx->delivered += 1;
+        rx->expected += 1;
+        rx->received >>= 1;
+    }
+
+    if (rx->unacked >= (rx->window + 1) / 2)
+    {
+        rx->ack_now = true;
+    }
+    return rx->ack_now;
+}
+
+uint8_t esp_ieee802154_window_rx_build_ack(ieee802154_window_rx_t *rx, uint8_t *payload)
+{
+    uint32_t selective = rx->received >> 1;
+
+    payload[0] = IEEE802154_WINDOW_DISPATCH;
+    payload[1] = IEEE802154_WINDOW_TYPE_ACK;
+    payload[2] = rx->expected;
+    payload[3] = selective & 0xFF;
+    payload[4] = (selective >> 8) & 0xFF;
+    payload[5] = (selective >> 16) & 0xFF;
+    payload[6] = (selective >> 24) & 0xFF;
+
+    rx->unacked = 0;
+    rx->ack_now = false;
+    return IEEE802154_WINDOW_ACK_LENGTH;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Return data in Enh-ACK payloads.
+ *
+ * The application registers a small payload for a peer, the Enh-ACK generator (see
+ * esp_ieee802154_create_2015_ack_frame()) appends it to the next ACK for a frame of that peer. Downlink data
+ * rides on uplink ACKs without extra frames. A payload is attached at most once, if the ACK is lost the
+ * payload is lost as well. Only 2015 frames are acknowledged with an Enh-ACK, 2003 frames get an Imm-ACK
+ * from the hardware without payload.
+ */
+#define IEEE802154_ACK_PAYLOAD_MAX      32  // Every byte adds 32 us to the ACK airtime
+#define IEEE802154_ACK_PAYLOAD_ENTRIES  8
+
+/**
+ * Register a payload for the next ACK to a peer.
+ * 
+ * A payload that is still pending for the peer is replaced.
+ * 
+ * @param[in]  addr    Pointer to the address ieee802154 struct of the peer (source of the acknowledged frame).
+ * @param[in]  data    Pointer to the payload.
+ * @param[in]  length  Length of the payload (1 to IEEE802154_ACK_PAYLOAD_MAX).
+ * 
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the payload is too long or empty,
+ *         ESP_ERR_NO_MEM if payloads for IEEE802154_ACK_PAYLOAD_ENTRIES peers are pending.
+ * 
+ */
+esp_err_t esp_ieee802154_ack_payload_set(const ieee802154_address_t *addr, const uint8_t *data, uint8_t length);
+
+/**
+ * Remove the pending payload for a peer.
+ * 
+ * @param[in]  addr  Pointer to the address ieee802154 struct of the peer.
+ * 
+ */
+void esp_ieee802154_ack_payload_clear(const ieee802154_address_t *addr);
+
+/**
+ * Check if a payload is pending for a peer.
+ * 
+ * @param[in]  addr  Pointer to the address ieee802154 struct of the peer.
+ * 
+ * @return True if the payload has not been attached to an ACK yet.
+ * 
+ */
+bool esp_ieee802154_ack_payload_pending(const ieee802154_address_t *addr);
+
+/**
+ * Take the pending payload for a peer.
+ * 
+ * @param[in]   addr_mode  Address mode of the peer.
+ * @param[in]   addr       Pointer to the address of the peer as it is on air (2 or 8 bytes, little endian).
+ * @param[out]  payload    Buffer for the payload (IEEE802154_ACK_PAYLOAD_MAX).
+ * 
+ * @return Length of the payload, 0 if no payload is pending.
+ * 
+ * Note: This function is called by esp_ieee802154_create_2015_ack_frame() in ISR context.
+ * 
+ */
+uint8_t esp_ieee802154_ack_payload_take(uint8_t addr_mode, const uint8_t *addr, uint8_t *payload);
+
+/**
+ * Get the payload of a received ACK.
+ * 
+ * @param[in]   ack      Pointer to the ACK frame (ack[0] is the length), e.g. from esp_ieee802154_transmit_done().
+ * @param[out]  payload  Pointer to store the start of the payload in the ACK frame.
+ * 
+ * @return Length of the payload, 0 if the ACK has no payload.
+ * 
+ */
+uint8_t esp_ieee802154_ack_payload_get(const uint8_t *ack, const uint8_t **payload);
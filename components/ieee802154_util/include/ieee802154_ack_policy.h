@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_tx.h"
+#include "ieee802154_addr_book.h"
+
+/**
+ * ACK request policy per destination.
+ *
+ * The sender asks the policy for every frame whether an ACK should be requested
+ * (esp_ieee802154_ack_policy_decide()), giving the reliability class of the data. The TX engine reports the
+ * outcome of every frame with ACK request to a destination (esp_ieee802154_ack_policy_update()), from which
+ * the loss rate is kept as a moving average.
+ *
+ * A destination starts in ACKed mode. Once IEEE802154_ACK_POLICY_MIN_SAMPLES frames were sent with ACK request
+ * and the loss rate is below half the limit of the class, frames are sent without ACK request, except every
+ * IEEE802154_ACK_POLICY_PROBE_INTERVAL-th frame, which keeps the loss rate up to date. As soon as the loss rate
+ * exceeds the limit of the class, the destination falls back to ACKed mode.
+ *
+ * Every frame sent without ACK saves the turnaround time and the air time of the ACK. The delivery ratio counts
+ * the ACKed frames as delivered and the frames without ACK by the loss rate at the time they were sent.
+ */
+#define IEEE802154_ACK_POLICY_MAX_DESTINATIONS 32
+#define IEEE802154_ACK_POLICY_MIN_SAMPLES      16
+#define IEEE802154_ACK_POLICY_PROBE_INTERVAL   8
+
+typedef enum {
+    IEEE802154_RELIABILITY_NONE,         // Never request an ACK
+    IEEE802154_RELIABILITY_BEST_EFFORT,  // ACKs are dropped while the loss rate is below 10 %
+    IEEE802154_RELIABILITY_NORMAL,       // ACKs are dropped while the loss rate is below 1 %
+    IEEE802154_RELIABILITY_CRITICAL,     // Always request an ACK
+} ieee802154_reliability_t;
+
+typedef struct {
+    bool unacked;              // Frames are sent without ACK request (apart from the probes)
+    uint16_t loss_permille;    // Moving average of the loss rate of frames with ACK request
+    uint8_t ack_length;        // Length of the last ACK including the FCS
+    uint32_t samples;          // Frames with ACK request (CCA failures and aborts are not counted)
+    uint32_t lost;             // Frames with ACK request and without ACK
+    uint32_t frames;           // Frames decided by the policy
+    uint32_t without_ack;      // Frames sent without ACK request by the policy
+    uint32_t fallbacks;        // Switches back to ACKed mode
+    uint64_t saved_us;         // Air time and turnaround time of the ACKs that were not requested
+    uint64_t delivered_milli;  // Expected deliveries of the frames without ACK in 1/1000 frames
+} ieee802154_ack_policy_state_t;
+
+/**
+ * Decide whether to request an ACK for a frame.
+ *
+ * @param[in]  dst          Address book id of the destination, IEEE802154_ADDR_ID_NONE for broadcasts.
+ * @param[in]  reliability  Reliability class of the frame.
+ *
+ * @return True if the frame should request an ACK.
+ *
+ */
+bool esp_ieee802154_ack_policy_decide(ieee802154_addr_id_t dst, ieee802154_reliability_t reliability);
+
+/**
+ * Record the outcome of a transmission, called by the TX engine task.
+ *
+ * @param[in]  dst     Address book id of the destination (see esp_ieee802154_addr_book_destination()).
+ * @param[in]  frame   Pointer to the frame that was sent (frame[0] is the length).
+ * @param[in]  result  Pointer to the outcome.
+ *
+ */
+void esp_ieee802154_ack_policy_update(ieee802154_addr_id_t dst, const uint8_t *frame, const ieee802154_tx_result_t *result);
+
+/**
+ * Get the policy state of a destination.
+ *
+ * @return False if no frames to the destination were recorded.
+ *
+ */
+bool esp_ieee802154_ack_policy_get(ieee802154_addr_id_t id, ieee802154_ack_policy_state_t *state);
+
+/**
+ * Get the delivery ratio of a destination in per mille.
+ *
+ * @return The delivery ratio of all frames with ACK request and of the frames sent without ACK by the policy.
+ *
+ */
+uint16_t esp_ieee802154_ack_policy_delivery(const ieee802154_ack_policy_state_t *state);
+
+/**
+ * Parse a reliability class: none, best, normal or critical.
+ *
+ * @return False if the name is unknown.
+ *
+ */
+bool esp_ieee802154_ack_policy_parse_reliability(const char *name, ieee802154_reliability_t *reliability);
+
+/**
+ * Forget all destinations, they start over in ACKed mode.
+ *
+ */
+void esp_ieee802154_ack_policy_reset(void);
+
+/**
+ * Register the console command:
+ *
+ * ackpolicy          Print the mode, loss rate, saved air time and delivery ratio of every destination
+ * ackpolicy reset    Forget all destinations
+ *
+ * @return ESP_OK on success.
+ *
+ */
+esp_err_t esp_ieee802154_ack_policy_register_console(void);
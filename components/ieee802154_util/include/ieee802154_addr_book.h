@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Address book.
+ *
+ * Every node the application deals with is stored once, with its pan id, its short address and its extended
+ * address (as far as they are known), and gets a small integer id. Tables that are kept per node (statistics,
+ * neighbors) use the id as key or index instead of the address, so they need neither their own hashing nor
+ * comparisons by address mode.
+ *
+ * Entries are never removed, so an id stays valid for the lifetime of the application.
+ * Lookups are O(1) (open addressing, every known address of an entry has a slot, at most 3/4 of the slots are
+ * used) and safe in ISR context.
+ */
+#define IEEE802154_ADDR_BOOK_BITS  CONFIG_IEEE802154_UTIL_ADDR_BOOK_BITS
+#define IEEE802154_ADDR_BOOK_SLOTS (1 << IEEE802154_ADDR_BOOK_BITS)
+#define IEEE802154_ADDR_BOOK_MAX   (IEEE802154_ADDR_BOOK_SLOTS / 2) // Two slots per entry if both addresses are known
+#define IEEE802154_ADDR_ID_NONE    0xFFFF
+
+typedef uint16_t ieee802154_addr_id_t;
+
+typedef struct {
+    uint16_t pan_id;
+    uint16_t short_address;   // 0xFFFF if not known
+    uint64_t ext_address;     // 0 if not known
+} ieee802154_addr_book_entry_t;
+
+/**
+ * Get the id of an address, the address is added if it is not known yet.
+ *
+ * @param[in]  pan_id  Pan id of the address.
+ * @param[in]  addr    Pointer to the address (short or long).
+ *
+ * @return The id, IEEE802154_ADDR_ID_NONE for an address without mode, the broadcast address, the extended
+ *         address 0 or if the book is full.
+ *
+ */
+ieee802154_addr_id_t esp_ieee802154_addr_book_intern(uint16_t pan_id, const ieee802154_address_t *addr);
+
+/**
+ * Get the id of the destination of a frame. The address is not added, see esp_ieee802154_addr_book_find().
+ *
+ * @param[in]  frame  Pointer to the frame (frame[0] is the length).
+ *
+ * @return The id, IEEE802154_ADDR_ID_NONE for broadcasts, frames without destination address and addresses
+ *         that are not known.
+ *
+ */
+ieee802154_addr_id_t esp_ieee802154_addr_book_destination(const uint8_t *frame);
+
+/**
+ * Get the id of a known address, safe in ISR context.
+ *
+ * @return The id, IEEE802154_ADDR_ID_NONE if the address is not known.
+ *
+ */
+ieee802154_addr_id_t esp_ieee802154_addr_book_find(uint16_t pan_id, const ieee802154_address_t *addr);
+
+/**
+ * Record that a short and an extended address belong to the same node, so both resolve to one id.
+ *
+ * @return The id, IEEE802154_ADDR_ID_NONE if the book is full or both addresses are already known with
+ *         different ids.
+ *
+ */
+ieee802154_addr_id_t esp_ieee802154_addr_book_bind(uint16_t pan_id, uint16_t short_address, uint64_t ext_address);
+
+/**
+ * Get the entry of an id.
+ *
+ * @return False if the id is not valid.
+ *
+ */
+bool esp_ieee802154_addr_book_get(ieee802154_addr_id_t id, ieee802154_addr_book_entry_t *entry);
+
+/**
+ * Get the address to send frames to an id: the short address if it is known, otherwise the extended address.
+ *
+ * @param[in]   id       The id.
+ * @param[out]  pan_id   Pointer to store the pan id, can be NULL.
+ * @param[out]  addr     Pointer to store the address.
+ *
+ * @return False if the id is not valid.
+ *
+ */
+bool esp_ieee802154_addr_book_address(ieee802154_addr_id_t id, uint16_t *pan_id, ieee802154_address_t *addr);
+
+/**
+ * Format the address of an id as text ("none" for an invalid id), see esp_ieee802154_format_address().
+ *
+ */
+int esp_ieee802154_addr_book_format(ieee802154_addr_id_t id, char *buffer, size_t size);
+
+/**
+ * @return Number of entries.
+ *
+ */
+uint16_t esp_ieee802154_addr_book_count(void);
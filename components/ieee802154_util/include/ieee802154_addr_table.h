@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Software address table.
+ *
+ * The radio filters frames by its own pan id and addresses in hardware, and only acknowledges those. To test
+ * a receiver against many senders or destinations (e.g. the virtual nodes of the traffic generator), the
+ * table holds a set of additional (pan id, address) pairs that the node accepts and acknowledges itself.
+ *
+ * While the table is not empty, the radio runs in promiscuous mode, the own addresses are part of the table
+ * and esp_ieee802154_addr_table_receive() takes over the filtering and the ACKs in the receive callback.
+ * Lookups are O(1) (open addressing with a fixed number of slots) and safe in ISR context.
+ */
+#define IEEE802154_ADDR_TABLE_BITS  9
+#define IEEE802154_ADDR_TABLE_SLOTS (1 << IEEE802154_ADDR_TABLE_BITS)
+#define IEEE802154_ADDR_TABLE_MAX   384 // At most 75 % of the slots are used, so probe sequences stay short
+
+/**
+ * Add an address to the table. The first address switches the radio to promiscuous mode.
+ *
+ * @param[in]  pan_id  Pan id of the address.
+ * @param[in]  addr    Pointer to the address (short or long).
+ *
+ * @return ESP_OK on success (also if the address is already present), ESP_ERR_INVALID_ARG for an address
+ *         without mode, ESP_ERR_NO_MEM if the table is full.
+ *
+ */
+esp_err_t esp_ieee802154_addr_table_add(uint16_t pan_id, const ieee802154_address_t *addr);
+
+/**
+ * Add count consecutive addresses, see esp_ieee802154_address_offset().
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the table is full (the addresses added so far are kept).
+ *
+ */
+esp_err_t esp_ieee802154_addr_table_add_range(uint16_t pan_id, const ieee802154_address_t *base, uint16_t count);
+
+/**
+ * Remove an address from the table.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the address is not in the table.
+ *
+ */
+esp_err_t esp_ieee802154_addr_table_remove(uint16_t pan_id, const ieee802154_address_t *addr);
+
+/**
+ * Remove all addresses and return to hardware filtering.
+ *
+ */
+void esp_ieee802154_addr_table_clear(void);
+
+/**
+ * @return Number of addresses in the table, including the own addresses.
+ *
+ */
+uint16_t esp_ieee802154_addr_table_count(void);
+
+/**
+ * Look up an address, safe in ISR context.
+ *
+ * @return True if the address is in the table.
+ *
+ */
+bool esp_ieee802154_addr_table_contains(uint16_t pan_id, const ieee802154_address_t *addr);
+
+/**
+ * Filter a received frame and acknowledge it if requested. Call in esp_ieee802154_receive_done().
+ *
+ * Frames to an address of the table (or to the broadcast address) are accepted. If the frame requests an
+ * ACK, an Imm-ACK (2003/2006) or an Enh-ACK (2015, see esp_ieee802154_create_2015_ack_frame()) is sent
+ * at once. With an empty table every frame is accepted (the hardware has filtered it already).
+ * 
+ * The transmit callbacks are also called for the software ACK, the TX engine ignores them. While a frame of the
+ * TX engine is in flight, no ACK is sent (IEEE802154_METRIC_ACK_SKIPPED), it would abort that frame.
+ * Call it first in esp_ieee802154_receive_done(), before anything slow like a log.
+ *
+ * @param[in]  frame  Pointer to the received frame (frame[0] is the length).
+ *
+ * @return True if the frame is accepted, false if it should be dropped.
+ *
+ */
+bool esp_ieee802154_addr_table_receive(const uint8_t *frame);
+
+/**
+ * Enable or disable the software ACKs of esp_ieee802154_addr_table_receive(), e.g. while frames are replayed
+ * into the receive path (see ieee802154_replay.h). The frames are still filtered. Enabled by default.
+ *
+ * @param[in]  enable  Bool to set whether requested ACKs are sent.
+ *
+ */
+void esp_ieee802154_addr_table_set_ack(bool enable);
+
+/**
+ * Register the "addrs" console command.
+ *
+ * addrs add <pan> <addr>                Add an address (0x1234 or 16 hex digits)
+ * addrs range <pan> <addr> <count>      Add count consecutive addresses
+ * addrs del <pan> <addr>                Remove an address
+ * addrs clear                           Remove all addresses
+ * addrs count                           Print the number of addresses
+ *
+ * @return ESP_OK on success, otherwise the error of esp_console_cmd_register().
+ *
+ */
+esp_err_t esp_ieee802154_addr_table_register_console(void);
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Batch header decoder for trace processing on the host.
+ *
+ * Decodes an array of PSDUs at once into a struct of arrays, with the same results as
+ * esp_ieee802154_parse_frame() for every frame. The FCF fields, the flags and the header and payload lengths
+ * are computed for 8 (SSE2) or 16 (AVX2) frames at a time on x86 hosts; the PAN ids and addresses are then read
+ * at the computed offsets. Every other target (including the ESP32-C6) uses the portable scalar kernel, which
+ * gives identical results (see tools/ieee802154_batch_bench.c). The scalar kernel decodes each frame in one pass
+ * without branches on the header fields, so it is faster than the parser on a trace with mixed frames.
+ *
+ * Frames shorter than 4 bytes (FCF and FCS) are not decoded, all their fields are 0, like the parser leaves them.
+ */
+#define IEEE802154_BATCH_SECURE             0x01
+#define IEEE802154_BATCH_FRAME_PENDING      0x02
+#define IEEE802154_BATCH_ACK_REQUEST        0x04
+#define IEEE802154_BATCH_PAN_ID_COMPRESSION 0x08
+#define IEEE802154_BATCH_SEQ_SUPPRESSION    0x10
+#define IEEE802154_BATCH_IE_PRESENT         0x20
+#define IEEE802154_BATCH_SEQ_PRESENT        0x40
+#define IEEE802154_BATCH_VALID              0x80 // esp_ieee802154_parse_frame() returns true for the frame
+
+typedef enum {
+    IEEE802154_BATCH_AUTO,     // Fastest kernel the CPU supports
+    IEEE802154_BATCH_SCALAR,
+    IEEE802154_BATCH_SSE2,
+    IEEE802154_BATCH_AVX2,
+} ieee802154_batch_kernel_t;
+
+typedef struct {
+    size_t capacity;
+    uint16_t *fcf;
+    uint8_t *frame_type;
+    uint8_t *frame_version;
+    uint8_t *flags;            // IEEE802154_BATCH_*
+    uint8_t *sequence_number;
+    uint8_t *dst_mode;
+    uint8_t *src_mode;
+    uint8_t *header_length;    // Offset of the payload in the PSDU
+    uint8_t *payload_length;   // Without FCS, 0 if the header does not fit into the frame
+    uint16_t *dst_pan_id;
+    uint16_t *src_pan_id;      // Equals dst_pan_id if the pan id is compressed
+    uint64_t *dst_addr;        // Short address or extended address as a number
+    uint64_t *src_addr;
+} ieee802154_batch_t;
+
+/**
+ * Allocate the arrays of a batch.
+ *
+ * @param[out]  batch     Pointer to the batch.
+ * @param[in]   capacity  Number of frames a batch can hold.
+ *
+ * @return False if the memory can not be allocated.
+ *
+ */
+bool esp_ieee802154_batch_alloc(ieee802154_batch_t *batch, size_t capacity);
+
+/**
+ * Free the arrays of a batch.
+ *
+ */
+void esp_ieee802154_batch_free(ieee802154_batch_t *batch);
+
+/**
+ * Resolve a kernel to one the CPU supports.
+ *
+ * @return The requested kernel if it is supported, otherwise (and for IEEE802154_BATCH_AUTO) the fastest
+ *         supported kernel.
+ *
+ */
+ieee802154_batch_kernel_t esp_ieee802154_batch_kernel(ieee802154_batch_kernel_t kernel);
+
+/**
+ * Get the name of a kernel.
+ *
+ */
+const char *esp_ieee802154_batch_kernel_name(ieee802154_batch_kernel_t kernel);
+
+/**
+ * Decode a batch of frames.
+ *
+ * @param[in]   psdus    Pointers to the PSDUs.
+ * @param[in]   lengths  Lengths of the PSDUs including the FCS, as for esp_ieee802154_parse_frame().
+ * @param[in]   count    Number of frames, at most the capacity of the batch.
+ * @param[out]  batch    Pointer to the batch which stores the results.
+ * @param[in]   kernel   Kernel to use, see esp_ieee802154_batch_kernel().
+ *
+ * @return The number of frames with IEEE802154_BATCH_VALID.
+ *
+ */
+size_t esp_ieee802154_batch_decode(const uint8_t *const *psdus, const uint8_t *lengths, size_t count,
+                                   ieee802154_batch_t *batch, ieee802154_batch_kernel_t kernel);
+
+/**
+ * Get a decoded frame in the form of esp_ieee802154_parse_frame().
+ *
+ * @param[in]   batch  Pointer to the batch.
+ * @param[in]   idx    Index of the frame.
+ * @param[out]  frame  Pointer to the struct which stores the frame.
+ *
+ * @return True if the frame is valid (the return value of esp_ieee802154_parse_frame()).
+ *
+ */
+bool esp_ieee802154_batch_get(const ieee802154_batch_t *batch, size_t idx, ieee802154_frame_t *frame);
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+#include "ieee802154_tx.h"
+
+/**
+ * Channel agility with announced switches.
+ *
+ * The TX engine reports the outcome of every frame (esp_ieee802154_channel_update()). The CCA failures of all
+ * frames and the missing ACKs of frames with ACK request are kept over a sliding window of the last
+ * CONFIG_IEEE802154_UTIL_CHANNEL_WINDOW frames. When one of the rates crosses its threshold, the channel task
+ * surveys all channels (ieee802154_survey.h) and moves to the quietest one. The periodic survey of the
+ * application runs in the channel task as well (esp_ieee802154_channel_survey()), so the task is the only one
+ * that moves the radio to another channel while it runs. A task that has to set the channel itself (e.g. to
+ * search a peer) holds the channel task off with esp_ieee802154_channel_hold().
+ *
+ * A switch is announced to the peers first: IEEE802154_CHANNEL_ANNOUNCEMENTS broadcast data frames, starting
+ * with the dispatch byte IEEE802154_CHANNEL_DISPATCH, carry the new channel and the time left until the switch.
+ * They are sent without CCA, so they also leave a jammed channel. A node that receives an announcement
+ * (esp_ieee802154_channel_input()) follows at the same time. If both peers announce at once, the announcement
+ * of the lower short address wins.
+ *
+ * Every switch is recorded: the time from the trigger to the first frame exchanged on the new channel (ACK or
+ * received frame), and the frames that failed in between.
+ */
+#define IEEE802154_CHANNEL_DISPATCH      0xB9
+#define IEEE802154_CHANNEL_ANNOUNCEMENTS 3    // Announcement frames per switch
+#define IEEE802154_CHANNEL_SPACING_MS    20   // Time between the announcements
+#define IEEE802154_CHANNEL_DELAY_MS      100  // Time from the first announcement to the switch
+#define IEEE802154_CHANNEL_HISTORY       8    // Switches kept for the report
+
+typedef enum {
+    IEEE802154_CHANNEL_REASON_CCA,       // CCA failure rate above the threshold
+    IEEE802154_CHANNEL_REASON_NO_ACK,    // Missing ACK rate above the threshold
+    IEEE802154_CHANNEL_REASON_SURVEY,    // Periodic survey or console command
+    IEEE802154_CHANNEL_REASON_PEER,      // Announced by a peer
+} ieee802154_channel_reason_t;
+
+typedef struct {
+    ieee802154_channel_reason_t reason;
+    uint8_t from;
+    uint8_t to;
+    int64_t trigger_us;        // Threshold crossed, switch requested or first announcement received
+    int64_t switch_us;         // Radio moved to the new channel
+    int64_t recovered_us;      // First frame exchanged on the new channel, 0 until then
+    uint32_t lost;             // Frames failed from the trigger until the recovery
+} ieee802154_channel_switch_t;
+
+typedef struct {
+    uint8_t channel;
+    uint8_t window;            // Frames in the window
+    uint8_t cca_failures;      // CCA failures in the window
+    uint8_t acked_window;      // Frames with ACK request in the window
+    uint8_t no_acks;           // Missing ACKs in the window
+    uint32_t switches;
+    uint32_t announcements_sent;
+    uint32_t announcements_received;
+    uint8_t history_count;
+    ieee802154_channel_switch_t history[IEEE802154_CHANNEL_HISTORY]; // Latest first
+} ieee802154_channel_stats_t;
+
+/**
+ * Start the channel task.
+ *
+ * The TX engine needs to be started before, see esp_ieee802154_tx_engine_start().
+ *
+ * @param[in]  priority  Priority of the channel task.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the queue or task can not be created.
+ *
+ */
+esp_err_t esp_ieee802154_channel_start(UBaseType_t priority);
+
+/**
+ * Record the outcome of a transmission, called by the TX engine task.
+ *
+ * @param[in]  frame   Pointer to the frame that was sent (frame[0] is the length).
+ * @param[in]  result  Pointer to the outcome.
+ *
+ */
+void esp_ieee802154_channel_update(const uint8_t *frame, const ieee802154_tx_result_t *result);
+
+/**
+ * Pass a received frame, called in the receiver task.
+ *
+ * Every frame counts as exchanged on the current channel, announcements are consumed.
+ *
+ * @param[in]  frame  Pointer to the received frame (frame[0] is the length).
+ *
+ * @return True if the frame was an announcement.
+ *
+ */
+bool esp_ieee802154_channel_input(const uint8_t *frame);
+
+/**
+ * Announce a switch to a channel and switch.
+ *
+ * @param[in]  channel  The new channel, IEEE802154_CHANNEL_MIN to IEEE802154_CHANNEL_MAX.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an invalid channel, ESP_ERR_INVALID_STATE if the
+ *         channel task is not started.
+ *
+ */
+esp_err_t esp_ieee802154_channel_switch(uint8_t channel);
+
+/**
+ * Survey all channels in the channel task, then announce a switch to the best channel and switch if the
+ * current channel is noticeably busier (see esp_ieee802154_survey_should_switch()).
+ *
+ * @return ESP_OK if the survey is queued, ESP_ERR_INVALID_STATE if the channel task is not started or busy.
+ *
+ */
+esp_err_t esp_ieee802154_channel_survey(void);
+
+/**
+ * Hold the channel task off while another task sets the channel. While held, the outcomes of the TX engine
+ * are not recorded, announcements of peers are consumed but not followed, and queued triggers and surveys
+ * are dropped. An own announcement in progress is aborted. Switches requested with
+ * esp_ieee802154_channel_switch() still run. The window starts over on the release.
+ *
+ * @param[in]  hold  True to hold, false to release.
+ *
+ */
+void esp_ieee802154_channel_hold(bool hold);
+
+/**
+ * Get the window and the recorded switches.
+ *
+ */
+void esp_ieee802154_channel_get_stats(ieee802154_channel_stats_t *stats);
+
+/**
+ * Register the console command:
+ *
+ * channel                 Print the window and the recorded switches
+ * channel survey          Survey and switch if the best channel is noticeably quieter
+ * channel switch <11-26>  Announce a switch to a channel and switch
+ *
+ * @return ESP_OK on success.
+ *
+ */
+esp_err_t esp_ieee802154_channel_register_console(void);
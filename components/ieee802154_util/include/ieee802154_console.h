@@ -0,0 +1,18 @@
+#pragma once
+
+#include <esp_err.h>
+
+#define IEEE802154_CONSOLE_MAX_LINE 384 // Long enough for "replay add" with a maximum frame in hex
+
+/**
+ * Start the interactive console (REPL) on the console port of the sdkconfig (UART or USB-Serial-JTAG).
+ * 
+ * Registers the "help" and "metrics" commands. Further commands can be registered with
+ * esp_console_cmd_register() before or after the start.
+ * 
+ * @param[in]  prompt  Prompt of the console, e.g. "rx>".
+ * 
+ * @return ESP_OK on success, otherwise the error of the console component.
+ * 
+ */
+esp_err_t esp_ieee802154_console_start(const char *prompt);
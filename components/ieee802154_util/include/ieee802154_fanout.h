@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <esp_ieee802154.h>
+#include <freertos/FreeRTOS.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Fan-out of one payload to many destinations.
+ *
+ * The source pan id and address are looked up once and the payload is copied once into a frame template. For
+ * every destination only the sequence number, the destination pan id and the destination address are patched
+ * into the template, the header is rebuilt only if the destination needs another header layout (addressing
+ * mode or pan id compression). The frames are queued back-to-back on the TX engine, so they go out without gaps
+ * in between, and the outcome of every frame is reported per destination.
+ */
+typedef struct {
+    uint16_t dst_pan_id;
+    ieee802154_address_t dst_addr;
+    uint8_t seq_nr;                   // Set on return: sequence number the frame was sent with
+    esp_ieee802154_tx_error_t error;  // Set on return: ESP_IEEE802154_TX_ERR_NONE if sent (and ACKed if requested)
+    bool acked;                       // Set on return: an ACK frame was received
+    int8_t ack_rssi;                  // Set on return: only valid if acked is true
+} ieee802154_fanout_dst_t;
+
+/**
+ * Send a 2015 data frame with the same payload to every destination and wait for the outcomes.
+ *
+ * The TX engine needs to be started before, see esp_ieee802154_tx_engine_start().
+ *
+ * @param[in,out]  dsts         Destinations, the outcome of every frame is stored in its entry.
+ * @param[in]      count        Number of destinations.
+ * @param[in]      data         Pointer to the data.
+ * @param[in]      data_length  Length of the data.
+ * @param[in,out]  seq_nr       Sequence number of the first frame, counted up per frame. Holds the sequence
+ *                              number of the last frame on return. NULL to suppress the sequence numbers.
+ * @param[in]      ack          Bool to set whether an ACK frame is required or not.
+ * @param[in]      timeout      Time to wait for space in the TX queue, per frame.
+ *
+ * @return ESP_OK if all frames were sent (and ACKed if requested), ESP_FAIL if at least one failed,
+ *         ESP_ERR_INVALID_SIZE if the payload does not fit into the frame of a destination and ESP_ERR_TIMEOUT
+ *         if the queue stayed full. In both cases no further frames are queued, the destinations from there on
+ *         report ESP_IEEE802154_TX_ERR_ABORT.
+ *
+ * Note: Waits on a semaphore of its own, the task notification of the calling task stays free for the
+ *       application.
+ *
+ */
+esp_err_t esp_ieee802154_fanout_send(ieee802154_fanout_dst_t *dsts, size_t count, uint8_t *data, uint8_t data_length,
+                                     uint8_t *seq_nr, bool ack, TickType_t timeout);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * Software FCS (CRC-16/ITU-T as used by IEEE802.15.4: polynomial x^16 + x^12 + x^5 + 1, initial value 0, bits
+ * processed LSB first, no final XOR). The FCS is stored after the MAC header and payload, low byte first.
+ *
+ * The radio generates and checks the FCS in hardware. This is for the code that has no radio: the host mocks
+ * and simulators append it to the frames they send, the tools validate captured frames with it.
+ *
+ * esp_ieee802154_fcs() processes 8 bytes per step with 8 lookup tables (slice-by-8, 4 KiB), the byte-wise
+ * variant uses the first table only (512 bytes). Both give the same result (see tools/ieee802154_fcs_bench.c).
+ */
+#define IEEE802154_FCS_LENGTH 2
+
+/**
+ * Compute the FCS with one table lookup per byte.
+ *
+ * @param[in]  data    Pointer to the MAC header and payload.
+ * @param[in]  length  Number of bytes.
+ *
+ * @return The FCS.
+ *
+ */
+uint16_t esp_ieee802154_fcs_bytewise(const uint8_t *data, size_t length);
+
+/**
+ * Compute the FCS, 8 bytes per step (slice-by-8).
+ *
+ * @param[in]  data    Pointer to the MAC header and payload.
+ * @param[in]  length  Number of bytes.
+ *
+ * @return The FCS.
+ *
+ */
+uint16_t esp_ieee802154_fcs(const uint8_t *data, size_t length);
+
+/**
+ * Compute the FCS of a frame and store it in its last two bytes.
+ *
+ * @param[in,out]  frame  Pointer to the frame (frame[0] is the length including the FCS, at least 2).
+ *
+ */
+void esp_ieee802154_fcs_append(uint8_t *frame);
+
+/**
+ * Check the FCS of a PSDU.
+ *
+ * @param[in]  psdu    Pointer to the PSDU.
+ * @param[in]  length  Length of the PSDU including the FCS.
+ *
+ * @return True if the PSDU holds at least the FCS and the FCS matches.
+ *
+ */
+bool esp_ieee802154_fcs_valid(const uint8_t *psdu, size_t length);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Histogram with log-spaced buckets.
+ *
+ * Bucket 0 counts the value 0, bucket i (i > 0) the values from 2^(i-1) to 2^i - 1, the last bucket also
+ * every larger value. With microseconds, 24 buckets cover up to 8.4 s. Adding a value is a count leading
+ * zeros and an increment, so it can be used on every frame.
+ */
+#define IEEE802154_HISTOGRAM_BUCKETS 24
+
+typedef struct {
+    uint32_t buckets[IEEE802154_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} ieee802154_histogram_t;
+
+static inline __attribute__((always_inline)) uint8_t esp_ieee802154_histogram_bucket(uint32_t value)
+{
+    uint8_t bucket = (value == 0) ? 0 : 32 - __builtin_clz(value);
+    return (bucket < IEEE802154_HISTOGRAM_BUCKETS) ? bucket : IEEE802154_HISTOGRAM_BUCKETS - 1;
+}
+
+static inline __attribute__((always_inline)) void esp_ieee802154_histogram_add(ieee802154_histogram_t *histogram, uint32_t value)
+{
+    if (histogram->count == 0 || value < histogram->min)
+    {
+        histogram->min = value;
+    }
+    if (value > histogram->max)
+    {
+        histogram->max = value;
+    }
+    histogram->buckets[esp_ieee802154_histogram_bucket(value)] += 1;
+    histogram->sum += value;
+    histogram->count += 1;
+}
+
+/**
+ * Estimate a percentile: the upper bound of the bucket in which it falls (at most the maximum).
+ *
+ * @param[in]  histogram  Pointer to the histogram.
+ * @param[in]  percent    Percentile (0 to 100).
+ *
+ * @return The estimate, 0 for an empty histogram.
+ *
+ */
+uint32_t esp_ieee802154_histogram_percentile(const ieee802154_histogram_t *histogram, uint8_t percent);
+
+/**
+ * Print the statistics (min, avg, p50, p99, max) and one line per non-empty bucket.
+ *
+ * @param[in]  histogram  Pointer to the histogram.
+ * @param[in]  indent     Text in front of every line.
+ * @param[in]  unit       Unit of the values, e.g. "us".
+ *
+ */
+void esp_ieee802154_histogram_print(const ieee802154_histogram_t *histogram, const char *indent, const char *unit);
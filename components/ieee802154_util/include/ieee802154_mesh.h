@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_rx_timing.h"
+
+/**
+ * Multi-hop forwarding.
+ *
+ * Mesh frames are ordinary data frames from one hop to the next. The payload starts with a mesh header that
+ * carries the final destination and the originator (short addresses), so every node on the way can look up
+ * the next hop in its routing table:
+ *
+ * Payload: | Dispatch (1) | Hops left (1) | Final destination (2) | Originator (2) | Data (n) |
+ *
+ * The routing table maps a destination to a next hop (short or long address). It has a fixed number of
+ * slots and is looked up in O(1) (open addressing). Routes are either fixed (esp_ieee802154_mesh_route_add())
+ * or learned from received mesh frames: the originator is reachable over the neighbor that sent the frame.
+ *
+ * Every neighbor has a link quality, an average of the LQI of its frames and ACKs, which is halved for
+ * every missing ACK and every IEEE802154_MESH_AGE_INTERVAL_S without a frame. Learned routes over a neighbor
+ * below CONFIG_IEEE802154_UTIL_MESH_MIN_LQI are removed, and a learned route moves to a neighbor with a
+ * clearly better link. Fixed routes never age.
+ *
+ * A forwarded frame is rewritten in the receive buffer: the MAC header is replaced by one to the next hop
+ * with the own source address and sequence number, the hop count is decremented, and the payload stays
+ * where it is (it only moves if the new header is longer than the old one). The TX engine sends the frame
+ * from there (esp_ieee802154_tx_engine_submit_ref()), so the mesh keeps the RX entry until the frame is sent
+ * and hands the receiver a spare entry in exchange. IEEE802154_MESH_FORWARD_BUFFERS frames can be on their
+ * way to the next hop at the same time.
+ */
+#define IEEE802154_MESH_DISPATCH        0xB8
+#define IEEE802154_MESH_HEADER_LENGTH   6
+#define IEEE802154_MESH_MAX_PAYLOAD     98  // Fits with the longest MAC header (long addresses) on every hop
+#define IEEE802154_MESH_ROUTE_BITS      7
+#define IEEE802154_MESH_ROUTE_SLOTS     (1 << IEEE802154_MESH_ROUTE_BITS)
+#define IEEE802154_MESH_MAX_ROUTES      96  // At most 75 % of the slots are used, so probe sequences stay short
+#define IEEE802154_MESH_MAX_NEIGHBORS   16
+#define IEEE802154_MESH_FORWARD_BUFFERS 4   // Spare RX entries, one per forwarded frame in the TX queue
+#define IEEE802154_MESH_AGE_INTERVAL_S  CONFIG_IEEE802154_UTIL_MESH_AGE_INTERVAL_S
+
+typedef struct {
+    uint32_t originated;      // Frames sent by this node
+    uint32_t delivered;       // Frames to this node
+    uint32_t forwarded;       // Frames queued for the next hop
+    uint32_t forward_sent;    // Forwarded frames sent (and ACKed)
+    uint32_t forward_failed;  // Forwarded frames not ACKed by the next hop
+    uint32_t moved;           // Forwarded frames whose payload had to move (longer header)
+    uint32_t no_route;        // Frames dropped without route
+    uint32_t hop_limit;       // Frames dropped after the last hop
+    uint32_t queue_full;      // Frames dropped, TX queue full or no spare RX entry
+    uint32_t too_long;        // Frames dropped, longer than the maximum PSDU with the header to the next hop
+    uint32_t latency_min_us;  // Per-hop latency, from the reception to the end of the transmission
+    uint32_t latency_max_us;
+    uint64_t latency_sum_us;  // Sum over forward_sent frames
+    uint32_t peak_rate;       // Most frames forwarded within one second
+} ieee802154_mesh_stats_t;
+
+/**
+ * Callback for mesh frames to this node, called in the receiver task.
+ *
+ * @param[in]  originator  Short address of the originator.
+ * @param[in]  data        Pointer to the data after the mesh header.
+ * @param[in]  length      Length of the data.
+ * @param[in]  hops        Number of hops the frame took.
+ * @param[in]  arg         The argument given to esp_ieee802154_mesh_start().
+ *
+ */
+typedef void (*ieee802154_mesh_deliver_cb_t)(uint16_t originator, const uint8_t *data, uint8_t length, uint8_t hops, void *arg);
+
+/**
+ * Start forwarding. Needs the TX engine.
+ *
+ * @param[in]  cb   Callback for frames to this node, can be NULL.
+ * @param[in]  arg  Argument for the callback.
+ *
+ */
+void esp_ieee802154_mesh_start(ieee802154_mesh_deliver_cb_t cb, void *arg);
+
+/**
+ * Add a fixed route or replace the route to dst.
+ *
+ * @param[in]  dst       Short address of the final destination.
+ * @param[in]  next_hop  Pointer to the address of the next hop (short or long).
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an address without mode, ESP_ERR_NO_MEM if the routing
+ *         or the neighbor table or the address book is full (or for the broadcast address).
+ *
+ */
+esp_err_t esp_ieee802154_mesh_route_add(uint16_t dst, const ieee802154_address_t *next_hop);
+
+/**
+ * Remove the route to dst.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no route.
+ *
+ */
+esp_err_t esp_ieee802154_mesh_route_remove(uint16_t dst);
+
+/**
+ * Look up the next hop to dst.
+ *
+ * @param[in]   dst       Short address of the final destination.
+ * @param[out]  next_hop  Pointer to store the address of the next hop.
+ *
+ * @return True if there is a usable route.
+ *
+ */
+bool esp_ieee802154_mesh_route_lookup(uint16_t dst, ieee802154_address_t *next_hop);
+
+/**
+ * Send data to dst over the mesh.
+ *
+ * @return ESP_OK if the frame is queued, ESP_ERR_INVALID_SIZE if the data is longer than
+ *         IEEE802154_MESH_MAX_PAYLOAD, ESP_ERR_INVALID_STATE without own short address, ESP_ERR_NOT_FOUND
+ *         without route and ESP_ERR_TIMEOUT if the TX queue is full.
+ *
+ */
+esp_err_t esp_ieee802154_mesh_send(uint16_t dst, const uint8_t *data, uint8_t length);
+
+/**
+ * Handle a received frame. Mesh frames to this node are delivered, all others are forwarded.
+ *
+ * @param[in,out]  entry  Pointer to the pointer to the RX entry of the frame (rssi/lqi in place of the FCS, see
+ *                        ieee802154_rx_timing.h). A forwarded frame is rewritten and sent in place, the mesh
+ *                        keeps its entry and stores a spare one here, the next frame is received into that.
+ *
+ * @return True if the frame was a mesh frame.
+ *
+ */
+bool esp_ieee802154_mesh_input(ieee802154_rx_entry_t **entry);
+
+/**
+ * Copy the forwarding statistics.
+ *
+ */
+void esp_ieee802154_mesh_get_stats(ieee802154_mesh_stats_t *stats);
+
+/**
+ * Register the "mesh" console command.
+ *
+ * mesh route <dst> <next hop>    Add a fixed route (next hop 0x1234 or 16 hex digits)
+ * mesh del <dst>                 Remove a route
+ * mesh routes                    Print the routing table and the neighbors
+ * mesh send <dst> <text>         Send text over the mesh
+ * mesh stats                     Print the forwarding statistics, per-hop latency and peak rate
+ *
+ * @return ESP_OK on success, otherwise the error of esp_console_cmd_register().
+ *
+ */
+esp_err_t esp_ieee802154_mesh_register_console(void);
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <esp_cpu.h>
+
+#include "sdkconfig.h"
+
+/**
+ * Runtime metrics of the radio stack.
+ *
+ * A fixed set of counters and gauges, updated from the radio callbacks, the TX engine and the apps with a
+ * single atomic add or store. They can be read with the "metrics" console command and are dumped in a
+ * compact line periodically. With CONFIG_IEEE802154_UTIL_METRICS_ENABLE disabled, the updates compile to nothing.
+ */
+#if CONFIG_IEEE802154_UTIL_METRICS_ENABLE
+#define IEEE802154_METRICS_ENABLED 1
+#else
+#define IEEE802154_METRICS_ENABLED 0
+#endif
+
+/**
+ * X(id, short name, description)
+ * Counters only grow (until reset), gauges hold the current or the highest value.
+ */
+#define IEEE802154_METRICS_COUNTERS(X) \
+    X(RX_FRAMES,        "rx",       "Frames received") \
+    X(RX_BYTES,         "rx_b",     "Bytes received (PSDU)") \
+    X(RX_DROPPED,       "rx_drop",  "Frames dropped, RX buffer full") \
+    X(RX_FILTERED,      "rx_filt",  "Frames dropped by the software address table") \
+    X(ACK_SENT,         "ack_tx",   "Enh-ACKs generated") \
+    X(ACK_PAYLOADS,     "ack_pl",   "Enh-ACKs with return payload") \
+    X(ACK_SKIPPED,      "ack_skip", "Software ACKs not sent, a frame of the TX engine was on air") \
+    X(TX_FRAMES,        "tx",       "Frames handed to the radio") \
+    X(TX_BYTES,         "tx_b",     "Bytes handed to the radio (PSDU)") \
+    X(TX_DONE,          "tx_ok",    "Transmissions done (ACKed if requested)") \
+    X(TX_ACKED,         "tx_ack",   "Transmissions with ACK received") \
+    X(TX_NO_ACK,        "no_ack",   "Transmissions without ACK") \
+    X(TX_CCA_BUSY,      "cca",      "Transmissions failed, channel busy") \
+    X(TX_ABORTED,       "abort",    "Transmissions aborted") \
+    X(TX_FAILED,        "tx_err",   "Transmissions failed otherwise (invalid ACK, coexistence, security)") \
+    X(TX_TIMEOUT,       "tx_to",    "Transmissions without callback of the driver") \
+    X(TX_QUEUE_FULL,    "txq_full", "Frames not queued, TX queue full") \
+    X(ISR_CALLS,        "isr",      "Measured radio callbacks") \
+    X(ISR_CYCLES,       "isr_cyc",  "CPU cycles in measured radio callbacks")
+
+#define IEEE802154_METRICS_GAUGES(X) \
+    X(RX_BUFFER_MAX,    "rxq_max",  "Highest RX buffer fill level in bytes") \
+    X(TX_QUEUE,         "txq",      "Frames in the TX queue") \
+    X(TX_QUEUE_MAX,     "txq_max",  "Highest number of frames in the TX queue") \
+    X(ISR_CYCLES_MAX,   "isr_max",  "Longest measured radio callback in CPU cycles")
+
+#define IEEE802154_METRIC_ENUM(id, name, description) IEEE802154_METRIC_##id,
+
+typedef enum {
+    IEEE802154_METRICS_COUNTERS(IEEE802154_METRIC_ENUM)
+    IEEE802154_METRICS_GAUGES(IEEE802154_METRIC_ENUM)
+    IEEE802154_METRIC_COUNT
+} ieee802154_metric_t;
+
+extern uint32_t ieee802154_metrics[IEEE802154_METRIC_COUNT];
+
+#if IEEE802154_METRICS_ENABLED
+
+static inline __attribute__((always_inline)) void esp_ieee802154_metrics_add(ieee802154_metric_t id, uint32_t value)
+{
+    __atomic_fetch_add(&ieee802154_metrics[id], value, __ATOMIC_RELAXED);
+}
+
+static inline __attribute__((always_inline)) void esp_ieee802154_metrics_set(ieee802154_metric_t id, uint32_t value)
+{
+    __atomic_store_n(&ieee802154_metrics[id], value, __ATOMIC_RELAXED);
+}
+
+// High-water mark, a concurrent update may be lost, which is fine for a peak value
+static inline __attribute__((always_inline)) void esp_ieee802154_metrics_max(ieee802154_metric_t id, uint32_t value)
+{
+    if (value > __atomic_load_n(&ieee802154_metrics[id], __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&ieee802154_metrics[id], value, __ATOMIC_RELAXED);
+    }
+}
+
+#define ESP_IEEE802154_METRICS_ISR_START(start) uint32_t start = esp_cpu_get_cycle_count()
+#define ESP_IEEE802154_METRICS_ISR_STOP(start) do { \
+        uint32_t cycles = esp_cpu_get_cycle_count() - (start); \
+        esp_ieee802154_metrics_add(IEEE802154_METRIC_ISR_CALLS, 1); \
+        esp_ieee802154_metrics_add(IEEE802154_METRIC_ISR_CYCLES, cycles); \
+        esp_ieee802154_metrics_max(IEEE802154_METRIC_ISR_CYCLES_MAX, cycles); \
+    } while (0)
+
+#else
+
+static inline void esp_ieee802154_metrics_add(ieee802154_metric_t id, uint32_t value) {}
+static inline void esp_ieee802154_metrics_set(ieee802154_metric_t id, uint32_t value) {}
+static inline void esp_ieee802154_metrics_max(ieee802154_metric_t id, uint32_t value) {}
+
+#define ESP_IEEE802154_METRICS_ISR_START(start)
+#define ESP_IEEE802154_METRICS_ISR_STOP(start)
+
+#endif
+
+#define esp_ieee802154_metrics_inc(id) esp_ieee802154_metrics_add(id, 1)
+
+/**
+ * Get the value of a metric.
+ * 
+ * @param[in]  id  The metric.
+ * 
+ * @return The value.
+ * 
+ */
+uint32_t esp_ieee802154_metrics_get(ieee802154_metric_t id);
+
+/**
+ * Get the short name of a metric (used in the compact dump).
+ * 
+ */
+const char *esp_ieee802154_metrics_name(ieee802154_metric_t id);
+
+/**
+ * Reset all counters and gauges to 0, except the TX queue gauge which holds a current value.
+ * 
+ */
+void esp_ieee802154_metrics_reset(void);
+
+/**
+ * Log all metrics in one compact line.
+ * 
+ */
+void esp_ieee802154_metrics_dump(void);
+
+/**
+ * Register the "metrics" console command.
+ * 
+ * "metrics" prints all metrics with their description, "metrics reset" resets them.
+ * The console (e.g. esp_console_new_repl_uart()) needs to be set up by the application.
+ * 
+ * @return ESP_OK on success, otherwise the error of esp_console_cmd_register().
+ * 
+ */
+esp_err_t esp_ieee802154_metrics_register_console(void);
+
+/**
+ * Start a task that dumps the metrics periodically.
+ * 
+ * @param[in]  interval_s  Interval of the dump in seconds.
+ * 
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task can not be created.
+ * 
+ */
+esp_err_t esp_ieee802154_metrics_start_dump(uint32_t interval_s);
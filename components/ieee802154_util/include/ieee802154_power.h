@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_tx.h"
+#include "ieee802154_addr_book.h"
+
+/**
+ * Closed-loop TX power control per destination.
+ *
+ * The TX engine asks for the power of every frame (esp_ieee802154_power_select()) and reports the outcome
+ * (esp_ieee802154_power_update()). The path loss to a destination is estimated from the RSSI of its ACKs,
+ * assuming the ACK was sent with IEEE802154_POWER_NOMINAL_DBM (the TX engine restores the nominal power after
+ * every frame, so the hardware ACKs of all nodes are sent with it). The power is the lowest one that keeps the
+ * target margin above the receiver sensitivity:
+ * - raised at once if the margin is too small, and by one step more if the LQI of the ACK is low
+ * - lowered by one step at most per ACK, and only once the margin exceeds the target by the hysteresis
+ * - raised by one step times the number of consecutive missing ACKs
+ *
+ * Broadcasts and unknown destinations are sent with the nominal power. With CONFIG_IEEE802154_UTIL_POWER_CONTROL
+ * disabled, every frame is sent with the nominal power.
+ */
+#if CONFIG_IEEE802154_UTIL_POWER_CONTROL
+#define IEEE802154_POWER_CONTROL_ENABLED 1
+#else
+#define IEEE802154_POWER_CONTROL_ENABLED 0
+#endif
+
+#define IEEE802154_POWER_MAX_DESTINATIONS 32
+#define IEEE802154_POWER_NOMINAL_DBM      CONFIG_IEEE802154_UTIL_POWER_NOMINAL_DBM
+#define IEEE802154_POWER_MIN_DBM          CONFIG_IEEE802154_UTIL_POWER_MIN_DBM
+#define IEEE802154_POWER_MAX_DBM          CONFIG_IEEE802154_UTIL_POWER_MAX_DBM
+#define IEEE802154_POWER_TARGET_MARGIN_DB CONFIG_IEEE802154_UTIL_POWER_TARGET_MARGIN_DB
+#define IEEE802154_POWER_HYSTERESIS_DB    CONFIG_IEEE802154_UTIL_POWER_HYSTERESIS_DB
+#define IEEE802154_POWER_SENSITIVITY_DBM  (-100) // Receiver sensitivity of the ESP32-C6 (O-QPSK, 1 % PER)
+#define IEEE802154_POWER_STEP_DB          3
+#define IEEE802154_POWER_LOW_LQI          80     // ACKs below this link quality ask for one step more
+
+typedef struct {
+    int8_t power_dbm;          // Power of the next frame
+    int8_t margin_db;          // Estimated margin above the sensitivity of the destination with power_dbm
+    int16_t path_loss_q;       // Path loss in quarter dB (moving average over the ACKs), 0 before the first ACK
+    int8_t last_rssi;
+    uint8_t last_lqi;
+    uint8_t no_ack_streak;     // Consecutive frames without ACK
+    uint32_t frames;
+    uint32_t acks;
+    uint32_t no_acks;
+    uint32_t raised;           // Power increases
+    uint32_t lowered;          // Power decreases
+} ieee802154_power_state_t;
+
+/**
+ * Get the TX power for a frame, called by the TX engine task.
+ *
+ * @param[in]  dst  Address book id of the destination (see esp_ieee802154_addr_book_destination()).
+ *
+ * @return The power in dBm.
+ *
+ */
+int8_t esp_ieee802154_power_select(ieee802154_addr_id_t dst);
+
+/**
+ * Adapt the TX power of a destination to the outcome of a transmission, called by the TX engine task.
+ *
+ * @param[in]  dst     Address book id of the destination.
+ * @param[in]  result  Pointer to the outcome with the RSSI and LQI of the ACK.
+ *
+ */
+void esp_ieee802154_power_update(ieee802154_addr_id_t dst, const ieee802154_tx_result_t *result);
+
+/**
+ * Get the power control state of a destination.
+ *
+ * @return False if no frames to the destination were sent.
+ *
+ */
+bool esp_ieee802154_power_get(ieee802154_addr_id_t id, ieee802154_power_state_t *state);
+
+/**
+ * Forget all destinations, the next frames are sent with the nominal power.
+ *
+ */
+void esp_ieee802154_power_reset(void);
+
+/**
+ * Register the console command:
+ *
+ * power          Print the power, margin and counters of every destination
+ * power reset    Forget all destinations
+ *
+ * @return ESP_OK on success.
+ *
+ */
+esp_err_t esp_ieee802154_power_register_console(void);
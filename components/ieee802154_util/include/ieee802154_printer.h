@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Rate-limited print worker.
+ *
+ * The receiver task hands every frame to esp_ieee802154_printer_submit(), which only counts it and copies it
+ * into the print buffer if it should be printed. A separate task at low priority prints the frames, so a
+ * slow console never holds up the radio processing.
+ *
+ * Up to rate_limit frames per second, every frame is printed in full. Above it, the worker switches to a
+ * summary per second (frames per source and type, RSSI min/avg/max) and prints only every sample_every-th
+ * frame in full. The mode is chosen from the rate of the previous second, and a flood switches to summaries
+ * as soon as the limit is reached within the current second.
+ */
+#define IEEE802154_PRINTER_MAX_SOURCES 8  // Further sources and sources not in the address book are summarized as "other"
+
+#if IEEE802154_PRINT_ENABLED
+/**
+ * Start the print worker.
+ *
+ * @param[in]  rate_limit    Frames per second that are printed in full.
+ * @param[in]  sample_every  Print every n-th frame in full while summarizing, 0 prints none.
+ * @param[in]  priority      Priority of the print task, below the radio processing tasks.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the buffer or the task can not be created.
+ *
+ */
+esp_err_t esp_ieee802154_printer_start(uint32_t rate_limit, uint32_t sample_every, UBaseType_t priority);
+
+/**
+ * Count a received frame and queue it for printing if the policy allows it. Never blocks.
+ * Frames submitted before esp_ieee802154_printer_start() are ignored.
+ *
+ * @param[in]  frame  Pointer to the received frame (frame[0] is the length, rssi/lqi in place of the FCS).
+ *
+ */
+void esp_ieee802154_printer_submit(const uint8_t *frame);
+#else
+static inline esp_err_t esp_ieee802154_printer_start(uint32_t rate_limit, uint32_t sample_every, UBaseType_t priority)
+{
+    return ESP_OK; // Printing is compiled out (CONFIG_IEEE802154_UTIL_PRINT_ENABLE)
+}
+
+static inline void esp_ieee802154_printer_submit(const uint8_t *frame)
+{
+    (void)frame;
+}
+#endif
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Replay of captured frames into the receive path.
+ *
+ * Frames are loaded into a RAM buffer (over the console, see tools/ieee802154_replay.c which turns a pcap
+ * capture into console commands) and are then handed to the radio callbacks of the application as if the
+ * radio had received them: esp_ieee802154_enh_ack_generator() for 2015 frames with ACK request, then
+ * esp_ieee802154_receive_done(). The frames are not filtered by address, every frame reaches the callbacks.
+ *
+ * The frames are injected from an esp_timer callback at the captured times, divided by a speed factor, or
+ * as fast as possible. Frames are never closer than their airtime, as on the air. The receive path reports
+ * the frames it drops with esp_ieee802154_replay_count_drop(), so the report shows how many frames it
+ * sustained before the first drop. The software ACKs of the address table (ieee802154_addr_table.h) are off
+ * while a frame is injected.
+ */
+#define IEEE802154_REPLAY_BUFFER_SIZE CONFIG_IEEE802154_UTIL_REPLAY_BUFFER_SIZE
+#define IEEE802154_REPLAY_FAST        0   // Speed factor: as fast as possible
+#define IEEE802154_REPLAY_NO_DROP     UINT32_MAX
+
+typedef struct {
+    bool running;
+    uint32_t frames;          // Frames in the buffer
+    uint32_t injected;        // Frames injected in the last (or current) replay
+    uint32_t enh_acks;        // Calls of the Enh-ACK generator
+    uint32_t dropped;         // Frames dropped by the RX path
+    uint32_t first_drop;      // Number of frames injected before the first drop, IEEE802154_REPLAY_NO_DROP if none
+    uint32_t max_late_us;     // Largest delay of an injection behind its schedule
+    int64_t duration_us;      // From the first to the last injection
+} ieee802154_replay_stats_t;
+
+/**
+ * Count a frame the receive path dropped (e.g. its RX buffer was full), safe in ISR context. Only the drops
+ * while a replayed frame is handed to the callbacks are counted, call it at the drop site of
+ * esp_ieee802154_receive_done().
+ *
+ */
+void esp_ieee802154_replay_count_drop(void);
+
+/**
+ * Remove all frames from the buffer.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE while a replay is running.
+ *
+ */
+esp_err_t esp_ieee802154_replay_clear(void);
+
+/**
+ * Append a frame to the buffer.
+ *
+ * @param[in]  delta_us  Time since the previous frame in the capture.
+ * @param[in]  psdu      Pointer to the PSDU without FCS.
+ * @param[in]  length    Length of the PSDU without FCS.
+ * @param[in]  rssi      RSSI to report for the frame.
+ * @param[in]  lqi       LQI to report for the frame.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE for a frame too long, ESP_ERR_NO_MEM if the buffer is full
+ *         and ESP_ERR_INVALID_STATE while a replay is running.
+ *
+ */
+esp_err_t esp_ieee802154_replay_add(uint32_t delta_us, const uint8_t *psdu, uint8_t length, int8_t rssi, uint8_t lqi);
+
+/**
+ * Start a replay of the buffer.
+ *
+ * @param[in]  speed   Time compression factor, 1 for the captured timing, IEEE802154_REPLAY_FAST for as fast
+ *                     as possible.
+ * @param[in]  passes  Number of passes over the buffer.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the buffer is empty or a replay is running,
+ *         ESP_ERR_NO_MEM if the timer can not be created.
+ *
+ */
+esp_err_t esp_ieee802154_replay_start(uint16_t speed, uint16_t passes);
+
+/**
+ * Stop a running replay.
+ *
+ */
+void esp_ieee802154_replay_stop(void);
+
+/**
+ * Get the state and the results of the last replay.
+ *
+ */
+void esp_ieee802154_replay_get_stats(ieee802154_replay_stats_t *stats);
+
+/**
+ * Register the console command:
+ *
+ * replay clear                               Remove all frames
+ * replay add <delta us> <hex> [rssi] [lqi]   Append a frame (PSDU without FCS)
+ * replay run [x<speed>|fast] [passes]        Start a replay, with the captured timing by default
+ * replay stop                                Stop the replay
+ * replay stats                               Print the results
+ *
+ * @return ESP_OK on success.
+ *
+ */
+esp_err_t esp_ieee802154_replay_register_console(void);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include <esp_ieee802154.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_histogram.h"
+#include "ieee802154_addr_book.h"
+
+/**
+ * RX timestamps and inter-arrival histograms.
+ *
+ * Every received frame is stamped in the receive callback with the time its SFD was received (the driver
+ * timestamp, esp_timer time base). The stamp travels with the frame through the RX message buffer, so the
+ * receiver task sees when the frame was on the air instead of when the task got to it:
+ *
+ * RX entry: | Timestamp (8) | Length (1) | PSDU (n, rssi/lqi in place of the FCS) |
+ *
+ * The receiver task records two things per frame:
+ * - The inter-arrival time per source (SFD to SFD), which shows the scheduling jitter of the sender.
+ * - The delay from the SFD to the receiver task, which shows how long frames wait in the ISR and the queue.
+ *
+ * Both are kept in log-spaced histograms (see ieee802154_histogram.h), sources are keyed by address book id.
+ * Only the first IEEE802154_RX_TIMING_MAX_SOURCES sources are recorded and added to the address book.
+ */
+#define IEEE802154_RX_TIMING_MAX_SOURCES 16
+
+typedef struct {
+    int64_t timestamp_us;    // SFD time of the frame
+    uint8_t frame[128];      // Length byte and maximum PSDU
+} ieee802154_rx_entry_t;
+
+#define IEEE802154_RX_ENTRY_LENGTH(entry) (offsetof(ieee802154_rx_entry_t, frame) + (entry)->frame[0] + 1)
+
+/**
+ * Stamp a received frame and copy it into an RX entry, in the receive callback (ISR context).
+ *
+ * @param[out]  entry       Pointer to the entry.
+ * @param[in]   frame       Pointer to the frame (length byte first).
+ * @param[in]   frame_info  Frame info of the driver, the time of the call is used if it has no timestamp.
+ *
+ * @return Number of bytes of the entry to queue.
+ *
+ */
+size_t esp_ieee802154_rx_entry_fill(ieee802154_rx_entry_t *entry, const uint8_t *frame, const esp_ieee802154_frame_info_t *frame_info);
+
+/**
+ * Record the timing of a received frame, in the receiver task.
+ *
+ * @param[in]  entry   Pointer to the entry as taken from the RX message buffer.
+ * @param[in]  now_us  Time the receiver task took the entry.
+ *
+ */
+void esp_ieee802154_rx_timing_record(const ieee802154_rx_entry_t *entry, int64_t now_us);
+
+/**
+ * Get the inter-arrival histogram of a source.
+ *
+ * @return False if no frames of the source were recorded.
+ *
+ */
+bool esp_ieee802154_rx_timing_get_source(ieee802154_addr_id_t id, ieee802154_histogram_t *histogram);
+
+/**
+ * Get the histogram of the delay from the SFD to the receiver task.
+ *
+ */
+void esp_ieee802154_rx_timing_get_delay(ieee802154_histogram_t *histogram);
+
+/**
+ * Clear all histograms.
+ *
+ */
+void esp_ieee802154_rx_timing_reset(void);
+
+/**
+ * Register the console command:
+ *
+ * rxtime          Print the delay histogram and the inter-arrival histogram of every source
+ * rxtime reset    Clear all histograms
+ *
+ * @return ESP_OK on success.
+ *
+ */
+esp_err_t esp_ieee802154_rx_timing_register_console(void);
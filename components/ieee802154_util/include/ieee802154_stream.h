@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Byte streams on top of 2015 data frames.
+ *
+ * The sender writes an arbitrary number of bytes into a ring buffer. A task segments the buffer into frames
+ * with the maximum payload that fits after the header and sends them via the TX engine with ACK request.
+ * A frame is sent as soon as it is full or the flush timeout expires.
+ *
+ * Every stream frame starts with the dispatch byte IEEE802154_STREAM_DISPATCH, so the receiver can tell stream
+ * frames apart from other data frames of the same source.
+ */
+#define IEEE802154_STREAM_DISPATCH 0xB5
+#define IEEE802154_STREAM_RETRIES  3    // Retransmissions (same sequence number) before a frame is dropped
+
+typedef struct ieee802154_stream *ieee802154_stream_handle_t;
+
+/**
+ * Open a sending stream to a destination.
+ * 
+ * The TX engine needs to be started before, see esp_ieee802154_tx_engine_start().
+ * 
+ * @param[in]   dst_pan_id        Destination pan id.
+ * @param[in]   dst_addr          Pointer to the destination address ieee802154 struct.
+ * @param[in]   buffer_size       Size of the TX ring buffer in bytes.
+ * @param[in]   flush_timeout_ms  Maximum time a byte waits in the ring buffer before a (partial) frame is sent.
+ * @param[out]  handle            Pointer to store the stream handle.
+ * 
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the stream can not be allocated,
+ *         ESP_ERR_INVALID_ARG if the header leaves no room for payload.
+ * 
+ */
+esp_err_t esp_ieee802154_stream_open(uint16_t dst_pan_id, const ieee802154_address_t *dst_addr, size_t buffer_size,
+                                     uint32_t flush_timeout_ms, ieee802154_stream_handle_t *handle);
+
+/**
+ * Write bytes into a sending stream.
+ * 
+ * @param[in]  handle   The stream handle.
+ * @param[in]  data     Pointer to the data.
+ * @param[in]  length   Number of bytes to write.
+ * @param[in]  timeout  Time to wait for space in the ring buffer.
+ * 
+ * @return The number of bytes written, can be less than length if the timeout expires.
+ * 
+ */
+size_t esp_ieee802154_stream_write(ieee802154_stream_handle_t handle, const void *data, size_t length, TickType_t timeout);
+
+/**
+ * Open a receiving stream for a source.
+ * 
+ * @param[in]   src_pan_id   Source pan id.
+ * @param[in]   src_addr     Pointer to the source address ieee802154 struct.
+ * @param[in]   buffer_size  Size of the RX ring buffer in bytes.
+ * @param[out]  handle       Pointer to store the stream handle.
+ * 
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the stream can not be allocated.
+ * 
+ */
+esp_err_t esp_ieee802154_stream_listen(uint16_t src_pan_id, const ieee802154_address_t *src_addr, size_t buffer_size,
+                                       ieee802154_stream_handle_t *handle);
+
+/**
+ * Read bytes from a receiving stream.
+ * 
+ * @param[in]   handle   The stream handle.
+ * @param[out]  data     Pointer to the buffer.
+ * @param[in]   length   Size of the buffer.
+ * @param[in]   timeout  Time to wait for at least one byte.
+ * 
+ * @return The number of bytes read.
+ * 
+ */
+size_t esp_ieee802154_stream_read(ieee802154_stream_handle_t handle, void *data, size_t length, TickType_t timeout);
+
+/**
+ * Pass a received frame to the receiving streams.
+ * 
+ * @param[in]  frame  Pointer to the received frame (frame[0] is the length).
+ * 
+ * @return True if the frame was a stream frame of a listening stream and has been consumed.
+ * 
+ * Note: This function should be called in the task that processes the received frames, not in ISR context.
+ * 
+ */
+bool esp_ieee802154_stream_input(const uint8_t *frame);
+
+/**
+ * Get the statistics of a stream.
+ * 
+ * @param[in]   handle   The stream handle.
+ * @param[out]  bytes    Bytes sent (sending stream) or received (receiving stream), can be NULL.
+ * @param[out]  frames   Frames sent or received, can be NULL.
+ * @param[out]  dropped  Bytes dropped after all retries (sending) or duplicate frames (receiving), can be NULL.
+ * 
+ */
+void esp_ieee802154_stream_get_stats(ieee802154_stream_handle_t handle, uint32_t *bytes, uint32_t *frames, uint32_t *dropped);
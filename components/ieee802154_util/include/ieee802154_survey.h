@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#define IEEE802154_CHANNEL_MIN  11
+#define IEEE802154_CHANNEL_MAX  26
+#define IEEE802154_NUM_CHANNELS (IEEE802154_CHANNEL_MAX - IEEE802154_CHANNEL_MIN + 1)
+
+#define IEEE802154_SURVEY_BUCKETS     8    // Energy histogram buckets, 10 dB wide
+#define IEEE802154_SURVEY_BUCKET_BASE -100 // Lower bound of bucket 1, bucket 0 collects everything below
+
+typedef struct {
+    uint16_t samples;
+    uint16_t busy;      // Samples at or above the busy threshold
+    int8_t min_dbm;
+    int8_t max_dbm;
+    int32_t sum_dbm;
+    uint16_t histogram[IEEE802154_SURVEY_BUCKETS];
+} ieee802154_channel_survey_t;
+
+typedef struct {
+    ieee802154_channel_survey_t channels[IEEE802154_NUM_CHANNELS]; // Index 0 is channel 11
+    int8_t busy_threshold_dbm;
+    uint8_t best_channel;
+    int64_t duration_us;
+} ieee802154_survey_t;
+
+/**
+ * Run an energy detection survey on all channels.
+ * 
+ * Every channel is sampled samples_per_channel times. Afterwards the radio is back on the channel it was on,
+ * the caller is responsible for moving to another channel (e.g. survey->best_channel) and for the receive state.
+ * 
+ * Only one survey runs at a time, a concurrent call waits for the running one. The TX engine is paused during
+ * the survey (see esp_ieee802154_tx_engine_pause()).
+ * 
+ * @param[in]   samples_per_channel  Number of energy detections per channel.
+ * @param[in]   ed_duration          Duration of a single energy detection in symbols (16 us).
+ * @param[in]   busy_threshold_dbm   Samples at or above this energy count as occupied.
+ * @param[out]  survey               Pointer to the struct which stores the results.
+ * 
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the radio did not finish an energy detection.
+ * 
+ * Note: This function blocks and must not be called in ISR context.
+ * 
+ */
+esp_err_t esp_ieee802154_survey_run(uint16_t samples_per_channel, uint32_t ed_duration, int8_t busy_threshold_dbm, ieee802154_survey_t *survey);
+
+/**
+ * Rank all channels from the quietest to the busiest.
+ * 
+ * Channels are compared by the number of busy samples first and by the mean energy second.
+ * Ties are resolved in favour of the higher channel, which overlaps less with WiFi.
+ * 
+ * @param[in]   survey    Pointer to the survey results.
+ * @param[out]  channels  Buffer for IEEE802154_NUM_CHANNELS channel numbers.
+ * 
+ */
+void esp_ieee802154_survey_rank(const ieee802154_survey_t *survey, uint8_t *channels);
+
+/**
+ * Check whether switching from the current channel to the best channel is worth it.
+ * 
+ * @param[in]  survey   Pointer to the survey results.
+ * @param[in]  channel  The channel that is currently used.
+ * 
+ * @return True if the current channel has at least 1/8 of the samples more busy than the best channel.
+ * 
+ */
+bool esp_ieee802154_survey_should_switch(const ieee802154_survey_t *survey, uint8_t channel);
+
+/**
+ * Print the survey duration and the occupancy of each channel.
+ * 
+ * @param[in]  survey  Pointer to the survey results.
+ * 
+ */
+void esp_ieee802154_survey_print(const ieee802154_survey_t *survey);
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_addr_book.h"
+#include "ieee802154_ack_policy.h"
+
+/**
+ * Traffic generator and verifier.
+ *
+ * A profile describes the arrival process, the payload sizes and the destinations of generated frames. It is
+ * given as a string of key=value pairs, e.g. from the "traffic" console command or from NVS:
+ *
+ *   mode=poisson rate=50 size=20:3,64-110:1 dst=0x0002,0x0004 ack=normal duration=60
+ *   mode=const rate=200 size=40 dst=0x0100-0x01ff nodes=300 src=0x1000
+ *
+ * mode      const (fixed interval), poisson (exponential inter-arrival times), onoff (const during on_ms,
+ *           silent during off_ms) or saturate (as fast as the TX engine accepts frames)
+ * rate      Frames per second (mean rate for poisson, rate during the on phase for onoff), 1 to
+ *           IEEE802154_TRAFFIC_MAX_RATE
+ * on, off   On and off phase in milliseconds (onoff)
+ * size      Comma separated payload sizes or ranges (min-max) with an optional weight (:w), from
+ *           IEEE802154_TRAFFIC_HEADER_LENGTH to IEEE802154_TRAFFIC_MAX_PAYLOAD bytes
+ * dst       Comma separated short destination addresses or ranges (first-last), one address is picked at
+ *           random for every frame
+ * ack       Request a MAC ACK (1) or not (0), or leave it to the ACK policy with the reliability class of the
+ *           frames (best or normal, see ieee802154_ack_policy.h). The policy keeps state only for destinations
+ *           in the address book, frames to the others request an ACK.
+ * duration  Run time in seconds, 0 runs until stopped
+ * nodes     Number of virtual nodes, 0 sends from the own address. Every frame is sent by a random node,
+ *           each with its own source address and sequence numbers.
+ * src       Address of the first virtual node (0x1234 or 16 hex digits), the others follow, see
+ *           esp_ieee802154_address_offset()
+ *
+ * A receiver that should accept frames to many destinations uses the software address table
+ * (ieee802154_addr_table.h).
+ *
+ * Every payload carries a sequence number, the send timestamp and a checksum, so the receiver can verify
+ * the integrity and measure the delay with esp_ieee802154_traffic_verify(). A sequence number far behind the
+ * expected one (or back near 0) is a restart of the sender: the sequence and delay tracking of the source
+ * start over, the counters are kept.
+ *
+ * Payload: | Dispatch (1) | Seq (4) | Timestamp us (4) | Checksum (2) | Filler (n) |
+ */
+#define IEEE802154_TRAFFIC_DISPATCH       0xB7
+#define IEEE802154_TRAFFIC_HEADER_LENGTH  11
+#define IEEE802154_TRAFFIC_MAX_PAYLOAD    110 // Fits with the longest header (long source address)
+#define IEEE802154_TRAFFIC_MAX_SIZES      4
+#define IEEE802154_TRAFFIC_MAX_DSTS       8
+#define IEEE802154_TRAFFIC_MAX_SOURCES    64
+#define IEEE802154_TRAFFIC_MAX_NODES      512
+#define IEEE802154_TRAFFIC_MAX_RATE       10000 // Frames per second, far above what the radio sends
+#define IEEE802154_TRAFFIC_SPEC_LENGTH    128
+
+typedef enum {
+    IEEE802154_TRAFFIC_CONSTANT,
+    IEEE802154_TRAFFIC_POISSON,
+    IEEE802154_TRAFFIC_ON_OFF,
+    IEEE802154_TRAFFIC_SATURATE,
+} ieee802154_traffic_mode_t;
+
+typedef struct {
+    uint8_t min;
+    uint8_t max;
+    uint8_t weight;
+} ieee802154_traffic_size_t;
+
+typedef struct {
+    uint16_t first;
+    uint16_t count;
+} ieee802154_traffic_range_t;
+
+typedef struct {
+    ieee802154_traffic_mode_t mode;
+    uint32_t rate;
+    uint32_t on_ms;
+    uint32_t off_ms;
+    uint8_t size_count;
+    ieee802154_traffic_size_t sizes[IEEE802154_TRAFFIC_MAX_SIZES];
+    uint8_t dst_count;
+    ieee802154_traffic_range_t dsts[IEEE802154_TRAFFIC_MAX_DSTS];
+    ieee802154_reliability_t ack;
+    uint32_t duration_s;
+    uint16_t nodes;
+    ieee802154_address_t src;
+} ieee802154_traffic_profile_t;
+
+typedef struct {
+    uint32_t generated;     // Frames created by the profile
+    uint32_t queue_full;    // Frames dropped because the TX queue was full
+    uint32_t sent;          // Frames sent (ACKed if requested)
+    uint32_t failed;        // Frames failed (CCA, no ACK, ...)
+    uint64_t bytes;         // Payload bytes sent
+} ieee802154_traffic_tx_stats_t;
+
+typedef struct {
+    ieee802154_addr_id_t src_id;  // See ieee802154_addr_book.h
+    uint32_t received;
+    uint32_t lost;          // Gaps in the sequence numbers
+    uint32_t duplicates;
+    uint32_t reordered;
+    uint32_t corrupted;     // Wrong checksum or length
+    uint32_t restarts;      // Sender restarts (sequence numbers started over)
+    uint32_t next_seq;
+    uint32_t history;       // Bit i: next_seq - 1 - i has been received
+    int32_t min_offset_us;  // Smallest receive time minus send timestamp (the clocks are not synchronized)
+    uint32_t max_delay_us;  // Delays are relative to the fastest frame
+    uint64_t sum_delay_us;
+} ieee802154_traffic_rx_stats_t;
+
+/**
+ * Parse a profile string.
+ * 
+ * @param[in]   spec     The profile string, see above.
+ * @param[out]  profile  Pointer to store the profile.
+ * 
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the string is malformed.
+ * 
+ */
+esp_err_t esp_ieee802154_traffic_parse(const char *spec, ieee802154_traffic_profile_t *profile);
+
+/**
+ * Start generating traffic, a running profile is stopped before.
+ * 
+ * The TX engine needs to be started before, see esp_ieee802154_tx_engine_start().
+ * 
+ * @param[in]  spec  The profile string.
+ * 
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the profile is malformed,
+ *         ESP_ERR_NO_MEM if the generator task can not be created.
+ * 
+ */
+esp_err_t esp_ieee802154_traffic_start(const char *spec);
+
+/**
+ * Stop generating traffic.
+ * 
+ */
+void esp_ieee802154_traffic_stop(void);
+
+/**
+ * Store a profile string in NVS, it is started by esp_ieee802154_traffic_start_saved() after a reboot.
+ * 
+ * @param[in]  spec  The profile string, NULL erases the saved profile.
+ * 
+ * @return ESP_OK on success, otherwise the NVS error.
+ * 
+ */
+esp_err_t esp_ieee802154_traffic_save(const char *spec);
+
+/**
+ * Start the profile saved in NVS.
+ * 
+ * @return ESP_OK if a profile has been started, ESP_ERR_NVS_NOT_FOUND if no profile is saved.
+ * 
+ */
+esp_err_t esp_ieee802154_traffic_start_saved(void);
+
+/**
+ * Verify a received frame of the traffic generator.
+ * 
+ * @param[in]  frame       Pointer to the received frame (frame[0] is the length).
+ * @param[in]  rx_time_us  Receive time in microseconds (esp_timer_get_time() or the driver timestamp).
+ * 
+ * @return True if the frame was a traffic frame.
+ * 
+ */
+bool esp_ieee802154_traffic_verify(const uint8_t *frame, int64_t rx_time_us);
+
+/**
+ * Get the statistics of the generator.
+ * 
+ */
+void esp_ieee802154_traffic_get_tx_stats(ieee802154_traffic_tx_stats_t *stats);
+
+/**
+ * Get the statistics of a verified source.
+ * 
+ * @param[in]   index  Index of the source (0 to IEEE802154_TRAFFIC_MAX_SOURCES - 1).
+ * @param[out]  stats  Pointer to store the statistics.
+ * 
+ * @return False if no source has been seen at this index.
+ * 
+ */
+bool esp_ieee802154_traffic_get_rx_stats(uint8_t index, ieee802154_traffic_rx_stats_t *stats);
+
+/**
+ * Register the "traffic" console command.
+ * 
+ * traffic start <profile>   Start a profile
+ * traffic stop              Stop the running profile
+ * traffic save [profile]    Save the profile (or the running one) in NVS
+ * traffic clear             Erase the saved profile
+ * traffic stats             Print the generator and verifier statistics
+ * traffic reset             Reset the statistics
+ * 
+ * @return ESP_OK on success, otherwise the error of esp_console_cmd_register().
+ * 
+ */
+esp_err_t esp_ieee802154_traffic_register_console(void);
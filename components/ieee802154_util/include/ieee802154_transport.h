@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_window.h"
+
+/**
+ * Reliable transport with a sliding window of in-flight frames.
+ *
+ * Data frames are sent without MAC ACK request through the TX engine, the receiver acknowledges them with
+ * cumulative and selective transport ACKs (see ieee802154_window.h). Only missing segments are retransmitted.
+ * The TX engine needs to be started before, see esp_ieee802154_tx_engine_start().
+ *
+ * The goodput only exceeds stop-and-wait with MAC ACKs from a window of about 16 on; a window of 8 breaks even
+ * (see tools/ieee802154_window_sim.c). The apps use CONFIG_IEEE802154_UTIL_TRANSPORT_WINDOW, 32 by default.
+ */
+
+typedef struct ieee802154_transport *ieee802154_transport_handle_t;
+
+typedef struct {
+    uint32_t transmissions;     // Data segments sent (sender) or ACKs sent (receiver)
+    uint32_t retransmissions;   // Data segments sent again (sender)
+    uint32_t delivered;         // Segments delivered in order (receiver)
+    uint32_t duplicates;        // Segments received more than once (receiver)
+} ieee802154_transport_stats_t;
+
+/**
+ * Open a sending transport to a destination.
+ * 
+ * @param[in]   dst_pan_id  Destination pan id.
+ * @param[in]   dst_addr    Pointer to the destination address ieee802154 struct.
+ * @param[in]   window      Maximum number of segments in flight (1 to IEEE802154_WINDOW_MAX).
+ * @param[in]   rto_ms      Retransmission timeout in milliseconds.
+ * @param[out]  handle      Pointer to store the transport handle.
+ * 
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the transport can not be allocated.
+ * 
+ */
+esp_err_t esp_ieee802154_transport_open(uint16_t dst_pan_id, const ieee802154_address_t *dst_addr, uint8_t window,
+                                        uint32_t rto_ms, ieee802154_transport_handle_t *handle);
+
+/**
+ * Send a segment, blocks while the window is full.
+ * 
+ * @param[in]  handle   The transport handle.
+ * @param[in]  data     Pointer to the segment data.
+ * @param[in]  length   Length of the segment, at most esp_ieee802154_transport_max_segment().
+ * @param[in]  timeout  Time to wait for a free window slot.
+ * 
+ * @return ESP_OK if the segment has been enqueued, ESP_ERR_INVALID_SIZE if it is too long,
+ *         ESP_ERR_TIMEOUT if the window stayed full.
+ * 
+ */
+esp_err_t esp_ieee802154_transport_send(ieee802154_transport_handle_t handle, const void *data, uint8_t length, TickType_t timeout);
+
+/**
+ * Wait until all sent segments are acknowledged.
+ * 
+ * @param[in]  handle   The transport handle.
+ * @param[in]  timeout  Maximum time to wait.
+ * 
+ * @return ESP_OK if all segments are acknowledged, ESP_ERR_TIMEOUT otherwise.
+ * 
+ */
+esp_err_t esp_ieee802154_transport_flush(ieee802154_transport_handle_t handle, TickType_t timeout);
+
+/**
+ * Get the maximum segment length of a sending transport (depends on the addressing of the frames).
+ * 
+ */
+uint8_t esp_ieee802154_transport_max_segment(ieee802154_transport_handle_t handle);
+
+/**
+ * Open a receiving transport for a source.
+ * 
+ * @param[in]   src_pan_id  Source pan id.
+ * @param[in]   src_addr    Pointer to the source address ieee802154 struct.
+ * @param[in]   window      Window of the sender.
+ * @param[in]   deliver     Callback for each segment in order, called in the task that calls esp_ieee802154_transport_input().
+ * @param[in]   arg         Argument for the callback.
+ * @param[out]  handle      Pointer to store the transport handle.
+ * 
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the transport can not be allocated.
+ * 
+ */
+esp_err_t esp_ieee802154_transport_listen(uint16_t src_pan_id, const ieee802154_address_t *src_addr, uint8_t window,
+                                          ieee802154_window_deliver_cb_t deliver, void *arg, ieee802154_transport_handle_t *handle);
+
+/**
+ * Pass a received frame to the transports.
+ * 
+ * Data segments go to the receiving transport of the source, ACK segments to the sending transport to the source.
+ * 
+ * @param[in]  frame  Pointer to the received frame (frame[0] is the length).
+ * 
+ * @return True if the frame was a transport frame of an open transport and has been consumed.
+ * 
+ * Note: This function should be called in the task that processes the received frames, not in ISR context.
+ * 
+ */
+bool esp_ieee802154_transport_input(const uint8_t *frame);
+
+/**
+ * Get the statistics of a transport.
+ * 
+ * @param[in]   handle  The transport handle.
+ * @param[out]  stats   Pointer to store the statistics.
+ * 
+ */
+void esp_ieee802154_transport_get_stats(ieee802154_transport_handle_t handle, ieee802154_transport_stats_t *stats);
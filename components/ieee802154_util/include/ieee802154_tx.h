@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <esp_ieee802154.h>
+#include <freertos/FreeRTOS.h>
+
+typedef struct {
+    int64_t submit_us;                // Frame queued (esp_timer time base)
+    int64_t start_us;                 // esp_ieee802154_transmit() called
+    int64_t done_us;                  // Transmit done or failed event of the radio (or the engine timeout)
+    int64_t ack_us;                   // SFD of the ACK, 0 without ACK
+} ieee802154_tx_timing_t;
+
+typedef struct {
+    esp_ieee802154_tx_error_t error;  // ESP_IEEE802154_TX_ERR_NONE if the frame was sent (and ACKed if requested)
+    bool acked;                       // An ACK frame was received
+    int8_t power_dbm;                 // TX power the frame was sent with (see ieee802154_power.h)
+    int8_t ack_rssi;
+    uint8_t ack_lqi;
+    uint8_t ack[128];                 // Copy of the ACK frame (ack[0] is the length), only valid if acked is true
+    ieee802154_tx_timing_t timing;
+} ieee802154_tx_result_t;
+
+/**
+ * Callback which is called in the TX engine task when a frame is done.
+ * 
+ * @param[in]  frame   Pointer to the frame that was sent (frame[0] is the length).
+ * @param[in]  result  Pointer to the outcome of the transmission.
+ * @param[in]  arg     The argument given to esp_ieee802154_tx_engine_submit() or esp_ieee802154_tx_engine_submit_ref().
+ * 
+ */
+typedef void (*ieee802154_tx_done_cb_t)(const uint8_t *frame, const ieee802154_tx_result_t *result, void *arg);
+
+/**
+ * Start the TX engine.
+ * 
+ * The TX engine owns the radio transmitter. Frames are queued and sent back-to-back by a task, each
+ * transmission waits for the radio to report the outcome before the next frame is started.
+ * Every frame is timestamped on submit, start, done and ACK, the latencies are kept per destination
+ * (see ieee802154_tx_latency.h). The TX power is chosen per destination from the ACKs (see ieee802154_power.h),
+ * the application sets the radio to IEEE802154_POWER_NOMINAL_DBM before the engine is started.
+ * The per-destination state is kept by address book id. The engine adds at most IEEE802154_POWER_MAX_DESTINATIONS
+ * unknown destinations to the book, further ones only get that state once the application or a module (e.g. the
+ * mesh for its neighbors) adds them.
+ * 
+ * @param[in]  queue_length  Number of frames that can be queued.
+ * @param[in]  priority      Priority of the TX engine task.
+ * 
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the queue, the frame buffers or the task can not be created.
+ * 
+ */
+esp_err_t esp_ieee802154_tx_engine_start(uint8_t queue_length, UBaseType_t priority);
+
+/**
+ * Queue a frame for transmission. The frame is copied.
+ * 
+ * @param[in]  frame    Pointer to the frame (frame[0] is the length).
+ * @param[in]  cca      Bool to set whether CCA is performed before the transmission.
+ * @param[in]  cb       Callback for the outcome, can be NULL.
+ * @param[in]  arg      Argument for the callback.
+ * @param[in]  timeout  Time to wait for a free buffer and space in the queue.
+ * 
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the frame is longer than IEEE802154_MAX_PSDU_LENGTH,
+ *         ESP_ERR_TIMEOUT if the queue is full.
+ * 
+ */
+esp_err_t esp_ieee802154_tx_engine_submit(const uint8_t *frame, bool cca, ieee802154_tx_done_cb_t cb, void *arg, TickType_t timeout);
+
+/**
+ * Queue a frame for transmission without copying it.
+ * 
+ * The engine sends the frame from the given buffer, which must stay valid and unchanged until the callback is
+ * called: the callback hands the buffer back to the caller (its frame argument is the buffer).
+ * 
+ * @param[in]  frame    Pointer to the frame (frame[0] is the length).
+ * @param[in]  cca      Bool to set whether CCA is performed before the transmission.
+ * @param[in]  cb       Callback for the outcome, can be NULL if the buffer is never reused.
+ * @param[in]  arg      Argument for the callback.
+ * @param[in]  timeout  Time to wait for space in the queue.
+ * 
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the frame is longer than IEEE802154_MAX_PSDU_LENGTH,
+ *         ESP_ERR_TIMEOUT if the queue is full (the buffer stays with the caller then).
+ * 
+ */
+esp_err_t esp_ieee802154_tx_engine_submit_ref(const uint8_t *frame, bool cca, ieee802154_tx_done_cb_t cb, void *arg, TickType_t timeout);
+
+/**
+ * Queue a frame for transmission and wait for the outcome.
+ * 
+ * @param[in]   frame    Pointer to the frame (frame[0] is the length).
+ * @param[in]   cca      Bool to set whether CCA is performed before the transmission.
+ * @param[out]  result   Pointer to store the outcome, can be NULL.
+ * @param[in]   timeout  Time to wait for space in the queue.
+ * 
+ * @return ESP_OK if the frame was sent (and ACKed if requested), ESP_FAIL if the transmission failed
+ *         and ESP_ERR_TIMEOUT if the queue is full.
+ * 
+ * Note: Waits on a semaphore of its own, the task notification of the calling task stays free for the
+ *       application. Must not be called in a TX done callback or while the engine is paused.
+ * 
+ */
+esp_err_t esp_ieee802154_tx_engine_transmit(const uint8_t *frame, bool cca, ieee802154_tx_result_t *result, TickType_t timeout);
+
+/**
+ * Pause the TX engine, e.g. while the radio is used for something else (see ieee802154_survey.h).
+ * 
+ * Waits until the frame in flight is done, queued frames stay queued until esp_ieee802154_tx_engine_resume().
+ * Does nothing if the engine is not started.
+ * 
+ * Note: Must be called by the task that resumes the engine, not in a TX done callback, and the task must not
+ *       wait for a frame of the engine (esp_ieee802154_tx_engine_transmit()) while the engine is paused.
+ * 
+ */
+void esp_ieee802154_tx_engine_pause(void);
+
+/**
+ * Resume the TX engine after esp_ieee802154_tx_engine_pause().
+ * 
+ */
+void esp_ieee802154_tx_engine_resume(void);
+
+/**
+ * Check whether a frame of the TX engine is on air (or waits for its ACK), safe in ISR context.
+ * 
+ * Code that transmits outside the engine (e.g. the software ACKs of ieee802154_addr_table.h) checks it first,
+ * any other transmission aborts the frame of the engine. If the driver does not report such an abort, the
+ * engine detects it at its timeout and reports ESP_IEEE802154_TX_ERR_ABORT (not a timeout).
+ * 
+ * @return True if a frame is in flight.
+ * 
+ */
+bool esp_ieee802154_tx_engine_busy(void);
+
+/**
+ * Forward the transmit done event of the radio to the TX engine.
+ * 
+ * Note: This function needs to be called in the esp_ieee802154_transmit_done() function.
+ * 
+ */
+void esp_ieee802154_tx_engine_transmit_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info);
+
+/**
+ * Forward the transmit failed event of the radio to the TX engine.
+ * 
+ * Note: This function needs to be called in the esp_ieee802154_transmit_failed() function.
+ * 
+ */
+void esp_ieee802154_tx_engine_transmit_failed(const uint8_t *frame, esp_ieee802154_tx_error_t error);
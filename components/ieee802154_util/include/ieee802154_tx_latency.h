@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "ieee802154_tx.h"
+#include "ieee802154_histogram.h"
+#include "ieee802154_addr_book.h"
+
+/**
+ * TX latency histograms.
+ *
+ * The TX engine records the timestamps of every frame (ieee802154_tx_timing_t) and hands them to this module,
+ * which keeps three log-spaced histograms per destination (address book id, broadcasts are not recorded):
+ * - queue:      from the submit to the start of the transmission (queue depth)
+ * - round trip: from the start to the done event of frames that were sent, with the ACK if one was requested
+ *               (CCA, air time, ACK wait)
+ * - failed:     from the start to the failed event (CCA busy, no ACK, abort)
+ */
+#define IEEE802154_TX_LATENCY_MAX_DESTINATIONS 16
+
+typedef struct {
+    ieee802154_histogram_t queue;
+    ieee802154_histogram_t round_trip;
+    ieee802154_histogram_t failed;
+} ieee802154_tx_latency_t;
+
+/**
+ * Record the outcome of a transmission, called by the TX engine task.
+ *
+ * @param[in]  dst     Address book id of the destination (see esp_ieee802154_addr_book_destination()).
+ * @param[in]  result  Pointer to the outcome with the timestamps.
+ *
+ */
+void esp_ieee802154_tx_latency_record(ieee802154_addr_id_t dst, const ieee802154_tx_result_t *result);
+
+/**
+ * Get the histograms of a destination.
+ *
+ * @return False if no frames to the destination were recorded.
+ *
+ */
+bool esp_ieee802154_tx_latency_get(ieee802154_addr_id_t id, ieee802154_tx_latency_t *latency);
+
+/**
+ * Clear all histograms.
+ *
+ */
+void esp_ieee802154_tx_latency_reset(void);
+
+/**
+ * Register the console command:
+ *
+ * txtime          Print the queue, round-trip and failure histograms of every destination
+ * txtime reset    Clear all histograms
+ *
+ * @return ESP_OK on success.
+ *
+ */
+esp_err_t esp_ieee802154_tx_latency_register_console(void);
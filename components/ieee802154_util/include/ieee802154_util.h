@@ -0,0 +1,385 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef ESP_PLATFORM
+#include <esp_attr.h>
+#include "sdkconfig.h"
+#endif
+
+/**
+ * Functions which are called in the radio ISR are placed in IRAM (if enabled), so they do not stall on
+ * flash cache misses. Host builds do not define ESP_PLATFORM and ignore the attribute.
+ */
+#if defined(ESP_PLATFORM) && CONFIG_IEEE802154_UTIL_ISR_IN_IRAM
+#define IEEE802154_ISR_ATTR IRAM_ATTR
+#else
+#define IEEE802154_ISR_ATTR
+#endif
+
+// Host builds always include the printer
+#if !defined(ESP_PLATFORM) || CONFIG_IEEE802154_UTIL_PRINT_ENABLE
+#define IEEE802154_PRINT_ENABLED 1
+#else
+#define IEEE802154_PRINT_ENABLED 0
+#endif
+
+#define IEEE802154_MAX_PSDU_LENGTH 127 // Including the FCS
+#define IEEE802154_ADDRESS_TEXT_LENGTH 17 // 16 hex digits of a long address and the terminator
+
+#define FRAME_VERSION_STD_2003 0
+#define FRAME_VERSION_STD_2006 1
+#define FRAME_VERSION_STD_2015 2
+
+#define FRAME_TYPE_BEACON       (0)
+#define FRAME_TYPE_DATA         (1)
+#define FRAME_TYPE_ACK          (2)
+#define FRAME_TYPE_MAC_COMMAND  (3)
+#define FRAME_TYPE_RESERVED     (4)
+#define FRAME_TYPE_MULTIPURPOSE (5)
+#define FRAME_TYPE_FRAGMENT     (6)
+#define FRAME_TYPE_EXTENDED     (7)
+
+#define ADDR_MODE_NONE     (0)  // PAN ID and address fields are not present
+#define ADDR_MODE_RESERVED (1)  // Reseved
+#define ADDR_MODE_SHORT    (2)  // Short address (16-bit)
+#define ADDR_MODE_LONG     (3)  // Extended address (64-bit)
+
+typedef struct ieee802154_fcf {
+    uint8_t frame_type                      : 3;
+    uint8_t secure                          : 1;
+    uint8_t frame_pending                   : 1;
+    uint8_t ack_request                     : 1;
+    uint8_t pan_id_compression              : 1;
+    uint8_t reserved                        : 1;
+    uint8_t sequence_number_suppression     : 1;
+    uint8_t information_elements_present    : 1;
+    uint8_t dst_addr_mode                   : 2;
+    uint8_t frame_ver                       : 2;
+    uint8_t src_addr_mode                   : 2;
+} ieee802154_fcf_t;
+
+/**
+ * Extended addresses are held as native 64-bit values (e.g. 0x404ccafffe5cefd8 for the printed address
+ * 404ccafffe5cefd8). The byte order is only converted where an address enters or leaves the node: in the
+ * frame headers and the radio registers (least significant byte first) and in the text form.
+ */
+typedef struct {
+    uint8_t mode; // ADDR_MODE_NONE || ADDR_MODE_SHORT || ADDR_MODE_LONG
+    union {
+        uint16_t short_address;
+        uint64_t long_address;
+    };
+} ieee802154_address_t;
+
+/* --- Byte order of extended addresses --- */
+
+/**
+ * Read an extended address from a frame or the radio (least significant byte first).
+ */
+static inline __attribute__((always_inline)) uint64_t esp_ieee802154_ext_address_read(const uint8_t *air)
+{
+    uint64_t addr = 0;
+    for (int8_t idx = 7; idx >= 0; idx--)
+    {
+        addr = (addr << 8) | air[idx];
+    }
+    return addr;
+}
+
+/**
+ * Write an extended address into a frame or for the radio (least significant byte first).
+ */
+static inline __attribute__((always_inline)) void esp_ieee802154_ext_address_write(uint64_t addr, uint8_t *air)
+{
+    for (uint8_t idx = 0; idx < 8; idx++)
+    {
+        air[idx] = addr & 0xFF;
+        addr >>= 8;
+    }
+}
+
+/**
+ * Convert an EUI-64 in the order it is printed (e.g. from esp_read_mac()) to an extended address.
+ */
+static inline uint64_t esp_ieee802154_ext_address_from_eui64(const uint8_t *eui64)
+{
+    uint64_t addr = 0;
+    for (uint8_t idx = 0; idx < 8; idx++)
+    {
+        addr = (addr << 8) | eui64[idx];
+    }
+    return addr;
+}
+
+typedef struct {
+    uint8_t frame_type;
+    uint8_t frame_version;
+    bool secure;
+    bool frame_pending;
+    bool ack_request;
+    bool pan_id_compression;
+    bool sequence_number_suppression;
+    bool information_elements_present;
+    bool sequence_number_present;
+    uint8_t sequence_number;
+    uint16_t dst_pan_id;            // Only valid if dst_addr.mode is ADDR_MODE_SHORT or ADDR_MODE_LONG
+    uint16_t src_pan_id;            // Equals dst_pan_id if the pan id is compressed
+    ieee802154_address_t dst_addr;
+    ieee802154_address_t src_addr;
+    uint8_t header_length;          // Length of the MAC header (FCF to the end of the addressing fields)
+    uint8_t payload_length;         // Length of the payload (without FCS)
+} ieee802154_frame_t;
+
+/**
+ * Function to create a header for a 2003 ieee802154 data frame.
+ * 
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  src_pan_id   Source pan id.
+ * @param[in]  src_addr     Pointer to the source address ieee802154 struct.
+ * @param[in]  seq_nr       Sequence number of this data frame.
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * @param[in]  header       Pointer to the buffer which should store the frame.
+ * 
+ * Note: The seq_nr cannot be NULL!
+ * 
+ */
+uint8_t esp_ieee802154_create_2003_data_header(uint16_t *dst_pan_id, ieee802154_address_t *dst_addr, uint16_t *src_pan_id, ieee802154_address_t *src_addr, uint8_t *seq_nr, bool ack, uint8_t *header);
+
+/**
+ * Function to create a header for a 2015 ieee802154 data frame.
+ * 
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  src_pan_id   Source pan id.
+ * @param[in]  src_addr     Pointer to the source address ieee802154 struct.
+ * @param[in]  seq_nr       Sequence number of this data frame.
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * @param[in]  header       Pointer to the buffer which should store the frame.
+ * 
+ */
+uint8_t esp_ieee802154_create_2015_data_header(uint16_t *dst_pan_id, ieee802154_address_t *dst_addr, uint16_t *src_pan_id, ieee802154_address_t *src_addr, uint8_t *seq_nr, bool ack, uint8_t *header);
+
+/**
+ * Function to get the source pan id and address of this node from the radio configuration.
+ * 
+ * If a short source address is available (different from 0xffff) the short address will be used,
+ * otherwise the extended address.
+ * 
+ * @param[out]  src_pan_id  Pointer to store the source pan id.
+ * @param[out]  src_addr    Pointer to store the source address.
+ * 
+ */
+void esp_ieee802154_get_source_address(uint16_t *src_pan_id, ieee802154_address_t *src_addr);
+
+/**
+ * Function to create a 2003 ieee802154 data frame with payload, without sending it.
+ * 
+ * The source address is taken from the radio configuration, see esp_ieee802154_send_2003_l2_data_frame().
+ * 
+ * @param[out] frame        Pointer to the buffer (at least 128 bytes) which stores the frame, frame[0] is the length.
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  data         Pointer to the data.
+ * @param[in]  data_length  Length of the data.
+ * @param[in]  seq_nr       Sequence number of this data frame.
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * 
+ * @return The length of the frame (frame[0]) or 0 if the payload does not fit into the frame.
+ * 
+ */
+uint8_t esp_ieee802154_create_2003_l2_data_frame(uint8_t *frame, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack);
+
+/**
+ * Function to create a 2015 ieee802154 data frame with payload, without sending it.
+ * 
+ * The source address is taken from the radio configuration, see esp_ieee802154_send_2015_l2_data_frame().
+ * 
+ * @param[out] frame        Pointer to the buffer (at least 128 bytes) which stores the frame, frame[0] is the length.
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  data         Pointer to the data.
+ * @param[in]  data_length  Length of the data.
+ * @param[in]  seq_nr       Sequence number of this data frame (NULL to suppress it).
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * 
+ * @return The length of the frame (frame[0]) or 0 if the payload does not fit into the frame.
+ * 
+ */
+uint8_t esp_ieee802154_create_2015_l2_data_frame(uint8_t *frame, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack);
+
+/**
+ * Function to create a 2015 ieee802154 data frame with an explicit source, without sending it.
+ * 
+ * Used to emulate several nodes from one radio, e.g. the virtual nodes of the traffic generator.
+ * 
+ * @param[out] frame        Pointer to the buffer (at least 128 bytes) which stores the frame, frame[0] is the length.
+ * @param[in]  src_pan_id   Source pan id.
+ * @param[in]  src_addr     Pointer to the source address ieee802154 struct.
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  data         Pointer to the data.
+ * @param[in]  data_length  Length of the data.
+ * @param[in]  seq_nr       Sequence number of this data frame (NULL to suppress it).
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * 
+ * @return The length of the frame (frame[0]) or 0 if the payload does not fit into the frame.
+ * 
+ */
+uint8_t esp_ieee802154_create_2015_l2_data_frame_from(uint8_t *frame, uint16_t src_pan_id, ieee802154_address_t *src_addr, uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack);
+
+/**
+ * Function to send a 2003 ieee802154 data frame with payload.
+ * 
+ * The source pan id and short/extended address need to be set via esp_ieee802154_set_panid() and
+ * esp_ieee802154_set_short/extended_address().
+ * If a short source address is available (different from 0xfff) the short address will be used.
+ * 
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  data         Pointer to the data.
+ * @param[in]  data_length  Length of the data.
+ * @param[in]  seq_nr       Sequence number of this data frame.
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * 
+ * Note: The seq_nr cannot be NULL!
+ * 
+ */
+void esp_ieee802154_send_2003_l2_data_frame(uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack);
+
+/**
+ * Function to send a 2015 ieee802154 data frame with payload.
+ * 
+ * The source pan id and short/extended address need to be set via esp_ieee802154_set_panid() and
+ * esp_ieee802154_set_short/extended_address().
+ * If a short source address is available (different from 0xfff) the short address will be used.
+ * 
+ * @param[in]  dst_pan_id   Destination pan id.
+ * @param[in]  dst_addr     Pointer to the destination address ieee802154 struct.
+ * @param[in]  data         Pointer to the data.
+ * @param[in]  data_length  Length of the data.
+ * @param[in]  seq_nr       Sequence number of this data frame.
+ * @param[in]  ack          Bool to set whether an ACK frame is required or not.
+ * 
+ */
+void esp_ieee802154_send_2015_l2_data_frame(uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr, bool ack);
+
+/**
+ * Function to create a 2015 ieee802154 ack frame from a received frame.
+ * 
+ * This function uses loop unrolling to be more efficient. A payload registered for the source of the frame
+ * with esp_ieee802154_ack_payload_set() is appended to the ACK.
+ * 
+ * @param[in]  frame            Pointer to the received frame.
+ * @param[in]  enhack_frame     Pointer to the to the buffer to store the Enh-ACK frame.
+ * 
+ * Note: This function should be called in the esp_ieee802154_enh_ack_generator() function.
+ * 
+ */
+void esp_ieee802154_create_2015_ack_frame(uint8_t *frame, uint8_t *enhack_frame);
+
+/**
+ * Parse the MAC header of a frame.
+ * 
+ * The addressing fields are parsed the same way as they are created by the header builders and the ACK
+ * generator: a pan id is present for every present address, the source pan id is omitted if the pan id
+ * compression bit is set.
+ * 
+ * @param[in]   psdu         Pointer to the PSDU (the first byte of the frame control field).
+ * @param[in]   psdu_length  Length of the PSDU, including the FCS (frame[0] of a received frame).
+ * @param[out]  frame        Pointer to the struct which stores the parsed fields.
+ * 
+ * @return True if the header fits into the PSDU and neither security nor information elements are used.
+ * 
+ * Note: This function does not depend on the radio driver and can be used in host tools.
+ * 
+ */
+bool esp_ieee802154_parse_frame(const uint8_t *psdu, uint8_t psdu_length, ieee802154_frame_t *frame);
+
+/**
+ * Compare two addresses.
+ * 
+ * @param[in]  a  Pointer to the first address ieee802154 struct.
+ * @param[in]  b  Pointer to the second address ieee802154 struct.
+ * 
+ * @return True if the modes and the addresses of the mode match.
+ * 
+ */
+bool esp_ieee802154_address_equal(const ieee802154_address_t *a, const ieee802154_address_t *b);
+
+/**
+ * Parse an address from text: a short address (e.g. 0x1234) or a long address as 16 hex digits in the
+ * order they are printed (e.g. 404ccafffe5cefd8).
+ * 
+ * @param[in]   str   The text.
+ * @param[out]  addr  Pointer to store the address.
+ * 
+ * @return True if the text is a valid address (the broadcast address 0xffff is not).
+ * 
+ */
+bool esp_ieee802154_parse_address(const char *str, ieee802154_address_t *addr);
+
+/**
+ * Format an address as text, the inverse of esp_ieee802154_parse_address() ("none" without address).
+ * 
+ * @param[out]  buffer  Buffer for the text, IEEE802154_ADDRESS_TEXT_LENGTH bytes fit every address.
+ * @param[in]   size    Size of the buffer.
+ * @param[in]   addr    Pointer to the address.
+ * 
+ * @return The length of the text, see snprintf().
+ * 
+ */
+int esp_ieee802154_format_address(char *buffer, size_t size, const ieee802154_address_t *addr);
+
+/**
+ * Get the address at an offset from a base address: the short address plus the offset, or the long address
+ * with the offset added to its lowest two bytes. Used for ranges of (virtual) nodes.
+ * 
+ * @param[in]   base    Pointer to the base address.
+ * @param[in]   offset  Offset from the base address.
+ * @param[out]  addr    Pointer to store the address.
+ * 
+ */
+void esp_ieee802154_address_offset(const ieee802154_address_t *base, uint16_t offset, ieee802154_address_t *addr);
+
+#if IEEE802154_PRINT_ENABLED
+#define IEEE802154_PRINT_BUFFER_SIZE 4096 // Text of the largest frame, longer output is truncated
+
+/**
+ * Print the contents of a packet.
+ * 
+ * Currently supported frames are
+ * - 2003/2006 Data and ACK frames
+ * - 2015 Data frames
+ * 
+ * Note: Security and Information Elements are not supported.
+ * 
+ * The frame is rendered into a static buffer and written with a single log call at INFO level, so the
+ * function is not reentrant. Call it from one task only (e.g. the receiver task).
+ * 
+ * @param[in]  packet  The package for which the information is to be printed.
+ * 
+ */
+void esp_ieee802154_print_packet(uint8_t *packet);
+
+/**
+ * Render the contents of a packet as text, in the same line format as ESP_LOGx.
+ * 
+ * @param[in]   packet     The packet (packet[0] is the length, rssi/lqi in place of the FCS).
+ * @param[in]   timestamp  Timestamp in milliseconds printed in the line prefix.
+ * @param[out]  buffer     Buffer for the text, IEEE802154_PRINT_BUFFER_SIZE bytes fit every frame.
+ * @param[in]   size       Size of the buffer.
+ * 
+ * @return Length of the text (without the terminating zero).
+ * 
+ */
+size_t esp_ieee802154_render_packet(const uint8_t *packet, uint32_t timestamp, char *buffer, size_t size);
+#else
+static inline void esp_ieee802154_print_packet(uint8_t *packet)
+{
+    (void)packet; // Printing is compiled out (CONFIG_IEEE802154_UTIL_PRINT_ENABLE)
+}
+#endif
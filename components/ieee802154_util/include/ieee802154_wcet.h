@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <esp_cpu.h>
+
+#include "sdkconfig.h"
+
+/**
+ * Worst-case execution time (WCET) measurement for the code that runs in ISR context.
+ *
+ * The measurement is enabled with CONFIG_IEEE802154_UTIL_WCET_ENABLE.
+ * If disabled, the measurement macros compile to nothing.
+ */
+#if CONFIG_IEEE802154_UTIL_WCET_ENABLE
+#define IEEE802154_WCET_ENABLED       1
+#define IEEE802154_WCET_BUDGET_CYCLES CONFIG_IEEE802154_UTIL_WCET_BUDGET_CYCLES  // Budget for a single call
+#define IEEE802154_WCET_RANDOM_FRAMES CONFIG_IEEE802154_UTIL_WCET_RANDOM_FRAMES  // Random frames after the FCF corpus
+#else
+#define IEEE802154_WCET_ENABLED       0
+#endif
+
+#define IEEE802154_WCET_BUCKET_CYCLES 16  // Width of a histogram bucket
+#define IEEE802154_WCET_BUCKETS       256 // The last bucket collects everything above the histogram range
+
+typedef struct {
+    const char *name;
+    const char *unit;         // Unit of the counts in the report, "cycles" unless the counter is replaced
+    uint32_t samples;
+    uint32_t max_cycles;
+    uint32_t histogram[IEEE802154_WCET_BUCKETS];
+    uint8_t worst_input[128]; // Frame (including the length byte) that caused max_cycles
+} ieee802154_wcet_t;
+
+#if IEEE802154_WCET_ENABLED
+#define ESP_IEEE802154_WCET_START(start) uint32_t start = esp_cpu_get_cycle_count()
+#define ESP_IEEE802154_WCET_STOP(wcet, start, frame) esp_ieee802154_wcet_record(wcet, esp_cpu_get_cycle_count() - (start), frame)
+#else
+#define ESP_IEEE802154_WCET_START(start)
+#define ESP_IEEE802154_WCET_STOP(wcet, start, frame)
+#endif
+
+/**
+ * Initialize (or reset) a WCET measurement.
+ * 
+ * @param[in]  wcet  Pointer to the measurement.
+ * @param[in]  name  Name of the measured code path, used for the report.
+ * 
+ */
+void esp_ieee802154_wcet_init(ieee802154_wcet_t *wcet, const char *name);
+
+/**
+ * Record a single execution time. If it is the new maximum, the input frame is stored.
+ * 
+ * @param[in]  wcet    Pointer to the measurement.
+ * @param[in]  cycles  Measured CPU cycles.
+ * @param[in]  frame   Pointer to the frame (length byte first) that was processed, can be NULL.
+ * 
+ * Note: This function can be called in ISR context.
+ * 
+ */
+void esp_ieee802154_wcet_record(ieee802154_wcet_t *wcet, uint32_t cycles, const uint8_t *frame);
+
+/**
+ * Get a percentile of the recorded execution times.
+ * 
+ * @param[in]  wcet        Pointer to the measurement.
+ * @param[in]  percentile  Percentile between 0 and 100.
+ * 
+ * @return The upper bound of the histogram bucket that contains the percentile, in CPU cycles. At most the
+ *         maximum, so the percentile is never above the slowest recorded run.
+ * 
+ */
+uint32_t esp_ieee802154_wcet_percentile(const ieee802154_wcet_t *wcet, uint8_t percentile);
+
+/**
+ * Log max, p99 and the worst input of a measurement and check it against a budget.
+ * 
+ * @param[in]  wcet           Pointer to the measurement.
+ * @param[in]  budget_cycles  Maximum allowed CPU cycles for a single execution.
+ * 
+ * @return ESP_OK if the maximum is within the budget, ESP_FAIL otherwise.
+ * 
+ */
+esp_err_t esp_ieee802154_wcet_report(const ieee802154_wcet_t *wcet, uint32_t budget_cycles);
+
+/**
+ * Code path that is measured over the corpus, called once per corpus frame.
+ * 
+ * @param[in]  frame  Pointer to the frame (frame[0] is the length), the buffer holds 128 bytes.
+ * 
+ */
+typedef void (*ieee802154_wcet_handler_t)(uint8_t *frame);
+
+/**
+ * Run a code path over a corpus of frames and record its execution times.
+ * 
+ * The corpus consists of every possible frame control field with a valid frame length, followed by
+ * random_frames frames with random content and random (possibly malformed) length.
+ * The random frames use a fixed seed, so the worst input can be reproduced.
+ * 
+ * On target the execution time is counted in CPU cycles. The host tool tools/ieee802154_wcet_host.c runs the
+ * same corpus and counts instructions (see esp_cpu_get_cycle_count() in tools/host).
+ * 
+ * @param[in]  wcet           Pointer to the measurement, initialized with esp_ieee802154_wcet_init().
+ * @param[in]  handler        Code path to measure.
+ * @param[in]  random_frames  Number of random frames.
+ * 
+ */
+void esp_ieee802154_wcet_run_corpus(ieee802154_wcet_t *wcet, ieee802154_wcet_handler_t handler, uint32_t random_frames);
+
+/**
+ * Run esp_ieee802154_create_2015_ack_frame() over the corpus (see esp_ieee802154_wcet_run_corpus()) and report
+ * the execution times.
+ * 
+ * @param[in]  random_frames  Number of random frames.
+ * @param[in]  budget_cycles  Maximum allowed CPU cycles for a single ACK creation.
+ * 
+ * @return ESP_OK if the maximum is within the budget, ESP_FAIL otherwise.
+ * 
+ */
+esp_err_t esp_ieee802154_wcet_run_ack_generator(uint32_t random_frames, uint32_t budget_cycles);
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ieee802154_util.h"
+
+/**
+ * Sliding window ARQ with cumulative and selective acknowledgements.
+ *
+ * This is the protocol core of the reliable transport (see ieee802154_transport.h). It does not use the radio
+ * driver or FreeRTOS, the caller passes the time and moves the segments, so it can also be used on the host.
+ *
+ * Segment formats (payload of a data frame):
+ *
+ * Data: | Dispatch (1) | Type = DATA (1) | Seq (1) | Data (n) |
+ * ACK:  | Dispatch (1) | Type = ACK (1)  | Cumulative (1) | Selective bitmap (4, little endian) |
+ *
+ * Cumulative is the next sequence number the receiver expects in order. Bit i of the selective bitmap is set
+ * if sequence number cumulative + 1 + i has been received. Data frames are sent without MAC ACK request, so
+ * up to window segments are in flight and only the missing ones are retransmitted.
+ */
+#define IEEE802154_WINDOW_DISPATCH      0xB6
+#define IEEE802154_WINDOW_TYPE_DATA     0
+#define IEEE802154_WINDOW_TYPE_ACK      1
+#define IEEE802154_WINDOW_HEADER_LENGTH 3
+#define IEEE802154_WINDOW_ACK_LENGTH    7
+#define IEEE802154_WINDOW_MAX           32  // Maximum window, limited by the selective bitmap (power of two)
+#define IEEE802154_WINDOW_MAX_SEGMENT   (IEEE802154_MAX_PSDU_LENGTH - IEEE802154_WINDOW_HEADER_LENGTH)
+
+typedef struct {
+    uint8_t length;
+    bool sent;
+    bool lost;              // Reported missing by a selective ACK, retransmitted without waiting for the timeout
+    bool acked;
+    uint32_t sent_at;
+    uint32_t order;         // Transmission counter of the last transmission
+    uint8_t data[IEEE802154_WINDOW_MAX_SEGMENT];
+} ieee802154_window_slot_t;
+
+typedef struct {
+    uint8_t window;
+    uint8_t base;           // Oldest sequence number that is not acknowledged cumulatively
+    uint8_t next;           // Sequence number of the next enqueued segment
+    uint32_t rto_us;        // Retransmission timeout
+    uint32_t transmissions;
+    uint32_t retransmissions;
+    ieee802154_window_slot_t slots[IEEE802154_WINDOW_MAX];
+} ieee802154_window_tx_t;
+
+typedef struct {
+    uint8_t window;
+    uint8_t expected;       // Next sequence number to deliver
+    uint32_t received;      // Bit i: sequence number expected + i is buffered
+    uint8_t unacked;        // Segments received since the last ACK
+    bool ack_now;           // An ACK should be sent without delay
+    uint32_t delivered;
+    uint32_t duplicates;
+    ieee802154_window_slot_t slots[IEEE802154_WINDOW_MAX];
+} ieee802154_window_rx_t;
+
+typedef void (*ieee802154_window_deliver_cb_t)(const uint8_t *data, uint8_t length, void *arg);
+
+/**
+ * Initialize the sender side.
+ * 
+ * @param[out]  tx      Pointer to the sender state.
+ * @param[in]   window  Maximum number of segments in flight (1 to IEEE802154_WINDOW_MAX).
+ * @param[in]   rto_us  Retransmission timeout in microseconds.
+ * 
+ */
+void esp_ieee802154_window_tx_init(ieee802154_window_tx_t *tx, uint8_t window, uint32_t rto_us);
+
+/**
+ * Enqueue a segment.
+ * 
+ * @param[in]  tx      Pointer to the sender state.
+ * @param[in]  data    Pointer to the segment data.
+ * @param[in]  length  Length of the segment data (at most IEEE802154_WINDOW_MAX_SEGMENT).
+ * 
+ * @return False if the window is full or the segment is too long.
+ * 
+ */
+bool esp_ieee802154_window_tx_enqueue(ieee802154_window_tx_t *tx, const uint8_t *data, uint8_t length);
+
+/**
+ * Get the next segment to transmit.
+ * 
+ * Unsent segments and segments whose retransmission timeout expired are returned, oldest first.
+ * 
+ * @param[in]   tx       Pointer to the sender state.
+ * @param[in]   now_us   Current time in microseconds.
+ * @param[out]  payload  Buffer for the frame payload (IEEE802154_WINDOW_HEADER_LENGTH + segment length).
+ * 
+ * @return Length of the payload, 0 if there is nothing to transmit.
+ * 
+ */
+uint8_t esp_ieee802154_window_tx_poll(ieee802154_window_tx_t *tx, uint32_t now_us, uint8_t *payload);
+
+/**
+ * Process an ACK segment.
+ * 
+ * Segments that are still missing and were transmitted before a selectively acknowledged one are lost (the
+ * radio keeps the order) and are retransmitted by the next poll without waiting for the timeout.
+ * 
+ * @param[in]  tx       Pointer to the sender state.
+ * @param[in]  payload  Pointer to the frame payload.
+ * @param[in]  length   Length of the frame payload.
+ * 
+ * @return Number of window slots that have been freed.
+ * 
+ */
+uint8_t esp_ieee802154_window_tx_ack(ieee802154_window_tx_t *tx, const uint8_t *payload, uint8_t length);
+
+/**
+ * Get the time until the next retransmission timeout.
+ * 
+ * @param[in]  tx      Pointer to the sender state.
+ * @param[in]  now_us  Current time in microseconds.
+ * 
+ * @return Time in microseconds, UINT32_MAX if no segment is in flight.
+ * 
+ */
+uint32_t esp_ieee802154_window_tx_next_timeout(const ieee802154_window_tx_t *tx, uint32_t now_us);
+
+/**
+ * Get the number of enqueued segments that are not acknowledged yet.
+ * 
+ */
+uint8_t esp_ieee802154_window_tx_in_flight(const ieee802154_window_tx_t *tx);
+
+/**
+ * Initialize the receiver side.
+ * 
+ * @param[out]  rx      Pointer to the receiver state.
+ * @param[in]   window  Window of the sender, an ACK is sent after window / 2 in-order segments.
+ * 
+ */
+void esp_ieee802154_window_rx_init(ieee802154_window_rx_t *rx, uint8_t window);
+
+/**
+ * Process a data segment.
+ * 
+ * Segments are delivered in order, out-of-order segments are buffered until the gap is filled.
+ * 
+ * @param[in]  rx       Pointer to the receiver state.
+ * @param[in]  payload  Pointer to the frame payload.
+ * @param[in]  length   Length of the frame payload.
+ * @param[in]  deliver  Callback for each in-order segment.
+ * @param[in]  arg      Argument for the callback.
+ * 
+ * @return True if an ACK should be sent without delay (gap, duplicate or window / 2 segments received).
+ * 
+ */
+bool esp_ieee802154_window_rx_input(ieee802154_window_rx_t *rx, const uint8_t *payload, uint8_t length,
+                                    ieee802154_window_deliver_cb_t deliver, void *arg);
+
+/**
+ * Build an ACK segment and reset the ACK state.
+ * 
+ * @param[in]   rx       Pointer to the receiver state.
+ * @param[out]  payload  Buffer for the frame payload (IEEE802154_WINDOW_ACK_LENGTH).
+ * 
+ * @return Length of the payload.
+ * 
+ */
+uint8_t esp_ieee802154_window_rx_build_ack(ieee802154_window_rx_t *rx, uint8_t *payload);
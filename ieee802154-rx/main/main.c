@@ -1,25 +1,62 @@
+#include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
 #include <nvs.h>
 #include <nvs_flash.h>
 #include <esp_ieee802154.h>
 #include <esp_log.h>
 #include <esp_phy_init.h>
 #include <esp_mac.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/message_buffer.h>
 
 #include "ieee802154_util.h"
+#include "ieee802154_wcet.h"
+#include "ieee802154_survey.h"
+#include "ieee802154_stream.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_transport.h"
+#include "ieee802154_ack_payload.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_console.h"
+#include "ieee802154_printer.h"
+#include "ieee802154_addr_table.h"
+#include "ieee802154_traffic.h"
+#include "ieee802154_mesh.h"
+#include "ieee802154_addr_book.h"
+#include "ieee802154_rx_timing.h"
+#include "ieee802154_tx_latency.h"
+#include "ieee802154_power.h"
+#include "ieee802154_ack_policy.h"
+#include "ieee802154_channel.h"
+#include "ieee802154_replay.h"
 
 #define TAG "main"
 #define RADIO_TAG "ieee802154"
 
 #define IEEE802154_PAN_ID 0x0001
+#define IEEE802154_SHORT_ADDR_SENDER 0x0003
 #define IEEE802154_SHORT_ADDR_RECEIVER 0x0002
 
+#define IEEE802154_CHANNEL_DEFAULT 26 // Used if the channel survey fails
+#define STREAM_BUFFER_SIZE 1024
+#define TX_ENGINE_QUEUE_LENGTH 8
+#define TX_ENGINE_PRIORITY 19
+#define CHANNEL_PRIORITY 6 // Surveys block for a while, below the radio processing
+#define PRINTER_PRIORITY 4 // Below the radio processing, printing must not hold up the receiver task
+
+#define RX_BUFFER_SIZE (4 * sizeof(ieee802154_rx_entry_t))
+
 StreamBufferHandle_t xMessageBuffer = NULL;
 
+#if IEEE802154_WCET_ENABLED
+static ieee802154_wcet_t wcet_receive_done;
+static ieee802154_wcet_t wcet_enh_ack_generator;
+#endif
+
 /* --- IEEE802154 Functions --- */
 
 void initialize_nvs(void)
@@ -34,21 +71,70 @@ void initialize_nvs(void)
 
 // ISR Context (Radio callbacks)
 
-void esp_ieee802154_receive_sfd_done(void)
+IEEE802154_ISR_ATTR void esp_ieee802154_receive_sfd_done(void)
 {
+#if IEEE802154_PRINT_ENABLED
     ESP_EARLY_LOGI(RADIO_TAG, "RX sfd done, Radio state: %d", esp_ieee802154_get_state());
+#endif
 }
 
-void esp_ieee802154_receive_done(uint8_t* frame, esp_ieee802154_frame_info_t* frame_info)
+/**
+ * The work of esp_ieee802154_receive_done() without the log and without handing the buffer back to the driver.
+ * Also run over the WCET corpus at startup.
+ */
+static IEEE802154_ISR_ATTR void receive_frame(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info)
 {
-    ESP_EARLY_LOGI(RADIO_TAG, "RX OK, received %d bytes with rssi: %d and lqi: %d", frame[0], frame_info->rssi, frame_info->lqi);
-    xMessageBufferSendFromISR(xMessageBuffer, frame, frame[0] + 1, NULL); // Add one to the frame length to get the lqi (the hardware inserts a 0 between data and rssi/lqi)
+    esp_ieee802154_metrics_inc(IEEE802154_METRIC_RX_FRAMES);
+    esp_ieee802154_metrics_add(IEEE802154_METRIC_RX_BYTES, frame[0]);
+
+    // Filters and acknowledges the frames while the software address table is in use (promiscuous mode)
+    bool accepted = esp_ieee802154_addr_table_receive(frame);
+    ieee802154_rx_entry_t entry; // The frame with its SFD timestamp, rssi/lqi are stored in place of the FCS
+    if (accepted && xMessageBufferSendFromISR(xMessageBuffer, &entry, esp_ieee802154_rx_entry_fill(&entry, frame, frame_info), NULL) == 0)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_RX_DROPPED);
+        esp_ieee802154_replay_count_drop();
+    }
+    esp_ieee802154_metrics_max(IEEE802154_METRIC_RX_BUFFER_MAX, RX_BUFFER_SIZE - xMessageBufferSpacesAvailable(xMessageBuffer));
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_receive_done(uint8_t* frame, esp_ieee802154_frame_info_t* frame_info)
+{
+    ESP_IEEE802154_WCET_START(start);
+    ESP_IEEE802154_METRICS_ISR_START(isr_start);
+    receive_frame(frame, frame_info);
     esp_ieee802154_receive_handle_done(frame);
+    ESP_IEEE802154_METRICS_ISR_STOP(isr_start);
+    ESP_IEEE802154_WCET_STOP(&wcet_receive_done, start, frame);
+
+    // The software ACK is out already, the UART neither delays it nor dominates the measurement
+#if IEEE802154_PRINT_ENABLED
+    ESP_EARLY_LOGI(RADIO_TAG, "RX OK, received %d bytes with rssi: %d and lqi: %d", frame[0], frame_info->rssi, frame_info->lqi);
+#endif
+}
+
+// Transport ACKs are sent through the TX engine
+IEEE802154_ISR_ATTR void esp_ieee802154_transmit_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info)
+{
+    if (ack != NULL)
+    {
+        esp_ieee802154_receive_handle_done(ack);
+    }
+    esp_ieee802154_tx_engine_transmit_done(frame, ack, ack_frame_info);
 }
 
-esp_err_t esp_ieee802154_enh_ack_generator(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info, uint8_t *enhack_frame)
+IEEE802154_ISR_ATTR void esp_ieee802154_transmit_failed(const uint8_t *frame, esp_ieee802154_tx_error_t error)
 {
+    esp_ieee802154_tx_engine_transmit_failed(frame, error);
+}
+
+IEEE802154_ISR_ATTR esp_err_t esp_ieee802154_enh_ack_generator(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info, uint8_t *enhack_frame)
+{
+    ESP_IEEE802154_WCET_START(start);
+    ESP_IEEE802154_METRICS_ISR_START(isr_start);
     esp_ieee802154_create_2015_ack_frame(frame, enhack_frame);
+    ESP_IEEE802154_METRICS_ISR_STOP(isr_start);
+    ESP_IEEE802154_WCET_STOP(&wcet_enh_ack_generator, start, frame);
     return ESP_OK;
 }
 
@@ -56,28 +142,173 @@ esp_err_t esp_ieee802154_enh_ack_generator(uint8_t *frame, esp_ieee802154_frame_
 
 static void receiver_task(void *pvParameters)
 {
-    uint8_t frame[127];
+    static ieee802154_rx_entry_t receive_entry;
+    ieee802154_rx_entry_t *entry = &receive_entry; // The mesh swaps in a spare entry when it forwards a frame
 
     while (1)
     {
-        size_t readBytes = xMessageBufferReceive(xMessageBuffer, frame, sizeof(frame), portMAX_DELAY);
+        size_t readBytes = xMessageBufferReceive(xMessageBuffer, entry, sizeof(*entry), portMAX_DELAY);
 		if (readBytes == 0) break;
 
+        uint8_t *frame = entry->frame;
+        esp_ieee802154_rx_timing_record(entry, esp_timer_get_time());
+        if (esp_ieee802154_channel_input(frame) || esp_ieee802154_mesh_input(&entry) ||
+            esp_ieee802154_stream_input(frame) || esp_ieee802154_transport_input(frame) ||
+            esp_ieee802154_traffic_verify(frame, entry->timestamp_us))
+        {
+            continue;
+        }
+
         //ESP_LOG_BUFFER_HEXDUMP(RADIO_TAG, frame, frame[0], ESP_LOG_INFO);
-        esp_ieee802154_print_packet(frame);
+        esp_ieee802154_printer_submit(frame);
     }
 
     ESP_LOGE("receiver_task", "Terminated");
     vTaskDelete(NULL);
 }
 
+static void transport_deliver(const uint8_t *data, uint8_t length, void *arg)
+{
+    static uint32_t segments = 0;
+    static uint32_t bytes = 0;
+
+    segments += 1;
+    bytes += length;
+    if (segments % 100 == 0)
+    {
+        ESP_LOGI(TAG, "Transport: %" PRIu32 " segments, %" PRIu32 " bytes delivered in order", segments, bytes);
+    }
+}
+
+static void mesh_deliver(uint16_t originator, const uint8_t *data, uint8_t length, uint8_t hops, void *arg)
+{
+    ESP_LOGI(TAG, "Mesh from 0x%04x over %d hops: %.*s", originator, hops, length, (const char *)data);
+}
+
+static void stream_task(void *pvParameters)
+{
+    ieee802154_stream_handle_t stream = pvParameters;
+    char line[128];
+    size_t length = 0;
+
+    while (1)
+    {
+        length += esp_ieee802154_stream_read(stream, &line[length], 1, portMAX_DELAY);
+        bool newline = (length > 0 && line[length - 1] == '\n');
+        if (newline || length == sizeof(line) - 1)
+        {
+            line[newline ? length - 1 : length] = '\0';
+            ESP_LOGI(TAG, "Stream: %s", line);
+            length = 0;
+        }
+    }
+}
+
+/* --- Channel selection --- */
+
+/**
+ * Survey all channels at startup and move to the quietest one, before any peer is listening.
+ */
+static void select_channel(void)
+{
+    ieee802154_survey_t survey;
+    uint8_t current = esp_ieee802154_get_channel();
+    uint8_t channel = IEEE802154_CHANNEL_DEFAULT;
+
+    if (esp_ieee802154_survey_run(CONFIG_IEEE802154_UTIL_SURVEY_SAMPLES, CONFIG_IEEE802154_UTIL_SURVEY_ED_DURATION,
+                                  CONFIG_IEEE802154_UTIL_SURVEY_BUSY_DBM, &survey) == ESP_OK)
+    {
+        esp_ieee802154_survey_print(&survey);
+        channel = survey.best_channel;
+    }
+
+    if (channel != current)
+    {
+        ESP_LOGI(TAG, "Switching from channel %d to channel %d", current, channel);
+    }
+    esp_ieee802154_set_channel(channel);
+    esp_ieee802154_receive();
+}
+
+/* Later surveys run in the channel task, which announces a switch to the sender first (see ieee802154_channel.h) */
+static void survey_task(void *pvParameters)
+{
+    while (1)
+    {
+        vTaskDelay(CONFIG_IEEE802154_UTIL_SURVEY_INTERVAL_S * 1000 / portTICK_PERIOD_MS);
+        esp_ieee802154_channel_survey();
+    }
+}
+
+#if IEEE802154_WCET_ENABLED
+static void wcet_receive_corpus(uint8_t *frame)
+{
+    esp_ieee802154_frame_info_t frame_info = { 0 };
+    receive_frame(frame, &frame_info);
+}
+
+/* Fails (and aborts) if the ACK generator or the receive path exceed their budget on the corpus */
+static void wcet_run_corpus(void)
+{
+    static ieee802154_wcet_t wcet;
+
+    ESP_ERROR_CHECK(esp_ieee802154_wcet_run_ack_generator(IEEE802154_WCET_RANDOM_FRAMES, IEEE802154_WCET_BUDGET_CYCLES));
+
+    // The receiver task is not running yet, the buffer runs full and the drop path is measured as well
+    esp_ieee802154_wcet_init(&wcet, "esp_ieee802154_receive_done (corpus)");
+    esp_ieee802154_wcet_run_corpus(&wcet, wcet_receive_corpus, IEEE802154_WCET_RANDOM_FRAMES);
+    ESP_ERROR_CHECK(esp_ieee802154_wcet_report(&wcet, IEEE802154_WCET_BUDGET_CYCLES));
+
+    // Start with empty buffers and metrics, the corpus frames are no traffic
+    xMessageBufferReset(xMessageBuffer);
+    esp_ieee802154_metrics_reset();
+}
+
+static void wcet_report_task(void *pvParameters)
+{
+    while (1)
+    {
+        vTaskDelay(10000 / portTICK_PERIOD_MS);
+        esp_ieee802154_wcet_report(&wcet_receive_done, IEEE802154_WCET_BUDGET_CYCLES);
+        esp_ieee802154_wcet_report(&wcet_enh_ack_generator, IEEE802154_WCET_BUDGET_CYCLES);
+    }
+}
+#endif
+
 void app_main()
 {
     
     initialize_nvs();
 
-    xMessageBuffer = xMessageBufferCreate(4 * 128);
+    xMessageBuffer = xMessageBufferCreate(RX_BUFFER_SIZE);
+
+#if IEEE802154_WCET_ENABLED
+    wcet_run_corpus();
+    esp_ieee802154_wcet_init(&wcet_receive_done, "esp_ieee802154_receive_done");
+    esp_ieee802154_wcet_init(&wcet_enh_ack_generator, "esp_ieee802154_enh_ack_generator");
+    xTaskCreate(wcet_report_task, "wcet_report_task", 4096, NULL, 5, NULL);
+#endif
+#if IEEE802154_PRINT_ENABLED
+    ESP_ERROR_CHECK(esp_ieee802154_printer_start(CONFIG_IEEE802154_UTIL_PRINT_RATE_LIMIT, CONFIG_IEEE802154_UTIL_PRINT_SAMPLE_EVERY, PRINTER_PRIORITY));
+#endif
     xTaskCreate(receiver_task, "receiver_task", 8192, NULL, 20, NULL);
+    ESP_ERROR_CHECK(esp_ieee802154_tx_engine_start(TX_ENGINE_QUEUE_LENGTH, TX_ENGINE_PRIORITY));
+    ESP_ERROR_CHECK(esp_ieee802154_channel_start(CHANNEL_PRIORITY));
+    esp_ieee802154_mesh_start(mesh_deliver, NULL);
+
+    ieee802154_stream_handle_t stream;
+    ieee802154_address_t sender = {
+        .mode = ADDR_MODE_SHORT,
+        .short_address = IEEE802154_SHORT_ADDR_SENDER,
+    };
+    // The printer only looks sources up and RX timing takes the first sources, so the configured peer is always listed
+    esp_ieee802154_addr_book_intern(IEEE802154_PAN_ID, &sender);
+    ESP_ERROR_CHECK(esp_ieee802154_stream_listen(IEEE802154_PAN_ID, &sender, STREAM_BUFFER_SIZE, &stream));
+    xTaskCreate(stream_task, "stream_task", 4096, stream, 5, NULL);
+
+    ieee802154_transport_handle_t transport;
+    ESP_ERROR_CHECK(esp_ieee802154_transport_listen(IEEE802154_PAN_ID, &sender, CONFIG_IEEE802154_UTIL_TRANSPORT_WINDOW,
+                                                    transport_deliver, NULL, &transport));
 
     esp_err_t ret = esp_ieee802154_enable();
     if (ret == ESP_OK)
@@ -88,24 +319,55 @@ void app_main()
         esp_ieee802154_set_panid(IEEE802154_PAN_ID);
         esp_ieee802154_set_short_address(IEEE802154_SHORT_ADDR_RECEIVER);
 
-        // For the promiscous mode to work, the hardware needs the address in reversed byte order
+        // The radio takes the extended address least significant byte first
         uint8_t mac_addr[8] = {0};
         esp_read_mac(mac_addr, ESP_MAC_IEEE802154);
-        uint8_t eui64_rev[8] = {0};
-        for (int i=0; i<8; i++) {
-            eui64_rev[7-i] = mac_addr[i];
-        }
-        esp_ieee802154_set_extended_address(eui64_rev);
+        uint64_t ext_address = esp_ieee802154_ext_address_from_eui64(mac_addr);
+        uint8_t ext_addr[8];
+        esp_ieee802154_ext_address_write(ext_address, ext_addr);
+        esp_ieee802154_set_extended_address(ext_addr);
+        esp_ieee802154_addr_book_bind(IEEE802154_PAN_ID, IEEE802154_SHORT_ADDR_RECEIVER, ext_address);
 
-        esp_ieee802154_set_channel(26);
-        esp_ieee802154_set_txpower(0);
+        esp_ieee802154_set_txpower(IEEE802154_POWER_NOMINAL_DBM);
 
         esp_ieee802154_set_rx_when_idle(true);
-        esp_ieee802154_receive();
+        select_channel();
+
+        if (CONFIG_IEEE802154_UTIL_SURVEY_INTERVAL_S > 0)
+        {
+            xTaskCreate(survey_task, "survey_task", 4096, NULL, 5, NULL);
+        }
+    }
+
+    ESP_ERROR_CHECK(esp_ieee802154_console_start("rx>"));
+    ESP_ERROR_CHECK(esp_ieee802154_traffic_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_addr_table_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_mesh_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_rx_timing_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_tx_latency_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_power_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_ack_policy_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_channel_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_replay_register_console());
+#if IEEE802154_METRICS_ENABLED
+    if (CONFIG_IEEE802154_UTIL_METRICS_DUMP_INTERVAL_S > 0)
+    {
+        esp_ieee802154_metrics_start_dump(CONFIG_IEEE802154_UTIL_METRICS_DUMP_INTERVAL_S);
     }
+#endif
+
+    uint32_t counter = 0;
+    char command[IEEE802154_ACK_PAYLOAD_MAX];
 
     while (1)
     {
         vTaskDelay(500 / portTICK_PERIOD_MS);
+
+        // Downlink to the sender without extra frames, attached to the next Enh-ACK
+        if (!esp_ieee802154_ack_payload_pending(&sender))
+        {
+            int length = snprintf(command, sizeof(command), "channel %d, cmd %" PRIu32, esp_ieee802154_get_channel(), counter++);
+            esp_ieee802154_ack_payload_set(&sender, (const uint8_t *)command, length);
+        }
     }
 }
@@ -1,25 +1,51 @@
+#include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
 #include <nvs.h>
 #include <nvs_flash.h>
 #include <esp_ieee802154.h>
 #include <esp_log.h>
 #include <esp_phy_init.h>
 #include <esp_mac.h>
+#include <esp_timer.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
-#include <freertos/message_buffer.h>
 
 #include "ieee802154_util.h"
+#include "ieee802154_survey.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_stream.h"
+#include "ieee802154_transport.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_console.h"
+#include "ieee802154_printer.h"
+#include "ieee802154_traffic.h"
+#include "ieee802154_mesh.h"
+#include "ieee802154_addr_book.h"
+#include "ieee802154_tx_latency.h"
+#include "ieee802154_power.h"
+#include "ieee802154_ack_policy.h"
+#include "ieee802154_channel.h"
+#include "sender.h"
 
 #define TAG "main"
-#define RADIO_TAG "ieee802154"
 
 #define IEEE802154_PAN_ID 0x0001
 #define IEEE802154_SHORT_ADDR_SENDER 0x0003
 #define IEEE802154_SHORT_ADDR_RECEIVER 0x0002
 
-StreamBufferHandle_t xMessageBuffer = NULL;
+#define IEEE802154_CHANNEL_DEFAULT 26
+#define TX_PROBES_PER_CHANNEL 3     // Probe frames sent on each channel while searching the receiver
+#define TX_MAX_FAILURES 5           // Consecutive missing ACKs before the receiver is searched again
+#define TX_ENGINE_QUEUE_LENGTH 8
+#define TX_ENGINE_PRIORITY 19
+#define RECEIVER_PRIORITY 20
+#define CHANNEL_PRIORITY 6 // Surveys block for a while, below the radio processing
+#define PRINTER_PRIORITY 4 // Below the radio processing, printing must not hold up the receiver task
+#define STREAM_BUFFER_SIZE 1024
+#define STREAM_FLUSH_TIMEOUT_MS 50
+#define TRANSPORT_TEST_BYTES (16 * 1024) // Sent once through the reliable transport to measure the goodput
 
 /* --- IEEE802154 Functions --- */
 
@@ -34,47 +60,133 @@ static void initialize_nvs(void)
     ESP_ERROR_CHECK(err);
 }
 
-// ISR Context (Radio callbacks)
+/* --- Channel selection --- */
 
-void esp_ieee802154_receive_sfd_done(void)
+/**
+ * Without ACK request, the frame counts as delivered once it is sent. The ACK policy requests an ACK for every
+ * few frames, so a receiver that moved to another channel is still noticed.
+ */
+static bool send_and_wait(uint16_t dst_pan_id, ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr,
+                          ieee802154_reliability_t reliability)
 {
-    ESP_EARLY_LOGI(RADIO_TAG, "RX sfd done, Radio state: %d", esp_ieee802154_get_state());
+    uint8_t frame[128];
+    bool ack = esp_ieee802154_ack_policy_decide(esp_ieee802154_addr_book_intern(dst_pan_id, dst_addr), reliability);
+    if (esp_ieee802154_create_2015_l2_data_frame(frame, dst_pan_id, dst_addr, data, data_length, seq_nr, ack) == 0)
+    {
+        return false;
+    }
+    return esp_ieee802154_tx_engine_transmit(frame, true, NULL, portMAX_DELAY) == ESP_OK;
 }
 
-void esp_ieee802154_transmit_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info)
+/* --- Reliable transport --- */
+
+static void measure_transport_goodput(ieee802154_address_t *dst_addr)
 {
-    ESP_EARLY_LOGI(RADIO_TAG, "tx OK, sent %d bytes, ack %d", frame[0], ack != NULL);
-    if (ack != NULL)
+    ieee802154_transport_handle_t transport;
+    if (esp_ieee802154_transport_open(IEEE802154_PAN_ID, dst_addr, CONFIG_IEEE802154_UTIL_TRANSPORT_WINDOW,
+                                      CONFIG_IEEE802154_UTIL_TRANSPORT_RTO_MS, &transport) != ESP_OK)
     {
-        xMessageBufferSendFromISR(xMessageBuffer, ack, ack[0] + 1, NULL); // Add one to the frame length to get the lqi (the hardware inserts a 0 between data and rssi/lqi)
-        esp_ieee802154_receive_handle_done(ack);
+        ESP_LOGE(TAG, "Failed to open the transport");
+        return;
+    }
+
+    uint8_t segment[IEEE802154_WINDOW_MAX_SEGMENT];
+    uint8_t max_segment = esp_ieee802154_transport_max_segment(transport);
+    int64_t start = esp_timer_get_time();
+
+    for (uint32_t sent = 0; sent < TRANSPORT_TEST_BYTES; sent += max_segment)
+    {
+        memset(segment, (uint8_t)(sent / max_segment), max_segment);
+        esp_ieee802154_transport_send(transport, segment, max_segment, portMAX_DELAY);
+    }
+    if (esp_ieee802154_transport_flush(transport, 10000 / portTICK_PERIOD_MS) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Transport not flushed within 10 s");
     }
-}
 
-/* --- FreeRTOS Tasks --- */
+    int64_t duration = esp_timer_get_time() - start;
+    ieee802154_transport_stats_t stats;
+    esp_ieee802154_transport_get_stats(transport, &stats);
+    ESP_LOGI(TAG, "Transport: %d bytes in %" PRId64 " ms (%" PRId64 " kbit/s), window %d, %" PRIu32 " transmissions, %" PRIu32 " retransmissions",
+             TRANSPORT_TEST_BYTES, duration / 1000, (int64_t)TRANSPORT_TEST_BYTES * 8 * 1000 / duration,
+             CONFIG_IEEE802154_UTIL_TRANSPORT_WINDOW, stats.transmissions, stats.retransmissions);
+}
 
-static void receiver_task(void *pvParameters)
+/**
+ * The receiver selects its channel with an energy detection survey. The sender surveys as well and probes
+ * the channels from the quietest to the busiest, so it usually finds the receiver on the first channel.
+ * The channel task is held off meanwhile, the failed probes would otherwise trigger a switch of its own.
+ */
+static uint8_t find_receiver_channel(ieee802154_address_t *dst_addr, uint8_t *data, uint8_t data_length, uint8_t *seq_nr)
 {
-    uint8_t frame[127];
+    ieee802154_survey_t survey;
+    uint8_t ranking[IEEE802154_NUM_CHANNELS];
+
+    esp_ieee802154_channel_hold(true);
+    if (esp_ieee802154_survey_run(CONFIG_IEEE802154_UTIL_SURVEY_SAMPLES, CONFIG_IEEE802154_UTIL_SURVEY_ED_DURATION,
+                                  CONFIG_IEEE802154_UTIL_SURVEY_BUSY_DBM, &survey) == ESP_OK)
+    {
+        esp_ieee802154_survey_print(&survey);
+        esp_ieee802154_survey_rank(&survey, ranking);
+    }
+    else
+    {
+        for (uint8_t idx = 0; idx < IEEE802154_NUM_CHANNELS; idx++)
+        {
+            ranking[idx] = IEEE802154_CHANNEL_MAX - idx;
+        }
+    }
 
     while (1)
     {
-        size_t readBytes = xMessageBufferReceive(xMessageBuffer, frame, sizeof(frame), portMAX_DELAY);
-		if (readBytes == 0) break;
+        for (uint8_t idx = 0; idx < IEEE802154_NUM_CHANNELS; idx++)
+        {
+            esp_ieee802154_set_channel(ranking[idx]);
+            esp_ieee802154_receive();
 
-        esp_ieee802154_print_packet(frame);
+            for (uint8_t probe = 0; probe < TX_PROBES_PER_CHANNEL; probe++)
+            {
+                *seq_nr += 1;
+                if (send_and_wait(IEEE802154_PAN_ID, dst_addr, data, data_length, seq_nr, IEEE802154_RELIABILITY_CRITICAL))
+                {
+                    ESP_LOGI(TAG, "Receiver found on channel %d", ranking[idx]);
+                    esp_ieee802154_channel_hold(false);
+                    return ranking[idx];
+                }
+            }
+        }
+        ESP_LOGW(TAG, "Receiver not found on any channel, retrying");
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
     }
-
-    ESP_LOGE("receiver_task", "Terminated");
-    vTaskDelete(NULL);
 }
 
 void app_main()
 {
     initialize_nvs();
 
-    xMessageBuffer = xMessageBufferCreate(4 * 128);
-    xTaskCreate(receiver_task, "receiver_task", 8192, NULL, 20, NULL);
+    ESP_ERROR_CHECK(sender_radio_init());
+    ESP_ERROR_CHECK(esp_ieee802154_tx_engine_start(TX_ENGINE_QUEUE_LENGTH, TX_ENGINE_PRIORITY));
+    ESP_ERROR_CHECK(esp_ieee802154_channel_start(CHANNEL_PRIORITY));
+    esp_ieee802154_mesh_start(NULL, NULL); // The sender only originates and relays mesh frames
+
+    ESP_ERROR_CHECK(esp_ieee802154_console_start("tx>"));
+    ESP_ERROR_CHECK(esp_ieee802154_traffic_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_mesh_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_rx_timing_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_tx_latency_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_power_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_ack_policy_register_console());
+    ESP_ERROR_CHECK(esp_ieee802154_channel_register_console());
+#if IEEE802154_METRICS_ENABLED
+    if (CONFIG_IEEE802154_UTIL_METRICS_DUMP_INTERVAL_S > 0)
+    {
+        esp_ieee802154_metrics_start_dump(CONFIG_IEEE802154_UTIL_METRICS_DUMP_INTERVAL_S);
+    }
+#endif
+#if IEEE802154_PRINT_ENABLED
+    ESP_ERROR_CHECK(esp_ieee802154_printer_start(CONFIG_IEEE802154_UTIL_PRINT_RATE_LIMIT, CONFIG_IEEE802154_UTIL_PRINT_SAMPLE_EVERY, PRINTER_PRIORITY));
+#endif
+    ESP_ERROR_CHECK(sender_receiver_start(RECEIVER_PRIORITY));
 
     esp_err_t ret = esp_ieee802154_enable();
     if (ret == ESP_OK)
@@ -85,17 +197,17 @@ void app_main()
         esp_ieee802154_set_panid(IEEE802154_PAN_ID);
         esp_ieee802154_set_short_address(IEEE802154_SHORT_ADDR_SENDER);
 
-        // For the promiscous mode to work, the hardware needs the address in reversed byte order
+        // The radio takes the extended address least significant byte first
         uint8_t mac_addr[8] = {0};
         esp_read_mac(mac_addr, ESP_MAC_IEEE802154);
-        uint8_t eui64_rev[8] = {0};
-        for (int i=0; i<8; i++) {
-            eui64_rev[7-i] = mac_addr[i];
-        }
-        esp_ieee802154_set_extended_address(eui64_rev);
+        uint64_t ext_address = esp_ieee802154_ext_address_from_eui64(mac_addr);
+        uint8_t ext_addr[8];
+        esp_ieee802154_ext_address_write(ext_address, ext_addr);
+        esp_ieee802154_set_extended_address(ext_addr);
+        esp_ieee802154_addr_book_bind(IEEE802154_PAN_ID, IEEE802154_SHORT_ADDR_SENDER, ext_address);
 
-        esp_ieee802154_set_channel(26);
-        esp_ieee802154_set_txpower(0);
+        esp_ieee802154_set_channel(IEEE802154_CHANNEL_DEFAULT);
+        esp_ieee802154_set_txpower(IEEE802154_POWER_NOMINAL_DBM);
 
         esp_ieee802154_set_rx_when_idle(true);
         esp_ieee802154_receive();
@@ -107,7 +219,7 @@ void app_main()
     ieee802154_address_t dst_addr = {
         .mode = ADDR_MODE_SHORT,
         .short_address = IEEE802154_SHORT_ADDR_RECEIVER,
-        //.long_address = { 0x40, 0x4c, 0xca, 0xff, 0xfe, 0x5c, 0xef, 0xd8 }
+        //.long_address = 0x404ccafffe5cefd8
     };
 
     /**
@@ -122,10 +234,39 @@ void app_main()
      * Is this a hardware bug of the esp32-c6 module?!
      */
 
+    find_receiver_channel(&dst_addr, data, sizeof(data), &sequence_number);
+    uint8_t failures = 0;
+
+    // Status text to the receiver, segmented into frames by the stream
+    ieee802154_stream_handle_t stream;
+    ESP_ERROR_CHECK(esp_ieee802154_stream_open(IEEE802154_PAN_ID, &dst_addr, STREAM_BUFFER_SIZE, STREAM_FLUSH_TIMEOUT_MS, &stream));
+    char status[64];
+
+    measure_transport_goodput(&dst_addr);
+
+    // A profile saved with "traffic save" runs after every boot
+    if (esp_ieee802154_traffic_start_saved() == ESP_OK)
+    {
+        ESP_LOGI(TAG, "Saved traffic profile started");
+    }
+
     while (1)
     {
         vTaskDelay(5000 / portTICK_PERIOD_MS);
         sequence_number += 1;
-        esp_ieee802154_send_2015_l2_data_frame(IEEE802154_PAN_ID, &dst_addr, data, sizeof(data), &sequence_number, true);
+        if (send_and_wait(IEEE802154_PAN_ID, &dst_addr, data, sizeof(data), &sequence_number, IEEE802154_RELIABILITY_NORMAL))
+        {
+            failures = 0;
+        }
+        else if (++failures >= TX_MAX_FAILURES)
+        {
+            // The receiver may have moved to another channel after a re-survey
+            ESP_LOGW(TAG, "%d frames without ACK, searching the receiver", failures);
+            find_receiver_channel(&dst_addr, data, sizeof(data), &sequence_number);
+            failures = 0;
+        }
+
+        int length = snprintf(status, sizeof(status), "seq %d, channel %d, failures %d\n", sequence_number, esp_ieee802154_get_channel(), failures);
+        esp_ieee802154_stream_write(stream, status, length, 0);
     }
 }
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <string.h>
+#include <esp_ieee802154.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/message_buffer.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_wcet.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_transport.h"
+#include "ieee802154_ack_payload.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_printer.h"
+#include "ieee802154_mesh.h"
+#include "ieee802154_rx_timing.h"
+#include "ieee802154_channel.h"
+#include "sender.h"
+
+#define TAG "main"
+#define RADIO_TAG "ieee802154"
+
+static MessageBufferHandle_t xMessageBuffer = NULL;
+
+#if IEEE802154_WCET_ENABLED
+static ieee802154_wcet_t wcet_transmit_done;
+#endif
+
+// ISR Context (Radio callbacks)
+
+IEEE802154_ISR_ATTR void esp_ieee802154_receive_sfd_done(void)
+{
+    ESP_EARLY_LOGI(RADIO_TAG, "RX sfd done, Radio state: %d", esp_ieee802154_get_state());
+}
+
+/**
+ * The work of esp_ieee802154_transmit_done() without the log and without handing the ACK buffer back to the
+ * driver. Also run over the WCET corpus at startup.
+ */
+static IEEE802154_ISR_ATTR void transmit_frame_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info)
+{
+    if (ack != NULL)
+    {
+        ieee802154_rx_entry_t entry; // The ACK with its SFD timestamp, rssi/lqi are stored in place of the FCS
+        xMessageBufferSendFromISR(xMessageBuffer, &entry, esp_ieee802154_rx_entry_fill(&entry, ack, ack_frame_info), NULL);
+    }
+    esp_ieee802154_tx_engine_transmit_done(frame, ack, ack_frame_info);
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_transmit_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info)
+{
+    ESP_EARLY_LOGI(RADIO_TAG, "tx OK, sent %d bytes, ack %d", frame[0], ack != NULL);
+    ESP_IEEE802154_WCET_START(start); // Without the log, the UART would dominate the measurement
+    ESP_IEEE802154_METRICS_ISR_START(isr_start);
+    transmit_frame_done(frame, ack, ack_frame_info);
+    if (ack != NULL)
+    {
+        esp_ieee802154_receive_handle_done(ack);
+    }
+    ESP_IEEE802154_METRICS_ISR_STOP(isr_start);
+    ESP_IEEE802154_WCET_STOP(&wcet_transmit_done, start, frame);
+}
+
+IEEE802154_ISR_ATTR void esp_ieee802154_transmit_failed(const uint8_t *frame, esp_ieee802154_tx_error_t error)
+{
+    ESP_EARLY_LOGI(RADIO_TAG, "tx failed, error %d", error);
+    esp_ieee802154_tx_engine_transmit_failed(frame, error);
+}
+
+/* --- FreeRTOS Tasks --- */
+
+static void receiver_task(void *pvParameters)
+{
+    static ieee802154_rx_entry_t receive_entry;
+    ieee802154_rx_entry_t *entry = &receive_entry; // The mesh swaps in a spare entry when it forwards a frame
+
+    while (1)
+    {
+        size_t readBytes = xMessageBufferReceive(xMessageBuffer, entry, sizeof(*entry), portMAX_DELAY);
+		if (readBytes == 0) break;
+
+        uint8_t *frame = entry->frame;
+        esp_ieee802154_rx_timing_record(entry, esp_timer_get_time());
+        if (esp_ieee802154_channel_input(frame) || esp_ieee802154_mesh_input(&entry) ||
+            esp_ieee802154_transport_input(frame))
+        {
+            continue;
+        }
+
+        // Return data of the receiver, piggybacked on the Enh-ACK
+        const uint8_t *payload;
+        uint8_t length = esp_ieee802154_ack_payload_get(frame, &payload);
+        if (length > 0)
+        {
+            ESP_LOGI(TAG, "ACK payload: %.*s", length, (const char *)payload);
+        }
+
+        esp_ieee802154_printer_submit(frame);
+    }
+
+    ESP_LOGE("receiver_task", "Terminated");
+    vTaskDelete(NULL);
+}
+
+#if IEEE802154_WCET_ENABLED
+/* The corpus frames are the ACKs, the sent frame is not the one of the TX engine and is ignored by it */
+static void wcet_transmit_corpus(uint8_t *ack)
+{
+    static const uint8_t frame[] = { 11, 0x41, 0x88, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00 };
+    esp_ieee802154_frame_info_t ack_frame_info = { 0 };
+    transmit_frame_done(frame, ack, &ack_frame_info);
+}
+
+/* Fails (and aborts) if the transmit done path exceeds its budget on the corpus */
+static void wcet_run_corpus(void)
+{
+    static ieee802154_wcet_t wcet;
+
+    // The receiver task is not running yet, the buffer runs full and the drop path is measured as well
+    esp_ieee802154_wcet_init(&wcet, "esp_ieee802154_transmit_done (corpus)");
+    esp_ieee802154_wcet_run_corpus(&wcet, wcet_transmit_corpus, IEEE802154_WCET_RANDOM_FRAMES);
+    ESP_ERROR_CHECK(esp_ieee802154_wcet_report(&wcet, IEEE802154_WCET_BUDGET_CYCLES));
+
+    // Start with empty buffers and metrics, the corpus frames are no traffic
+    xMessageBufferReset(xMessageBuffer);
+    esp_ieee802154_metrics_reset();
+}
+
+static void wcet_report_task(void *pvParameters)
+{
+    while (1)
+    {
+        vTaskDelay(10000 / portTICK_PERIOD_MS);
+        esp_ieee802154_wcet_report(&wcet_transmit_done, IEEE802154_WCET_BUDGET_CYCLES);
+    }
+}
+#endif
+
+/* --- Setup --- */
+
+esp_err_t sender_radio_init(void)
+{
+    xMessageBuffer = xMessageBufferCreate(4 * sizeof(ieee802154_rx_entry_t));
+    if (xMessageBuffer == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+#if IEEE802154_WCET_ENABLED
+    wcet_run_corpus();
+    esp_ieee802154_wcet_init(&wcet_transmit_done, "esp_ieee802154_transmit_done");
+    xTaskCreate(wcet_report_task, "wcet_report_task", 4096, NULL, 5, NULL);
+#endif
+    return ESP_OK;
+}
+
+esp_err_t sender_receiver_start(UBaseType_t priority)
+{
+    if (xTaskCreate(receiver_task, "receiver_task", 8192, NULL, priority, NULL) != pdPASS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * Radio side of the sender app: the driver callbacks and the receiver task.
+ *
+ * Kept apart from app_main(), so the medium simulation (tools/ieee802154_medium_sim.c) runs the same code for
+ * its device on the host shims.
+ */
+
+/**
+ * Create the RX message buffer. With WCET measurement, the transmit done path is also run over the corpus.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the message buffer can not be created.
+ *
+ */
+esp_err_t sender_radio_init(void);
+
+/**
+ * Start the receiver task, which hands the received ACKs to the channel selection, the mesh and the transport
+ * and prints the others.
+ *
+ * @param[in]  priority  Priority of the receiver task.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task can not be created.
+ *
+ */
+esp_err_t sender_receiver_start(UBaseType_t priority);
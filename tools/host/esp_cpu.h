@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Returns the counter installed with host_cpu_set_counter(), nanoseconds by default (see host_idf.h) */
+uint32_t esp_cpu_get_cycle_count(void);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/* The subset of the esp_ieee802154 driver API the component uses, implemented in host_idf.c */
+
+typedef enum {
+    ESP_IEEE802154_RADIO_DISABLE,
+    ESP_IEEE802154_RADIO_IDLE,
+    ESP_IEEE802154_RADIO_SLEEP,
+    ESP_IEEE802154_RADIO_RECEIVE,
+    ESP_IEEE802154_RADIO_TRANSMIT,
+} esp_ieee802154_state_t;
+
+typedef enum {
+    ESP_IEEE802154_TX_ERR_NONE,
+    ESP_IEEE802154_TX_ERR_CCA_BUSY,
+    ESP_IEEE802154_TX_ERR_ABORT,
+    ESP_IEEE802154_TX_ERR_NO_ACK,
+    ESP_IEEE802154_TX_ERR_INVALID_ACK,
+    ESP_IEEE802154_TX_ERR_COEXIST,
+    ESP_IEEE802154_TX_ERR_SECURITY,
+} esp_ieee802154_tx_error_t;
+
+typedef struct {
+    bool pending;
+    bool process;
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t lqi;
+    uint64_t timestamp;
+} esp_ieee802154_frame_info_t;
+
+esp_err_t esp_ieee802154_enable(void);
+esp_err_t esp_ieee802154_disable(void);
+esp_ieee802154_state_t esp_ieee802154_get_state(void);
+uint8_t esp_ieee802154_get_channel(void);
+esp_err_t esp_ieee802154_set_channel(uint8_t channel);
+int8_t esp_ieee802154_get_txpower(void);
+esp_err_t esp_ieee802154_set_txpower(int8_t power);
+bool esp_ieee802154_get_promiscuous(void);
+esp_err_t esp_ieee802154_set_promiscuous(bool enable);
+esp_err_t esp_ieee802154_set_coordinator(bool enable);
+esp_err_t esp_ieee802154_set_rx_when_idle(bool enable);
+uint16_t esp_ieee802154_get_panid(void);
+esp_err_t esp_ieee802154_set_panid(uint16_t panid);
+uint16_t esp_ieee802154_get_short_address(void);
+esp_err_t esp_ieee802154_set_short_address(uint16_t short_address);
+esp_err_t esp_ieee802154_get_extended_address(uint8_t *ext_addr);
+esp_err_t esp_ieee802154_set_extended_address(const uint8_t *ext_addr);
+esp_err_t esp_ieee802154_transmit(const uint8_t *frame, bool cca);
+esp_err_t esp_ieee802154_receive(void);
+esp_err_t esp_ieee802154_sleep(void);
+esp_err_t esp_ieee802154_energy_detect(uint32_t duration);
+esp_err_t esp_ieee802154_receive_handle_done(const uint8_t *frame);
+
+/* Callbacks of the driver, implemented by the application */
+extern void esp_ieee802154_receive_done(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info);
+extern void esp_ieee802154_receive_sfd_done(void);
+extern void esp_ieee802154_transmit_done(const uint8_t *frame, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info);
+extern void esp_ieee802154_transmit_failed(const uint8_t *frame, esp_ieee802154_tx_error_t error);
+extern void esp_ieee802154_energy_detect_done(int8_t power);
+extern esp_err_t esp_ieee802154_enh_ack_generator(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info, uint8_t *enhack_frame);
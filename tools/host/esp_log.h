@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include <inttypes.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+#define LOG_COLOR_E ""
+#define LOG_COLOR_W ""
+#define LOG_COLOR_I ""
+#define LOG_RESET_COLOR ""
+
+/* Messages below this level are dropped, see host_idf.h */
+extern esp_log_level_t host_log_level;
+
+uint32_t esp_log_timestamp(void);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+void esp_log_buffer_hexdump_internal(const char *tag, const void *buffer, uint16_t length, esp_log_level_t level);
+
+#define HOST_LOG(level, letter, tag, format, ...) \
+    esp_log_write(level, tag, letter " (%" PRIu32 ") %s: " format "\n", esp_log_timestamp(), tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) HOST_LOG(ESP_LOG_ERROR, "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) HOST_LOG(ESP_LOG_WARN, "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) HOST_LOG(ESP_LOG_INFO, "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) HOST_LOG(ESP_LOG_DEBUG, "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) HOST_LOG(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
+
+// The early logs of the ISR callbacks are dropped, the radio callbacks are measured without them
+#define ESP_EARLY_LOGE(tag, format, ...) do { } while (0)
+#define ESP_EARLY_LOGW(tag, format, ...) do { } while (0)
+#define ESP_EARLY_LOGI(tag, format, ...) do { } while (0)
+
+#define ESP_LOG_BUFFER_HEXDUMP(tag, buffer, length, level) esp_log_buffer_hexdump_internal(tag, buffer, length, level)
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* The subset of the FreeRTOS API the component uses, implemented in host_freertos.c */
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define configTICK_RATE_HZ   1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS   (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY        ((TickType_t)0xffffffff)
+#define pdMS_TO_TICKS(ms)    ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+// Only one task runs at a time and tasks are never preempted, a critical section needs no lock
+typedef struct {
+    uint32_t owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define portENTER_CRITICAL(mux)      (void)(mux)
+#define portEXIT_CRITICAL(mux)       (void)(mux)
+#define portENTER_CRITICAL_ISR(mux)  (void)(mux)
+#define portEXIT_CRITICAL_ISR(mux)   (void)(mux)
+#define portENTER_CRITICAL_SAFE(mux) (void)(mux)
+#define portEXIT_CRITICAL_SAFE(mux)  (void)(mux)
+#define portYIELD_FROM_ISR(woken)    (void)(woken)
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "stream_buffer.h"
+
+typedef StreamBufferHandle_t MessageBufferHandle_t;
+
+// Every message is stored with a size_t length in front of it, as in FreeRTOS
+#define xMessageBufferCreate(size)                                xStreamBufferGenericCreate(size, 0, true)
+#define vMessageBufferDelete(buffer)                              vStreamBufferDelete(buffer)
+#define xMessageBufferSend(buffer, data, length, ticks)           xStreamBufferSend(buffer, data, length, ticks)
+#define xMessageBufferSendFromISR(buffer, data, length, woken)    xStreamBufferSendFromISR(buffer, data, length, woken)
+#define xMessageBufferReceive(buffer, data, length, ticks)        xStreamBufferReceive(buffer, data, length, ticks)
+#define xMessageBufferSpacesAvailable(buffer)                     xStreamBufferSpacesAvailable(buffer)
+#define xMessageBufferReset(buffer)                               xStreamBufferReset(buffer)
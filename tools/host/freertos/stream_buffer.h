@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct host_stream_buffer *StreamBufferHandle_t;
+
+StreamBufferHandle_t xStreamBufferGenericCreate(size_t size, size_t trigger_level, bool message_buffer);
+void vStreamBufferDelete(StreamBufferHandle_t buffer);
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void *data, size_t length, TickType_t ticks);
+size_t xStreamBufferSendFromISR(StreamBufferHandle_t buffer, const void *data, size_t length, BaseType_t *higher_priority_task_woken);
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void *data, size_t length, TickType_t ticks);
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t buffer);
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer);
+BaseType_t xStreamBufferSetTriggerLevel(StreamBufferHandle_t buffer, size_t trigger_level);
+BaseType_t xStreamBufferReset(StreamBufferHandle_t buffer);
+
+#define xStreamBufferCreate(size, trigger_level) xStreamBufferGenericCreate(size, trigger_level, false)
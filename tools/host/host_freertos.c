@@ -0,0 +1,847 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/stream_buffer.h>
+#include "esp_timer.h"
+#include "host_idf.h"
+
+#define TASK_STACK_SIZE (256 * 1024) // Host code (printf) needs more stack than the FreeRTOS stack depth
+#define US_PER_TICK     (portTICK_PERIOD_MS * 1000)
+#define NEVER           INT64_MAX
+
+/* --- Tasks --- */
+
+typedef enum {
+    TASK_READY,
+    TASK_BLOCKED,
+    TASK_DELETED,
+} task_state_t;
+
+struct host_task {
+    ucontext_t context;
+    void *stack;
+    TaskFunction_t function;
+    void *parameters;
+    const char *name;
+    UBaseType_t priority;
+    task_state_t state;
+    const void *object;          // Object the task waits for, NULL for a delay
+    int64_t wake_us;             // Timeout of the wait, NEVER without timeout
+    bool woken;                  // The wait ended because the object changed (and not by the timeout)
+    int64_t order;               // Tasks of the same priority run in the order they became ready
+    uint32_t notification;
+    struct host_task *next;
+};
+
+struct host_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t expiry_us;           // NEVER if the timer is not armed
+    uint64_t period_us;          // 0 for a one-shot timer
+    struct host_timer *next;
+};
+
+static int64_t now_us = 0;
+static int64_t ready_order = 0;
+static struct host_task *tasks = NULL;
+static struct host_task *current = NULL; // NULL in the main context
+static struct host_task main_task;       // Waits of the main context
+static ucontext_t main_context;
+static struct host_timer *timers = NULL;
+
+static int64_t ticks_deadline(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+    {
+        return NEVER;
+    }
+    return now_us + (int64_t)ticks * US_PER_TICK;
+}
+
+static void task_ready(struct host_task *task, bool woken)
+{
+    task->state = TASK_READY;
+    task->woken = woken;
+    task->object = NULL;
+    task->order = ++ready_order;
+}
+
+static struct host_task *task_next_ready(void)
+{
+    struct host_task *next = NULL;
+    for (struct host_task *task = tasks; task != NULL; task = task->next)
+    {
+        if (task->state == TASK_READY &&
+            (next == NULL || task->priority > next->priority || (task->priority == next->priority && task->order < next->order)))
+        {
+            next = task;
+        }
+    }
+    return next;
+}
+
+static void task_reap(void)
+{
+    struct host_task **link = &tasks;
+    while (*link != NULL)
+    {
+        struct host_task *task = *link;
+        if (task->state == TASK_DELETED && task != current)
+        {
+            *link = task->next;
+            free(task->stack);
+            free(task);
+        }
+        else
+        {
+            link = &task->next;
+        }
+    }
+}
+
+/* Back to the main context, the task continues when it is picked again */
+static void task_switch_out(void)
+{
+    struct host_task *task = current;
+    swapcontext(&task->context, &main_context);
+}
+
+/* Wake every task (and the main context) that waits for the object, they check their condition again */
+static void object_wake(const void *object)
+{
+    for (struct host_task *task = tasks; task != NULL; task = task->next)
+    {
+        if (task->state == TASK_BLOCKED && task->object == object)
+        {
+            task_ready(task, true);
+        }
+    }
+    if (main_task.state == TASK_BLOCKED && main_task.object == object)
+    {
+        task_ready(&main_task, true);
+    }
+}
+
+/* A task that wakes a task of a higher priority is preempted, as on FreeRTOS */
+static void task_preempt(void)
+{
+    if (current == NULL)
+    {
+        return;
+    }
+    struct host_task *next = task_next_ready();
+    if (next != NULL && next->priority > current->priority)
+    {
+        current->order = -(++ready_order); // Continues first among the tasks of its priority
+        task_switch_out();
+    }
+}
+
+static void schedule(int64_t until_us, const task_state_t *waiting);
+
+/**
+ * Block the calling task until the object changes or the deadline passes.
+ *
+ * @return true if the object changed, false on the timeout.
+ */
+static bool task_wait(const void *object, int64_t deadline_us)
+{
+    if (deadline_us <= now_us)
+    {
+        return false;
+    }
+
+    struct host_task *task = (current != NULL) ? current : &main_task;
+    task->state = TASK_BLOCKED;
+    task->object = object;
+    task->wake_us = deadline_us;
+    task->woken = false;
+
+    if (current != NULL)
+    {
+        task_switch_out();
+    }
+    else
+    {
+        schedule(deadline_us, &main_task.state);
+        if (main_task.state == TASK_BLOCKED)
+        {
+            main_task.state = TASK_READY; // Timed out, or nothing left that could wake it
+        }
+    }
+    return task->woken;
+}
+
+static void task_entry(void)
+{
+    current->function(current->parameters);
+    // A FreeRTOS task must not return, delete it like vTaskDelete(NULL)
+    current->state = TASK_DELETED;
+    task_switch_out();
+}
+
+/* --- Scheduler --- */
+
+static int64_t timer_next_us(void)
+{
+    int64_t next = NEVER;
+    for (struct host_timer *timer = timers; timer != NULL; timer = timer->next)
+    {
+        if (timer->expiry_us < next)
+        {
+            next = timer->expiry_us;
+        }
+    }
+    return next;
+}
+
+static bool timer_run_due(void)
+{
+    for (struct host_timer *timer = timers; timer != NULL; timer = timer->next)
+    {
+        if (timer->expiry_us <= now_us)
+        {
+            timer->expiry_us = (timer->period_us > 0) ? timer->expiry_us + timer->period_us : NEVER;
+            timer->callback(timer->arg);
+            return true;
+        }
+    }
+    return false;
+}
+
+int64_t host_next_event_us(void)
+{
+    int64_t next = timer_next_us();
+    for (struct host_task *task = tasks; task != NULL; task = task->next)
+    {
+        if (task->state == TASK_READY)
+        {
+            return now_us;
+        }
+        if (task->state == TASK_BLOCKED && task->wake_us < next)
+        {
+            next = task->wake_us;
+        }
+    }
+    return next;
+}
+
+/**
+ * Run the ready tasks and the due timers, advance the virtual time to the next timeout while nothing is ready.
+ * Returns when nothing is due before until_us, or as soon as *waiting is not TASK_BLOCKED any more.
+ */
+static void schedule(int64_t until_us, const task_state_t *waiting)
+{
+    while (waiting == NULL || *waiting == TASK_BLOCKED)
+    {
+        struct host_task *task = task_next_ready();
+        if (task != NULL)
+        {
+            current = task;
+            swapcontext(&main_context, &task->context);
+            current = NULL;
+            task_reap();
+            continue;
+        }
+        if (timer_run_due())
+        {
+            continue;
+        }
+
+        int64_t next = host_next_event_us();
+        if (main_task.state == TASK_BLOCKED && main_task.wake_us < next)
+        {
+            next = main_task.wake_us;
+        }
+        if (next > until_us || next == NEVER)
+        {
+            if (until_us != NEVER && until_us > now_us)
+            {
+                now_us = until_us;
+            }
+            return;
+        }
+        if (next > now_us)
+        {
+            now_us = next;
+        }
+
+        for (task = tasks; task != NULL; task = task->next)
+        {
+            if (task->state == TASK_BLOCKED && task->wake_us <= now_us)
+            {
+                task_ready(task, false);
+            }
+        }
+        if (main_task.state == TASK_BLOCKED && main_task.wake_us <= now_us)
+        {
+            main_task.state = TASK_READY;
+        }
+    }
+}
+
+void host_run(int64_t until_us)
+{
+    if (current != NULL)
+    {
+        return; // Only the main context runs the scheduler
+    }
+    schedule(until_us, NULL);
+}
+
+/* --- Task API --- */
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    struct host_task *task = calloc(1, sizeof(struct host_task));
+    if (task == NULL)
+    {
+        return pdFAIL;
+    }
+    task->stack = malloc(TASK_STACK_SIZE);
+    if (task->stack == NULL)
+    {
+        free(task);
+        return pdFAIL;
+    }
+
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = TASK_STACK_SIZE;
+    task->context.uc_link = NULL;
+    makecontext(&task->context, task_entry, 0);
+
+    task->function = function;
+    task->parameters = parameters;
+    task->name = name;
+    task->priority = priority;
+    task_ready(task, false);
+
+    // Appended, so tasks of the same priority start in the order they were created
+    struct host_task **link = &tasks;
+    while (*link != NULL)
+    {
+        link = &(*link)->next;
+    }
+    *link = task;
+
+    if (handle != NULL)
+    {
+        *handle = task;
+    }
+    task_preempt();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL)
+    {
+        task = current;
+    }
+    if (task == NULL)
+    {
+        return;
+    }
+    task->state = TASK_DELETED;
+    if (task == current)
+    {
+        task_switch_out();
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0)
+    {
+        if (current != NULL)
+        {
+            task_ready(current, false); // Yield to the tasks of the same priority
+            task_switch_out();
+        }
+        return;
+    }
+    task_wait(NULL, ticks_deadline(ticks));
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment)
+{
+    *previous_wake_time += increment;
+    int64_t wake_us = (int64_t)*previous_wake_time * US_PER_TICK;
+    if (wake_us > now_us)
+    {
+        task_wait(NULL, wake_us);
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(now_us / US_PER_TICK);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current;
+}
+
+void vTaskSetTimeOutState(TimeOut_t *timeout)
+{
+    timeout->entered_us = now_us;
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t *timeout, TickType_t *ticks_to_wait)
+{
+    if (*ticks_to_wait == portMAX_DELAY)
+    {
+        return pdFALSE;
+    }
+
+    TickType_t elapsed = (TickType_t)((now_us - timeout->entered_us) / US_PER_TICK);
+    if (elapsed >= *ticks_to_wait)
+    {
+        *ticks_to_wait = 0;
+        return pdTRUE;
+    }
+    *ticks_to_wait -= elapsed;
+    timeout->entered_us = now_us;
+    return pdFALSE;
+}
+
+/* --- Task notifications --- */
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task *task = (current != NULL) ? current : &main_task;
+    int64_t deadline_us = ticks_deadline(ticks);
+
+    while (task->notification == 0)
+    {
+        if (!task_wait(task, deadline_us))
+        {
+            return 0;
+        }
+    }
+
+    uint32_t value = task->notification;
+    task->notification = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    task->notification += 1;
+    object_wake(task);
+    task_preempt();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken)
+{
+    task->notification += 1;
+    object_wake(task);
+    if (higher_priority_task_woken != NULL)
+    {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+/* --- Queues and semaphores --- */
+
+struct host_queue {
+    uint8_t *items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t count;
+    UBaseType_t head;
+    bool is_static;
+};
+
+_Static_assert(sizeof(struct host_queue) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t is too small");
+
+static void queue_init(struct host_queue *queue, UBaseType_t length, UBaseType_t item_size, uint8_t *items)
+{
+    memset(queue, 0, sizeof(struct host_queue));
+    queue->items = items;
+    queue->length = length;
+    queue->item_size = item_size;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *queue = malloc(sizeof(struct host_queue) + length * item_size);
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue_init(queue, length, item_size, (uint8_t *)(queue + 1));
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (!queue->is_static)
+    {
+        free(queue);
+    }
+}
+
+static BaseType_t queue_send(QueueHandle_t queue, const void *item, int64_t deadline_us)
+{
+    while (queue->count == queue->length)
+    {
+        if (!task_wait(queue, deadline_us))
+        {
+            return pdFALSE;
+        }
+    }
+
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    if (queue->item_size > 0)
+    {
+        memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+    }
+    queue->count += 1;
+    object_wake(queue);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    BaseType_t sent = queue_send(queue, item, ticks_deadline(ticks));
+    task_preempt();
+    return sent;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_priority_task_woken)
+{
+    return queue_send(queue, item, now_us);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    // Only for queues of length 1, like in FreeRTOS
+    queue->count = 0;
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueOverwriteFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_priority_task_woken)
+{
+    queue->count = 0;
+    return xQueueSendFromISR(queue, item, higher_priority_task_woken);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    int64_t deadline_us = ticks_deadline(ticks);
+    while (queue->count == 0)
+    {
+        if (!task_wait(queue, deadline_us))
+        {
+            return pdFALSE;
+        }
+    }
+
+    if (queue->item_size > 0)
+    {
+        memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count -= 1;
+    object_wake(queue);
+    task_preempt();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    queue->count = 0;
+    queue->head = 0;
+    object_wake(queue);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer)
+{
+    struct host_queue *queue = (struct host_queue *)buffer;
+    queue_init(queue, 1, 0, NULL);
+    queue->is_static = true;
+    return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+    if (mutex != NULL)
+    {
+        mutex->count = 1;
+    }
+    return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    return xQueueReceive(semaphore, NULL, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    return xQueueSend(semaphore, NULL, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken)
+{
+    return xQueueSendFromISR(semaphore, NULL, higher_priority_task_woken);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    vQueueDelete(semaphore);
+}
+
+/* --- Stream and message buffers --- */
+
+struct host_stream_buffer {
+    uint8_t *data;
+    size_t size;
+    size_t used;
+    size_t head;
+    size_t trigger_level;        // Bytes a blocked receiver waits for
+    bool message_buffer;         // Every message is stored with a size_t length in front of it
+};
+
+static void stream_copy_in(StreamBufferHandle_t buffer, const void *data, size_t length)
+{
+    const uint8_t *bytes = data;
+    for (size_t idx = 0; idx < length; idx++)
+    {
+        buffer->data[(buffer->head + buffer->used) % buffer->size] = bytes[idx];
+        buffer->used += 1;
+    }
+}
+
+static void stream_copy_out(StreamBufferHandle_t buffer, void *data, size_t length, bool consume)
+{
+    uint8_t *bytes = data;
+    for (size_t idx = 0; idx < length; idx++)
+    {
+        bytes[idx] = buffer->data[(buffer->head + idx) % buffer->size];
+    }
+    if (consume)
+    {
+        buffer->head = (buffer->head + length) % buffer->size;
+        buffer->used -= length;
+    }
+}
+
+StreamBufferHandle_t xStreamBufferGenericCreate(size_t size, size_t trigger_level, bool message_buffer)
+{
+    struct host_stream_buffer *buffer = calloc(1, sizeof(struct host_stream_buffer) + size);
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer->data = (uint8_t *)(buffer + 1);
+    buffer->size = size;
+    buffer->trigger_level = (trigger_level > 0) ? trigger_level : 1;
+    buffer->message_buffer = message_buffer;
+    return buffer;
+}
+
+void vStreamBufferDelete(StreamBufferHandle_t buffer)
+{
+    free(buffer);
+}
+
+static size_t stream_send(StreamBufferHandle_t buffer, const void *data, size_t length, int64_t deadline_us)
+{
+    size_t needed = buffer->message_buffer ? length + sizeof(size_t) : 1;
+    if (needed > buffer->size)
+    {
+        return 0;
+    }
+    while (buffer->size - buffer->used < needed)
+    {
+        if (!task_wait(buffer, deadline_us))
+        {
+            return 0;
+        }
+    }
+
+    if (buffer->message_buffer)
+    {
+        stream_copy_in(buffer, &length, sizeof(size_t));
+    }
+    else if (length > buffer->size - buffer->used)
+    {
+        length = buffer->size - buffer->used;
+    }
+    stream_copy_in(buffer, data, length);
+    object_wake(buffer);
+    return length;
+}
+
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void *data, size_t length, TickType_t ticks)
+{
+    size_t sent = stream_send(buffer, data, length, ticks_deadline(ticks));
+    task_preempt();
+    return sent;
+}
+
+size_t xStreamBufferSendFromISR(StreamBufferHandle_t buffer, const void *data, size_t length, BaseType_t *higher_priority_task_woken)
+{
+    return stream_send(buffer, data, length, now_us);
+}
+
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void *data, size_t length, TickType_t ticks)
+{
+    int64_t deadline_us = ticks_deadline(ticks);
+    if (buffer->used == 0)
+    {
+        // As on FreeRTOS, a receiver which blocks is woken once the trigger level is reached (or on its timeout)
+        size_t trigger_level = buffer->message_buffer ? 1 : buffer->trigger_level;
+        while (buffer->used < trigger_level && task_wait(buffer, deadline_us))
+        {
+        }
+        if (buffer->used == 0)
+        {
+            return 0;
+        }
+    }
+
+    if (buffer->message_buffer)
+    {
+        size_t message_length;
+        stream_copy_out(buffer, &message_length, sizeof(size_t), false);
+        if (message_length > length)
+        {
+            return 0; // The message stays in the buffer, as on FreeRTOS
+        }
+        stream_copy_out(buffer, &message_length, sizeof(size_t), true);
+        length = message_length;
+    }
+    else if (length > buffer->used)
+    {
+        length = buffer->used;
+    }
+    stream_copy_out(buffer, data, length, true);
+    object_wake(buffer);
+    task_preempt();
+    return length;
+}
+
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t buffer)
+{
+    return buffer->size - buffer->used;
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer)
+{
+    return buffer->used;
+}
+
+BaseType_t xStreamBufferSetTriggerLevel(StreamBufferHandle_t buffer, size_t trigger_level)
+{
+    if (trigger_level > buffer->size)
+    {
+        return pdFALSE;
+    }
+    buffer->trigger_level = (trigger_level > 0) ? trigger_level : 1;
+    return pdTRUE;
+}
+
+BaseType_t xStreamBufferReset(StreamBufferHandle_t buffer)
+{
+    buffer->used = 0;
+    buffer->head = 0;
+    object_wake(buffer);
+    return pdPASS;
+}
+
+/* --- esp_timer --- */
+
+int64_t esp_timer_get_time(void)
+{
+    return now_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    struct host_timer *timer = calloc(1, sizeof(struct host_timer));
+    if (timer == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->expiry_us = NEVER;
+    timer->next = timers;
+    timers = timer;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if (timer->expiry_us != NEVER)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry_us = now_us + (int64_t)timeout_us;
+    timer->period_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    if (timer->expiry_us != NEVER)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry_us = now_us + (int64_t)period_us;
+    timer->period_us = period_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (timer->expiry_us == NEVER)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry_us = NEVER;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    struct host_timer **link = &timers;
+    while (*link != NULL && *link != timer)
+    {
+        link = &(*link)->next;
+    }
+    if (*link == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *link = timer->next;
+    free(timer);
+    return ESP_OK;
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "esp_console.h"
+#include "esp_random.h"
+#include "host_idf.h"
+
+#define HOST_CONSOLE_COMMANDS 64
+
+/* --- Errors --- */
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+        return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+/* --- Log --- */
+
+esp_log_level_t host_log_level = ESP_LOG_INFO;
+
+uint32_t esp_log_timestamp(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    if (level > host_log_level)
+    {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(level <= ESP_LOG_WARN ? stderr : stdout, format, args);
+    va_end(args);
+}
+
+void esp_log_buffer_hexdump_internal(const char *tag, const void *buffer, uint16_t length, esp_log_level_t level)
+{
+    const uint8_t *bytes = buffer;
+    for (uint16_t offset = 0; offset < length; offset += 16)
+    {
+        char line[16 * 3 + 1];
+        size_t position = 0;
+        for (uint16_t idx = offset; idx < length && idx < offset + 16; idx++)
+        {
+            position += snprintf(&line[position], sizeof(line) - position, " %02x", bytes[idx]);
+        }
+        line[position] = '\0';
+        esp_log_write(level, tag, "%s: 0x%04x %s\n", tag, offset, line);
+    }
+}
+
+/* --- CPU counter --- */
+
+static uint32_t clock_counter(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+static host_counter_t cpu_counter = clock_counter;
+
+void host_cpu_set_counter(host_counter_t counter)
+{
+    cpu_counter = (counter != NULL) ? counter : clock_counter;
+}
+
+uint32_t esp_cpu_get_cycle_count(void)
+{
+    return cpu_counter();
+}
+
+/* --- Console --- */
+
+static esp_console_cmd_t console_commands[HOST_CONSOLE_COMMANDS];
+static size_t console_count = 0;
+
+esp_err_t esp_console_cmd_register(const esp_console_cmd_t *cmd)
+{
+    for (size_t idx = 0; idx < console_count; idx++)
+    {
+        if (strcmp(console_commands[idx].command, cmd->command) == 0)
+        {
+            console_commands[idx] = *cmd;
+            return ESP_OK;
+        }
+    }
+    if (console_count == HOST_CONSOLE_COMMANDS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    console_commands[console_count++] = *cmd;
+    return ESP_OK;
+}
+
+int host_console_run(int argc, char **argv)
+{
+    for (size_t idx = 0; idx < console_count; idx++)
+    {
+        if (strcmp(console_commands[idx].command, argv[0]) == 0)
+        {
+            return console_commands[idx].func(argc, argv);
+        }
+    }
+    return -1;
+}
+
+/* --- Random numbers --- */
+
+uint32_t esp_random(void)
+{
+    // Deterministic, so the runs of a tool can be reproduced
+    static uint32_t state = 0x802154;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
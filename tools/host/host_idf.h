@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_ieee802154.h"
+
+/**
+ * Host shims of the ESP-IDF and FreeRTOS APIs the component uses, so the component sources build and run
+ * unchanged on the host (the host tools in tools/ link them).
+ *
+ * - FreeRTOS (host_freertos.c): tasks run as coroutines in one thread, one at a time, in virtual time. A task
+ *   runs until it blocks, or until it wakes a task of a higher priority. The virtual time only advances when all
+ *   tasks are blocked, to the next timeout or esp_timer. Tick period is 1 ms.
+ * - esp_timer (host_freertos.c): esp_timer_get_time() returns the virtual time, timer callbacks are called in
+ *   the main context.
+ * - Radio (host_radio.c): the address and channel setters and getters keep their values, the transmission and
+ *   energy detection are forwarded to the hooks of the tool, without hooks they succeed and nothing happens.
+ * - Log, console, CPU counter and random numbers (host_idf.c).
+ *
+ * The code of the tool runs in the main context, which also stands in for the ISR context: the driver callbacks
+ * are called from there. Blocking calls in the main context run the tasks until they return.
+ */
+
+/* --- Virtual time --- */
+
+/**
+ * Run the tasks and timers until all tasks are blocked and nothing is due before until_us, then set the virtual
+ * time to until_us.
+ *
+ * @param[in]  until_us  Virtual time to run to, INT64_MAX runs until nothing is due any more.
+ *
+ */
+void host_run(int64_t until_us);
+
+/**
+ * Get the time of the next task timeout or timer.
+ *
+ * @return The virtual time in microseconds, INT64_MAX if nothing is due.
+ *
+ */
+int64_t host_next_event_us(void);
+
+/* --- CPU counter --- */
+
+typedef uint32_t (*host_counter_t)(void);
+
+/**
+ * Set the counter esp_cpu_get_cycle_count() returns, e.g. an instruction counter. NULL restores the default
+ * (the monotonic clock in nanoseconds).
+ *
+ */
+void host_cpu_set_counter(host_counter_t counter);
+
+/* --- Console --- */
+
+/**
+ * Run a registered console command.
+ *
+ * @return The return value of the command, -1 if it is not registered.
+ *
+ */
+int host_console_run(int argc, char **argv);
+
+/* --- Radio --- */
+
+typedef struct {
+    esp_err_t (*transmit)(void *ctx, const uint8_t *frame, bool cca);  // Report the outcome with the driver callbacks
+    esp_err_t (*energy_detect)(void *ctx, uint32_t duration);           // Report with esp_ieee802154_energy_detect_done()
+    void (*receive)(void *ctx);                                         // Radio back to receive (aborts a transmission)
+    void *ctx;
+} host_radio_hooks_t;
+
+/**
+ * Set the hooks of the radio.
+ *
+ * @param[in]  hooks  Pointer to the hooks, copied. NULL removes them.
+ *
+ */
+void host_radio_set_hooks(const host_radio_hooks_t *hooks);
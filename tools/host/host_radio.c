@@ -0,0 +1,167 @@
+#include <string.h>
+
+#include "esp_ieee802154.h"
+#include "host_idf.h"
+
+/* --- Radio state --- */
+
+static esp_ieee802154_state_t radio_state = ESP_IEEE802154_RADIO_DISABLE;
+static uint8_t radio_channel = 11;
+static int8_t radio_txpower = 0;
+static bool radio_promiscuous = false;
+static uint16_t radio_panid = 0xffff;
+static uint16_t radio_short_address = 0xffff;
+static uint8_t radio_ext_address[8];
+static host_radio_hooks_t radio_hooks;
+
+void host_radio_set_hooks(const host_radio_hooks_t *hooks)
+{
+    if (hooks != NULL)
+    {
+        radio_hooks = *hooks;
+    }
+    else
+    {
+        memset(&radio_hooks, 0, sizeof(radio_hooks));
+    }
+}
+
+/* --- Driver API --- */
+
+esp_err_t esp_ieee802154_enable(void)
+{
+    radio_state = ESP_IEEE802154_RADIO_IDLE;
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_disable(void)
+{
+    radio_state = ESP_IEEE802154_RADIO_DISABLE;
+    return ESP_OK;
+}
+
+esp_ieee802154_state_t esp_ieee802154_get_state(void)
+{
+    return radio_state;
+}
+
+uint8_t esp_ieee802154_get_channel(void)
+{
+    return radio_channel;
+}
+
+esp_err_t esp_ieee802154_set_channel(uint8_t channel)
+{
+    if (channel < 11 || channel > 26)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    radio_channel = channel;
+    return ESP_OK;
+}
+
+int8_t esp_ieee802154_get_txpower(void)
+{
+    return radio_txpower;
+}
+
+esp_err_t esp_ieee802154_set_txpower(int8_t power)
+{
+    radio_txpower = power;
+    return ESP_OK;
+}
+
+bool esp_ieee802154_get_promiscuous(void)
+{
+    return radio_promiscuous;
+}
+
+esp_err_t esp_ieee802154_set_promiscuous(bool enable)
+{
+    radio_promiscuous = enable;
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_coordinator(bool enable)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_rx_when_idle(bool enable)
+{
+    return ESP_OK;
+}
+
+uint16_t esp_ieee802154_get_panid(void)
+{
+    return radio_panid;
+}
+
+esp_err_t esp_ieee802154_set_panid(uint16_t panid)
+{
+    radio_panid = panid;
+    return ESP_OK;
+}
+
+uint16_t esp_ieee802154_get_short_address(void)
+{
+    return radio_short_address;
+}
+
+esp_err_t esp_ieee802154_set_short_address(uint16_t short_address)
+{
+    radio_short_address = short_address;
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_get_extended_address(uint8_t *ext_addr)
+{
+    memcpy(ext_addr, radio_ext_address, sizeof(radio_ext_address));
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_set_extended_address(const uint8_t *ext_addr)
+{
+    memcpy(radio_ext_address, ext_addr, sizeof(radio_ext_address));
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_transmit(const uint8_t *frame, bool cca)
+{
+    radio_state = ESP_IEEE802154_RADIO_TRANSMIT;
+    if (radio_hooks.transmit == NULL)
+    {
+        return ESP_OK;
+    }
+    return radio_hooks.transmit(radio_hooks.ctx, frame, cca);
+}
+
+esp_err_t esp_ieee802154_receive(void)
+{
+    radio_state = ESP_IEEE802154_RADIO_RECEIVE;
+    if (radio_hooks.receive != NULL)
+    {
+        radio_hooks.receive(radio_hooks.ctx);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_sleep(void)
+{
+    radio_state = ESP_IEEE802154_RADIO_SLEEP;
+    return ESP_OK;
+}
+
+esp_err_t esp_ieee802154_energy_detect(uint32_t duration)
+{
+    if (radio_hooks.energy_detect == NULL)
+    {
+        return ESP_OK;
+    }
+    return radio_hooks.energy_detect(radio_hooks.ctx, duration);
+}
+
+esp_err_t esp_ieee802154_receive_handle_done(const uint8_t *frame)
+{
+    return ESP_OK;
+}
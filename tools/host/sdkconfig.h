@@ -0,0 +1,29 @@
+#pragma once
+
+/* Kconfig defaults of the ieee802154_util component for host builds (see components/ieee802154_util/Kconfig) */
+#define CONFIG_IEEE802154_UTIL_ISR_IN_IRAM 1
+#define CONFIG_IEEE802154_UTIL_WCET_BUDGET_CYCLES 4000
+#define CONFIG_IEEE802154_UTIL_WCET_RANDOM_FRAMES 100000
+#define CONFIG_IEEE802154_UTIL_SURVEY_SAMPLES 32
+#define CONFIG_IEEE802154_UTIL_SURVEY_ED_DURATION 8
+#define CONFIG_IEEE802154_UTIL_SURVEY_BUSY_DBM -75
+#define CONFIG_IEEE802154_UTIL_SURVEY_INTERVAL_S 600
+#define CONFIG_IEEE802154_UTIL_METRICS_ENABLE 1
+#define CONFIG_IEEE802154_UTIL_METRICS_DUMP_INTERVAL_S 60
+#define CONFIG_IEEE802154_UTIL_TRANSPORT_WINDOW 32
+#define CONFIG_IEEE802154_UTIL_TRANSPORT_RTO_MS 50
+#define CONFIG_IEEE802154_UTIL_ADDR_BOOK_BITS 9
+#define CONFIG_IEEE802154_UTIL_MESH_MAX_HOPS 8
+#define CONFIG_IEEE802154_UTIL_MESH_MIN_LQI 40
+#define CONFIG_IEEE802154_UTIL_MESH_AGE_INTERVAL_S 10
+#define CONFIG_IEEE802154_UTIL_REPLAY_BUFFER_SIZE 16384
+#define CONFIG_IEEE802154_UTIL_POWER_CONTROL 1
+#define CONFIG_IEEE802154_UTIL_POWER_NOMINAL_DBM 0
+#define CONFIG_IEEE802154_UTIL_POWER_MIN_DBM -15
+#define CONFIG_IEEE802154_UTIL_POWER_MAX_DBM 20
+#define CONFIG_IEEE802154_UTIL_POWER_TARGET_MARGIN_DB 15
+#define CONFIG_IEEE802154_UTIL_POWER_HYSTERESIS_DB 6
+#define CONFIG_IEEE802154_UTIL_CHANNEL_WINDOW 32
+#define CONFIG_IEEE802154_UTIL_CHANNEL_CCA_PERCENT 30
+#define CONFIG_IEEE802154_UTIL_CHANNEL_NO_ACK_PERCENT 50
+#define CONFIG_IEEE802154_UTIL_CHANNEL_HOLDOFF_S 10
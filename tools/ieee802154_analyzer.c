@@ -0,0 +1,848 @@
+/**
+ * Offline analyzer for IEEE802.15.4 captures.
+ *
+ * Reads a pcap file (link type 195 IEEE802_15_4_WITHFCS or 230 IEEE802_15_4_NOFCS), decodes the frames in
+ * parallel with the parser of the utility library and reports
+ * - corrupted frames (invalid FCS, only for link type 195), which are not decoded,
+ * - per frame type, per PAN and per source statistics,
+ * - lost and duplicated frames per source (derived from the sequence numbers),
+ * - inter-arrival time histograms per source and the ACK turnaround histogram.
+ *
+ * Build (host):
+ *   gcc -O2 -pthread -I components/ieee802154_util/include tools/ieee802154_analyzer.c components/ieee802154_util/ieee802154_parse.c components/ieee802154_util/ieee802154_fcs.c -o ieee802154_analyzer
+ *
+ * Usage:
+ *   ieee802154_analyzer [-j threads] [--json] capture.pcap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_fcs.h"
+
+#define PCAP_MAGIC_USEC         0xa1b2c3d4
+#define PCAP_MAGIC_NSEC         0xa1b23c4d
+#define PCAP_GLOBAL_HEADER_LEN  24
+#define PCAP_RECORD_HEADER_LEN  16
+
+#define LINKTYPE_IEEE802_15_4_WITHFCS 195
+#define LINKTYPE_IEEE802_15_4_NOFCS   230
+
+#define CHUNK_RECORDS    (1 << 16) // Number of frames decoded by a worker at once
+#define HIST_BUCKETS     32        // Log2 buckets in microseconds, bucket 0 collects everything below 2 us
+#define SEQ_WINDOW       128       // Sequence number jumps beyond this window are counted as reordered
+#define NUM_FRAME_TYPES  8
+#define NUM_PAN_IDS      65536
+
+/* --- Capture --- */
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    bool swapped;
+    bool nsec;
+    bool with_fcs;
+} capture_t;
+
+typedef struct {
+    size_t offset;      // Offset of the first record header
+    uint32_t records;   // Number of records in this chunk
+} chunk_t;
+
+static uint32_t read_u32(const capture_t *cap, const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return cap->swapped ? __builtin_bswap32(v) : v;
+}
+
+static int capture_open(const char *path, capture_t *cap)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < PCAP_GLOBAL_HEADER_LEN)
+    {
+        fprintf(stderr, "%s: not a pcap file\n", path);
+        close(fd);
+        return -1;
+    }
+
+    cap->size = st.st_size;
+    cap->data = mmap(NULL, cap->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (cap->data == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+    madvise((void *)cap->data, cap->size, MADV_SEQUENTIAL);
+
+    uint32_t magic;
+    memcpy(&magic, cap->data, sizeof(magic));
+    cap->swapped = (magic == __builtin_bswap32(PCAP_MAGIC_USEC) || magic == __builtin_bswap32(PCAP_MAGIC_NSEC));
+    magic = cap->swapped ? __builtin_bswap32(magic) : magic;
+    if (magic != PCAP_MAGIC_USEC && magic != PCAP_MAGIC_NSEC)
+    {
+        fprintf(stderr, "%s: unknown pcap magic 0x%08" PRIx32 "\n", path, magic);
+        return -1;
+    }
+    cap->nsec = (magic == PCAP_MAGIC_NSEC);
+
+    uint32_t linktype = read_u32(cap, &cap->data[20]);
+    if (linktype != LINKTYPE_IEEE802_15_4_WITHFCS && linktype != LINKTYPE_IEEE802_15_4_NOFCS)
+    {
+        fprintf(stderr, "%s: unsupported link type %" PRIu32 "\n", path, linktype);
+        return -1;
+    }
+    cap->with_fcs = (linktype == LINKTYPE_IEEE802_15_4_WITHFCS);
+    return 0;
+}
+
+/**
+ * Split the capture into chunks of CHUNK_RECORDS records. pcap records have no sync marker, so this pass only
+ * hops over the record headers and is the only sequential part of the analysis.
+ */
+static chunk_t *capture_index(const capture_t *cap, size_t *num_chunks, uint64_t *truncated)
+{
+    size_t capacity = 64;
+    size_t count = 0;
+    chunk_t *chunks = malloc(capacity * sizeof(chunk_t));
+    size_t offset = PCAP_GLOBAL_HEADER_LEN;
+
+    while (offset + PCAP_RECORD_HEADER_LEN <= cap->size)
+    {
+        if (count == capacity)
+        {
+            capacity *= 2;
+            chunks = realloc(chunks, capacity * sizeof(chunk_t));
+        }
+        chunks[count].offset = offset;
+        chunks[count].records = 0;
+
+        while (chunks[count].records < CHUNK_RECORDS && offset + PCAP_RECORD_HEADER_LEN <= cap->size)
+        {
+            uint32_t incl_len = read_u32(cap, &cap->data[offset + 8]);
+            if (offset + PCAP_RECORD_HEADER_LEN + incl_len > cap->size)
+            {
+                *truncated += 1;
+                offset = cap->size; // Truncated last record
+                break;
+            }
+            offset += PCAP_RECORD_HEADER_LEN + incl_len;
+            chunks[count].records += 1;
+        }
+        if (chunks[count].records > 0)
+        {
+            count += 1;
+        }
+    }
+
+    *num_chunks = count;
+    return chunks;
+}
+
+/* --- Statistics --- */
+
+typedef struct {
+    uint64_t addr;   // Short address or extended address as a number
+    uint16_t pan_id;
+    uint8_t mode;
+} source_key_t;
+
+typedef struct {
+    source_key_t key;
+    bool used;
+    bool seq_valid;
+    uint8_t first_seq;
+    uint8_t last_seq;
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t ack_requests;
+    uint64_t lost;
+    uint64_t duplicates;
+    uint64_t reordered;
+    uint64_t interarrival[HIST_BUCKETS];
+} source_stats_t;
+
+typedef struct {
+    source_stats_t *entries;
+    size_t capacity; // Power of two
+    size_t count;
+} source_table_t;
+
+typedef struct {
+    bool valid;
+    uint8_t seq;
+    uint64_t ts;
+} ack_point_t;
+
+typedef struct {
+    source_table_t sources;
+    ack_point_t leading_ack;    // ACK at the start of the chunk, may belong to the previous chunk
+    ack_point_t trailing_data;  // Data frame with ACK request at the end of the chunk which was not ACKed yet
+    uint64_t ack_latency[HIST_BUCKETS];
+    bool done;
+} chunk_result_t;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t bytes;
+} counter_t;
+
+typedef struct {
+    uint64_t frames;
+    uint64_t bytes;
+    uint64_t malformed;
+    uint64_t fcs_errors;
+    uint64_t unsupported; // Security or information elements
+    counter_t types[NUM_FRAME_TYPES][4]; // [frame type][frame version]
+    counter_t *pans;                     // NUM_PAN_IDS entries
+} thread_stats_t;
+
+static uint32_t hist_bucket(uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    uint32_t bucket = us < 2 ? 0 : 63 - __builtin_clzll(us);
+    return bucket < HIST_BUCKETS ? bucket : HIST_BUCKETS - 1;
+}
+
+static uint64_t hist_percentile(const uint64_t *hist, uint8_t percentile)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        total += hist[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t threshold = (total * percentile + 99) / 100;
+    uint64_t count = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        count += hist[i];
+        if (count >= threshold)
+        {
+            return 2ULL << i; // Upper bound of the bucket in us
+        }
+    }
+    return 2ULL << (HIST_BUCKETS - 1);
+}
+
+static uint64_t key_hash(const source_key_t *key)
+{
+    uint64_t h = key->addr ^ ((uint64_t)key->pan_id << 48) ^ ((uint64_t)key->mode << 40);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static bool key_equal(const source_key_t *a, const source_key_t *b)
+{
+    return a->addr == b->addr && a->pan_id == b->pan_id && a->mode == b->mode;
+}
+
+static void source_table_init(source_table_t *table, size_t capacity)
+{
+    table->capacity = capacity;
+    table->count = 0;
+    table->entries = calloc(capacity, sizeof(source_stats_t));
+}
+
+static source_stats_t *source_table_get(source_table_t *table, const source_key_t *key)
+{
+    if ((table->count + 1) * 10 > table->capacity * 7)
+    {
+        source_table_t grown;
+        source_table_init(&grown, table->capacity * 2);
+        for (size_t i = 0; i < table->capacity; i++)
+        {
+            if (table->entries[i].used)
+            {
+                *source_table_get(&grown, &table->entries[i].key) = table->entries[i];
+            }
+        }
+        free(table->entries);
+        *table = grown;
+    }
+
+    size_t mask = table->capacity - 1;
+    for (size_t idx = key_hash(key) & mask;; idx = (idx + 1) & mask)
+    {
+        source_stats_t *entry = &table->entries[idx];
+        if (!entry->used)
+        {
+            memset(entry, 0, sizeof(source_stats_t));
+            entry->used = true;
+            entry->key = *key;
+            table->count += 1;
+            return entry;
+        }
+        if (key_equal(&entry->key, key))
+        {
+            return entry;
+        }
+    }
+}
+
+static void account_sequence(source_stats_t *stats, uint8_t previous, uint8_t seq)
+{
+    uint8_t delta = seq - previous;
+    if (delta == 0)
+    {
+        stats->duplicates += 1; // Retransmission or duplicate
+    }
+    else if (delta < SEQ_WINDOW)
+    {
+        stats->lost += delta - 1;
+    }
+    else
+    {
+        stats->reordered += 1;
+    }
+}
+
+static source_key_t source_key(const ieee802154_frame_t *frame)
+{
+    source_key_t key = {.addr = 0, .pan_id = frame->src_pan_id, .mode = frame->src_addr.mode};
+    if (frame->src_addr.mode == ADDR_MODE_SHORT)
+    {
+        key.addr = frame->src_addr.short_address;
+    }
+    else if (frame->src_addr.mode == ADDR_MODE_LONG)
+    {
+        key.addr = frame->src_addr.long_address;
+    }
+    return key;
+}
+
+/* --- Workers --- */
+
+typedef struct {
+    const capture_t *cap;
+    const chunk_t *chunks;
+    chunk_result_t *results;
+    size_t num_chunks;
+    size_t next_chunk;          // Next chunk to decode
+    size_t next_merge;          // Next chunk to merge into the global result
+    pthread_mutex_t lock;
+    source_table_t sources;     // Merged result
+    uint64_t ack_latency[HIST_BUCKETS];
+    ack_point_t pending_data;
+} analysis_t;
+
+static void decode_chunk(const capture_t *cap, const chunk_t *chunk, chunk_result_t *result, thread_stats_t *stats)
+{
+    size_t offset = chunk->offset;
+    ack_point_t pending = {0};
+    bool first = true;
+
+    source_table_init(&result->sources, 64);
+
+    for (uint32_t rec = 0; rec < chunk->records; rec++)
+    {
+        const uint8_t *hdr = &cap->data[offset];
+        uint64_t ts = (uint64_t)read_u32(cap, hdr) * 1000000000ULL + (uint64_t)read_u32(cap, hdr + 4) * (cap->nsec ? 1 : 1000);
+        uint32_t incl_len = read_u32(cap, hdr + 8);
+        const uint8_t *psdu = hdr + PCAP_RECORD_HEADER_LEN;
+        offset += PCAP_RECORD_HEADER_LEN + incl_len;
+
+        // The parser expects the PSDU length including the FCS
+        uint32_t psdu_length = cap->with_fcs ? incl_len : incl_len + 2;
+        stats->frames += 1;
+        stats->bytes += incl_len;
+
+        ieee802154_frame_t frame;
+        if (psdu_length > IEEE802154_MAX_PSDU_LENGTH || (incl_len < 2 + (cap->with_fcs ? 2 : 0)))
+        {
+            stats->malformed += 1;
+            first = false;
+            continue;
+        }
+        if (cap->with_fcs && !esp_ieee802154_fcs_valid(psdu, psdu_length))
+        {
+            stats->fcs_errors += 1;
+            first = false;
+            continue;
+        }
+        if (!esp_ieee802154_parse_frame(psdu, psdu_length, &frame))
+        {
+            if (frame.header_length > psdu_length - 2)
+            {
+                stats->malformed += 1;
+                first = false;
+                continue;
+            }
+            stats->unsupported += 1; // Header is valid, but the payload can not be interpreted
+        }
+
+        stats->types[frame.frame_type][frame.frame_version].frames += 1;
+        stats->types[frame.frame_type][frame.frame_version].bytes += incl_len;
+
+        // Frames without any address (e.g. Imm-ACKs) do not belong to a PAN
+        bool dst_present = frame.dst_addr.mode == ADDR_MODE_SHORT || frame.dst_addr.mode == ADDR_MODE_LONG;
+        bool src_present = frame.src_addr.mode == ADDR_MODE_SHORT || frame.src_addr.mode == ADDR_MODE_LONG;
+        if (dst_present || src_present)
+        {
+            uint16_t pan_id = dst_present ? frame.dst_pan_id : frame.src_pan_id;
+            stats->pans[pan_id].frames += 1;
+            stats->pans[pan_id].bytes += incl_len;
+        }
+
+        if (frame.frame_type == FRAME_TYPE_ACK)
+        {
+            if (pending.valid && frame.sequence_number_present && pending.seq == frame.sequence_number)
+            {
+                result->ack_latency[hist_bucket(ts - pending.ts)] += 1;
+            }
+            else if (first)
+            {
+                result->leading_ack = (ack_point_t){.valid = frame.sequence_number_present, .seq = frame.sequence_number, .ts = ts};
+            }
+            pending.valid = false;
+        }
+        else
+        {
+            pending = (ack_point_t){.valid = frame.ack_request && frame.sequence_number_present, .seq = frame.sequence_number, .ts = ts};
+        }
+        first = false;
+
+        /* ACKs do not carry their own sequence number space and are only counted per source */
+        source_key_t key = source_key(&frame);
+        source_stats_t *src = source_table_get(&result->sources, &key);
+        if (src->frames > 0)
+        {
+            src->interarrival[hist_bucket(ts - src->last_ts)] += 1;
+        }
+        else
+        {
+            src->first_ts = ts;
+        }
+        src->last_ts = ts;
+        src->frames += 1;
+        src->bytes += incl_len;
+        src->ack_requests += frame.ack_request;
+
+        if (frame.frame_type != FRAME_TYPE_ACK && frame.sequence_number_present)
+        {
+            if (src->seq_valid)
+            {
+                account_sequence(src, src->last_seq, frame.sequence_number);
+            }
+            else
+            {
+                src->seq_valid = true;
+                src->first_seq = frame.sequence_number;
+            }
+            src->last_seq = frame.sequence_number;
+        }
+    }
+
+    result->trailing_data = pending;
+}
+
+/**
+ * Merge a chunk into the global result. Chunks are merged in capture order, so the sequence numbers and
+ * timestamps at the chunk boundaries can be evaluated like inside a chunk.
+ */
+static void merge_chunk(analysis_t *analysis, chunk_result_t *result)
+{
+    for (size_t i = 0; i < result->sources.capacity; i++)
+    {
+        source_stats_t *chunk_src = &result->sources.entries[i];
+        if (!chunk_src->used)
+        {
+            continue;
+        }
+
+        source_stats_t *src = source_table_get(&analysis->sources, &chunk_src->key);
+        if (src->frames == 0)
+        {
+            *src = *chunk_src;
+            continue;
+        }
+
+        src->interarrival[hist_bucket(chunk_src->first_ts - src->last_ts)] += 1;
+        if (src->seq_valid && chunk_src->seq_valid)
+        {
+            account_sequence(src, src->last_seq, chunk_src->first_seq);
+        }
+        if (chunk_src->seq_valid)
+        {
+            if (!src->seq_valid)
+            {
+                src->first_seq = chunk_src->first_seq;
+            }
+            src->seq_valid = true;
+            src->last_seq = chunk_src->last_seq;
+        }
+
+        src->last_ts = chunk_src->last_ts;
+        src->frames += chunk_src->frames;
+        src->bytes += chunk_src->bytes;
+        src->ack_requests += chunk_src->ack_requests;
+        src->lost += chunk_src->lost;
+        src->duplicates += chunk_src->duplicates;
+        src->reordered += chunk_src->reordered;
+        for (int b = 0; b < HIST_BUCKETS; b++)
+        {
+            src->interarrival[b] += chunk_src->interarrival[b];
+        }
+    }
+
+    if (analysis->pending_data.valid && result->leading_ack.valid && analysis->pending_data.seq == result->leading_ack.seq)
+    {
+        analysis->ack_latency[hist_bucket(result->leading_ack.ts - analysis->pending_data.ts)] += 1;
+    }
+    analysis->pending_data = result->trailing_data;
+    for (int b = 0; b < HIST_BUCKETS; b++)
+    {
+        analysis->ack_latency[b] += result->ack_latency[b];
+    }
+
+    free(result->sources.entries);
+    result->sources.entries = NULL;
+}
+
+typedef struct {
+    analysis_t *analysis;
+    thread_stats_t stats;
+} worker_t;
+
+static void *worker_main(void *arg)
+{
+    worker_t *worker = arg;
+    analysis_t *analysis = worker->analysis;
+
+    while (1)
+    {
+        pthread_mutex_lock(&analysis->lock);
+        size_t idx = analysis->next_chunk++;
+        pthread_mutex_unlock(&analysis->lock);
+        if (idx >= analysis->num_chunks)
+        {
+            break;
+        }
+
+        decode_chunk(analysis->cap, &analysis->chunks[idx], &analysis->results[idx], &worker->stats);
+
+        // Merge every chunk which is complete and in order, this keeps the number of buffered chunks small
+        pthread_mutex_lock(&analysis->lock);
+        analysis->results[idx].done = true;
+        while (analysis->next_merge < analysis->num_chunks && analysis->results[analysis->next_merge].done)
+        {
+            merge_chunk(analysis, &analysis->results[analysis->next_merge]);
+            analysis->next_merge += 1;
+        }
+        pthread_mutex_unlock(&analysis->lock);
+    }
+    return NULL;
+}
+
+/* --- Output --- */
+
+static const char *frame_type_name(uint8_t type, uint8_t version)
+{
+    static const char *names[NUM_FRAME_TYPES] = {"Beacon", "Data", "ACK", "MAC CMD", "Reserved", "Multipurpose", "Fragment", "Extended"};
+    if (type == FRAME_TYPE_ACK)
+    {
+        return version == FRAME_VERSION_STD_2015 ? "Enh-ACK" : "Imm-ACK";
+    }
+    return names[type];
+}
+
+static const char *frame_version_name(uint8_t version)
+{
+    static const char *names[4] = {"2003", "2006", "2015", "Invalid"};
+    return names[version];
+}
+
+static void format_source(const source_key_t *key, char *buffer, size_t size)
+{
+    switch (key->mode)
+    {
+    case ADDR_MODE_SHORT:
+        snprintf(buffer, size, "%04x/%04" PRIx64, key->pan_id, key->addr);
+        break;
+    case ADDR_MODE_LONG:
+        snprintf(buffer, size, "%04x/%016" PRIx64, key->pan_id, key->addr);
+        break;
+    default:
+        snprintf(buffer, size, "none");
+        break;
+    }
+}
+
+static int compare_sources(const void *a, const void *b)
+{
+    const source_stats_t *sa = *(const source_stats_t *const *)a;
+    const source_stats_t *sb = *(const source_stats_t *const *)b;
+    return sa->frames < sb->frames ? 1 : (sa->frames > sb->frames ? -1 : 0);
+}
+
+static void print_histogram_json(FILE *out, const uint64_t *hist)
+{
+    fprintf(out, "[");
+    for (int b = 0; b < HIST_BUCKETS; b++)
+    {
+        fprintf(out, "%s%" PRIu64, b ? "," : "", hist[b]);
+    }
+    fprintf(out, "]");
+}
+
+static void print_histogram(FILE *out, const char *title, const uint64_t *hist)
+{
+    uint64_t max = 0;
+    int last = -1;
+    for (int b = 0; b < HIST_BUCKETS; b++)
+    {
+        max = hist[b] > max ? hist[b] : max;
+        last = hist[b] ? b : last;
+    }
+
+    fprintf(out, "\n%s (p50 < %" PRIu64 " us, p99 < %" PRIu64 " us)\n", title, hist_percentile(hist, 50), hist_percentile(hist, 99));
+    for (int b = 0; b <= last; b++)
+    {
+        int width = max ? (int)(hist[b] * 50 / max) : 0;
+        fprintf(out, "  < %10" PRIu64 " us %12" PRIu64 " |%.*s\n", (uint64_t)2 << b, hist[b], width,
+                "##################################################");
+    }
+}
+
+static void print_report(FILE *out, const thread_stats_t *total, const analysis_t *analysis, source_stats_t **sources,
+                         size_t num_sources, uint64_t truncated, int threads, double seconds)
+{
+    char name[32];
+
+    fprintf(out, "Frames: %" PRIu64 ", bytes: %" PRIu64 ", malformed: %" PRIu64 ", FCS errors: %" PRIu64 ", unsupported: %" PRIu64
+                 ", truncated: %" PRIu64 "\n",
+            total->frames, total->bytes, total->malformed, total->fcs_errors, total->unsupported, truncated);
+    fprintf(out, "Decoded with %d threads in %.3f s (%.2f Mframes/s, %.1f MB/s)\n", threads, seconds,
+            total->frames / seconds / 1e6, analysis->cap->size / seconds / 1e6);
+
+    fprintf(out, "\n%-14s %-8s %14s %14s\n", "Type", "Version", "Frames", "Bytes");
+    for (int t = 0; t < NUM_FRAME_TYPES; t++)
+    {
+        for (int v = 0; v < 4; v++)
+        {
+            if (total->types[t][v].frames)
+            {
+                fprintf(out, "%-14s %-8s %14" PRIu64 " %14" PRIu64 "\n", frame_type_name(t, v), frame_version_name(v),
+                        total->types[t][v].frames, total->types[t][v].bytes);
+            }
+        }
+    }
+
+    fprintf(out, "\n%-8s %14s %14s\n", "PAN", "Frames", "Bytes");
+    for (int pan = 0; pan < NUM_PAN_IDS; pan++)
+    {
+        if (total->pans[pan].frames)
+        {
+            fprintf(out, "%04x     %14" PRIu64 " %14" PRIu64 "\n", pan, total->pans[pan].frames, total->pans[pan].bytes);
+        }
+    }
+
+    fprintf(out, "\n%-21s %12s %12s %10s %10s %8s %10s %10s\n", "Source (PAN/addr)", "Frames", "Bytes", "Lost", "Dup", "Loss %",
+            "IAT p50", "IAT p99");
+    for (size_t i = 0; i < num_sources; i++)
+    {
+        const source_stats_t *src = sources[i];
+        double loss = src->frames + src->lost ? 100.0 * src->lost / (src->frames + src->lost) : 0.0;
+        format_source(&src->key, name, sizeof(name));
+        fprintf(out, "%-21s %12" PRIu64 " %12" PRIu64 " %10" PRIu64 " %10" PRIu64 " %8.2f %8" PRIu64 "us %8" PRIu64 "us\n", name,
+                src->frames, src->bytes, src->lost, src->duplicates, loss, hist_percentile(src->interarrival, 50),
+                hist_percentile(src->interarrival, 99));
+    }
+
+    print_histogram(out, "ACK turnaround", analysis->ack_latency);
+    for (size_t i = 0; i < num_sources; i++)
+    {
+        char title[64];
+        format_source(&sources[i]->key, name, sizeof(name));
+        snprintf(title, sizeof(title), "Inter-arrival %s", name);
+        print_histogram(out, title, sources[i]->interarrival);
+    }
+}
+
+static void print_json(FILE *out, const thread_stats_t *total, const analysis_t *analysis, source_stats_t **sources,
+                       size_t num_sources, uint64_t truncated, int threads, double seconds)
+{
+    char name[32];
+    bool first = true;
+
+    fprintf(out, "{\"frames\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"malformed\":%" PRIu64 ",\"fcs_errors\":%" PRIu64
+                 ",\"unsupported\":%" PRIu64 ",\"truncated\":%" PRIu64 ",\"threads\":%d,\"seconds\":%.6f,\n",
+            total->frames, total->bytes, total->malformed, total->fcs_errors, total->unsupported, truncated, threads, seconds);
+
+    fprintf(out, "\"types\":[");
+    for (int t = 0; t < NUM_FRAME_TYPES; t++)
+    {
+        for (int v = 0; v < 4; v++)
+        {
+            if (total->types[t][v].frames)
+            {
+                fprintf(out, "%s{\"type\":\"%s\",\"version\":\"%s\",\"frames\":%" PRIu64 ",\"bytes\":%" PRIu64 "}", first ? "" : ",",
+                        frame_type_name(t, v), frame_version_name(v), total->types[t][v].frames, total->types[t][v].bytes);
+                first = false;
+            }
+        }
+    }
+
+    fprintf(out, "],\n\"pans\":[");
+    first = true;
+    for (int pan = 0; pan < NUM_PAN_IDS; pan++)
+    {
+        if (total->pans[pan].frames)
+        {
+            fprintf(out, "%s{\"pan\":%d,\"frames\":%" PRIu64 ",\"bytes\":%" PRIu64 "}", first ? "" : ",", pan, total->pans[pan].frames,
+                    total->pans[pan].bytes);
+            first = false;
+        }
+    }
+
+    fprintf(out, "],\n\"sources\":[");
+    for (size_t i = 0; i < num_sources; i++)
+    {
+        const source_stats_t *src = sources[i];
+        format_source(&src->key, name, sizeof(name));
+        fprintf(out, "%s\n{\"source\":\"%s\",\"frames\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"ack_requests\":%" PRIu64 ",\"lost\":%" PRIu64
+                     ",\"duplicates\":%" PRIu64 ",\"reordered\":%" PRIu64 ",\"interarrival_us_log2\":",
+                i ? "," : "", name, src->frames, src->bytes, src->ack_requests, src->lost, src->duplicates, src->reordered);
+        print_histogram_json(out, src->interarrival);
+        fprintf(out, "}");
+    }
+
+    fprintf(out, "],\n\"ack_turnaround_us_log2\":");
+    print_histogram_json(out, analysis->ack_latency);
+    fprintf(out, "}\n");
+}
+
+/* --- Main --- */
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool json = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL || threads < 1)
+    {
+        fprintf(stderr, "Usage: %s [-j threads] [--json] capture.pcap\n", argv[0]);
+        return 1;
+    }
+
+    capture_t cap;
+    if (capture_open(path, &cap) != 0)
+    {
+        return 1;
+    }
+
+    double start = now_seconds();
+    uint64_t truncated = 0;
+    analysis_t analysis = {.cap = &cap};
+    analysis.chunks = capture_index(&cap, &analysis.num_chunks, &truncated);
+    analysis.results = calloc(analysis.num_chunks ? analysis.num_chunks : 1, sizeof(chunk_result_t));
+    pthread_mutex_init(&analysis.lock, NULL);
+    source_table_init(&analysis.sources, 64);
+
+    worker_t *workers = calloc(threads, sizeof(worker_t));
+    pthread_t *tids = calloc(threads, sizeof(pthread_t));
+    for (int i = 0; i < threads; i++)
+    {
+        workers[i].analysis = &analysis;
+        workers[i].stats.pans = calloc(NUM_PAN_IDS, sizeof(counter_t));
+        pthread_create(&tids[i], NULL, worker_main, &workers[i]);
+    }
+
+    thread_stats_t total = {.pans = calloc(NUM_PAN_IDS, sizeof(counter_t))};
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(tids[i], NULL);
+        total.frames += workers[i].stats.frames;
+        total.bytes += workers[i].stats.bytes;
+        total.malformed += workers[i].stats.malformed;
+        total.fcs_errors += workers[i].stats.fcs_errors;
+        total.unsupported += workers[i].stats.unsupported;
+        for (int t = 0; t < NUM_FRAME_TYPES; t++)
+        {
+            for (int v = 0; v < 4; v++)
+            {
+                total.types[t][v].frames += workers[i].stats.types[t][v].frames;
+                total.types[t][v].bytes += workers[i].stats.types[t][v].bytes;
+            }
+        }
+        for (int pan = 0; pan < NUM_PAN_IDS; pan++)
+        {
+            total.pans[pan].frames += workers[i].stats.pans[pan].frames;
+            total.pans[pan].bytes += workers[i].stats.pans[pan].bytes;
+        }
+        free(workers[i].stats.pans);
+    }
+    double seconds = now_seconds() - start;
+
+    source_stats_t **sources = malloc((analysis.sources.count + 1) * sizeof(source_stats_t *));
+    size_t num_sources = 0;
+    for (size_t i = 0; i < analysis.sources.capacity; i++)
+    {
+        if (analysis.sources.entries[i].used)
+        {
+            sources[num_sources++] = &analysis.sources.entries[i];
+        }
+    }
+    qsort(sources, num_sources, sizeof(source_stats_t *), compare_sources);
+
+    if (json)
+    {
+        print_json(stdout, &total, &analysis, sources, num_sources, truncated, threads, seconds);
+    }
+    else
+    {
+        print_report(stdout, &total, &analysis, sources, num_sources, truncated, threads, seconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+/**
+ * Host benchmark of the batch header decoder.
+ *
+ * Builds a synthetic trace with every combination of frame version, addressing modes, pan id compression and
+ * sequence number suppression, plus secure, IE, truncated and too short frames. Every kernel of
+ * esp_ieee802154_batch_decode() decodes the trace; the results are compared with esp_ieee802154_parse_frame()
+ * frame by frame and between the kernels array by array before the timing. The throughput is reported in
+ * frames per second for the parser (one frame at a time) and for every kernel the CPU supports.
+ *
+ * Build (host):
+ *   gcc -O2 -I components/ieee802154_util/include tools/ieee802154_batch_bench.c components/ieee802154_util/ieee802154_batch.c components/ieee802154_util/ieee802154_parse.c -o ieee802154_batch_bench
+ *
+ * Usage:
+ *   ieee802154_batch_bench [-n frames] [-b batch_size] [-r rounds] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_batch.h"
+
+#define MAX_PSDU_LENGTH 127
+
+typedef struct {
+    size_t count;
+    uint8_t *data;           // All PSDUs back to back
+    const uint8_t **psdus;
+    uint8_t *lengths;
+} trace_t;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* --- Synthetic trace --- */
+
+/**
+ * Mostly well formed data and ACK frames with random addressing, 1/32 each of secure frames, frames with IEs,
+ * reserved addressing modes, truncated headers and frames shorter than FCF and FCS.
+ */
+static uint8_t trace_frame(uint8_t *psdu)
+{
+    static const uint8_t modes[] = { ADDR_MODE_NONE, ADDR_MODE_SHORT, ADDR_MODE_SHORT, ADDR_MODE_LONG };
+    static const uint8_t address_length[4] = { 0, 0, 2, 8 };
+
+    uint32_t r = rng_next();
+    uint8_t type = (r & 0x3) == 0 ? FRAME_TYPE_ACK : FRAME_TYPE_DATA;
+    uint8_t version = (r >> 2) % 3;
+    uint8_t dst_mode = modes[(r >> 4) & 0x3];
+    uint8_t src_mode = modes[(r >> 6) & 0x3];
+    uint16_t fcf = type | (dst_mode << 10) | (version << 12) | (src_mode << 14);
+    fcf |= ((r >> 8) & 0x1) << 4;   // Frame pending
+    fcf |= ((r >> 9) & 0x1) << 5;   // ACK request
+    fcf |= ((r >> 10) & 0x1) << 6;  // Pan id compression
+    fcf |= ((r >> 11) & 0x1) << 8;  // Sequence number suppression
+
+    uint8_t special = (r >> 12) & 0x1F;
+    if (special == 0)
+    {
+        fcf |= 1 << 3;              // Secure
+    }
+    else if (special == 1)
+    {
+        fcf |= 1 << 9;              // Information elements
+    }
+    else if (special == 2)
+    {
+        fcf = (fcf & ~(0x3 << 10)) | (ADDR_MODE_RESERVED << 10);
+    }
+
+    uint8_t header_length = 2 + address_length[dst_mode] + address_length[src_mode];
+    header_length += !(version == FRAME_VERSION_STD_2015 && (fcf & (1 << 8)));
+    header_length += (dst_mode >= ADDR_MODE_SHORT) ? 2 : 0;
+    header_length += (src_mode >= ADDR_MODE_SHORT && !(dst_mode >= ADDR_MODE_SHORT && (fcf & (1 << 6)))) ? 2 : 0;
+
+    uint8_t length = header_length + 2 + rng_next() % (MAX_PSDU_LENGTH - 2 - header_length + 1);
+    if (special == 3)
+    {
+        length = 4 + rng_next() % (header_length + 1 - 2); // Truncated header
+    }
+    else if (special == 4)
+    {
+        length = rng_next() % 4;                           // Too short for FCF and FCS
+    }
+
+    psdu[0] = fcf & 0xFF;
+    psdu[1] = fcf >> 8;
+    for (uint8_t idx = 2; idx < length; idx++)
+    {
+        psdu[idx] = rng_next();
+    }
+    return length;
+}
+
+static void trace_build(trace_t *trace, size_t count)
+{
+    trace->count = count;
+    trace->data = malloc(count * MAX_PSDU_LENGTH);
+    trace->psdus = malloc(count * sizeof(uint8_t *));
+    trace->lengths = malloc(count);
+
+    size_t offset = 0;
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        trace->psdus[idx] = &trace->data[offset];
+        trace->lengths[idx] = trace_frame(&trace->data[offset]);
+        offset += trace->lengths[idx];
+    }
+}
+
+/* --- Verification --- */
+
+static bool frame_equal(const ieee802154_frame_t *a, const ieee802154_frame_t *b)
+{
+    return a->frame_type == b->frame_type && a->frame_version == b->frame_version && a->secure == b->secure &&
+           a->frame_pending == b->frame_pending && a->ack_request == b->ack_request &&
+           a->pan_id_compression == b->pan_id_compression && a->sequence_number_suppression == b->sequence_number_suppression &&
+           a->information_elements_present == b->information_elements_present &&
+           a->sequence_number_present == b->sequence_number_present && a->sequence_number == b->sequence_number &&
+           a->dst_pan_id == b->dst_pan_id && a->src_pan_id == b->src_pan_id &&
+           esp_ieee802154_address_equal(&a->dst_addr, &b->dst_addr) && esp_ieee802154_address_equal(&a->src_addr, &b->src_addr) &&
+           a->header_length == b->header_length && a->payload_length == b->payload_length;
+}
+
+static bool batch_equal(const ieee802154_batch_t *a, const ieee802154_batch_t *b, size_t count)
+{
+    return memcmp(a->fcf, b->fcf, count * sizeof(uint16_t)) == 0 &&
+           memcmp(a->frame_type, b->frame_type, count) == 0 &&
+           memcmp(a->frame_version, b->frame_version, count) == 0 &&
+           memcmp(a->flags, b->flags, count) == 0 &&
+           memcmp(a->sequence_number, b->sequence_number, count) == 0 &&
+           memcmp(a->dst_mode, b->dst_mode, count) == 0 &&
+           memcmp(a->src_mode, b->src_mode, count) == 0 &&
+           memcmp(a->header_length, b->header_length, count) == 0 &&
+           memcmp(a->payload_length, b->payload_length, count) == 0 &&
+           memcmp(a->dst_pan_id, b->dst_pan_id, count * sizeof(uint16_t)) == 0 &&
+           memcmp(a->src_pan_id, b->src_pan_id, count * sizeof(uint16_t)) == 0 &&
+           memcmp(a->dst_addr, b->dst_addr, count * sizeof(uint64_t)) == 0 &&
+           memcmp(a->src_addr, b->src_addr, count * sizeof(uint64_t)) == 0;
+}
+
+/**
+ * Decode the trace with a kernel and compare every frame with the parser, and the arrays with the scalar kernel.
+ */
+static int verify(const trace_t *trace, size_t batch_size, ieee802154_batch_kernel_t kernel, ieee802154_batch_t *batch,
+                  ieee802154_batch_t *reference)
+{
+    for (size_t first = 0; first < trace->count; first += batch_size)
+    {
+        size_t count = (trace->count - first < batch_size) ? trace->count - first : batch_size;
+        esp_ieee802154_batch_decode(&trace->psdus[first], &trace->lengths[first], count, batch, kernel);
+        esp_ieee802154_batch_decode(&trace->psdus[first], &trace->lengths[first], count, reference, IEEE802154_BATCH_SCALAR);
+
+        if (!batch_equal(batch, reference, count))
+        {
+            fprintf(stderr, "%s: results differ from the scalar kernel in frames %zu to %zu\n",
+                    esp_ieee802154_batch_kernel_name(kernel), first, first + count - 1);
+            return 1;
+        }
+        for (size_t idx = 0; idx < count; idx++)
+        {
+            ieee802154_frame_t parsed;
+            ieee802154_frame_t decoded;
+            bool parsed_valid = esp_ieee802154_parse_frame(trace->psdus[first + idx], trace->lengths[first + idx], &parsed);
+            bool decoded_valid = esp_ieee802154_batch_get(batch, idx, &decoded);
+            if (parsed_valid != decoded_valid || !frame_equal(&parsed, &decoded))
+            {
+                fprintf(stderr, "%s: frame %zu (fcf 0x%04x, length %d) differs from the parser\n",
+                        esp_ieee802154_batch_kernel_name(kernel), first + idx, batch->fcf[idx], trace->lengths[first + idx]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* --- Benchmark --- */
+
+static double bench_parser(const trace_t *trace, uint32_t rounds, size_t *valid)
+{
+    ieee802154_frame_t frame;
+    double start = now_ns();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        *valid = 0;
+        for (size_t idx = 0; idx < trace->count; idx++)
+        {
+            *valid += esp_ieee802154_parse_frame(trace->psdus[idx], trace->lengths[idx], &frame);
+        }
+    }
+    return (now_ns() - start) / 1e9;
+}
+
+static double bench_kernel(const trace_t *trace, size_t batch_size, uint32_t rounds, ieee802154_batch_kernel_t kernel,
+                           ieee802154_batch_t *batch, size_t *valid)
+{
+    double start = now_ns();
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        *valid = 0;
+        for (size_t first = 0; first < trace->count; first += batch_size)
+        {
+            size_t count = (trace->count - first < batch_size) ? trace->count - first : batch_size;
+            *valid += esp_ieee802154_batch_decode(&trace->psdus[first], &trace->lengths[first], count, batch, kernel);
+        }
+    }
+    return (now_ns() - start) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    size_t frames = 4000000;
+    size_t batch_size = 4096;
+    uint32_t rounds = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            frames = strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            batch_size = strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            rounds = strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            rng_state = strtoull(argv[++i], NULL, 0) | 1;
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n frames] [-b batch_size] [-r rounds] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames == 0 || batch_size == 0 || rounds == 0)
+    {
+        fprintf(stderr, "frames, batch size and rounds need to be positive\n");
+        return 1;
+    }
+
+    trace_t trace;
+    trace_build(&trace, frames);
+
+    ieee802154_batch_t batch;
+    ieee802154_batch_t reference;
+    if (!esp_ieee802154_batch_alloc(&batch, batch_size) || !esp_ieee802154_batch_alloc(&reference, batch_size))
+    {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    const ieee802154_batch_kernel_t kernels[] = { IEEE802154_BATCH_SCALAR, IEEE802154_BATCH_SSE2, IEEE802154_BATCH_AVX2 };
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+        if (esp_ieee802154_batch_kernel(kernels[k]) == kernels[k] && verify(&trace, batch_size, kernels[k], &batch, &reference))
+        {
+            return 1;
+        }
+    }
+
+    size_t valid;
+    double seconds = bench_parser(&trace, rounds, &valid);
+    double parser_rate = trace.count * (double)rounds / seconds;
+    printf("%zu frames (%zu valid), batches of %zu, %" PRIu32 " rounds, identical results in all kernels\n",
+           trace.count, valid, batch_size, rounds);
+    printf("%-8s %14s %9s\n", "kernel", "Mframes/s", "speedup");
+    printf("%-8s %14.1f %8.1fx\n", "parser", parser_rate / 1e6, 1.0);
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+        if (esp_ieee802154_batch_kernel(kernels[k]) != kernels[k])
+        {
+            printf("%-8s %14s\n", esp_ieee802154_batch_kernel_name(kernels[k]), "unsupported");
+            continue;
+        }
+        seconds = bench_kernel(&trace, batch_size, rounds, kernels[k], &batch, &valid);
+        double rate = trace.count * (double)rounds / seconds;
+        printf("%-8s %14.1f %8.1fx\n", esp_ieee802154_batch_kernel_name(kernels[k]), rate / 1e6, rate / parser_rate);
+    }
+
+    esp_ieee802154_batch_free(&batch);
+    esp_ieee802154_batch_free(&reference);
+    return 0;
+}
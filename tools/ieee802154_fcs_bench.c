@@ -0,0 +1,184 @@
+/**
+ * Host benchmark of the software FCS.
+ *
+ * Checks esp_ieee802154_fcs_bytewise() and esp_ieee802154_fcs() against a bit-by-bit reference (the check
+ * value of "123456789" and random PSDUs of every length), then measures the reference, the byte-wise and the
+ * slice-by-8 variant for an Imm-ACK, a typical 20 byte payload frame and a maximum size frame, in frames and
+ * bytes per second.
+ *
+ * Build (host):
+ *   gcc -O2 -I components/ieee802154_util/include tools/ieee802154_fcs_bench.c components/ieee802154_util/ieee802154_fcs.c -o ieee802154_fcs_bench
+ *
+ * Usage:
+ *   ieee802154_fcs_bench [-n iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_fcs.h"
+
+#define CHECK_VALUE 0x2189 // CRC-16/ITU-T (KERMIT) of "123456789"
+#define FRAMES      64     // Different PSDUs per size, so the timing does not depend on one buffer
+
+typedef uint16_t (*fcs_fn_t)(const uint8_t *data, size_t length);
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Reference, one bit at a time */
+static uint16_t fcs_bitwise(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0;
+    for (size_t idx = 0; idx < length; idx++)
+    {
+        crc ^= data[idx];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+/* --- Verification --- */
+
+static int verify(void)
+{
+    const uint8_t check[] = "123456789";
+    if (fcs_bitwise(check, 9) != CHECK_VALUE || esp_ieee802154_fcs_bytewise(check, 9) != CHECK_VALUE ||
+        esp_ieee802154_fcs(check, 9) != CHECK_VALUE)
+    {
+        fprintf(stderr, "Check value mismatch\n");
+        return 1;
+    }
+
+    uint8_t frame[1 + IEEE802154_MAX_PSDU_LENGTH];
+    for (int round = 0; round < 100; round++)
+    {
+        for (uint8_t length = IEEE802154_FCS_LENGTH; length <= IEEE802154_MAX_PSDU_LENGTH; length++)
+        {
+            frame[0] = length;
+            for (uint8_t idx = 1; idx <= length; idx++)
+            {
+                frame[idx] = rng_next();
+            }
+
+            uint16_t reference = fcs_bitwise(&frame[1], length - IEEE802154_FCS_LENGTH);
+            if (esp_ieee802154_fcs_bytewise(&frame[1], length - IEEE802154_FCS_LENGTH) != reference ||
+                esp_ieee802154_fcs(&frame[1], length - IEEE802154_FCS_LENGTH) != reference)
+            {
+                fprintf(stderr, "FCS mismatch at length %u\n", length);
+                return 1;
+            }
+
+            esp_ieee802154_fcs_append(frame);
+            uint16_t bit = rng_next() % (length * 8);
+            bool valid = esp_ieee802154_fcs_valid(&frame[1], length);
+            frame[1 + bit / 8] ^= 1 << (bit % 8);
+            if (!valid || esp_ieee802154_fcs_valid(&frame[1], length))
+            {
+                fprintf(stderr, "FCS check failed at length %u\n", length);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* --- Benchmark --- */
+
+static double bench(fcs_fn_t fn, const uint8_t *frames, size_t length, uint32_t iterations)
+{
+    volatile uint16_t sink = 0;
+    double start = now_ns();
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        sink ^= fn(&frames[(it % FRAMES) * IEEE802154_MAX_PSDU_LENGTH], length);
+    }
+    return (now_ns() - start) / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 10000000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            iterations = strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations == 0)
+    {
+        fprintf(stderr, "iterations need to be positive\n");
+        return 1;
+    }
+
+    if (verify())
+    {
+        return 1;
+    }
+
+    static uint8_t frames[FRAMES * IEEE802154_MAX_PSDU_LENGTH];
+    for (size_t idx = 0; idx < sizeof(frames); idx++)
+    {
+        frames[idx] = rng_next();
+    }
+
+    const struct {
+        const char *name;
+        fcs_fn_t fn;
+    } variants[] = {
+        { "bitwise", fcs_bitwise },
+        { "bytewise", esp_ieee802154_fcs_bytewise },
+        { "slice-by-8", esp_ieee802154_fcs },
+    };
+    const struct {
+        const char *name;
+        size_t length;                                    // Covered bytes, without the FCS
+    } sizes[] = {
+        { "Imm-ACK", 3 },
+        { "20 B payload", 9 + 20 },
+        { "max PSDU", IEEE802154_MAX_PSDU_LENGTH - IEEE802154_FCS_LENGTH },
+    };
+
+    printf("Identical results in all variants, %" PRIu32 " iterations per size\n", iterations);
+    printf("%-12s %-14s %10s %12s %10s\n", "variant", "frame", "ns/frame", "Mframes/s", "MB/s");
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+    {
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            double ns = bench(variants[v].fn, frames, sizes[s].length, iterations);
+            printf("%-12s %-14s %10.1f %12.1f %10.1f\n", variants[v].name, sizes[s].name, ns, 1e3 / ns,
+                   sizes[s].length * 1e3 / ns);
+        }
+    }
+    return 0;
+}
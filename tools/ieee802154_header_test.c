@@ -0,0 +1,235 @@
+/**
+ * Host test of the data header builders.
+ *
+ * Compares esp_ieee802154_create_2003_data_header() and esp_ieee802154_create_2015_data_header() byte by byte
+ * with the previous implementation (the bitfield FCF and memcpy based builders, kept below as the reference).
+ * Every combination of frame version, sequence number suppression, pan id compression, destination and source
+ * addressing mode (including the reserved mode) and ACK request is checked with a set of pan ids, short and
+ * long addresses and sequence numbers. Returns 0 if all headers are identical.
+ *
+ * The reference stores a long address as 8 bytes in reversed order, the builders take it as a native
+ * uint64_t. Both are filled from the same value, so both need to produce the same bytes on air.
+ *
+ * Build (host, little endian):
+ *   gcc -O2 -I components/ieee802154_util/include tools/ieee802154_header_test.c components/ieee802154_util/ieee802154_header.c -o ieee802154_header_test
+ *
+ * Usage:
+ *   ieee802154_header_test
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "ieee802154_util.h"
+
+/* --- Reference: previous implementation --- */
+
+typedef struct {
+    uint8_t mode;
+    union {
+        uint16_t short_address;
+        uint8_t long_address[8]; // Needs to be in reversed byte order
+    };
+} reference_address_t;
+
+static void reverse_memcpy(uint8_t *restrict dst, const uint8_t *restrict src, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+    {
+        dst[n - 1 - i] = src[i];
+    }
+}
+
+static uint8_t reference_data_header(uint8_t version, uint16_t *dst_pan_id, reference_address_t *dst_addr, uint16_t *src_pan_id,
+                                     reference_address_t *src_addr, uint8_t *seq_nr, bool ack, uint8_t *header)
+{
+    bool sns = false;
+    if (version == FRAME_VERSION_STD_2015 && seq_nr == NULL)
+    {
+        sns = true;
+    }
+
+    bool pic = true;
+    if (*dst_pan_id != *src_pan_id)
+    {
+        pic = false;
+    }
+
+    ieee802154_fcf_t frame_control_field = {
+        .frame_type = FRAME_TYPE_DATA,
+        .secure = false,
+        .frame_pending = false,
+        .ack_request = ack,
+        .pan_id_compression = pic,
+        .reserved = false,
+        .sequence_number_suppression = sns,
+        .information_elements_present = false,
+        .dst_addr_mode = dst_addr->mode,
+        .frame_ver = version,
+        .src_addr_mode = src_addr->mode};
+
+    uint8_t position = 0; // The position in the header
+    memcpy(&header[position], &frame_control_field, sizeof(frame_control_field));
+    position = 2;
+
+    if (sns == false)
+    {
+        memcpy(&header[position], seq_nr, sizeof(uint8_t));
+        position += 1; // 3
+    }
+
+    memcpy(&header[position], dst_pan_id, sizeof(uint16_t));
+    position += 2; // 5
+
+    if (frame_control_field.dst_addr_mode == ADDR_MODE_SHORT)
+    {
+        memcpy(&header[position], &dst_addr->short_address, sizeof(dst_addr->short_address));
+        position += 2; // 7
+    }
+    else if (frame_control_field.dst_addr_mode == ADDR_MODE_LONG)
+    {
+        reverse_memcpy(&header[position], (uint8_t *)&dst_addr->long_address, sizeof(dst_addr->long_address));
+        position += 8;
+    }
+
+    if (pic == false)
+    {
+        memcpy(&header[position], src_pan_id, sizeof(uint16_t));
+        position += 2; // 9
+    }
+
+    if (frame_control_field.src_addr_mode == ADDR_MODE_SHORT)
+    {
+        memcpy(&header[position], &src_addr->short_address, sizeof(src_addr->short_address));
+        position += 2; // 9/11
+    }
+    else if (frame_control_field.src_addr_mode == ADDR_MODE_LONG)
+    {
+        memcpy(&header[position], (uint8_t *)&src_addr->long_address, sizeof(src_addr->long_address));
+        position += 8;
+    }
+
+    return position; // Length of the header
+}
+
+/* --- Address conversion --- */
+
+/* The destination is stored reversed (reverse_memcpy on write), the source as it goes on air (plain memcpy) */
+static void reference_address(uint8_t mode, uint16_t short_address, uint64_t long_address, bool source, reference_address_t *ref,
+                              ieee802154_address_t *addr)
+{
+    uint8_t air[8];
+    esp_ieee802154_ext_address_write(long_address, air);
+
+    memset(ref, 0, sizeof(reference_address_t));
+    memset(addr, 0, sizeof(ieee802154_address_t));
+    ref->mode = mode;
+    addr->mode = mode;
+    if (mode == ADDR_MODE_LONG)
+    {
+        if (source)
+        {
+            memcpy(ref->long_address, air, sizeof(air));
+        }
+        else
+        {
+            reverse_memcpy(ref->long_address, air, sizeof(air));
+        }
+        addr->long_address = long_address;
+    }
+    else
+    {
+        ref->short_address = short_address;
+        addr->short_address = short_address;
+    }
+}
+
+/* --- Test --- */
+
+static void print_header(const char *name, const uint8_t *header, uint8_t length)
+{
+    printf("  %-9s", name);
+    for (uint8_t idx = 0; idx < length; idx++)
+    {
+        printf(" %02x", header[idx]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    const uint16_t pan_ids[][2] = { { 0x1234, 0x1234 }, { 0x1234, 0xabcd }, { 0xffff, 0x0000 } };
+    const uint16_t short_addresses[] = { 0x0000, 0x00ff, 0xbeef, 0xffff };
+    const uint64_t long_addresses[] = { 0x0000000000000000ULL, 0x0123456789abcdefULL, 0xf0e1d2c3b4a59687ULL, 0xffffffffffffffffULL };
+    const uint8_t seq_nrs[] = { 0x00, 0x5a, 0xff };
+
+    if (argc > 1)
+    {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t checked = 0;
+    uint32_t mismatches = 0;
+
+    for (uint8_t version = FRAME_VERSION_STD_2003; version <= FRAME_VERSION_STD_2015; version += 2)
+    {
+        for (int sns = 0; sns <= (version == FRAME_VERSION_STD_2015); sns++)
+        for (size_t pan = 0; pan < sizeof(pan_ids) / sizeof(pan_ids[0]); pan++)
+        for (uint8_t dst_mode = 0; dst_mode < 4; dst_mode++)
+        for (uint8_t src_mode = 0; src_mode < 4; src_mode++)
+        for (int ack = 0; ack <= 1; ack++)
+        for (size_t addr = 0; addr < 4; addr++)
+        for (size_t seq = 0; seq < sizeof(seq_nrs) / sizeof(seq_nrs[0]); seq++)
+        {
+            reference_address_t ref_dst, ref_src;
+            ieee802154_address_t dst, src;
+            reference_address(dst_mode, short_addresses[addr], long_addresses[addr], false, &ref_dst, &dst);
+            reference_address(src_mode, short_addresses[3 - addr], long_addresses[3 - addr], true, &ref_src, &src);
+
+            uint16_t dst_pan_id = pan_ids[pan][0];
+            uint16_t src_pan_id = pan_ids[pan][1];
+            uint8_t ref_seq_nr = seq_nrs[seq];
+            uint8_t seq_nr = seq_nrs[seq];
+
+            uint8_t expected[32];
+            uint8_t actual[32];
+            memset(expected, 0xa5, sizeof(expected));
+            memset(actual, 0xa5, sizeof(actual));
+
+            uint8_t expected_length = reference_data_header(version, &dst_pan_id, &ref_dst, &src_pan_id, &ref_src,
+                                                            sns ? NULL : &ref_seq_nr, ack, expected);
+            uint8_t actual_length;
+            if (version == FRAME_VERSION_STD_2003)
+            {
+                actual_length = esp_ieee802154_create_2003_data_header(&dst_pan_id, &dst, &src_pan_id, &src, &seq_nr, ack, actual);
+            }
+            else
+            {
+                actual_length = esp_ieee802154_create_2015_data_header(&dst_pan_id, &dst, &src_pan_id, &src,
+                                                                       sns ? NULL : &seq_nr, ack, actual);
+            }
+
+            checked++;
+            // The whole buffer is compared, so bytes written past the header are found as well
+            if (expected_length != actual_length || memcmp(expected, actual, sizeof(expected)) != 0)
+            {
+                if (mismatches++ < 10)
+                {
+                    printf("Mismatch: version %u sns %d pan %04x/%04x dst mode %u src mode %u ack %d\n", version, sns,
+                           dst_pan_id, src_pan_id, dst_mode, src_mode, ack);
+                    print_header("expected", expected, expected_length);
+                    print_header("actual", actual, actual_length);
+                }
+            }
+        }
+    }
+
+    printf("%" PRIu32 " headers checked, %" PRIu32 " mismatches\n", checked, mismatches);
+    return mismatches != 0;
+}
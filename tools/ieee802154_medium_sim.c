@@ -0,0 +1,1082 @@
+/**
+ * Discrete-event simulation of many nodes on a shared 2.4 GHz medium.
+ *
+ * Every node has a model of the radio, and the receive, transmit done and transmit failed events of its radio
+ * are handed to the application of the node, one node after the other. The application section below is
+ * written like the sender and receiver apps: the senders queue frames to the receiver with Poisson arrivals,
+ * send them with CCA and retry them on a missing ACK, the receiver counts them per source.
+ *
+ * One sender, the device, runs the component code instead of the model application, on the FreeRTOS,
+ * esp_timer and radio shims of tools/host: its frames go through the TX engine (ieee802154_tx.c, with the TX
+ * power control and the per-destination latency), and its radio events go to the driver callbacks and the
+ * receiver task of the sender app, compiled from ieee802154-tx/main/sender.c as they are. Its tasks and timers
+ * run in the virtual time of the simulation, the radio hooks of the shims hand its transmissions to the medium
+ * with the TX power the engine selected. The device sends the same traffic as the other senders, so the engine
+ * can be compared with the model in the same run.
+ *
+ * Not covered: the component keeps its state in globals, so only one node per process can run it. The sink and
+ * the other senders are models, the receiver app (ieee802154-rx/main/main.c) does not run. The app_main() of the
+ * sender app (NVS, console, channel search, transport and stream) does not run either, the traffic of the
+ * device comes from the simulation.
+ *
+ * The medium model:
+ * - Log-distance path loss with symmetric log-normal shadowing per link, nodes are placed at random on a square.
+ * - A receiver locks on the first frame above its sensitivity. Every other transmission that overlaps the
+ *   reception is interference; the frame is received with the packet error rate of O-QPSK DSSS at the lowest
+ *   SINR during the frame (IEEE 802.15.4 Annex E). Frames that start while the receiver is transmitting or
+ *   locked are not received, a node that starts to transmit loses its reception (half-duplex).
+ * - Unslotted CSMA-CA (macMinBe 3, macMaxBe 5, macMaxCsmaBackoffs 4) with energy detection CCA.
+ * - Receivers acknowledge unicast frames with ACK request after aTurnaroundTime, senders wait
+ *   macAckWaitDuration for the ACK. Like the driver, a transmission is a single attempt, retries are up to
+ *   the application.
+ * - The radio appends the FCS to every frame it sends (ieee802154_fcs.h). Frames lost to the packet error rate
+ *   arrive with a bit error and are dropped by the FCS check of the receiver.
+ *
+ * The simulation is deterministic for a seed and runs much faster than real time, so the delivery ratio and
+ * throughput of a configuration can be compared between versions.
+ *
+ * Build (host):
+ *   gcc -O2 -DESP_PLATFORM -I tools/host -I ieee802154-tx/main -I components/ieee802154_util/include tools/ieee802154_medium_sim.c ieee802154-tx/main/sender.c tools/host/host_idf.c tools/host/host_freertos.c tools/host/host_radio.c components/ieee802154_util/ieee802154_tx.c components/ieee802154_util/ieee802154_util.c components/ieee802154_util/ieee802154_parse.c components/ieee802154_util/ieee802154_header.c components/ieee802154_util/ieee802154_ack_payload.c components/ieee802154_util/ieee802154_metrics.c components/ieee802154_util/ieee802154_addr_book.c components/ieee802154_util/ieee802154_power.c components/ieee802154_util/ieee802154_ack_policy.c components/ieee802154_util/ieee802154_channel.c components/ieee802154_util/ieee802154_survey.c components/ieee802154_util/ieee802154_tx_latency.c components/ieee802154_util/ieee802154_histogram.c components/ieee802154_util/ieee802154_fcs.c components/ieee802154_util/ieee802154_mesh.c components/ieee802154_util/ieee802154_transport.c components/ieee802154_util/ieee802154_window.c components/ieee802154_util/ieee802154_rx_timing.c -lm -o ieee802154_medium_sim
+ *
+ * Usage:
+ *   ieee802154_medium_sim [-n nodes] [-t seconds] [-r frames_per_s] [-l payload_length] [-a area_m]
+ *                         [-e path_loss_exponent] [-w shadowing_db] [-p tx_power_dbm] [-x extra_loss_percent] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include "esp_timer.h"
+#include "host_idf.h"
+#include "ieee802154_util.h"
+#include "ieee802154_histogram.h"
+#include "ieee802154_fcs.h"
+#include "ieee802154_tx.h"
+#include "ieee802154_power.h"
+#include "sender.h"
+
+#define US_PER_BYTE         32      // 250 kbit/s
+#define PHY_OVERHEAD        6       // Preamble, SFD and PHR
+#define IMM_ACK_LENGTH      5       // FCF, seq, FCS
+#define TURNAROUND_US       192     // aTurnaroundTime
+#define CCA_US              128     // 8 symbols
+#define BACKOFF_PERIOD_US   320     // aUnitBackoffPeriod
+#define MIN_BE              3       // macMinBe
+#define MAX_BE              5       // macMaxBe
+#define MAX_CSMA_BACKOFFS   4       // macMaxCsmaBackoffs
+#define MAC_ACK_WAIT_US     864     // macAckWaitDuration
+
+#define SENSITIVITY_DBM     -97.0
+#define NOISE_FLOOR_DBM     -100.0
+#define CCA_THRESHOLD_DBM   -75.0
+#define PATH_LOSS_1M_DB     40.2    // Free space at 1 m, 2.45 GHz
+
+/* --- Simulation state --- */
+
+#define MAC_IDLE      0
+#define MAC_CSMA      1   // Backoff and CCA
+#define MAC_TX        2   // Turnaround and transmission of the data frame
+#define MAC_WAIT_ACK  3
+
+#define EV_APP_TIMER    0
+#define EV_CCA          1
+#define EV_TX_START     2
+#define EV_TX_END       3
+#define EV_ACK_TIMEOUT  4
+#define EV_ACK_START    5
+
+#define APP_QUEUE_LENGTH 8  // As the TX engine queue of the apps
+#define APP_MAX_RETRIES  3  // macMaxFrameRetries
+#define APP_PAN_ID       0x0001
+#define APP_SINK_ADDRESS 0x0002
+#define APP_FIRST_SENDER 0x0100
+
+#define DEVICE_NODE         1   // The sender that runs the TX engine
+#define DEVICE_TX_PRIORITY  19  // As TX_ENGINE_PRIORITY of the sender app
+#define DEVICE_RX_PRIORITY  20  // As RECEIVER_PRIORITY of the sender app
+#define DEVICE_APP_PRIORITY 5
+
+typedef struct {
+    uint64_t time_us;
+    uint64_t order;     // Events at the same time run in the order they were scheduled
+    uint8_t type;
+    uint16_t node;
+    uint32_t arg;
+} sim_event_t;
+
+typedef struct {
+    double x, y;
+    uint16_t pan_id;
+    uint16_t short_address;
+
+    /* Radio */
+    uint8_t mac_state;
+    uint8_t data_frame[128];    // Copy of the frame given to the radio
+    const uint8_t *tx_frame;    // The frame as given to esp_ieee802154_transmit() by the device
+    bool data_cca;
+    uint8_t backoffs;
+    uint8_t backoff_exponent;
+    uint32_t tx_generation;     // Invalidates the pending events of an aborted or finished data frame
+    bool transmitting;
+    uint8_t on_air[128];        // Data frame or ACK being transmitted
+    uint32_t on_air_id;
+    float on_air_gain;          // TX power of the frame on air relative to the configured power
+    double interference_mw;     // Sum of all transmissions at this node
+    int32_t rx_from;            // Node the receiver is locked on, -1 if none
+    uint32_t rx_id;
+    double rx_signal_mw;
+    double rx_worst_interference_mw;
+
+    /* Application */
+    uint64_t queue_us[APP_QUEUE_LENGTH]; // Enqueue times, the head is in flight
+    uint8_t queue_head;
+    uint8_t queue_count;
+    uint8_t attempts;
+    uint8_t seq;
+    uint32_t counter;
+    int32_t last_seq;           // At the receiver, per source: last sequence number, -1 if none
+    uint32_t received;
+} sim_node_t;
+
+typedef struct {
+    uint16_t nodes;
+    double seconds;
+    double rate;
+    uint8_t payload_length;
+    double area_m;
+    double path_loss_exponent;
+    double shadowing_db;
+    double tx_power_dbm;
+    double extra_loss;
+    uint64_t seed;
+} sim_config_t;
+
+typedef struct {
+    uint64_t offered;
+    uint64_t queue_full;
+    uint64_t attempts;
+    uint64_t acked;
+    uint64_t no_ack;
+    uint64_t cca_busy;
+    uint64_t aborted;
+    uint64_t dropped;           // After all retries
+    uint64_t delivered;         // At the sink, without duplicates
+    uint64_t duplicates;
+    uint64_t receptions;        // Frames a receiver locked on (all, also frames to other nodes)
+    uint64_t lost_collision;
+    uint64_t lost_noise;
+    uint64_t missed_busy;       // Frames to a node that was transmitting
+    uint64_t missed_locked;     // Frames to a node that was receiving another frame
+    uint64_t fcs_errors;        // Frames dropped by the FCS check of the receiver
+    ieee802154_histogram_t latency;
+} sim_stats_t;
+
+typedef struct {
+    uint64_t offered;
+    uint64_t queue_full;
+    uint64_t attempts;
+    uint64_t acked;
+    uint64_t no_ack;
+    uint64_t cca_busy;
+    uint64_t aborted;
+    uint64_t dropped;           // After all retries
+    int8_t power_min_dbm;       // TX power the engine selected
+    int8_t power_max_dbm;
+    ieee802154_histogram_t latency;
+} sim_device_stats_t;
+
+static sim_config_t config;
+static sim_stats_t stats;
+static sim_device_stats_t device_stats;
+static sim_node_t *nodes;
+static sim_node_t *device;
+static float *link_mw;          // Received power, link_mw[from * n + to]
+static sim_node_t *self;        // Node the model application runs for
+static uint64_t now_us = 0;
+
+static sim_event_t *events;
+static uint32_t event_count = 0;
+static uint32_t event_capacity = 0;
+static uint64_t event_order = 0;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static double rng_uniform(void)
+{
+    return (rng_next() + 0.5) / 4294967296.0;
+}
+
+static double rng_gaussian(void)
+{
+    return sqrt(-2.0 * log(rng_uniform())) * cos(2.0 * M_PI * rng_uniform()); // Box-Muller
+}
+
+static double dbm_to_mw(double dbm)
+{
+    return pow(10.0, dbm / 10.0);
+}
+
+static double mw_to_dbm(double mw)
+{
+    return 10.0 * log10(mw);
+}
+
+static uint16_t node_index(const sim_node_t *node)
+{
+    return (uint16_t)(node - nodes);
+}
+
+static uint32_t airtime_us(const uint8_t *frame)
+{
+    return (PHY_OVERHEAD + frame[0]) * US_PER_BYTE;
+}
+
+/* --- Event queue (binary heap) --- */
+
+static bool event_before(const sim_event_t *a, const sim_event_t *b)
+{
+    return (a->time_us != b->time_us) ? (a->time_us < b->time_us) : (a->order < b->order);
+}
+
+static void event_schedule(uint64_t time_us, uint8_t type, const sim_node_t *node, uint32_t arg)
+{
+    if (event_count == event_capacity)
+    {
+        event_capacity = (event_capacity > 0) ? event_capacity * 2 : 1024;
+        events = realloc(events, event_capacity * sizeof(sim_event_t));
+        if (events == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+
+    sim_event_t event = { .time_us = time_us, .order = event_order++, .type = type, .node = node_index(node), .arg = arg };
+    uint32_t pos = event_count++;
+    while (pos > 0 && event_before(&event, &events[(pos - 1) / 2]))
+    {
+        events[pos] = events[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    events[pos] = event;
+}
+
+static sim_event_t event_pop(void)
+{
+    sim_event_t first = events[0];
+    sim_event_t last = events[--event_count];
+    uint32_t pos = 0;
+    while (true)
+    {
+        uint32_t child = 2 * pos + 1;
+        if (child >= event_count)
+        {
+            break;
+        }
+        if (child + 1 < event_count && event_before(&events[child + 1], &events[child]))
+        {
+            child += 1;
+        }
+        if (!event_before(&events[child], &last))
+        {
+            break;
+        }
+        events[pos] = events[child];
+        pos = child;
+    }
+    events[pos] = last;
+    return first;
+}
+
+/* --- Medium --- */
+
+/* Packet error rate of O-QPSK DSSS at 2.4 GHz, IEEE 802.15.4 Annex E */
+static double packet_error_rate(double sinr, uint8_t length)
+{
+    static double binomial[17];
+    if (binomial[0] == 0)
+    {
+        binomial[0] = 1;
+        for (int k = 1; k <= 16; k++)
+        {
+            binomial[k] = binomial[k - 1] * (16 - k + 1) / k;
+        }
+    }
+
+    double sum = 0;
+    for (int k = 2; k <= 16; k++)
+    {
+        sum += ((k % 2 == 0) ? 1 : -1) * binomial[k] * exp(20.0 * sinr * (1.0 / k - 1.0));
+    }
+    double ber = (8.0 / 15.0) * (1.0 / 16.0) * sum;
+    ber = (ber < 0) ? 0 : (ber > 0.5 ? 0.5 : ber);
+    return 1.0 - pow(1.0 - ber, 8.0 * (PHY_OVERHEAD + length));
+}
+
+static void medium_deliver(sim_node_t *receiver, const sim_node_t *sender, const ieee802154_frame_t *parsed, bool corrupted);
+
+/* Frame filter of the radio: ACKs the receiver waits for, data frames to its pan id and short address */
+static bool medium_accepts(const sim_node_t *receiver, const ieee802154_frame_t *parsed)
+{
+    if (parsed->frame_type == FRAME_TYPE_ACK)
+    {
+        return receiver->mac_state == MAC_WAIT_ACK && parsed->sequence_number == receiver->data_frame[3];
+    }
+
+    bool to_pan = parsed->dst_pan_id == receiver->pan_id || parsed->dst_pan_id == 0xFFFF;
+    bool to_node = parsed->dst_addr.mode == ADDR_MODE_SHORT &&
+                   (parsed->dst_addr.short_address == receiver->short_address || parsed->dst_addr.short_address == 0xFFFF);
+    return to_pan && to_node;
+}
+
+static void medium_start(sim_node_t *sender)
+{
+    uint16_t from = node_index(sender);
+    double sensitivity_mw = dbm_to_mw(SENSITIVITY_DBM);
+    ieee802154_frame_t parsed;
+    bool valid = esp_ieee802154_parse_frame(&sender->on_air[1], sender->on_air[0], &parsed);
+
+    for (uint16_t to = 0; to < config.nodes; to++)
+    {
+        sim_node_t *receiver = &nodes[to];
+        if (to == from)
+        {
+            continue;
+        }
+
+        double power = link_mw[(size_t)from * config.nodes + to] * sender->on_air_gain;
+        receiver->interference_mw += power;
+        if (power >= sensitivity_mw && receiver->rx_from < 0 && !receiver->transmitting)
+        {
+            receiver->rx_from = from;
+            receiver->rx_id = sender->on_air_id;
+            receiver->rx_signal_mw = power;
+            receiver->rx_worst_interference_mw = receiver->interference_mw - power;
+            stats.receptions += 1;
+            continue;
+        }
+
+        if (receiver->rx_from >= 0)
+        {
+            double interference = receiver->interference_mw - receiver->rx_signal_mw;
+            receiver->rx_worst_interference_mw = fmax(receiver->rx_worst_interference_mw, interference);
+        }
+        if (power >= sensitivity_mw && valid && medium_accepts(receiver, &parsed))
+        {
+            stats.missed_busy += receiver->transmitting;
+            stats.missed_locked += !receiver->transmitting;
+        }
+    }
+}
+
+static void medium_end(sim_node_t *sender)
+{
+    uint16_t from = node_index(sender);
+    double noise_mw = dbm_to_mw(NOISE_FLOOR_DBM);
+    ieee802154_frame_t parsed;
+    bool valid = esp_ieee802154_parse_frame(&sender->on_air[1], sender->on_air[0], &parsed);
+
+    for (uint16_t to = 0; to < config.nodes; to++)
+    {
+        sim_node_t *receiver = &nodes[to];
+        if (to == from)
+        {
+            continue;
+        }
+
+        receiver->interference_mw -= link_mw[(size_t)from * config.nodes + to] * sender->on_air_gain;
+        if (receiver->interference_mw < 0)
+        {
+            receiver->interference_mw = 0; // Rounding
+        }
+        if (receiver->rx_from != from || receiver->rx_id != sender->on_air_id)
+        {
+            continue;
+        }
+
+        // Frames the radio filters out are not decoded, they only counted as interference
+        receiver->rx_from = -1;
+        if (!valid || !medium_accepts(receiver, &parsed))
+        {
+            continue;
+        }
+
+        double sinr = receiver->rx_signal_mw / (noise_mw + receiver->rx_worst_interference_mw);
+        bool lost = rng_uniform() < packet_error_rate(sinr, sender->on_air[0]);
+        if (lost)
+        {
+            // Lost to interference if the frame would have made it with the noise alone
+            double clean = receiver->rx_signal_mw / noise_mw;
+            bool collision = receiver->rx_worst_interference_mw > 0 && packet_error_rate(clean, sender->on_air[0]) < 0.5;
+            stats.lost_collision += collision;
+            stats.lost_noise += !collision;
+        }
+        if (!lost && rng_uniform() < config.extra_loss)
+        {
+            stats.lost_noise += 1;
+            continue;
+        }
+        medium_deliver(receiver, sender, &parsed, lost);
+    }
+}
+
+/* --- Radio model --- */
+
+static void app_receive_done(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info);
+static void app_transmit_done(void);
+static void app_transmit_failed(esp_ieee802154_tx_error_t error);
+
+/**
+ * The events of the device go to the driver callbacks of the sender app, the events of the other nodes to the
+ * model application. The sender app has no receive callback, the default of the driver hands the frame back.
+ */
+static void radio_receive_done(sim_node_t *node, uint8_t *frame, esp_ieee802154_frame_info_t *frame_info)
+{
+    if (node != device)
+    {
+        self = node;
+        app_receive_done(frame, frame_info);
+    }
+}
+
+static void radio_transmit_done(sim_node_t *node, const uint8_t *ack, esp_ieee802154_frame_info_t *ack_frame_info)
+{
+    node->mac_state = MAC_IDLE;
+    node->tx_generation += 1;
+    if (node == device)
+    {
+        esp_ieee802154_transmit_done(node->tx_frame, ack, ack_frame_info);
+        return;
+    }
+    self = node;
+    app_transmit_done();
+}
+
+static void radio_transmit_failed(sim_node_t *node, esp_ieee802154_tx_error_t error)
+{
+    node->mac_state = MAC_IDLE;
+    node->tx_generation += 1;
+    if (node == device)
+    {
+        esp_ieee802154_transmit_failed(node->tx_frame, error);
+        return;
+    }
+    self = node;
+    app_transmit_failed(error);
+}
+
+static void radio_start_transmission(sim_node_t *node, const uint8_t *frame)
+{
+    memcpy(node->on_air, frame, frame[0] + 1);
+    esp_ieee802154_fcs_append(node->on_air); // Generated by the radio
+    node->on_air_id += 1;
+    // The device sends with the power the TX engine set, relative to the nominal power
+    node->on_air_gain = (node == device) ? (float)dbm_to_mw(esp_ieee802154_get_txpower() - IEEE802154_POWER_NOMINAL_DBM) : 1.0f;
+    node->transmitting = true;
+    node->rx_from = -1; // Half-duplex, a reception in progress is lost
+    medium_start(node);
+    event_schedule(now_us + airtime_us(frame), EV_TX_END, node, 0);
+}
+
+static void radio_send_ack(sim_node_t *node, uint8_t seq)
+{
+    uint8_t ack[IMM_ACK_LENGTH + 1] = { IMM_ACK_LENGTH, FRAME_TYPE_ACK, 0x00, seq, 0x00, 0x00 };
+    if (!node->transmitting)
+    {
+        radio_start_transmission(node, ack);
+    }
+}
+
+static void radio_cca(sim_node_t *node)
+{
+    bool busy = node->transmitting || node->interference_mw >= dbm_to_mw(CCA_THRESHOLD_DBM);
+    if (!busy)
+    {
+        node->mac_state = MAC_TX;
+        event_schedule(now_us + TURNAROUND_US, EV_TX_START, node, node->tx_generation);
+        return;
+    }
+
+    node->backoffs += 1;
+    node->backoff_exponent = (node->backoff_exponent < MAX_BE) ? node->backoff_exponent + 1 : MAX_BE;
+    if (node->backoffs > MAX_CSMA_BACKOFFS)
+    {
+        radio_transmit_failed(node, ESP_IEEE802154_TX_ERR_CCA_BUSY);
+        return;
+    }
+    uint32_t backoff = (rng_next() % (1u << node->backoff_exponent)) * BACKOFF_PERIOD_US;
+    event_schedule(now_us + backoff + CCA_US, EV_CCA, node, node->tx_generation);
+}
+
+static bool radio_ack_requested(const uint8_t *frame)
+{
+    ieee802154_frame_t parsed;
+    return esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) && parsed.ack_request &&
+           parsed.dst_addr.mode != ADDR_MODE_NONE &&
+           !(parsed.dst_addr.mode == ADDR_MODE_SHORT && parsed.dst_addr.short_address == 0xFFFF);
+}
+
+static void radio_tx_end(sim_node_t *node)
+{
+    medium_end(node);
+    node->transmitting = false;
+    if ((node->on_air[1] & 0x07) == FRAME_TYPE_ACK || node->mac_state != MAC_TX)
+    {
+        return; // An ACK of the receiver side, or a frame the device aborted
+    }
+
+    if (radio_ack_requested(node->data_frame))
+    {
+        node->mac_state = MAC_WAIT_ACK;
+        event_schedule(now_us + MAC_ACK_WAIT_US, EV_ACK_TIMEOUT, node, node->tx_generation);
+        return;
+    }
+    radio_transmit_done(node, NULL, NULL);
+}
+
+/* FCS check of the radio, then the ACK or the receive callback */
+static void medium_deliver(sim_node_t *receiver, const sim_node_t *sender, const ieee802154_frame_t *parsed, bool corrupted)
+{
+    uint8_t frame[128];
+    uint8_t length = sender->on_air[0];
+    memcpy(frame, sender->on_air, length + 1);
+
+    // A frame lost to the packet error rate arrives with a bit error, the bit does not draw from the RNG so the
+    // results of a seed do not change
+    if (corrupted)
+    {
+        uint16_t bit = receiver->rx_id % (length * 8);
+        frame[1 + bit / 8] ^= 1 << (bit % 8);
+    }
+    if (!esp_ieee802154_fcs_valid(&frame[1], length))
+    {
+        stats.fcs_errors += 1;
+        return;
+    }
+
+    double signal_dbm = mw_to_dbm(receiver->rx_signal_mw);
+    double snr_db = signal_dbm - NOISE_FLOOR_DBM;
+    esp_ieee802154_frame_info_t info = {
+        .channel = 26,
+        .rssi = (int8_t)lround(signal_dbm),
+        .lqi = (uint8_t)fmin(255.0, fmax(0.0, snr_db * 255.0 / 30.0)),
+        .timestamp = now_us - airtime_us(frame) + PHY_OVERHEAD * US_PER_BYTE, // SFD
+    };
+    frame[length - 1] = (uint8_t)info.rssi; // rssi/lqi in place of the FCS, as the driver stores them
+    frame[length] = info.lqi;
+
+    if (parsed->frame_type == FRAME_TYPE_ACK)
+    {
+        radio_transmit_done(receiver, frame, &info);
+        return;
+    }
+
+    if (radio_ack_requested(frame))
+    {
+        event_schedule(now_us + TURNAROUND_US, EV_ACK_START, receiver, parsed->sequence_number);
+    }
+    radio_receive_done(receiver, frame, &info);
+}
+
+/* Transmission of a data frame, as esp_ieee802154_transmit(): events of the frame carry its generation */
+static esp_err_t radio_transmit(sim_node_t *node, const uint8_t *frame, bool cca)
+{
+    if (node->mac_state != MAC_IDLE)
+    {
+        return ESP_FAIL;
+    }
+
+    memcpy(node->data_frame, frame, frame[0] + 1);
+    node->data_cca = cca;
+    node->tx_generation += 1;
+    if (cca)
+    {
+        node->mac_state = MAC_CSMA;
+        node->backoffs = 0;
+        node->backoff_exponent = MIN_BE;
+        uint32_t backoff = (rng_next() % (1u << MIN_BE)) * BACKOFF_PERIOD_US;
+        event_schedule(now_us + backoff + CCA_US, EV_CCA, node, node->tx_generation);
+    }
+    else
+    {
+        node->mac_state = MAC_TX;
+        event_schedule(now_us + TURNAROUND_US, EV_TX_START, node, node->tx_generation);
+    }
+    return ESP_OK;
+}
+
+static void radio_event(const sim_event_t *event)
+{
+    sim_node_t *node = &nodes[event->node];
+    switch (event->type)
+    {
+    case EV_CCA:
+        if (event->arg == node->tx_generation)
+        {
+            radio_cca(node);
+        }
+        break;
+    case EV_TX_START:
+        if (event->arg != node->tx_generation)
+        {
+            break;
+        }
+        if (node->transmitting)
+        {
+            radio_transmit_failed(node, ESP_IEEE802154_TX_ERR_ABORT); // An ACK of the receiver side is on the air
+        }
+        else
+        {
+            radio_start_transmission(node, node->data_frame);
+        }
+        break;
+    case EV_ACK_START:
+        radio_send_ack(node, (uint8_t)event->arg);
+        break;
+    case EV_TX_END:
+        radio_tx_end(node);
+        break;
+    case EV_ACK_TIMEOUT:
+        if (node->mac_state == MAC_WAIT_ACK && event->arg == node->tx_generation)
+        {
+            radio_transmit_failed(node, ESP_IEEE802154_TX_ERR_NO_ACK);
+        }
+        break;
+    }
+}
+
+/* --- Radio hooks of the device --- */
+
+/* Called from the TX engine task, in the virtual time of the shims */
+static esp_err_t device_transmit(void *ctx, const uint8_t *frame, bool cca)
+{
+    now_us = esp_timer_get_time();
+    device->tx_frame = frame;
+    return radio_transmit(device, frame, cca);
+}
+
+/* The radio back to receive, e.g. after the engine timeout: a frame in CSMA or waiting for its ACK is dropped without event */
+static void device_receive(void *ctx)
+{
+    now_us = esp_timer_get_time();
+    if (device->mac_state != MAC_IDLE)
+    {
+        device->mac_state = MAC_IDLE;
+        device->tx_generation += 1;
+    }
+}
+
+/* --- Application (sender and receiver) --- */
+
+static uint64_t app_interval_us(void)
+{
+    return (uint64_t)(-log(rng_uniform()) * 1e6 / config.rate); // Poisson arrivals
+}
+
+/* Data frame to the sink with ACK request, the payload starts with the counter of the sender */
+static void app_create_frame(uint8_t *frame, uint16_t pan_id, uint16_t src, uint8_t seq, uint32_t counter)
+{
+    uint8_t header[] = {
+        0x61, 0x88,                                  // Data, ACK request, pan id compression, short addresses, 2003
+        seq,
+        (uint8_t)pan_id, (uint8_t)(pan_id >> 8),
+        (uint8_t)APP_SINK_ADDRESS, (uint8_t)(APP_SINK_ADDRESS >> 8),
+        (uint8_t)src, (uint8_t)(src >> 8),
+    };
+
+    memcpy(&frame[1], header, sizeof(header));
+    memset(&frame[1 + sizeof(header)], (uint8_t)counter, config.payload_length);
+    memcpy(&frame[1 + sizeof(header)], &counter, sizeof(counter));
+    frame[0] = sizeof(header) + config.payload_length + 2; // FCS
+}
+
+static void app_send_head(void)
+{
+    uint8_t frame[128];
+    app_create_frame(frame, self->pan_id, self->short_address, self->seq, self->counter);
+
+    stats.attempts += 1;
+    if (radio_transmit(self, frame, true) != ESP_OK)
+    {
+        stats.aborted += 1;
+    }
+}
+
+static void app_next(bool delivered)
+{
+    if (delivered)
+    {
+        esp_ieee802154_histogram_add(&stats.latency, (uint32_t)(now_us - self->queue_us[self->queue_head]));
+    }
+    self->queue_head = (self->queue_head + 1) % APP_QUEUE_LENGTH;
+    self->queue_count -= 1;
+    self->attempts = 0;
+    self->seq += 1;
+    self->counter += 1;
+    if (self->queue_count > 0)
+    {
+        app_send_head();
+    }
+}
+
+static void app_timer(sim_node_t *node)
+{
+    self = node;
+    event_schedule(now_us + app_interval_us(), EV_APP_TIMER, node, 0);
+    stats.offered += 1;
+    if (node->queue_count == APP_QUEUE_LENGTH)
+    {
+        stats.queue_full += 1;
+        return;
+    }
+
+    node->queue_us[(node->queue_head + node->queue_count) % APP_QUEUE_LENGTH] = now_us;
+    node->queue_count += 1;
+    if (node->queue_count == 1)
+    {
+        app_send_head();
+    }
+}
+
+static void app_receive_done(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info)
+{
+    ieee802154_frame_t parsed;
+    if (esp_ieee802154_parse_frame(&frame[1], frame[0], &parsed) && parsed.frame_type == FRAME_TYPE_DATA &&
+        parsed.src_addr.mode == ADDR_MODE_SHORT && parsed.src_addr.short_address >= APP_FIRST_SENDER &&
+        parsed.src_addr.short_address - APP_FIRST_SENDER + 1 < config.nodes)
+    {
+        sim_node_t *source = &nodes[parsed.src_addr.short_address - APP_FIRST_SENDER + 1];
+        if (source->last_seq == parsed.sequence_number)
+        {
+            stats.duplicates += 1; // The ACK was lost and the sender retried
+        }
+        else
+        {
+            source->last_seq = parsed.sequence_number;
+            source->received += 1;
+            stats.delivered += 1;
+        }
+    }
+}
+
+static void app_transmit_done(void)
+{
+    stats.acked += 1;
+    app_next(true);
+}
+
+static void app_transmit_failed(esp_ieee802154_tx_error_t error)
+{
+    stats.no_ack += (error == ESP_IEEE802154_TX_ERR_NO_ACK);
+    stats.cca_busy += (error == ESP_IEEE802154_TX_ERR_CCA_BUSY);
+    stats.aborted += (error == ESP_IEEE802154_TX_ERR_ABORT);
+
+    self->attempts += 1;
+    if (self->attempts > APP_MAX_RETRIES)
+    {
+        stats.dropped += 1;
+        app_next(false);
+        return;
+    }
+    app_send_head();
+}
+
+/* --- Device (TX engine) --- */
+
+static QueueHandle_t device_queue;      // Enqueue times, the frame in flight is taken out by the device task
+static esp_timer_handle_t device_timer;
+
+/* Poisson arrivals, as app_timer() */
+static void device_arrival(void *arg)
+{
+    int64_t enqueue_us = esp_timer_get_time();
+    esp_timer_start_once(device_timer, app_interval_us());
+    stats.offered += 1;
+    device_stats.offered += 1;
+    if (xQueueSend(device_queue, &enqueue_us, 0) != pdTRUE)
+    {
+        device_stats.queue_full += 1;
+    }
+}
+
+/* Sends the queued frames through the TX engine and retries them like the model senders */
+static void device_task(void *pvParameters)
+{
+    uint8_t frame[128];
+    uint8_t seq = (uint8_t)rng_next();
+    uint32_t counter = 0;
+    int64_t enqueue_us;
+
+    while (1)
+    {
+        xQueueReceive(device_queue, &enqueue_us, portMAX_DELAY);
+        app_create_frame(frame, esp_ieee802154_get_panid(), esp_ieee802154_get_short_address(), seq, counter);
+
+        bool acked = false;
+        for (uint8_t attempt = 0; attempt <= APP_MAX_RETRIES && !acked; attempt++)
+        {
+            ieee802154_tx_result_t result;
+            device_stats.attempts += 1;
+            acked = (esp_ieee802154_tx_engine_transmit(frame, true, &result, portMAX_DELAY) == ESP_OK);
+            device_stats.no_ack += (result.error == ESP_IEEE802154_TX_ERR_NO_ACK);
+            device_stats.cca_busy += (result.error == ESP_IEEE802154_TX_ERR_CCA_BUSY);
+            device_stats.aborted += (result.error == ESP_IEEE802154_TX_ERR_ABORT);
+            device_stats.power_min_dbm = (result.power_dbm < device_stats.power_min_dbm) ? result.power_dbm : device_stats.power_min_dbm;
+            device_stats.power_max_dbm = (result.power_dbm > device_stats.power_max_dbm) ? result.power_dbm : device_stats.power_max_dbm;
+        }
+
+        if (acked)
+        {
+            device_stats.acked += 1;
+            esp_ieee802154_histogram_add(&device_stats.latency, (uint32_t)(esp_timer_get_time() - enqueue_us));
+        }
+        else
+        {
+            device_stats.dropped += 1;
+        }
+        seq += 1;
+        counter += 1;
+    }
+}
+
+static void device_setup(void)
+{
+    host_radio_hooks_t hooks = {
+        .transmit = device_transmit,
+        .receive = device_receive,
+    };
+    host_radio_set_hooks(&hooks);
+    esp_ieee802154_enable();
+    esp_ieee802154_set_panid(device->pan_id);
+    esp_ieee802154_set_short_address(device->short_address);
+    esp_ieee802154_set_txpower(IEEE802154_POWER_NOMINAL_DBM);
+
+    device_stats.power_min_dbm = INT8_MAX;
+    device_stats.power_max_dbm = INT8_MIN;
+    device_queue = xQueueCreate(APP_QUEUE_LENGTH - 1, sizeof(int64_t));
+    esp_timer_create_args_t timer_args = {
+        .callback = device_arrival,
+        .name = "device_arrival",
+    };
+    if (device_queue == NULL || esp_timer_create(&timer_args, &device_timer) != ESP_OK || sender_radio_init() != ESP_OK ||
+        esp_ieee802154_tx_engine_start(APP_QUEUE_LENGTH, DEVICE_TX_PRIORITY) != ESP_OK ||
+        sender_receiver_start(DEVICE_RX_PRIORITY) != ESP_OK ||
+        xTaskCreate(device_task, "device_task", 4096, NULL, DEVICE_APP_PRIORITY, NULL) != pdPASS)
+    {
+        fprintf(stderr, "Failed to start the device\n");
+        exit(1);
+    }
+    esp_timer_start_once(device_timer, app_interval_us());
+}
+
+/* --- Setup and report --- */
+
+static void sim_setup(void)
+{
+    nodes = calloc(config.nodes, sizeof(sim_node_t));
+    link_mw = calloc((size_t)config.nodes * config.nodes, sizeof(float));
+    if (nodes == NULL || link_mw == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    for (uint16_t idx = 0; idx < config.nodes; idx++)
+    {
+        sim_node_t *node = &nodes[idx];
+        node->x = (idx == 0) ? config.area_m / 2 : rng_uniform() * config.area_m; // The sink in the middle
+        node->y = (idx == 0) ? config.area_m / 2 : rng_uniform() * config.area_m;
+        node->pan_id = APP_PAN_ID;
+        node->short_address = (idx == 0) ? APP_SINK_ADDRESS : APP_FIRST_SENDER + idx - 1;
+        node->rx_from = -1;
+        node->last_seq = -1;
+        node->seq = (uint8_t)rng_next();
+    }
+
+    for (uint16_t from = 0; from < config.nodes; from++)
+    {
+        for (uint16_t to = from + 1; to < config.nodes; to++)
+        {
+            double distance = fmax(1.0, hypot(nodes[from].x - nodes[to].x, nodes[from].y - nodes[to].y));
+            double loss_db = PATH_LOSS_1M_DB + 10.0 * config.path_loss_exponent * log10(distance) + config.shadowing_db * rng_gaussian();
+            float power = (float)dbm_to_mw(config.tx_power_dbm - loss_db);
+            link_mw[(size_t)from * config.nodes + to] = power;
+            link_mw[(size_t)to * config.nodes + from] = power;
+        }
+    }
+
+    device = &nodes[DEVICE_NODE];
+    for (uint16_t idx = 1; idx < config.nodes; idx++)
+    {
+        if (&nodes[idx] != device)
+        {
+            event_schedule(app_interval_us(), EV_APP_TIMER, &nodes[idx], 0);
+        }
+    }
+    device_setup();
+}
+
+static void sim_report(double wall_s)
+{
+    double seconds = now_us / 1e6;
+    uint32_t out_of_range = 0;
+    for (uint16_t idx = 1; idx < config.nodes; idx++)
+    {
+        out_of_range += (link_mw[idx] < dbm_to_mw(SENSITIVITY_DBM)); // link_mw[0 * n + idx], from the sink
+    }
+
+    printf("%u nodes on %.0f m x %.0f m, %.2f frames/s per sender, %u byte payload, seed %" PRIu64 "\n",
+           config.nodes, config.area_m, config.area_m, config.rate, config.payload_length, config.seed);
+    printf("%.1f s simulated in %.2f s (%.0fx real time), %u senders out of range of the sink\n",
+           seconds, wall_s, (wall_s > 0) ? seconds / wall_s : 0, out_of_range);
+    printf("Offered %" PRIu64 ", delivered %" PRIu64 " (%.1f %%), duplicates %" PRIu64 ", throughput at the sink %.1f kbit/s\n",
+           stats.offered, stats.delivered, stats.offered > 0 ? 100.0 * stats.delivered / stats.offered : 0,
+           stats.duplicates, stats.delivered * config.payload_length * 8 / seconds / 1000);
+    printf("Model senders: %" PRIu64 " attempts, %" PRIu64 " acked, %" PRIu64 " no ACK, %" PRIu64 " CCA busy, %" PRIu64 " aborted, "
+           "%" PRIu64 " dropped after %d retries, %" PRIu64 " queue full\n",
+           stats.attempts, stats.acked, stats.no_ack, stats.cca_busy, stats.aborted, stats.dropped, APP_MAX_RETRIES, stats.queue_full);
+    printf("Medium: %" PRIu64 " receptions, %" PRIu64 " lost to collisions, %" PRIu64 " lost to noise, %" PRIu64 " missed while "
+           "transmitting, %" PRIu64 " missed while receiving, %" PRIu64 " FCS errors\n",
+           stats.receptions, stats.lost_collision, stats.lost_noise, stats.missed_busy, stats.missed_locked, stats.fcs_errors);
+    printf("Device (TX engine): offered %" PRIu64 ", delivered %" PRIu64 ", %" PRIu64 " attempts, %" PRIu64 " acked, %" PRIu64 " no ACK, "
+           "%" PRIu64 " CCA busy, %" PRIu64 " aborted, %" PRIu64 " dropped, %" PRIu64 " queue full, TX power %d to %d dBm\n",
+           device_stats.offered, (uint64_t)device->received, device_stats.attempts, device_stats.acked, device_stats.no_ack,
+           device_stats.cca_busy, device_stats.aborted, device_stats.dropped, device_stats.queue_full,
+           device_stats.attempts > 0 ? device_stats.power_min_dbm : IEEE802154_POWER_NOMINAL_DBM,
+           device_stats.attempts > 0 ? device_stats.power_max_dbm : IEEE802154_POWER_NOMINAL_DBM);
+    printf("Latency from enqueue to ACK, model senders:\n");
+    esp_ieee802154_histogram_print(&stats.latency, "  ", "us");
+    printf("Latency from enqueue to ACK, device:\n");
+    esp_ieee802154_histogram_print(&device_stats.latency, "  ", "us");
+}
+
+int main(int argc, char **argv)
+{
+    config = (sim_config_t){
+        .nodes = 100,
+        .seconds = 60,
+        .rate = 1.0,
+        .payload_length = 20,
+        .area_m = 60,
+        .path_loss_exponent = 3.0,
+        .shadowing_db = 4.0,
+        .tx_power_dbm = 0,
+        .extra_loss = 0,
+        .seed = 1,
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            config.nodes = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            config.seconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            config.rate = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+        {
+            config.payload_length = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc)
+        {
+            config.area_m = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            config.path_loss_exponent = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+        {
+            config.shadowing_db = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            config.tx_power_dbm = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+        {
+            config.extra_loss = atof(argv[++i]) / 100.0;
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            config.seed = strtoull(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n nodes] [-t seconds] [-r frames_per_s] [-l payload_length] [-a area_m] [-e path_loss_exponent]"
+                            " [-w shadowing_db] [-p tx_power_dbm] [-x extra_loss_percent] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Header (9), payload and FCS fit into the PSDU, the payload holds the 4 byte counter
+    if (config.nodes < 2 || config.rate <= 0 || config.payload_length < 4 || config.payload_length > IEEE802154_MAX_PSDU_LENGTH - 11)
+    {
+        fprintf(stderr, "Needs at least 2 nodes, a positive rate and a payload of 4 to %d bytes\n", IEEE802154_MAX_PSDU_LENGTH - 11);
+        return 1;
+    }
+
+    rng_state ^= config.seed * 0xD1B54A32D192ED03ULL;
+    sim_setup();
+
+    clock_t start = clock();
+    uint64_t end_us = (uint64_t)(config.seconds * 1e6);
+    while (true)
+    {
+        // The tasks and timers of the device run first, up to the next event of the medium
+        int64_t host_next = host_next_event_us();
+        uint64_t sim_next = (event_count > 0) ? events[0].time_us : UINT64_MAX;
+        if (host_next != INT64_MAX && (uint64_t)host_next <= sim_next && (uint64_t)host_next <= end_us)
+        {
+            host_run(host_next);
+            continue;
+        }
+        if (sim_next > end_us)
+        {
+            break;
+        }
+
+        host_run(sim_next);
+        sim_event_t event = event_pop();
+        now_us = event.time_us;
+        if (event.type == EV_APP_TIMER)
+        {
+            app_timer(&nodes[event.node]);
+        }
+        else
+        {
+            radio_event(&event);
+        }
+    }
+    host_run(end_us);
+    now_us = end_us;
+
+    sim_report((double)(clock() - start) / CLOCKS_PER_SEC);
+    free(events);
+    free(nodes);
+    free(link_mw);
+    return 0;
+}
@@ -0,0 +1,460 @@
+/**
+ * Host benchmark of the rich packet printer.
+ *
+ * Compares the previous printer, which formatted every field and every hexdump byte with printf and wrote one
+ * log line per field, with esp_ieee802154_render_packet(), which renders the whole frame into one buffer. The
+ * log calls of the previous printer are modelled by formatting the ESP_LOGx prefix and message into a sink
+ * (the log lock and the UART are not included, so the gain on the target is larger). Both outputs are
+ * compared byte for byte before the timing.
+ *
+ * Build (host):
+ *   gcc -O2 -I components/ieee802154_util/include tools/ieee802154_print_bench.c components/ieee802154_util/ieee802154_print.c -o ieee802154_print_bench
+ *
+ * Usage:
+ *   ieee802154_print_bench [-n iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "ieee802154_util.h"
+
+#define TIMESTAMP 123456 // Milliseconds in the line prefix
+
+static char sink[IEEE802154_PRINT_BUFFER_SIZE];
+static size_t sink_length;
+
+/* Model of ESP_LOGx: the prefix and the message are formatted separately, then the line is written */
+static void log_line(const char *level, const char *format, ...)
+{
+    va_list args;
+    sink_length += snprintf(&sink[sink_length], sizeof(sink) - sink_length, "%s (%u) %s: ", level, TIMESTAMP, "ieee802154_util");
+    va_start(args, format);
+    sink_length += vsnprintf(&sink[sink_length], sizeof(sink) - sink_length, format, args);
+    va_end(args);
+    sink_length += snprintf(&sink[sink_length], sizeof(sink) - sink_length, "\n");
+}
+
+#define LOG_LINE(level, format, ...) log_line(level, format, ##__VA_ARGS__)
+
+/* --- Baseline: one log call per field, sprintf per hexdump byte --- */
+
+
+static char *baseline_frame_version_to_string(uint8_t frame_version)
+{
+    switch (frame_version)
+    {
+    case FRAME_VERSION_STD_2003:
+        return "2003";
+    case FRAME_VERSION_STD_2006:
+        return "2006";
+    case FRAME_VERSION_STD_2015:
+        return "2015";
+    default:
+        return "Invalid";
+    }
+}
+
+static char *baseline_addr_mode_to_string(uint8_t addr_mode)
+{
+    switch (addr_mode)
+    {
+    case ADDR_MODE_NONE:
+        return "None";
+    case ADDR_MODE_RESERVED:
+        return "Reserved";
+    case ADDR_MODE_SHORT:
+        return "Short";
+    case ADDR_MODE_LONG:
+        return "Long";
+    default:
+        return "Invalid"; // Should never happen
+    }
+}
+
+static char *baseline_frame_type_to_string(ieee802154_fcf_t *fcf)
+{
+    switch (fcf->frame_type)
+    {
+    case FRAME_TYPE_BEACON:
+        return "Beacon";
+    case FRAME_TYPE_DATA:
+        return "Data";
+    case FRAME_TYPE_ACK:
+        if (fcf->frame_ver == FRAME_VERSION_STD_2015)
+        {
+            return "Enh-ACK";
+        }
+        return "Imm-ACK";
+    case FRAME_TYPE_MAC_COMMAND:
+        return "MAC CMD";
+    case FRAME_TYPE_RESERVED:
+        return "Reserved";
+    case FRAME_TYPE_MULTIPURPOSE:
+        return "Multipurpose (2015)";
+    case FRAME_TYPE_FRAGMENT:
+        return "Fragment (2015)";
+    case FRAME_TYPE_EXTENDED:
+        return "Extended (2015)";
+    default:
+        return "Invalid"; // Should never happen
+    }
+}
+
+#define BYTES_PER_LINE 12
+
+static void baseline_data_hexdump(uint8_t *buffer, uint8_t buff_len)
+{
+    uint8_t line = 0;
+    uint8_t offset = 0;
+    uint8_t bytesRead;
+    char hexPart[BYTES_PER_LINE * 3 + 1];
+    char asciiPart[BYTES_PER_LINE + 1];
+
+    while (offset < buff_len)
+    {
+        bytesRead = buff_len - offset < BYTES_PER_LINE ? buff_len - offset : BYTES_PER_LINE;
+
+        for (uint8_t i = 0; i < BYTES_PER_LINE; i++)
+        {
+            if (i < bytesRead)
+            {
+                sprintf(&hexPart[i * 3], "%02x ", buffer[offset + i]);
+                asciiPart[i] = (buffer[offset + i] >= 32 && buffer[offset + i] <= 126) ? buffer[offset + i] : '.';
+            }
+            else
+            {
+                sprintf(&hexPart[i * 3], "   ");
+                asciiPart[i] = '\0';
+            }
+        }
+        hexPart[BYTES_PER_LINE * 3] = '\0';
+        asciiPart[BYTES_PER_LINE] = '\0';
+
+        if (line == 0)
+        {
+            LOG_LINE("I", "Data dump: %s|%s|", hexPart, asciiPart);
+        }
+        else
+        {
+            LOG_LINE("I", "           %s|%s|", hexPart, asciiPart);
+        }
+        line += 1;
+        offset += bytesRead;
+    }
+}
+
+static void baseline_print_address_information(uint8_t *packet, uint8_t *position)
+{
+    ieee802154_fcf_t *fcf = (ieee802154_fcf_t *)&packet[1];
+    uint16_t dst_pan_id = 0;
+    uint16_t src_pan_id = 0;
+    uint8_t dst_addr[8] = {0};
+    uint8_t src_addr[8] = {0};
+    uint16_t short_dst_addr = 0;
+    uint16_t short_src_addr = 0;
+
+    if (fcf->dst_addr_mode == ADDR_MODE_SHORT || fcf->dst_addr_mode == ADDR_MODE_LONG)
+    {
+        dst_pan_id = *((uint16_t *)&packet[*position]);
+        *position += 2;
+        LOG_LINE("I", "DST PAN: %02x:%02x", dst_pan_id >> 8, dst_pan_id & 0x00FF);
+    }
+
+    switch (fcf->dst_addr_mode)
+    {
+    case ADDR_MODE_SHORT:
+    {
+        short_dst_addr = *((uint16_t *)&packet[*position]);
+        *position += 2;
+        char broadcast_str[20] = "";
+        if (short_dst_addr == 0xFFFF)
+        {
+            if (dst_pan_id == 0xFFFF)
+            {
+                char *globalb = "(global Broadcast)";
+                memcpy(&broadcast_str, globalb, 19);
+            }
+            else
+            {
+                char *localb = "(local Broadcast)";
+                memcpy(&broadcast_str, localb, 18);
+            }
+        }
+        LOG_LINE("I", "DST ADDR: %02x:%02x %s", short_dst_addr >> 8, short_dst_addr & 0x00FF, broadcast_str);
+        break;
+    }
+    case ADDR_MODE_LONG:
+    {
+        for (uint8_t idx = 0; idx < sizeof(dst_addr); idx++)
+        {
+            dst_addr[idx] = packet[*position + sizeof(dst_addr) - 1 - idx];
+        }
+        *position += 8;
+        LOG_LINE("I", "DST ADDR: %02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x", dst_addr[0],
+                 dst_addr[1], dst_addr[2], dst_addr[3], dst_addr[4], dst_addr[5], dst_addr[6], dst_addr[7]);
+        break;
+    }
+    default:
+    {
+        // Typically not possible, because of hardware filtering
+        LOG_LINE("W", "No DST address information present");
+        return;
+    }
+    }
+
+    if (fcf->dst_addr_mode == ADDR_MODE_SHORT || fcf->dst_addr_mode == ADDR_MODE_LONG)
+    {
+        if (fcf->pan_id_compression)
+        {
+            // SRC PAN is the same as DST PAN -> intra PAN (same network)
+            LOG_LINE("I", "SRC PAN: %02x:%02x (intra PAN)", dst_pan_id >> 8, dst_pan_id & 0x00FF);
+        }
+        else
+        {
+            // SRC PAN is different from DST PAN -> inter PAN (across network)
+            src_pan_id = *((uint16_t *)&packet[*position]);
+            *position += 2;
+            LOG_LINE("I", "SRC PAN: %02x:%02x (inter PAN)", src_pan_id >> 8, src_pan_id & 0x00FF);
+        }
+    }
+
+    switch (fcf->src_addr_mode)
+    {
+    case ADDR_MODE_SHORT:
+    {
+        short_src_addr = *((uint16_t *)&packet[*position]);
+        *position += 2;
+        LOG_LINE("I", "SRC ADDR: %02x:%02x", short_src_addr >> 8, short_src_addr & 0x00FF);
+        break;
+    }
+    case ADDR_MODE_LONG:
+    {
+        for (uint8_t idx = 0; idx < sizeof(src_addr); idx++)
+        {
+            src_addr[idx] = packet[*position + sizeof(src_addr) - 1 - idx];
+        }
+        *position += 8;
+        LOG_LINE("I", "SRC ADDR: %02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x", src_addr[0], src_addr[1],
+                 src_addr[2], src_addr[3], src_addr[4], src_addr[5], src_addr[6], src_addr[7]);
+        break;
+    }
+    default:
+    {
+        LOG_LINE("W", "No SRC address information present.");
+        return;
+    }
+    }
+}
+
+static void baseline_print_packet(uint8_t *packet)
+{
+    uint8_t packet_length = packet[0];
+    uint8_t position = 1; // Exclude the length
+
+    ieee802154_fcf_t *fcf = (ieee802154_fcf_t *)&packet[position];
+    position += 2;
+
+    LOG_LINE("I", "---------------------------------------------------------------------");
+
+    LOG_LINE("I", "------ Frame Control Field ------");
+    LOG_LINE("I", "Frame type:                   %s", baseline_frame_type_to_string(fcf));
+    LOG_LINE("I", "Security Enabled:             %s", fcf->secure ? "True" : "False");
+    LOG_LINE("I", "Frame pending:                %s", fcf->frame_pending ? "True" : "False");
+    LOG_LINE("I", "Acknowledge request:          %s", fcf->ack_request ? "True" : "False");
+    LOG_LINE("I", "PAN ID Compression:           %s", fcf->pan_id_compression ? "True" : "False");
+    LOG_LINE("I", "Reserved:                     %s", fcf->reserved ? "True" : "False");
+    if (fcf->frame_ver == FRAME_VERSION_STD_2015)
+    {
+        LOG_LINE("I", "Sequence Number Suppression:  %s", fcf->sequence_number_suppression ? "True" : "False");
+        LOG_LINE("I", "Information Elements Present: %s", fcf->information_elements_present ? "True" : "False");
+    }
+    LOG_LINE("I", "Destination addressing mode:  %s", baseline_addr_mode_to_string(fcf->dst_addr_mode));
+    LOG_LINE("I", "Frame version:                %s", baseline_frame_version_to_string(fcf->frame_ver));
+    LOG_LINE("I", "Source addressing mode:       %s", baseline_addr_mode_to_string(fcf->src_addr_mode));
+
+    if (fcf->secure || fcf->information_elements_present)
+    {
+        LOG_LINE("E", "Security and Information Elements are currently not supported.");
+        LOG_LINE("I", "---------------------------------------------------------------------");
+        return;
+    }
+
+    if (fcf->reserved)
+    {
+        LOG_LINE("W", "Reserved bit is set...");
+    }
+    
+    LOG_LINE("I", "------ %s Packet ------", baseline_frame_type_to_string(fcf));
+
+    switch (fcf->frame_type)
+    {
+    case FRAME_TYPE_DATA:
+
+        if (fcf->sequence_number_suppression && fcf->frame_ver == FRAME_VERSION_STD_2015)
+        {
+            LOG_LINE("I", "Sequence number suppressed.");
+        }
+        else // FRAME_VERSION_STD_2003/2006 or sequence_number_suppression == false
+        {
+
+            uint8_t sequence_number = packet[position];
+            position += 1;
+            LOG_LINE("I", "Sequence number: %u", sequence_number);
+        }
+
+        baseline_print_address_information(packet, &position);
+
+        // The FCS is not stored in the receive buffer, the radio puts rssi/lqi in its place
+        uint8_t *data = &packet[position];
+        uint8_t data_length = packet_length - (position - 1) - sizeof(uint16_t);
+        position += data_length;
+
+        LOG_LINE("I", "Data length: %u", data_length);
+        baseline_data_hexdump(data, data_length);
+
+        break;
+    case FRAME_TYPE_ACK:
+        if (fcf->frame_ver == FRAME_VERSION_STD_2015)
+        {
+            if (fcf->sequence_number_suppression)
+            {
+                LOG_LINE("I", "Sequence number suppressed.");
+            }
+            else
+            {
+                uint8_t sequence_number = packet[position];
+                position += 1;
+                LOG_LINE("I", "Sequence number: %u", sequence_number);
+            }
+
+            baseline_print_address_information(packet, &position);
+
+            uint8_t *data = &packet[position];
+            uint8_t data_length = packet_length - (position - 1) - sizeof(uint16_t);
+            position += data_length;
+
+            if (data_length > 0)
+            {
+                LOG_LINE("I", "ACK contains data.");
+                LOG_LINE("I", "Data length: %u", data_length);
+                baseline_data_hexdump(data, data_length);
+            }
+            else
+            {
+                LOG_LINE("I", "ACK contains no data."); 
+            }
+        }
+        else
+        {
+            uint8_t sequence_number = packet[position];
+            position += 1;
+            LOG_LINE("I", "Sequence number: %u", sequence_number);
+        }
+        break;
+    default:
+        LOG_LINE("W", "Printing this packets is currently not supported.");
+        break;
+    }
+
+    // Doesnt work if the type is not supported
+    LOG_LINE("I", "----- Transmission Info -----");
+
+    // The radio stores rssi/lqi in place of the FCS
+    int8_t rssi = packet[position];
+    uint8_t lqi = packet[position + 1];
+    LOG_LINE("I", "RSSI: %d", rssi);
+    LOG_LINE("I", "LQI: %d", lqi);
+
+    LOG_LINE("I", "---------------------------------------------------------------------");
+}
+
+
+/* --- Benchmark --- */
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* 2015 data frame, intra PAN, short destination, long source, rssi/lqi in place of the FCS */
+static void build_frame(uint8_t *packet, uint8_t payload_length)
+{
+    uint8_t header[] = { 0x41, 0xe8, 0x2a, 0x34, 0x12, 0x02, 0x00, 0xd8, 0xef, 0x5c, 0xfe, 0xff, 0xca, 0x4c, 0x40 };
+    memcpy(&packet[1], header, sizeof(header));
+    for (uint8_t idx = 0; idx < payload_length; idx++)
+    {
+        packet[1 + sizeof(header) + idx] = 'A' + idx % 64;
+    }
+    packet[1 + sizeof(header) + payload_length] = (uint8_t)-67; // RSSI
+    packet[2 + sizeof(header) + payload_length] = 255;          // LQI
+    packet[0] = sizeof(header) + payload_length + 2;
+}
+
+static int bench(const char *name, uint8_t payload_length, uint32_t iterations)
+{
+    uint8_t packet[128];
+    static char buffer[IEEE802154_PRINT_BUFFER_SIZE];
+    build_frame(packet, payload_length);
+
+    sink_length = 0;
+    baseline_print_packet(packet);
+    size_t length = esp_ieee802154_render_packet(packet, TIMESTAMP, buffer, sizeof(buffer));
+    if (length != sink_length || memcmp(buffer, sink, length) != 0)
+    {
+        fprintf(stderr, "%s: output differs from the baseline\n--- baseline\n%s--- render\n%s", name, sink, buffer);
+        return 1;
+    }
+
+    double start = now_ns();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        sink_length = 0;
+        baseline_print_packet(packet);
+    }
+    double baseline = (now_ns() - start) / iterations;
+
+    start = now_ns();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        // The single log write is modelled by one copy into the sink
+        length = esp_ieee802154_render_packet(packet, TIMESTAMP, buffer, sizeof(buffer));
+        memcpy(sink, buffer, length);
+    }
+    double render = (now_ns() - start) / iterations;
+
+    printf("%-10s %8u %8zu %12.0f %12.0f %8.1fx\n", name, payload_length, length, baseline, render, baseline / render);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 100000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            iterations = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-10s %8s %8s %12s %12s %9s\n", "frame", "payload", "chars", "baseline ns", "render ns", "speedup");
+    if (bench("typical", 20, iterations) || bench("maximum", 127 - 15 - 2, iterations))
+    {
+        return 1;
+    }
+    return 0;
+}
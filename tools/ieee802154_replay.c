@@ -0,0 +1,472 @@
+/**
+ * Replay of a capture into the receive path.
+ *
+ * Reads a pcap file (link type 195 IEEE802_15_4_WITHFCS or 230 IEEE802_15_4_NOFCS) and replays its frames with
+ * the captured timing, divided by a speed factor (-x), or as fast as possible (-f). Frames are never closer
+ * than their airtime. Captured frames with an invalid FCS are skipped, like the radio drops them.
+ *
+ * Without --script, the frames are replayed on the host in virtual time against a mock of the receive path
+ * of the receiver app: esp_ieee802154_enh_ack_generator() for 2015 frames with ACK request, then
+ * esp_ieee802154_receive_done(), which queues the frame with its timestamp into an RX message buffer of
+ * -b bytes. The receiver task takes -s us per frame. The report shows how many frames the receive path
+ * sustained before the first drop.
+ *
+ * With --script, the tool writes the console commands that load the capture into the replay buffer of a
+ * board (see ieee802154_replay.h) and start the replay there, e.g.
+ *   ieee802154_replay --script -x 4 capture.pcap > /dev/ttyACM0
+ * and "replay stats" on the board prints the same report for the real receive path.
+ *
+ * Build (host):
+ *   gcc -O2 -I components/ieee802154_util/include tools/ieee802154_replay.c components/ieee802154_util/ieee802154_parse.c components/ieee802154_util/ieee802154_fcs.c -o ieee802154_replay
+ *
+ * Usage:
+ *   ieee802154_replay [-x speed | -f] [-p passes] [-b rx_buffer_bytes] [-s service_us] [--script [-B replay_buffer_bytes]] capture.pcap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ieee802154_util.h"
+#include "ieee802154_fcs.h"
+
+#define PCAP_MAGIC_USEC         0xa1b2c3d4
+#define PCAP_MAGIC_NSEC         0xa1b23c4d
+#define PCAP_GLOBAL_HEADER_LEN  24
+#define PCAP_RECORD_HEADER_LEN  16
+
+#define LINKTYPE_IEEE802_15_4_WITHFCS 195
+#define LINKTYPE_IEEE802_15_4_NOFCS   230
+
+#define US_PER_BYTE             32  // 250 kbit/s
+#define PHY_OVERHEAD            6   // Preamble, SFD and PHR
+#define RX_ENTRY_HEADER         8   // Timestamp in front of the frame, see ieee802154_rx_timing.h
+#define MESSAGE_HEADER          4   // Length of every message in a FreeRTOS message buffer
+#define RX_BUFFER_DEFAULT       (4 * (RX_ENTRY_HEADER + 128)) // RX_BUFFER_SIZE of the receiver app
+#define REPLAY_RECORD_HEADER    8   // Per frame in the replay buffer of the board
+#define REPLAY_BUFFER_DEFAULT   16384
+
+/* --- Capture --- */
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    bool swapped;
+    bool nsec;
+    bool with_fcs;
+} capture_t;
+
+typedef struct {
+    uint64_t time_us;           // Capture time
+    const uint8_t *psdu;        // Without FCS
+    uint8_t length;
+} capture_frame_t;
+
+static uint32_t read_u32(const capture_t *cap, const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return cap->swapped ? __builtin_bswap32(v) : v;
+}
+
+static int capture_open(const char *path, capture_t *cap)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < PCAP_GLOBAL_HEADER_LEN)
+    {
+        fprintf(stderr, "%s: not a pcap file\n", path);
+        close(fd);
+        return -1;
+    }
+
+    cap->size = st.st_size;
+    cap->data = mmap(NULL, cap->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (cap->data == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+
+    uint32_t magic;
+    memcpy(&magic, cap->data, sizeof(magic));
+    cap->swapped = (magic == __builtin_bswap32(PCAP_MAGIC_USEC) || magic == __builtin_bswap32(PCAP_MAGIC_NSEC));
+    magic = cap->swapped ? __builtin_bswap32(magic) : magic;
+    if (magic != PCAP_MAGIC_USEC && magic != PCAP_MAGIC_NSEC)
+    {
+        fprintf(stderr, "%s: unknown pcap magic 0x%08" PRIx32 "\n", path, magic);
+        return -1;
+    }
+    cap->nsec = (magic == PCAP_MAGIC_NSEC);
+
+    uint32_t linktype = read_u32(cap, &cap->data[20]);
+    if (linktype != LINKTYPE_IEEE802_15_4_WITHFCS && linktype != LINKTYPE_IEEE802_15_4_NOFCS)
+    {
+        fprintf(stderr, "%s: unsupported link type %" PRIu32 "\n", path, linktype);
+        return -1;
+    }
+    cap->with_fcs = (linktype == LINKTYPE_IEEE802_15_4_WITHFCS);
+    return 0;
+}
+
+/* Read all frames that fit into a PSDU and, if captured, have a valid FCS. Returns the number of frames */
+static uint32_t capture_read(const capture_t *cap, capture_frame_t **frames, uint32_t *skipped, uint32_t *fcs_errors)
+{
+    uint32_t count = 0;
+    uint32_t capacity = 1024;
+    *frames = malloc(capacity * sizeof(capture_frame_t));
+    *skipped = 0;
+    *fcs_errors = 0;
+
+    size_t offset = PCAP_GLOBAL_HEADER_LEN;
+    while (*frames != NULL && offset + PCAP_RECORD_HEADER_LEN <= cap->size)
+    {
+        const uint8_t *hdr = &cap->data[offset];
+        uint32_t incl_len = read_u32(cap, hdr + 8);
+        if (offset + PCAP_RECORD_HEADER_LEN + incl_len > cap->size)
+        {
+            break; // Truncated capture
+        }
+        offset += PCAP_RECORD_HEADER_LEN + incl_len;
+
+        uint32_t length = cap->with_fcs ? incl_len - 2 : incl_len;
+        if (incl_len < (cap->with_fcs ? 2u : 0u) + 3 || length > IEEE802154_MAX_PSDU_LENGTH - 2)
+        {
+            *skipped += 1;
+            continue;
+        }
+        if (cap->with_fcs && !esp_ieee802154_fcs_valid(hdr + PCAP_RECORD_HEADER_LEN, incl_len))
+        {
+            *fcs_errors += 1; // The radio drops these frames, they never reach the receive path
+            continue;
+        }
+
+        if (count == capacity)
+        {
+            capacity *= 2;
+            *frames = realloc(*frames, capacity * sizeof(capture_frame_t));
+            if (*frames == NULL)
+            {
+                break;
+            }
+        }
+        (*frames)[count].time_us = (uint64_t)read_u32(cap, hdr) * 1000000 + read_u32(cap, hdr + 4) / (cap->nsec ? 1000 : 1);
+        (*frames)[count].psdu = hdr + PCAP_RECORD_HEADER_LEN;
+        (*frames)[count].length = (uint8_t)length;
+        count += 1;
+    }
+
+    if (*frames == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    return count;
+}
+
+static bool frame_wants_enh_ack(const capture_frame_t *frame)
+{
+    ieee802154_frame_t parsed;
+    return esp_ieee802154_parse_frame(frame->psdu, frame->length + 2, &parsed) && parsed.ack_request &&
+           parsed.frame_version == FRAME_VERSION_STD_2015;
+}
+
+/* --- Mock receive path (receiver app) --- */
+
+typedef struct {
+    uint32_t capacity;          // Bytes of the RX message buffer
+    uint32_t service_us;        // Receiver task time per frame
+} rx_config_t;
+
+typedef struct {
+    uint64_t start_us;          // The receiver task takes the message out of the buffer
+    uint32_t bytes;
+} rx_message_t;
+
+typedef struct {
+    rx_message_t *messages;     // Ring of the messages in the buffer or in the receiver task
+    uint32_t ring_size;
+    uint32_t head;
+    uint32_t count;
+    uint32_t used;              // Bytes in the buffer
+    uint32_t max_used;
+    uint64_t task_free_us;      // End of the frame the receiver task is working on
+    uint64_t now_us;
+    uint64_t injected;
+    uint64_t enh_acks;
+    uint64_t dropped;
+    uint64_t first_drop;        // Frames injected before the first drop, UINT64_MAX if none
+} rx_path_t;
+
+typedef struct {
+    int8_t rssi;
+    uint8_t lqi;
+    uint64_t timestamp;
+} esp_ieee802154_frame_info_t;
+
+static rx_config_t rx_config;
+static rx_path_t rx_path;
+
+/* Messages leave the buffer when the receiver task takes them */
+static void rx_path_advance(uint64_t now_us)
+{
+    while (rx_path.count > 0 && rx_path.messages[rx_path.head].start_us <= now_us)
+    {
+        rx_path.used -= rx_path.messages[rx_path.head].bytes;
+        rx_path.head = (rx_path.head + 1) % rx_path.ring_size;
+        rx_path.count -= 1;
+    }
+    rx_path.now_us = now_us;
+}
+
+void esp_ieee802154_enh_ack_generator(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info, uint8_t *enhack_frame)
+{
+    rx_path.enh_acks += 1;
+}
+
+void esp_ieee802154_receive_done(uint8_t *frame, esp_ieee802154_frame_info_t *frame_info)
+{
+    uint32_t bytes = MESSAGE_HEADER + RX_ENTRY_HEADER + frame[0] + 1;
+    if (rx_path.used + bytes > rx_config.capacity || rx_path.count == rx_path.ring_size)
+    {
+        if (rx_path.first_drop == UINT64_MAX)
+        {
+            rx_path.first_drop = rx_path.injected;
+        }
+        rx_path.dropped += 1;
+        return;
+    }
+
+    uint64_t start = (rx_path.task_free_us > rx_path.now_us) ? rx_path.task_free_us : rx_path.now_us;
+    rx_path.task_free_us = start + rx_config.service_us;
+    rx_path.messages[(rx_path.head + rx_path.count) % rx_path.ring_size] = (rx_message_t){ .start_us = start, .bytes = bytes };
+    rx_path.count += 1;
+    rx_path.used += bytes;
+    rx_path.max_used = (rx_path.used > rx_path.max_used) ? rx_path.used : rx_path.max_used;
+}
+
+static void rx_path_inject(const capture_frame_t *frame, uint64_t now_us)
+{
+    uint8_t buffer[IEEE802154_MAX_PSDU_LENGTH + 1];
+    buffer[0] = frame->length + 2;
+    memcpy(&buffer[1], frame->psdu, frame->length);
+    buffer[frame->length + 1] = (uint8_t)-50; // rssi/lqi in place of the FCS
+    buffer[frame->length + 2] = 255;
+
+    esp_ieee802154_frame_info_t frame_info = { .rssi = -50, .lqi = 255, .timestamp = now_us };
+    rx_path_advance(now_us);
+    if (frame_wants_enh_ack(frame))
+    {
+        uint8_t ack[IEEE802154_MAX_PSDU_LENGTH + 1];
+        esp_ieee802154_enh_ack_generator(buffer, &frame_info, ack);
+    }
+    esp_ieee802154_receive_done(buffer, &frame_info);
+    rx_path.injected += 1;
+}
+
+/* --- Replay --- */
+
+static uint32_t airtime_us(const capture_frame_t *frame)
+{
+    return (PHY_OVERHEAD + frame->length + 2) * US_PER_BYTE;
+}
+
+/* Gap to the next frame: the captured gap divided by the speed (0: as fast as possible), at least the airtime */
+static uint64_t replay_gap(const capture_frame_t *frame, const capture_frame_t *next, uint32_t speed)
+{
+    uint64_t gap = 0;
+    if (speed > 0 && next->time_us > frame->time_us)
+    {
+        gap = (next->time_us - frame->time_us) / speed;
+    }
+    return (gap > airtime_us(frame)) ? gap : airtime_us(frame);
+}
+
+static void replay_host(const capture_frame_t *frames, uint32_t count, uint32_t speed, uint32_t passes)
+{
+    rx_path.ring_size = rx_config.capacity / (MESSAGE_HEADER + RX_ENTRY_HEADER + 4) + 1;
+    rx_path.messages = calloc(rx_path.ring_size, sizeof(rx_message_t));
+    rx_path.first_drop = UINT64_MAX;
+    if (rx_path.messages == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+
+    uint64_t now = 0;
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            rx_path_inject(&frames[idx], now);
+            if (idx + 1 < count || pass + 1 < passes)
+            {
+                now += replay_gap(&frames[idx], &frames[(idx + 1) % count], speed);
+            }
+        }
+    }
+
+    double seconds = now / 1e6;
+    printf("Replayed %" PRIu64 " frames in %.3f s (%.0f frames/s), %" PRIu64 " Enh-ACKs generated\n",
+           rx_path.injected, seconds, (seconds > 0) ? (rx_path.injected - 1) / seconds : 0, rx_path.enh_acks);
+    printf("RX buffer %" PRIu32 " bytes (at most %" PRIu32 " used), receiver task %" PRIu32 " us per frame\n",
+           rx_config.capacity, rx_path.max_used, rx_config.service_us);
+    if (rx_path.first_drop == UINT64_MAX)
+    {
+        printf("No drops\n");
+    }
+    else
+    {
+        printf("%" PRIu64 " dropped, the RX path sustained %" PRIu64 " frames before the first drop\n", rx_path.dropped, rx_path.first_drop);
+    }
+    free(rx_path.messages);
+}
+
+static void replay_script(const capture_frame_t *frames, uint32_t count, uint32_t speed, uint32_t passes, uint32_t buffer_size)
+{
+    uint32_t used = 0;
+    uint32_t loaded = 0;
+
+    printf("replay clear\n");
+    for (uint32_t idx = 0; idx < count; idx++)
+    {
+        if (used + REPLAY_RECORD_HEADER + frames[idx].length > buffer_size)
+        {
+            break;
+        }
+        used += REPLAY_RECORD_HEADER + frames[idx].length;
+        loaded += 1;
+
+        uint64_t delta = (idx > 0 && frames[idx].time_us > frames[idx - 1].time_us) ? frames[idx].time_us - frames[idx - 1].time_us : 0;
+        printf("replay add %" PRIu32 " ", (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta);
+        for (uint8_t pos = 0; pos < frames[idx].length; pos++)
+        {
+            printf("%02x", frames[idx].psdu[pos]);
+        }
+        printf("\n");
+    }
+
+    if (speed == 0)
+    {
+        printf("replay run fast %" PRIu32 "\n", passes);
+    }
+    else
+    {
+        printf("replay run x%" PRIu32 " %" PRIu32 "\n", speed, passes);
+    }
+    if (loaded < count)
+    {
+        fprintf(stderr, "Only the first %" PRIu32 " of %" PRIu32 " frames fit into the replay buffer of %" PRIu32 " bytes\n", loaded, count, buffer_size);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    uint32_t speed = 1;
+    uint32_t passes = 1;
+    uint32_t buffer_size = REPLAY_BUFFER_DEFAULT;
+    bool script = false;
+    rx_config.capacity = RX_BUFFER_DEFAULT;
+    rx_config.service_us = 250;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+        {
+            speed = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-f") == 0)
+        {
+            speed = 0;
+        }
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            passes = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            rx_config.capacity = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            rx_config.service_us = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-B") == 0 && i + 1 < argc)
+        {
+            buffer_size = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--script") == 0)
+        {
+            script = true;
+        }
+        else if (argv[i][0] != '-' && path == NULL)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            path = NULL;
+            break;
+        }
+    }
+
+    if (path == NULL || passes == 0)
+    {
+        fprintf(stderr, "Usage: %s [-x speed | -f] [-p passes] [-b rx_buffer_bytes] [-s service_us] [--script [-B replay_buffer_bytes]] capture.pcap\n", argv[0]);
+        return 1;
+    }
+
+    capture_t cap;
+    if (capture_open(path, &cap) != 0)
+    {
+        return 1;
+    }
+
+    capture_frame_t *frames;
+    uint32_t skipped;
+    uint32_t fcs_errors;
+    uint32_t count = capture_read(&cap, &frames, &skipped, &fcs_errors);
+    if (count == 0)
+    {
+        fprintf(stderr, "%s: no frames\n", path);
+        return 1;
+    }
+    if (skipped > 0)
+    {
+        fprintf(stderr, "Skipped %" PRIu32 " records that are not a valid PSDU\n", skipped);
+    }
+    if (fcs_errors > 0)
+    {
+        fprintf(stderr, "Skipped %" PRIu32 " frames with an invalid FCS\n", fcs_errors);
+    }
+
+    if (script)
+    {
+        replay_script(frames, count, speed, passes, buffer_size);
+    }
+    else
+    {
+        printf("%s: %" PRIu32 " frames over %.3f s, replayed %s\n", path, count, (frames[count - 1].time_us - frames[0].time_us) / 1e6,
+               (speed == 0) ? "as fast as possible" : (speed == 1) ? "with the captured timing" : "time-compressed");
+        replay_host(frames, count, speed, passes);
+    }
+
+    free(frames);
+    munmap((void *)cap.data, cap.size);
+    return 0;
+}
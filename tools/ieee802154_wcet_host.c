@@ -0,0 +1,281 @@
+/**
+ * Host instruction counts of the ISR-context code.
+ *
+ * Runs the WCET corpus of ieee802154_wcet.h (every frame control field with a valid length, then random frames)
+ * over the code paths of the radio callbacks, built from the component sources with the host shims in
+ * tools/host, and reports max, p99 and the worst input like on target. The counts are instructions instead of
+ * CPU cycles, so they do not depend on the host load and can be compared between versions:
+ * - enh_ack: esp_ieee802154_create_2015_ack_frame(), as in esp_ieee802154_enh_ack_generator().
+ * - rx: the receive path of esp_ieee802154_receive_done() of the receiver app (metrics, address table, RX entry
+ *   and message buffer).
+ * - tx: the transmit done path of esp_ieee802154_transmit_done() of the sender app, the corpus frames are the
+ *   ACKs of a frame the TX engine has in flight.
+ *
+ * The instructions are counted with the hardware counter (perf_event_open). Where it is not available (e.g. in
+ * a VM), the x86-64 trap flag is used to single-step the measured code, which is exact but slow (see the README
+ * for run times). The report labels the counts as instructions.
+ *
+ * Build (host, Linux):
+ *   gcc -O2 -DESP_PLATFORM -I tools/host -I components/ieee802154_util/include tools/ieee802154_wcet_host.c tools/host/host_idf.c tools/host/host_freertos.c tools/host/host_radio.c components/ieee802154_util/ieee802154_wcet.c components/ieee802154_util/ieee802154_util.c components/ieee802154_util/ieee802154_parse.c components/ieee802154_util/ieee802154_header.c components/ieee802154_util/ieee802154_ack_payload.c components/ieee802154_util/ieee802154_metrics.c components/ieee802154_util/ieee802154_addr_table.c components/ieee802154_util/ieee802154_rx_timing.c components/ieee802154_util/ieee802154_tx.c components/ieee802154_util/ieee802154_addr_book.c components/ieee802154_util/ieee802154_power.c components/ieee802154_util/ieee802154_ack_policy.c components/ieee802154_util/ieee802154_channel.c components/ieee802154_util/ieee802154_survey.c components/ieee802154_util/ieee802154_tx_latency.c components/ieee802154_util/ieee802154_histogram.c -o ieee802154_wcet_host
+ *
+ * Usage:
+ *   ieee802154_wcet_host [-p enh_ack|rx|tx|all] [-n random_frames] [-b budget_instructions] [-c perf|step]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/message_buffer.h>
+#include "esp_timer.h"
+#include "host_idf.h"
+#include "ieee802154_util.h"
+#include "ieee802154_wcet.h"
+#include "ieee802154_metrics.h"
+#include "ieee802154_addr_table.h"
+#include "ieee802154_rx_timing.h"
+#include "ieee802154_tx.h"
+
+#define RX_BUFFER_SIZE   (4 * sizeof(ieee802154_rx_entry_t)) // As in the apps
+#define TX_QUEUE_LENGTH  32                                   // Keeps a frame in flight for the whole corpus
+#define TX_PRIORITY      19
+
+/* --- Instruction counters --- */
+
+static int perf_fd = -1;
+
+static uint32_t perf_counter(void)
+{
+    uint64_t count = 0;
+    if (read(perf_fd, &count, sizeof(count)) != sizeof(count))
+    {
+        return 0;
+    }
+    return (uint32_t)count;
+}
+
+static bool perf_open(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    perf_fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return perf_fd >= 0;
+}
+
+#if defined(__x86_64__)
+/**
+ * Single-step counter: every instruction with the trap flag set raises SIGTRAP. The wcet harness reads the
+ * counter once before and once after the measured code, so the first read of a pair sets the trap flag and the
+ * second clears it. The instructions of the two reads themselves are calibrated out.
+ */
+static volatile uint32_t step_count = 0;
+static bool step_running = false;
+static uint32_t step_overhead = 0;
+
+static void step_trap(int signal)
+{
+    step_count += 1;
+}
+
+static __attribute__((noinline)) uint32_t step_counter(void)
+{
+    if (!step_running)
+    {
+        step_running = true;
+        uint32_t count = step_count + step_overhead;
+        __asm__ volatile("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+        return count;
+    }
+    __asm__ volatile("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+    step_running = false;
+    return step_count;
+}
+
+static bool step_open(void)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = step_trap;
+    if (sigaction(SIGTRAP, &action, NULL) != 0)
+    {
+        return false;
+    }
+
+    uint32_t start = step_counter();
+    step_overhead = step_counter() - start;
+    return true;
+}
+#else
+static uint32_t step_counter(void)
+{
+    return 0;
+}
+
+static bool step_open(void)
+{
+    return false;
+}
+#endif
+
+/* --- Code paths --- */
+
+static MessageBufferHandle_t rx_buffer;
+static const uint8_t *tx_in_flight = NULL;
+
+static void measure_enh_ack(uint8_t *frame)
+{
+    static uint8_t enhack_frame[128];
+    esp_ieee802154_create_2015_ack_frame(frame, enhack_frame);
+}
+
+/* As receive_frame() in ieee802154-rx/main/main.c */
+static void measure_rx(uint8_t *frame)
+{
+    esp_ieee802154_frame_info_t frame_info = { 0 };
+
+    esp_ieee802154_metrics_inc(IEEE802154_METRIC_RX_FRAMES);
+    esp_ieee802154_metrics_add(IEEE802154_METRIC_RX_BYTES, frame[0]);
+
+    bool accepted = esp_ieee802154_addr_table_receive(frame);
+    ieee802154_rx_entry_t entry;
+    if (accepted && xMessageBufferSendFromISR(rx_buffer, &entry, esp_ieee802154_rx_entry_fill(&entry, frame, &frame_info), NULL) == 0)
+    {
+        esp_ieee802154_metrics_inc(IEEE802154_METRIC_RX_DROPPED);
+    }
+    esp_ieee802154_metrics_max(IEEE802154_METRIC_RX_BUFFER_MAX, RX_BUFFER_SIZE - xMessageBufferSpacesAvailable(rx_buffer));
+}
+
+/* As transmit_frame_done() in ieee802154-tx/main/main.c */
+static void measure_tx(uint8_t *ack)
+{
+    esp_ieee802154_frame_info_t ack_frame_info = { 0 };
+
+    ieee802154_rx_entry_t entry;
+    xMessageBufferSendFromISR(rx_buffer, &entry, esp_ieee802154_rx_entry_fill(&entry, ack, &ack_frame_info), NULL);
+    esp_ieee802154_tx_engine_transmit_done(tx_in_flight, ack, &ack_frame_info);
+}
+
+/* The radio never reports the outcome, the frame stays in flight until the engine times out */
+static esp_err_t radio_transmit(void *ctx, const uint8_t *frame, bool cca)
+{
+    tx_in_flight = frame;
+    return ESP_OK;
+}
+
+static void tx_setup(void)
+{
+    host_radio_hooks_t hooks = {
+        .transmit = radio_transmit,
+    };
+    host_radio_set_hooks(&hooks);
+    ESP_ERROR_CHECK(esp_ieee802154_tx_engine_start(TX_QUEUE_LENGTH, TX_PRIORITY));
+
+    // A data frame to 0x0002 with ACK request, the engine picks the first one right away
+    uint8_t frame[] = { 11, 0x61, 0x88, 0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00 };
+    for (int idx = 0; idx < TX_QUEUE_LENGTH; idx++)
+    {
+        ESP_ERROR_CHECK(esp_ieee802154_tx_engine_submit(frame, true, NULL, NULL, 0));
+    }
+    host_run(esp_timer_get_time());
+}
+
+/* --- Main --- */
+
+static bool run(const char *name, ieee802154_wcet_handler_t handler, uint32_t random_frames, uint32_t budget)
+{
+    static ieee802154_wcet_t wcet;
+
+    esp_ieee802154_wcet_init(&wcet, name);
+    wcet.unit = "instructions";
+    esp_ieee802154_wcet_run_corpus(&wcet, handler, random_frames);
+    xMessageBufferReset(rx_buffer);
+    return esp_ieee802154_wcet_report(&wcet, budget) == ESP_OK;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = "all";
+    const char *counter = NULL;
+    uint32_t random_frames = CONFIG_IEEE802154_UTIL_WCET_RANDOM_FRAMES;
+    uint32_t budget = CONFIG_IEEE802154_UTIL_WCET_BUDGET_CYCLES;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            path = argv[++i];
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            random_frames = strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            budget = strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+        {
+            counter = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-p enh_ack|rx|tx|all] [-n random_frames] [-b budget_instructions] [-c perf|step]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bool all = strcmp(path, "all") == 0;
+    if (!all && strcmp(path, "enh_ack") != 0 && strcmp(path, "rx") != 0 && strcmp(path, "tx") != 0)
+    {
+        fprintf(stderr, "Unknown path %s\n", path);
+        return 1;
+    }
+
+    if ((counter == NULL || strcmp(counter, "perf") == 0) && perf_open())
+    {
+        host_cpu_set_counter(perf_counter);
+        printf("Counting instructions with the hardware counter\n");
+    }
+    else if ((counter == NULL || strcmp(counter, "step") == 0) && step_open())
+    {
+        host_cpu_set_counter(step_counter);
+        printf("Counting instructions by single-stepping (slow)\n");
+    }
+    else
+    {
+        fprintf(stderr, "No instruction counter available\n");
+        return 1;
+    }
+
+    rx_buffer = xMessageBufferCreate(RX_BUFFER_SIZE);
+    tx_setup();
+
+    bool ok = true;
+    if (all || strcmp(path, "enh_ack") == 0)
+    {
+        ok &= run("esp_ieee802154_enh_ack_generator", measure_enh_ack, random_frames, budget);
+    }
+    if (all || strcmp(path, "rx") == 0)
+    {
+        ok &= run("esp_ieee802154_receive_done", measure_rx, random_frames, budget);
+    }
+    if (all || strcmp(path, "tx") == 0)
+    {
+        ok &= run("esp_ieee802154_transmit_done", measure_tx, random_frames, budget);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+/**
+ * Host simulation of the sliding window transport.
+ *
+ * Runs the protocol core of the utility library (ieee802154_window.c) between a sender and a receiver on a
+ * simulated half-duplex 250 kbit/s channel with unslotted CSMA-CA backoff and independent frame loss, and
+ * reports the goodput per window size. Window 1 is stop-and-wait on transport ACKs, the row "mac" is the
+ * stop-and-wait baseline with MAC ACK request (what the data frame API does today).
+ *
+ * Build (host):
+ *   gcc -O2 -I components/ieee802154_util/include tools/ieee802154_window_sim.c components/ieee802154_util/ieee802154_window.c -o ieee802154_window_sim
+ *
+ * Usage:
+ *   ieee802154_window_sim [-n segments] [-s segment_size] [-l loss_percent] [-d ack_delay_us]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ieee802154_window.h"
+
+#define US_PER_BYTE         32      // 250 kbit/s
+#define PHY_OVERHEAD        6       // Preamble, SFD and PHR
+#define MAC_OVERHEAD        11      // FCF, seq, dst pan, dst and src short address, FCS
+#define IMM_ACK_LENGTH      5       // FCF, seq, FCS
+#define TURNAROUND_US       192     // aTurnaroundTime
+#define CCA_US              128     // 8 symbols
+#define BACKOFF_PERIOD_US   320     // aUnitBackoffPeriod
+#define MIN_BE              3       // macMinBe
+#define MAC_ACK_WAIT_US     864     // macAckWaitDuration
+#define MAC_MAX_RETRIES     3       // macMaxFrameRetries
+
+typedef struct {
+    uint32_t segments;
+    uint8_t segment_size;
+    double loss;
+    uint32_t ack_delay_us;
+} sim_config_t;
+
+typedef struct {
+    uint32_t next_index;
+    bool in_order;
+} sim_sink_t;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static bool frame_lost(const sim_config_t *config)
+{
+    return (rng_next() / 4294967296.0) < config->loss;
+}
+
+/* Time to get a frame with the given MAC payload on the air: CSMA-CA backoff, CCA, turnaround and airtime */
+static uint32_t frame_time(uint8_t payload_length)
+{
+    uint32_t backoff = (rng_next() % (1 << MIN_BE)) * BACKOFF_PERIOD_US;
+    return backoff + CCA_US + TURNAROUND_US + (PHY_OVERHEAD + MAC_OVERHEAD + payload_length) * US_PER_BYTE;
+}
+
+static void sink_deliver(const uint8_t *data, uint8_t length, void *arg)
+{
+    sim_sink_t *sink = arg;
+    uint32_t index;
+    memcpy(&index, data, sizeof(index));
+    if (index != sink->next_index || length < sizeof(index))
+    {
+        sink->in_order = false;
+    }
+    sink->next_index += 1;
+}
+
+static void fill_segment(uint8_t *segment, uint8_t length, uint32_t index)
+{
+    memset(segment, (uint8_t)index, length);
+    memcpy(segment, &index, sizeof(index));
+}
+
+/* --- Simulations --- */
+
+static uint64_t simulate_mac_ack(const sim_config_t *config, uint32_t *transmissions)
+{
+    uint64_t now = 0;
+    *transmissions = 0;
+
+    uint32_t delivered = 0;
+    while (delivered < config->segments)
+    {
+        // A frame that is dropped after all retries is sent again by the application
+        bool acked = false;
+        for (uint8_t attempt = 0; attempt <= MAC_MAX_RETRIES && !acked; attempt++)
+        {
+            *transmissions += 1;
+            now += frame_time(config->segment_size);
+            acked = !frame_lost(config) && !frame_lost(config); // Data and ACK
+            now += acked ? TURNAROUND_US + (PHY_OVERHEAD + IMM_ACK_LENGTH) * US_PER_BYTE : MAC_ACK_WAIT_US;
+        }
+        delivered += acked;
+    }
+    return now;
+}
+
+static uint64_t simulate_window(const sim_config_t *config, uint8_t window, uint32_t rto_us, ieee802154_window_tx_t *tx,
+                                ieee802154_window_rx_t *rx, sim_sink_t *sink)
+{
+    uint8_t segment[IEEE802154_WINDOW_MAX_SEGMENT];
+    uint8_t payload[IEEE802154_MAX_PSDU_LENGTH];
+    uint32_t enqueued = 0;
+    uint64_t now = 0;
+    uint64_t last_rx = 0;
+
+    esp_ieee802154_window_tx_init(tx, window, rto_us);
+    esp_ieee802154_window_rx_init(rx, window);
+    sink->next_index = 0;
+    sink->in_order = true;
+
+    while (rx->delivered < config->segments)
+    {
+        while (enqueued < config->segments)
+        {
+            fill_segment(segment, config->segment_size, enqueued);
+            if (!esp_ieee802154_window_tx_enqueue(tx, segment, config->segment_size))
+            {
+                break;
+            }
+            enqueued += 1;
+        }
+
+        // The receiver acknowledges at once after a gap or window / 2 segments, otherwise after the ACK delay
+        if (rx->ack_now || (rx->unacked > 0 && now - last_rx >= config->ack_delay_us))
+        {
+            uint8_t length = esp_ieee802154_window_rx_build_ack(rx, payload);
+            now += frame_time(length);
+            if (!frame_lost(config))
+            {
+                esp_ieee802154_window_tx_ack(tx, payload, length);
+            }
+            continue;
+        }
+
+        uint8_t length = esp_ieee802154_window_tx_poll(tx, (uint32_t)now, payload);
+        if (length > 0)
+        {
+            now += frame_time(length);
+            if (!frame_lost(config))
+            {
+                esp_ieee802154_window_rx_input(rx, payload, length, sink_deliver, sink);
+                last_rx = now;
+            }
+            continue;
+        }
+
+        // Idle until the next retransmission timeout or delayed ACK
+        uint64_t wait = esp_ieee802154_window_tx_next_timeout(tx, (uint32_t)now);
+        if (rx->unacked > 0 && config->ack_delay_us - (now - last_rx) < wait)
+        {
+            wait = config->ack_delay_us - (now - last_rx);
+        }
+        now += (wait > 0) ? wait : 1;
+    }
+    return now;
+}
+
+static double goodput_kbps(const sim_config_t *config, uint64_t duration_us)
+{
+    return (double)config->segments * config->segment_size * 8 * 1000 / (double)duration_us;
+}
+
+int main(int argc, char **argv)
+{
+    sim_config_t config = {
+        .segments = 10000,
+        .segment_size = 100,
+        .loss = 0.01,
+        .ack_delay_us = 2000,
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            config.segments = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+        {
+            config.segment_size = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+        {
+            config.loss = atof(argv[++i]) / 100.0;
+        }
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+        {
+            config.ack_delay_us = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [-n segments] [-s segment_size] [-l loss_percent] [-d ack_delay_us]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.segment_size < sizeof(uint32_t) || config.segment_size > IEEE802154_MAX_PSDU_LENGTH - MAC_OVERHEAD - IEEE802154_WINDOW_HEADER_LENGTH)
+    {
+        fprintf(stderr, "Segment size must be between %d and %d bytes\n", (int)sizeof(uint32_t),
+                IEEE802154_MAX_PSDU_LENGTH - MAC_OVERHEAD - IEEE802154_WINDOW_HEADER_LENGTH);
+        return 1;
+    }
+
+    static ieee802154_window_tx_t tx;
+    static ieee802154_window_rx_t rx;
+    sim_sink_t sink;
+
+    printf("%u segments of %u bytes, %.1f %% frame loss, ACK delay %u us\n\n", config.segments, config.segment_size,
+           config.loss * 100, config.ack_delay_us);
+    printf("%-8s %12s %14s %16s\n", "window", "kbit/s", "transmissions", "retransmissions");
+
+    uint32_t transmissions;
+    uint64_t duration = simulate_mac_ack(&config, &transmissions);
+    printf("%-8s %12.1f %14u %16u\n", "mac", goodput_kbps(&config, duration), transmissions, transmissions - config.segments);
+
+    for (uint8_t window = 1; window <= IEEE802154_WINDOW_MAX; window *= 2)
+    {
+        // Time for a full window and the ACK, with one maximum backoff per frame as margin
+        uint32_t rto_us = (window + 1) * (frame_time(IEEE802154_WINDOW_HEADER_LENGTH + config.segment_size) + (1 << MIN_BE) * BACKOFF_PERIOD_US) + config.ack_delay_us;
+        duration = simulate_window(&config, window, rto_us, &tx, &rx, &sink);
+        if (!sink.in_order)
+        {
+            fprintf(stderr, "Window %u: segments delivered out of order\n", window);
+            return 1;
+        }
+        printf("%-8u %12.1f %14u %16u\n", window, goodput_kbps(&config, duration), tx.transmissions, tx.retransmissions);
+    }
+    return 0;
+}